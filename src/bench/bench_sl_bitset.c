@@ -0,0 +1,67 @@
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#include "../sl_bitset.h"
+#include <snlsys/snlsys.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NB_BITS (1UL << 20)
+#define NB_BITSETS 256
+#define NB_RUNS 16
+
+static double
+now(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1.e-9;
+}
+
+/* Combine NB_BITSETS bitsets as a filter evaluation would do and count the
+ * matching bits. */
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_bitset* bitsets[NB_BITSETS];
+  struct sl_bitset* result = NULL;
+  uint64_t* words = NULL;
+  size_t nb_words = 0;
+  size_t count = 0;
+  size_t checksum = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t run = 0;
+  double t = 0;
+
+  for(i = 0; i < NB_BITSETS; ++i) {
+    SL(create_bitset(NB_BITS, NULL, bitsets + i));
+    SL(bitset_buffer(bitsets[i], &nb_words, &words));
+    for(j = 0; j < NB_BITS / 64; ++j)
+      words[j] = (uint64_t)rand() << 33 | (uint64_t)rand() << 2 | i % 4;
+  }
+  SL(create_bitset(NB_BITS, NULL, &result));
+
+  t = now();
+  for(run = 0; run < NB_RUNS; ++run) {
+    SL(bitset_reset(result));
+    for(i = 0; i < NB_BITSETS; i += 4) {
+      SL(bitset_or(result, bitsets[i]));
+      SL(bitset_and(result, bitsets[i + 1]));
+      SL(bitset_xor(result, bitsets[i + 2]));
+      SL(bitset_andnot(result, bitsets[i + 3]));
+    }
+    SL(bitset_count(result, &count));
+    checksum += count;
+  }
+  t = now() - t;
+  printf("%.2f GB/s (checksum %lu)\n",
+    (double)(NB_RUNS * NB_BITSETS) * (double)(NB_BITS / 8) / t * 1.e-9,
+    (unsigned long)checksum);
+
+  for(i = 0; i < NB_BITSETS; ++i)
+    SL(free_bitset(bitsets[i]));
+  SL(free_bitset(result));
+  return 0;
+}
+
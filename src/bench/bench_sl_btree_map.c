@@ -0,0 +1,140 @@
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#include "../sl_btree_map.h"
+#include "../sl_flat_map.h"
+#include <snlsys/snlsys.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NB_LOOKUPS (1UL << 21)
+#define MAX_FLAT_KEYS 300000 /* Flat maps are not built past this size. */
+
+static double
+now(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1.e-9;
+}
+
+static int
+cmp_u32(const void* a, const void* b)
+{
+  const uint32_t i = *(const uint32_t*)a;
+  const uint32_t j = *(const uint32_t*)b;
+  return (i > j) - (i < j);
+}
+
+static uint32_t
+next_random(uint64_t* rng)
+{
+  *rng ^= *rng << 13;
+  *rng ^= *rng >> 7;
+  *rng ^= *rng << 17;
+  return (uint32_t)(*rng >> 32);
+}
+
+/* Insert nb_keys random keys, look for random keys, scan the map in order
+ * and erase half of the keys, in a B+tree map and in a flat map. */
+static void
+run(const size_t nb_keys)
+{
+  struct sl_btree_map* btree = NULL;
+  struct sl_flat_map* flat = NULL;
+  struct sl_btree_map_it it;
+  bool is_end_reached = false;
+  uint32_t* keys = NULL;
+  uint32_t* sorted_keys = NULL;
+  uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  uint64_t checksum = 0;
+  size_t len = 0;
+  size_t i = 0;
+  void* data = NULL;
+  double t_insert = 0;
+  double t_find = 0;
+  double t_scan = 0;
+  double t_erase = 0;
+
+  keys = malloc(nb_keys * sizeof(uint32_t));
+  sorted_keys = malloc(nb_keys * sizeof(uint32_t));
+  if(!keys || !sorted_keys) {
+    fprintf(stderr, "Not enough memory\n");
+    exit(1);
+  }
+  for(i = 0; i < nb_keys; ++i)
+    keys[i] = next_random(&rng);
+
+  SL(create_btree_map(sizeof(uint32_t), ALIGNOF(uint32_t), sizeof(uint32_t),
+    ALIGNOF(uint32_t), cmp_u32, NULL, &btree));
+  t_insert = now();
+  for(i = 0; i < nb_keys; ++i)
+    sl_btree_map_insert(btree, keys + i, keys + i); /* Fails on duplicates. */
+  t_insert = now() - t_insert;
+  t_find = now();
+  for(i = 0; i < NB_LOOKUPS; ++i) {
+    SL(btree_map_find(btree, keys + (i * 7) % nb_keys, &data));
+    checksum += *(uint32_t*)data;
+  }
+  t_find = now() - t_find;
+  t_scan = now();
+  SL(btree_map_begin(btree, &it, &is_end_reached));
+  for(len = 0; !is_end_reached; ++len) {
+    sorted_keys[len] = *(uint32_t*)it.pair.key;
+    checksum += *(uint32_t*)it.pair.data;
+    SL(btree_map_it_next(&it, &is_end_reached));
+  }
+  t_scan = now() - t_scan;
+  t_erase = now();
+  for(i = 0; i < nb_keys; i += 2)
+    sl_btree_map_erase(btree, keys + i); /* Fails on duplicates. */
+  t_erase = now() - t_erase;
+  printf("%8lu keys: btree insert %6.3f s, find %5.2f M/s, scan %5.1f M/s, "
+    "erase %6.3f s\n", (unsigned long)nb_keys, t_insert,
+    (double)NB_LOOKUPS / t_find * 1.e-6, (double)len / t_scan * 1.e-6,
+    t_erase);
+
+  SL(clear_btree_map(btree));
+  t_insert = now();
+  SL(btree_map_bulk_load(btree, sorted_keys, sorted_keys, len));
+  t_insert = now() - t_insert;
+  printf("%8lu keys: btree bulk load %6.3f s\n", (unsigned long)len, t_insert);
+  SL(free_btree_map(btree));
+
+  if(nb_keys <= MAX_FLAT_KEYS) {
+    SL(create_flat_map(sizeof(uint32_t), ALIGNOF(uint32_t), sizeof(uint32_t),
+      ALIGNOF(uint32_t), cmp_u32, NULL, &flat));
+    t_insert = now();
+    for(i = 0; i < nb_keys; ++i)
+      sl_flat_map_insert(flat, keys + i, keys + i, NULL);
+    t_insert = now() - t_insert;
+    t_find = now();
+    for(i = 0; i < NB_LOOKUPS; ++i) {
+      SL(flat_map_find(flat, keys + (i * 7) % nb_keys, &data));
+      checksum += *(uint32_t*)data;
+    }
+    t_find = now() - t_find;
+    t_erase = now();
+    for(i = 0; i < nb_keys; i += 2)
+      sl_flat_map_erase(flat, keys + i, NULL);
+    t_erase = now() - t_erase;
+    printf("%8lu keys: flat  insert %6.3f s, find %5.2f M/s, "
+      "erase %6.3f s\n", (unsigned long)nb_keys, t_insert,
+      (double)NB_LOOKUPS / t_find * 1.e-6, t_erase);
+    SL(free_flat_map(flat));
+  }
+  printf("checksum %lu\n", (unsigned long)checksum);
+  free(keys);
+  free(sorted_keys);
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  const size_t sizes[] = { 10000, 100000, 300000, 4000000 };
+  size_t i = 0;
+  for(i = 0; i < sizeof(sizes)/sizeof(size_t); ++i)
+    run(sizes[i]);
+  return 0;
+}
+
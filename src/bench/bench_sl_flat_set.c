@@ -0,0 +1,447 @@
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#include "../sl_flat_map.h"
+#include "../sl_flat_set.h"
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NB_LOOKUPS (1UL << 22)
+#define NB_BULK_KEYS 10000000
+#define NB_SINGLE_KEYS 200000
+#define NB_MAP_KEYS 1000000
+#define NB_UPDATES 100000
+#define NB_INGESTED_KEYS 10000000
+#define NB_WINDOW_KEYS 200000 /* # pairs of the time window. */
+#define NB_SLIDES 20
+#define NB_QUERIES 1000000
+#define SLIDE_LENGTH 500
+#define NB_IDS 1000000 /* # ids of the large posting lists. */
+#define NB_INTERSECTIONS 20
+
+static double
+now(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1.e-9;
+}
+
+static int
+cmp_u32(const void* a, const void* b)
+{
+  const uint32_t i = *(const uint32_t*)a;
+  const uint32_t j = *(const uint32_t*)b;
+  return (i > j) - (i < j);
+}
+
+static int
+cmp_u64(const void* a, const void* b)
+{
+  const uint64_t i = *(const uint64_t*)a;
+  const uint64_t j = *(const uint64_t*)b;
+  return (i > j) - (i < j);
+}
+
+static uint32_t
+next_random(uint64_t* rng)
+{
+  *rng ^= *rng << 13;
+  *rng ^= *rng >> 7;
+  *rng ^= *rng << 17;
+  return (uint32_t)(*rng >> 32);
+}
+
+/* Look for random keys in a set of nb_keys even keys: half of the lookups
+ * fail. */
+static void
+run_lookups(size_t nb_keys, const bool is_frozen)
+{
+  struct sl_flat_set* set = NULL;
+  uint32_t* keys = NULL;
+  uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  size_t checksum = 0;
+  size_t id = 0;
+  size_t i = 0;
+  double t_find = 0;
+  double t_bound = 0;
+
+  SL(create_flat_set(sizeof(uint32_t), ALIGNOF(uint32_t), cmp_u32, NULL,
+    &set));
+  SL(flat_set_reserve(set, nb_keys));
+  for(i = 0; i < nb_keys; ++i) {
+    const uint32_t key = (uint32_t)i * 2;
+    SL(flat_set_insert(set, &key, NULL));
+  }
+  if(is_frozen)
+    SL(flat_set_freeze(set));
+  keys = malloc(NB_LOOKUPS * sizeof(uint32_t));
+  if(!keys) {
+    fprintf(stderr, "Not enough memory\n");
+    exit(1);
+  }
+  for(i = 0; i < NB_LOOKUPS; ++i)
+    keys[i] = next_random(&rng) % (uint32_t)(nb_keys * 2);
+
+  t_find = now();
+  for(i = 0; i < NB_LOOKUPS; ++i) {
+    SL(flat_set_find(set, keys + i, &id));
+    checksum += id;
+  }
+  t_find = now() - t_find;
+
+  t_bound = now();
+  for(i = 0; i < NB_LOOKUPS; ++i) {
+    SL(flat_set_lower_bound(set, keys + i, &id));
+    checksum += id;
+  }
+  t_bound = now() - t_bound;
+
+  printf("%9lu keys%s: find %6.2f M/s, lower bound %6.2f M/s "
+    "(checksum %lu)\n",
+    (unsigned long)nb_keys, is_frozen ? " (frozen)" : "",
+    (double)NB_LOOKUPS / t_find * 1.e-6,
+    (double)NB_LOOKUPS / t_bound * 1.e-6,
+    (unsigned long)checksum);
+
+  free(keys);
+  SL(free_flat_set(set));
+}
+
+/* Build a set and a map from random keys with sl_flat_set_insert_n and
+ * sl_flat_map_insert_n, and a set with one sl_flat_set_insert per key. */
+static void
+run_build(void)
+{
+  struct sl_flat_set* set = NULL;
+  struct sl_flat_map* map = NULL;
+  uint32_t* keys = NULL;
+  uint64_t rng = 0x2545F4914F6CDD1DULL;
+  size_t len = 0;
+  size_t i = 0;
+  double t = 0;
+
+  keys = malloc(NB_BULK_KEYS * sizeof(uint32_t));
+  if(!keys) {
+    fprintf(stderr, "Not enough memory\n");
+    exit(1);
+  }
+  for(i = 0; i < NB_BULK_KEYS; ++i)
+    keys[i] = next_random(&rng);
+
+  SL(create_flat_set(sizeof(uint32_t), ALIGNOF(uint32_t), cmp_u32, NULL,
+    &set));
+  t = now();
+  for(i = 0; i < NB_SINGLE_KEYS; ++i)
+    sl_flat_set_insert(set, keys + i, NULL); /* Fails on duplicates. */
+  t = now() - t;
+  SL(flat_set_length(set, &len));
+  printf("insert:   %8lu keys in %6.3f s\n", (unsigned long)len, t);
+
+  SL(clear_flat_set(set));
+  t = now();
+  SL(flat_set_insert_n
+    (set, keys, NB_BULK_KEYS, SL_DUPLICATE_KEEP_FIRST, NULL));
+  t = now() - t;
+  SL(flat_set_length(set, &len));
+  printf("insert_n: %8lu keys in %6.3f s (set)\n", (unsigned long)len, t);
+  SL(free_flat_set(set));
+
+  SL(create_flat_map(sizeof(uint32_t), ALIGNOF(uint32_t), sizeof(uint32_t),
+    ALIGNOF(uint32_t), cmp_u32, NULL, &map));
+  t = now();
+  SL(flat_map_insert_n
+    (map, keys, keys, NB_BULK_KEYS, SL_DUPLICATE_KEEP_LAST, NULL));
+  t = now() - t;
+  SL(flat_map_length(map, &len));
+  printf("insert_n: %8lu keys in %6.3f s (map)\n", (unsigned long)len, t);
+  SL(free_flat_map(map));
+  free(keys);
+}
+
+/* Interleave inserts, erases and lookups on a map of NB_MAP_KEYS pairs, with
+ * or without the write buffer. */
+static void
+run_updates(const size_t max_delta_length)
+{
+  struct sl_flat_map* map = NULL;
+  uint32_t* keys = NULL;
+  uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  size_t checksum = 0;
+  size_t i = 0;
+  void* data = NULL;
+  double t = 0;
+
+  keys = malloc(NB_MAP_KEYS * sizeof(uint32_t));
+  if(!keys) {
+    fprintf(stderr, "Not enough memory\n");
+    exit(1);
+  }
+  for(i = 0; i < NB_MAP_KEYS; ++i)
+    keys[i] = (uint32_t)i * 2;
+  SL(create_flat_map(sizeof(uint32_t), ALIGNOF(uint32_t), sizeof(uint32_t),
+    ALIGNOF(uint32_t), cmp_u32, NULL, &map));
+  SL(flat_map_insert_n
+    (map, keys, keys, NB_MAP_KEYS / 2, SL_DUPLICATE_REJECT, NULL));
+  if(max_delta_length)
+    SL(flat_map_enable_delta(map, max_delta_length));
+
+  t = now();
+  for(i = 0; i < NB_UPDATES; ++i) {
+    const uint32_t key = next_random(&rng) % (uint32_t)(NB_MAP_KEYS * 2);
+    const uint32_t value = (uint32_t)i;
+    if(i % 4 == 3) {
+      sl_flat_map_erase(map, &key, NULL); /* Fails on missing keys. */
+    } else {
+      sl_flat_map_insert(map, &key, &value, NULL); /* Fails on duplicates. */
+    }
+    SL(flat_map_find(map, keys + i % NB_MAP_KEYS, &data));
+    checksum += data != NULL;
+  }
+  SL(flat_map_merge_delta(map));
+  t = now() - t;
+  printf("updates:  %8lu in %6.3f s, delta of %5lu pairs (checksum %lu)\n",
+    (unsigned long)NB_UPDATES, t, (unsigned long)max_delta_length,
+    (unsigned long)checksum);
+  SL(free_flat_map(map));
+  free(keys);
+}
+
+/* Insert time stamps in increasing order, and then nearly sorted ones whose
+ * insertion is hinted by the id of the previous insertion. */
+static void
+run_ingest(void)
+{
+  struct sl_flat_map* map = NULL;
+  uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  size_t hint = 0;
+  size_t id = 0;
+  size_t len = 0;
+  size_t i = 0;
+  double t = 0;
+
+  SL(create_flat_map(sizeof(uint32_t), ALIGNOF(uint32_t), sizeof(uint32_t),
+    ALIGNOF(uint32_t), cmp_u32, NULL, &map));
+  t = now();
+  for(i = 0; i < NB_INGESTED_KEYS; ++i) {
+    const uint32_t key = (uint32_t)i * 4;
+    SL(flat_map_insert(map, &key, &key, NULL));
+  }
+  t = now() - t;
+  printf("ingest:   %8lu sorted keys in %6.3f s\n",
+    (unsigned long)NB_INGESTED_KEYS, t);
+
+  /* Each key may precede the 2 previous ones; duplicates are rejected. */
+  SL(clear_flat_map(map));
+  t = now();
+  for(i = 0; i < NB_INGESTED_KEYS; ++i) {
+    const uint32_t key = (uint32_t)i * 8 + next_random(&rng) % 24;
+    if(sl_flat_map_insert_hint(map, &key, &key, hint, &id) == SL_NO_ERROR)
+      hint = id + 1;
+  }
+  t = now() - t;
+  SL(flat_map_length(map, &len));
+  printf("ingest:   %8lu nearly sorted keys in %6.3f s (%lu inserted)\n",
+    (unsigned long)NB_INGESTED_KEYS, t, (unsigned long)len);
+  SL(free_flat_map(map));
+}
+
+/* Slide a time window: append the new time stamps and drop the oldest ones,
+ * key by key or as one range. */
+static void
+run_retention(const bool use_range)
+{
+  struct sl_flat_map* map = NULL;
+  size_t i = 0;
+  size_t j = 0;
+  double t = 0;
+
+  SL(create_flat_map(sizeof(uint32_t), ALIGNOF(uint32_t), sizeof(uint32_t),
+    ALIGNOF(uint32_t), cmp_u32, NULL, &map));
+  for(i = 0; i < NB_WINDOW_KEYS; ++i) {
+    const uint32_t key = (uint32_t)i;
+    SL(flat_map_insert(map, &key, &key, NULL));
+  }
+  t = now();
+  for(i = 0; i < NB_SLIDES; ++i) {
+    const uint32_t oldest = (uint32_t)(i * SLIDE_LENGTH);
+    const uint32_t cutoff = oldest + SLIDE_LENGTH;
+    for(j = 0; j < SLIDE_LENGTH; ++j) {
+      const uint32_t key = (uint32_t)(NB_WINDOW_KEYS + i * SLIDE_LENGTH + j);
+      SL(flat_map_insert(map, &key, &key, NULL));
+    }
+    if(use_range) {
+      SL(flat_map_erase_range(map, NULL, &cutoff, NULL));
+    } else {
+      for(j = 0; j < SLIDE_LENGTH; ++j) {
+        const uint32_t key = oldest + (uint32_t)j;
+        SL(flat_map_erase(map, &key, NULL));
+      }
+    }
+  }
+  t = now() - t;
+  printf("window:   %8lu slides of %lu keys in %6.3f s, %s\n",
+    (unsigned long)NB_SLIDES, (unsigned long)SLIDE_LENGTH, t,
+    use_range ? "range erase" : "key erase");
+  SL(free_flat_map(map));
+}
+
+/* Look for NB_QUERIES random keys in a set of nb_keys keys, one by one and
+ * as a batch, the queries being sorted or not. */
+static void
+run_find_n(const size_t nb_keys, const bool is_sorted)
+{
+  struct sl_flat_set* set = NULL;
+  uint32_t* keys = NULL;
+  uint32_t* queries = NULL;
+  size_t* ids = NULL;
+  uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  size_t checksum = 0;
+  size_t id = 0;
+  size_t i = 0;
+  double t_find = 0;
+  double t_find_n = 0;
+
+  keys = malloc(nb_keys * sizeof(uint32_t));
+  queries = malloc(NB_QUERIES * sizeof(uint32_t));
+  ids = malloc(NB_QUERIES * sizeof(size_t));
+  if(!keys || !queries || !ids) {
+    fprintf(stderr, "Not enough memory\n");
+    exit(1);
+  }
+  for(i = 0; i < nb_keys; ++i)
+    keys[i] = (uint32_t)i * 2;
+  SL(create_flat_set
+    (sizeof(uint32_t), ALIGNOF(uint32_t), cmp_u32, NULL, &set));
+  SL(flat_set_insert_n(set, keys, nb_keys, SL_DUPLICATE_REJECT, NULL));
+  for(i = 0; i < NB_QUERIES; ++i)
+    queries[i] = next_random(&rng) % (uint32_t)(nb_keys * 2);
+  if(is_sorted)
+    qsort(queries, NB_QUERIES, sizeof(uint32_t), cmp_u32);
+
+  t_find = now();
+  for(i = 0; i < NB_QUERIES; ++i) {
+    SL(flat_set_find(set, queries + i, &id));
+    checksum += id;
+  }
+  t_find = now() - t_find;
+  t_find_n = now();
+  SL(flat_set_find_n(set, queries, NB_QUERIES, ids));
+  t_find_n = now() - t_find_n;
+  for(i = 0; i < NB_QUERIES; ++i)
+    checksum -= ids[i];
+  printf("find_n:   %8lu keys, %s queries: find %6.3f s, find_n %6.3f s "
+    "(checksum %lu)\n", (unsigned long)nb_keys,
+    is_sorted ? "sorted  " : "unsorted", t_find, t_find_n,
+    (unsigned long)checksum);
+  SL(free_flat_set(set));
+  free(keys);
+  free(queries);
+  free(ids);
+}
+
+/* Fill the set with nb_ids random ids lower than 16 * NB_IDS. */
+static void
+fill_ids
+  (struct sl_flat_set* set,
+   const size_t id_size,
+   const size_t nb_ids,
+   uint64_t* rng)
+{
+  void* ids = NULL;
+  size_t i = 0;
+
+  ids = malloc(nb_ids * id_size);
+  if(!ids) {
+    fprintf(stderr, "Not enough memory\n");
+    exit(1);
+  }
+  for(i = 0; i < nb_ids; ++i) {
+    const uint32_t id = next_random(rng) % (uint32_t)(NB_IDS * 16);
+    if(id_size == sizeof(uint32_t)) {
+      ((uint32_t*)ids)[i] = id;
+    } else {
+      ((uint64_t*)ids)[i] = (uint64_t)id << 20;
+    }
+  }
+  SL(flat_set_insert_n(set, ids, nb_ids, SL_DUPLICATE_KEEP_FIRST, NULL));
+  free(ids);
+}
+
+/* Intersect a posting list of NB_IDS ids with a list of nb_ids ids, with the
+ * built-in comparator and with a user one. */
+static void
+run_intersections(const size_t id_size, const size_t nb_ids)
+{
+  int (*const builtin)(const void*, const void*) =
+    id_size == sizeof(uint32_t) ? sl_flat_set_cmp_u32 : sl_flat_set_cmp_u64;
+  int (*const user)(const void*, const void*) =
+    id_size == sizeof(uint32_t) ? cmp_u32 : cmp_u64;
+  int (*compare)(const void*, const void*) = NULL;
+  struct sl_flat_set* a = NULL;
+  struct sl_flat_set* b = NULL;
+  struct sl_flat_set* dst = NULL;
+  size_t len = 0;
+  size_t i = 0;
+  int k = 0;
+  double t = 0;
+
+  for(k = 0; k < 2; ++k) {
+    uint64_t rng = 0x2545F4914F6CDD1DULL;
+    compare = k == 0 ? builtin : user;
+    SL(create_flat_set(id_size, id_size, compare, NULL, &a));
+    SL(create_flat_set(id_size, id_size, compare, NULL, &b));
+    SL(create_flat_set(id_size, id_size, compare, NULL, &dst));
+    fill_ids(a, id_size, NB_IDS, &rng);
+    fill_ids(b, id_size, nb_ids, &rng);
+    t = now();
+    for(i = 0; i < NB_INTERSECTIONS; ++i)
+      SL(flat_set_intersect(dst, a, b));
+    t = now() - t;
+    SL(flat_set_length(dst, &len));
+    printf("intersect u%lu %7lu x %7lu: %7.2f ms (%s comparator, %lu ids)\n",
+      (unsigned long)id_size * 8, (unsigned long)NB_IDS,
+      (unsigned long)nb_ids, t / NB_INTERSECTIONS * 1.e3,
+      k == 0 ? "built-in" : "user", (unsigned long)len);
+    SL(free_flat_set(a));
+    SL(free_flat_set(b));
+    SL(free_flat_set(dst));
+  }
+}
+
+int
+main(int argc, char** argv)
+{
+  const size_t sizes[] = { 1000, 64000, 1000000, 8000000 };
+  size_t i = 0;
+  for(i = 0; i < sizeof(sizes)/sizeof(size_t); ++i) {
+    run_lookups(sizes[i], false);
+    run_lookups(sizes[i], true);
+  }
+  /* The size in MiB of the last level cache may be given so that the lookups
+   * also run on keys that do not fit in it. */
+  if(argc == 2) {
+    const size_t nb_keys = (size_t)atoi(argv[1]) * 2 * 1024 * 1024
+      / sizeof(uint32_t);
+    run_lookups(nb_keys, false);
+    run_lookups(nb_keys, true);
+  }
+  run_build();
+  run_updates(0);
+  run_updates(1024);
+  run_ingest();
+  run_retention(false);
+  run_retention(true);
+  run_find_n(64000, false);
+  run_find_n(64000, true);
+  run_find_n(8000000, false);
+  run_find_n(8000000, true);
+  run_intersections(sizeof(uint32_t), NB_IDS);
+  run_intersections(sizeof(uint32_t), NB_IDS / 100);
+  run_intersections(sizeof(uint64_t), NB_IDS);
+  run_intersections(sizeof(uint64_t), NB_IDS / 100);
+  return 0;
+}
+
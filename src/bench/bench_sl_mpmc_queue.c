@@ -0,0 +1,114 @@
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#include "../sl_mpmc_queue.h"
+#include <snlsys/snlsys.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NB_MSGS (1ULL << 24)
+#define QUEUE_CAPACITY 1024
+#define MAX_NB_THREADS 64
+
+struct bench {
+  struct sl_mpmc_queue* queue;
+  uint64_t nb_msgs; /* Per thread. */
+  uint64_t sum;
+};
+
+static double
+now(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1.e-9;
+}
+
+static void*
+produce(void* arg)
+{
+  struct bench* bench = arg;
+  uint64_t i = 0;
+  for(i = 0; i < bench->nb_msgs; ++i)
+    SL(mpmc_queue_push(bench->queue, &i));
+  return NULL;
+}
+
+static void*
+consume(void* arg)
+{
+  struct bench* bench = arg;
+  uint64_t i = 0;
+  uint64_t msg = 0;
+  for(i = 0; i < bench->nb_msgs; ++i) {
+    SL(mpmc_queue_pop(bench->queue, &msg));
+    bench->sum += msg;
+  }
+  return NULL;
+}
+
+/* Run nb_threads / 2 producers and nb_threads / 2 consumers. With one thread,
+ * the same thread pushes and pops each message. */
+static void
+run(size_t nb_threads)
+{
+  struct bench benches[MAX_NB_THREADS];
+  pthread_t threads[MAX_NB_THREADS];
+  struct sl_mpmc_queue* queue = NULL;
+  const size_t nb_producers = MAX(nb_threads / 2, 1);
+  uint64_t sum = 0;
+  uint64_t nb_msgs = 0;
+  double t = 0;
+  size_t i = 0;
+
+  SL(create_mpmc_queue
+    (sizeof(uint64_t), ALIGNOF(uint64_t), QUEUE_CAPACITY, NULL, &queue));
+  nb_msgs = NB_MSGS / nb_producers;
+
+  t = now();
+  if(nb_threads == 1) {
+    uint64_t msg = 0;
+    for(i = 0; i < nb_msgs; ++i) {
+      SL(mpmc_queue_push(queue, &i));
+      SL(mpmc_queue_pop(queue, &msg));
+      sum += msg;
+    }
+  } else {
+    for(i = 0; i < nb_threads; ++i) {
+      benches[i].queue = queue;
+      benches[i].nb_msgs = nb_msgs;
+      benches[i].sum = 0;
+      if(pthread_create
+        (threads + i, NULL, i % 2 ? consume : produce, benches + i)) {
+        fprintf(stderr, "Can't create the thread %lu.\n", (unsigned long)i);
+        exit(1);
+      }
+    }
+    for(i = 0; i < nb_threads; ++i) {
+      pthread_join(threads[i], NULL);
+      sum += benches[i].sum;
+    }
+  }
+  t = now() - t;
+
+  if(sum != nb_producers * (nb_msgs * (nb_msgs - 1) / 2)) {
+    fprintf(stderr, "Invalid checksum.\n");
+    exit(1);
+  }
+  printf("%2lu threads: %8.2f M msgs/s\n",
+    (unsigned long)nb_threads,
+    (double)(nb_msgs * nb_producers) / t * 1.e-6);
+  SL(free_mpmc_queue(queue));
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  size_t nb_threads = 0;
+  run(1);
+  for(nb_threads = 2; nb_threads <= MAX_NB_THREADS; nb_threads *= 2)
+    run(nb_threads);
+  return 0;
+}
+
@@ -0,0 +1,125 @@
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#include "../sl_flat_set.h"
+#include "../sl_priority_queue.h"
+#include <snlsys/snlsys.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NB_OPS (1ULL << 21)
+/* Each operation on a flat set moves the whole set in memory. */
+#define NB_FLAT_SET_OPS(NbTimers) MIN(NB_OPS, (1ULL << 28) / (NbTimers))
+
+/* Timers are ordered by deadline and then by id so that the flat set accepts
+ * timers with the same deadline. */
+struct timer {
+  uint64_t deadline;
+  uint64_t id;
+};
+
+static double
+now(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1.e-9;
+}
+
+static int
+cmp_timer(const void* a, const void* b)
+{
+  const struct timer* t0 = a;
+  const struct timer* t1 = b;
+  if(t0->deadline != t1->deadline)
+    return t0->deadline < t1->deadline ? -1 : 1;
+  return (t0->id > t1->id) - (t0->id < t1->id);
+}
+
+static uint64_t
+next_delay(uint64_t* rng)
+{
+  *rng ^= *rng << 13;
+  *rng ^= *rng >> 7;
+  *rng ^= *rng << 17;
+  return *rng % 1000000;
+}
+
+/* Expire the earliest timer and rearm it, nb_ops times. */
+static void
+run_flat_set(size_t nb_timers)
+{
+  const uint64_t nb_ops = NB_FLAT_SET_OPS(nb_timers);
+  struct sl_flat_set* set = NULL;
+  struct timer timer;
+  void* data = NULL;
+  uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  uint64_t i = 0;
+  double t = 0;
+
+  SL(create_flat_set
+    (sizeof(struct timer), ALIGNOF(struct timer), cmp_timer, NULL, &set));
+  for(i = 0; i < nb_timers; ++i) {
+    timer.deadline = next_delay(&rng);
+    timer.id = i;
+    SL(flat_set_insert(set, &timer, NULL));
+  }
+  t = now();
+  for(i = 0; i < nb_ops; ++i) {
+    SL(flat_set_at(set, 0, &data));
+    timer = *(struct timer*)data;
+    SL(flat_set_erase(set, &timer, NULL));
+    timer.deadline += next_delay(&rng);
+    SL(flat_set_insert(set, &timer, NULL));
+  }
+  t = now() - t;
+  printf("%7lu timers, flat set:  %7.2f M ops/s\n",
+    (unsigned long)nb_timers, (double)nb_ops / t * 1.e-6);
+  SL(free_flat_set(set));
+}
+
+static void
+run_priority_queue(size_t nb_timers, size_t arity)
+{
+  struct sl_priority_queue* queue = NULL;
+  struct timer timer;
+  void* data = NULL;
+  uint64_t rng = 0x9E3779B97F4A7C15ULL;
+  uint64_t i = 0;
+  double t = 0;
+
+  SL(create_priority_queue(sizeof(struct timer), ALIGNOF(struct timer),
+    arity, cmp_timer, NULL, &queue));
+  for(i = 0; i < nb_timers; ++i) {
+    timer.deadline = next_delay(&rng);
+    timer.id = i;
+    SL(priority_queue_push(queue, &timer));
+  }
+  t = now();
+  for(i = 0; i < NB_OPS; ++i) {
+    SL(priority_queue_top(queue, &data));
+    timer = *(struct timer*)data;
+    SL(priority_queue_pop(queue));
+    timer.deadline += next_delay(&rng);
+    SL(priority_queue_push(queue, &timer));
+  }
+  t = now() - t;
+  printf("%7lu timers, %lu-ary heap: %7.2f M ops/s\n",
+    (unsigned long)nb_timers, (unsigned long)arity,
+    (double)NB_OPS / t * 1.e-6);
+  SL(free_priority_queue(queue));
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  size_t nb_timers = 0;
+  for(nb_timers = 100; nb_timers <= 100000; nb_timers *= 10) {
+    run_flat_set(nb_timers);
+    run_priority_queue(nb_timers, 2);
+    run_priority_queue(nb_timers, 4);
+    run_priority_queue(nb_timers, 8);
+  }
+  return 0;
+}
+
@@ -0,0 +1,79 @@
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#include "../sl_roaring_set.h"
+#include <snlsys/snlsys.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NB_LISTS 16
+#define NB_IDS (1UL << 24) /* Range of the ids. */
+#define NB_RUNS 8
+
+static double
+now(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1.e-9;
+}
+
+/* Build posting lists of increasing density, report their compressed size
+ * with respect to an array of 32 bits ids and intersect/merge them. */
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_roaring_set* lists[NB_LISTS];
+  struct sl_roaring_set* result = NULL;
+  size_t nb_ids = 0;
+  size_t total_size = 0;
+  size_t size = 0;
+  size_t card = 0;
+  size_t checksum = 0;
+  size_t i = 0;
+  size_t run = 0;
+  uint32_t id = 0;
+  double t = 0;
+
+  for(i = 0; i < NB_LISTS; ++i) {
+    /* Posting lists are made of clustered ids. */
+    SL(create_roaring_set(NULL, lists + i));
+    for(id = 0; id < NB_IDS; ++id) {
+      if((size_t)rand() % 64 < (i + 1) * 2 && (id / 4096) % 4 != i % 4)
+        SL(roaring_set_insert(lists[i], id, NULL));
+    }
+    SL(roaring_set_optimize(lists[i]));
+    SL(roaring_set_cardinality(lists[i], &card));
+    SL(roaring_set_serialized_size(lists[i], &size));
+    nb_ids += card;
+    total_size += size;
+  }
+  printf("%lu ids: %.2f MB as arrays, %.2f MB serialized\n",
+    (unsigned long)nb_ids, (double)(nb_ids * 4) * 1.e-6,
+    (double)total_size * 1.e-6);
+
+  SL(create_roaring_set(NULL, &result));
+  t = now();
+  for(run = 0; run < NB_RUNS; ++run) {
+    SL(clear_roaring_set(result));
+    SL(roaring_set_or(result, lists[run % NB_LISTS]));
+    for(i = 0; i < NB_LISTS; ++i)
+      SL(roaring_set_or(result, lists[i]));
+    SL(roaring_set_cardinality(result, &card));
+    checksum += card;
+    for(i = 0; i < NB_LISTS; ++i)
+      SL(roaring_set_and(result, lists[i]));
+    SL(roaring_set_cardinality(result, &card));
+    checksum += card;
+  }
+  t = now() - t;
+  printf("%.2f M ids/s (checksum %lu)\n",
+    (double)(NB_RUNS * 2) * (double)nb_ids / t * 1.e-6,
+    (unsigned long)checksum);
+
+  for(i = 0; i < NB_LISTS; ++i)
+    SL(free_roaring_set(lists[i]));
+  SL(free_roaring_set(result));
+  return 0;
+}
+
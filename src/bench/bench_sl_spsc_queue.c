@@ -0,0 +1,121 @@
+#define _GNU_SOURCE
+#include "../sl_spsc_queue.h"
+#include <snlsys/snlsys.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NB_MSGS 200000000ULL
+#define QUEUE_CAPACITY 4096
+#define BATCH_SIZE 64
+
+struct bench {
+  struct sl_spsc_queue* queue;
+  size_t batch_size;
+  int cpu;
+};
+
+static void
+pin_thread(int cpu)
+{
+  cpu_set_t set;
+  if(cpu < 0)
+    return;
+  CPU_ZERO(&set);
+  CPU_SET((size_t)cpu, &set);
+  if(pthread_setaffinity_np(pthread_self(), sizeof(set), &set))
+    fprintf(stderr, "Can't pin the thread to the CPU %d.\n", cpu);
+}
+
+static double
+now(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1.e-9;
+}
+
+static void*
+produce(void* arg)
+{
+  struct bench* bench = arg;
+  uint64_t batch[BATCH_SIZE];
+  uint64_t i = 0;
+
+  pin_thread(bench->cpu);
+  while(i < NB_MSGS) {
+    size_t n = 0;
+    size_t j = 0;
+    for(j = 0; j < bench->batch_size; ++j)
+      batch[j] = i + j;
+    SL(spsc_queue_enqueue_n(bench->queue, bench->batch_size, batch, &n));
+    if(!n)
+      sched_yield();
+    i += n;
+  }
+  return NULL;
+}
+
+static void
+run(size_t batch_size, int cpu_producer, int cpu_consumer)
+{
+  struct bench bench;
+  pthread_t producer;
+  uint64_t batch[BATCH_SIZE];
+  uint64_t sum = 0;
+  uint64_t i = 0;
+  double t = 0;
+
+  SL(create_spsc_queue
+    (sizeof(uint64_t), ALIGNOF(uint64_t), QUEUE_CAPACITY, NULL, &bench.queue));
+  bench.batch_size = batch_size;
+  bench.cpu = cpu_producer;
+  pin_thread(cpu_consumer);
+
+  t = now();
+  if(pthread_create(&producer, NULL, produce, &bench)) {
+    fprintf(stderr, "Can't create the producer thread.\n");
+    exit(1);
+  }
+  while(i < NB_MSGS) {
+    size_t n = 0;
+    size_t j = 0;
+    SL(spsc_queue_dequeue_n(bench.queue, batch_size, batch, &n));
+    if(!n)
+      sched_yield();
+    for(j = 0; j < n; ++j)
+      sum += batch[j];
+    i += n;
+  }
+  pthread_join(producer, NULL);
+  t = now() - t;
+
+  if(sum != NB_MSGS * (NB_MSGS - 1) / 2) {
+    fprintf(stderr, "Invalid checksum.\n");
+    exit(1);
+  }
+  printf("batch %3lu: %8.2f M msgs/s\n",
+    (unsigned long)batch_size, (double)NB_MSGS / t * 1.e-6);
+  SL(free_spsc_queue(bench.queue));
+}
+
+/* Usage: bench_sl_spsc_queue [PRODUCER_CPU CONSUMER_CPU] */
+int
+main(int argc, char** argv)
+{
+  int cpu_producer = -1;
+  int cpu_consumer = -1;
+
+  if(argc == 3) {
+    cpu_producer = atoi(argv[1]);
+    cpu_consumer = atoi(argv[2]);
+  }
+  run(1, cpu_producer, cpu_consumer);
+  run(16, cpu_producer, cpu_consumer);
+  run(BATCH_SIZE, cpu_producer, cpu_consumer);
+  return 0;
+}
+
@@ -0,0 +1,156 @@
+#define _POSIX_C_SOURCE 200112L /* clock_gettime */
+#include "../sl_priority_queue.h"
+#include "../sl_timer_wheel.h"
+#include <snlsys/snlsys.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define NB_TIMERS (1UL << 21)
+#define NB_ROUNDS 4
+#define TIMEOUT 30000 /* In ticks. */
+
+/* Idle connection timeouts: each round arms a timeout per connection and
+ * cancels most of them since the connections are active again before their
+ * timeout. */
+struct timer {
+  uint64_t deadline;
+  uint64_t connection;
+};
+
+static double
+now(void)
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return (double)t.tv_sec + (double)t.tv_nsec * 1.e-9;
+}
+
+static int
+cmp_timer(const void* a, const void* b)
+{
+  const uint64_t i = ((const struct timer*)a)->deadline;
+  const uint64_t j = ((const struct timer*)b)->deadline;
+  return (i > j) - (i < j);
+}
+
+static void
+track_timer(const void* data, size_t id, void* context)
+{
+  ((size_t*)context)[((const struct timer*)data)->connection] = id;
+}
+
+static void
+print(const char* name, uint64_t nb_expired, double t)
+{
+  printf("%-12s %7.2f M ops/s (%lu expired)\n", name,
+    (double)(2 * NB_ROUNDS * NB_TIMERS) / t * 1.e-6,
+    (unsigned long)nb_expired);
+}
+
+static void
+run_timer_wheel(void)
+{
+  struct sl_timer_wheel* wheel = NULL;
+  struct timer timer;
+  uint64_t* ids = NULL;
+  uint64_t tick = 0;
+  uint64_t nb_expired = 0;
+  size_t count = 0;
+  size_t i = 0;
+  size_t round = 0;
+  void* expired = NULL;
+  double t = 0;
+
+  ids = malloc(NB_TIMERS * sizeof(uint64_t));
+  if(!ids) {
+    fprintf(stderr, "Not enough memory.\n");
+    exit(1);
+  }
+  SL(create_timer_wheel
+    (sizeof(struct timer), ALIGNOF(struct timer), 0, NULL, &wheel));
+  t = now();
+  for(round = 0; round < NB_ROUNDS; ++round) {
+    for(i = 0; i < NB_TIMERS; ++i) {
+      timer.deadline = tick + TIMEOUT + i % 1024;
+      timer.connection = i;
+      SL(timer_wheel_schedule(wheel, timer.deadline, &timer, ids + i));
+    }
+    tick += TIMEOUT / 2;
+    SL(timer_wheel_advance(wheel, tick, &count, &expired));
+    nb_expired += count;
+    /* 1 connection out of 32 stays idle. */
+    for(i = 0; i < NB_TIMERS; ++i) {
+      if(i % 32)
+        SL(timer_wheel_cancel(wheel, ids[i]));
+    }
+  }
+  tick += 2 * TIMEOUT;
+  SL(timer_wheel_advance(wheel, tick, &count, &expired));
+  nb_expired += count;
+  t = now() - t;
+  print("timer wheel", nb_expired, t);
+  SL(free_timer_wheel(wheel));
+  free(ids);
+}
+
+static void
+run_priority_queue(void)
+{
+  struct sl_priority_queue* queue = NULL;
+  struct timer timer;
+  size_t* positions = NULL;
+  uint64_t tick = 0;
+  uint64_t nb_expired = 0;
+  size_t i = 0;
+  size_t round = 0;
+  void* data = NULL;
+  double t = 0;
+
+  positions = malloc(NB_TIMERS * sizeof(size_t));
+  if(!positions) {
+    fprintf(stderr, "Not enough memory.\n");
+    exit(1);
+  }
+  SL(create_priority_queue(sizeof(struct timer), ALIGNOF(struct timer),
+    4, cmp_timer, NULL, &queue));
+  SL(priority_queue_set_position_callback(queue, track_timer, positions));
+  t = now();
+  for(round = 0; round <= NB_ROUNDS; ++round) {
+    if(round == NB_ROUNDS) {
+      tick += 2 * TIMEOUT;
+    } else {
+      for(i = 0; i < NB_TIMERS; ++i) {
+        timer.deadline = tick + TIMEOUT + i % 1024;
+        timer.connection = i;
+        SL(priority_queue_push(queue, &timer));
+      }
+      tick += TIMEOUT / 2;
+    }
+    while(sl_priority_queue_top(queue, &data) == SL_NO_ERROR
+       && ((struct timer*)data)->deadline <= tick) {
+      SL(priority_queue_pop(queue));
+      ++nb_expired;
+    }
+    if(round == NB_ROUNDS)
+      break;
+    for(i = 0; i < NB_TIMERS; ++i) {
+      if(i % 32)
+        SL(priority_queue_erase(queue, positions[i]));
+    }
+  }
+  t = now() - t;
+  print("4-ary heap", nb_expired, t);
+  SL(free_priority_queue(queue));
+  free(positions);
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  run_timer_wheel();
+  run_priority_queue();
+  return 0;
+}
+
@@ -0,0 +1,502 @@
+#include "sl_bitset.h"
+#include "sl_vector.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __x86_64__
+  #define BITSET_AVX2
+  #include <immintrin.h>
+#endif
+
+#define WORD_BITS 64
+#define BLOCK_WORDS 4 /* Number of words in a 256 bits register. */
+#define BLOCK_ALIGNMENT 32
+
+enum bitwise_op {
+  OP_AND,
+  OP_OR,
+  OP_XOR,
+  OP_ANDNOT
+};
+
+struct sl_bitset {
+  struct mem_allocator* allocator;
+  struct sl_vector* words;
+  size_t nb_bits;
+};
+
+/*******************************************************************************
+ *
+ * Kernels.
+ *
+ ******************************************************************************/
+static void
+bitwise_scalar
+  (uint64_t* restrict dst,
+   const uint64_t* restrict src,
+   size_t nb_words,
+   enum bitwise_op op)
+{
+  size_t i = 0;
+  switch(op) {
+    case OP_AND: for(i = 0; i < nb_words; ++i) dst[i] &= src[i]; break;
+    case OP_OR: for(i = 0; i < nb_words; ++i) dst[i] |= src[i]; break;
+    case OP_XOR: for(i = 0; i < nb_words; ++i) dst[i] ^= src[i]; break;
+    case OP_ANDNOT: for(i = 0; i < nb_words; ++i) dst[i] &= ~src[i]; break;
+    default: ASSERT(0); break;
+  }
+}
+
+static size_t
+popcount_scalar(const uint64_t* words, size_t nb_words)
+{
+  size_t count = 0;
+  size_t i = 0;
+  for(i = 0; i < nb_words; ++i)
+    count += (size_t)__builtin_popcountll(words[i]);
+  return count;
+}
+
+#ifdef BITSET_AVX2
+/* The words are 32 bytes aligned and their number is a multiple of 4. */
+__attribute__((target("avx2"))) static void
+bitwise_avx2
+  (uint64_t* restrict dst,
+   const uint64_t* restrict src,
+   size_t nb_words,
+   enum bitwise_op op)
+{
+  __m256i* d = (__m256i*)dst;
+  const __m256i* s = (const __m256i*)src;
+  const size_t n = nb_words / BLOCK_WORDS;
+  size_t i = 0;
+  ASSERT(nb_words % BLOCK_WORDS == 0);
+
+  switch(op) {
+    case OP_AND:
+      for(i = 0; i < n; ++i)
+        _mm256_store_si256(d + i, _mm256_and_si256
+          (_mm256_load_si256(d + i), _mm256_load_si256(s + i)));
+      break;
+    case OP_OR:
+      for(i = 0; i < n; ++i)
+        _mm256_store_si256(d + i, _mm256_or_si256
+          (_mm256_load_si256(d + i), _mm256_load_si256(s + i)));
+      break;
+    case OP_XOR:
+      for(i = 0; i < n; ++i)
+        _mm256_store_si256(d + i, _mm256_xor_si256
+          (_mm256_load_si256(d + i), _mm256_load_si256(s + i)));
+      break;
+    case OP_ANDNOT:
+      for(i = 0; i < n; ++i)
+        _mm256_store_si256(d + i, _mm256_andnot_si256
+          (_mm256_load_si256(s + i), _mm256_load_si256(d + i)));
+      break;
+    default: ASSERT(0); break;
+  }
+}
+
+/* Count the bits of each nibble with a lookup table in a byte shuffle and sum
+ * the bytes in 64 bits lanes. */
+__attribute__((target("avx2,popcnt"))) static size_t
+popcount_avx2(const uint64_t* words, size_t nb_words)
+{
+  const __m256i lookup = _mm256_setr_epi8
+    (0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+     0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+  const __m256i low_mask = _mm256_set1_epi8(0x0F);
+  const __m256i* w = (const __m256i*)words;
+  const size_t n = nb_words / BLOCK_WORDS;
+  __m256i acc = _mm256_setzero_si256();
+  size_t count = 0;
+  size_t i = 0;
+
+  for(i = 0; i < n; ++i) {
+    const __m256i v = _mm256_loadu_si256(w + i);
+    const __m256i lo = _mm256_and_si256(v, low_mask);
+    const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), low_mask);
+    const __m256i cnt = _mm256_add_epi8
+      (_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+    acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+  }
+  count = (size_t)_mm256_extract_epi64(acc, 0)
+        + (size_t)_mm256_extract_epi64(acc, 1)
+        + (size_t)_mm256_extract_epi64(acc, 2)
+        + (size_t)_mm256_extract_epi64(acc, 3);
+  for(i = n * BLOCK_WORDS; i < nb_words; ++i)
+    count += (size_t)__builtin_popcountll(words[i]);
+  return count;
+}
+#endif /* BITSET_AVX2 */
+
+static FINLINE void
+bitwise
+  (uint64_t* restrict dst,
+   const uint64_t* restrict src,
+   size_t nb_words,
+   enum bitwise_op op)
+{
+#ifdef BITSET_AVX2
+  if(__builtin_cpu_supports("avx2")) {
+    bitwise_avx2(dst, src, nb_words, op);
+    return;
+  }
+#endif
+  bitwise_scalar(dst, src, nb_words, op);
+}
+
+static FINLINE size_t
+popcount(const uint64_t* words, size_t nb_words)
+{
+#ifdef BITSET_AVX2
+  if(__builtin_cpu_supports("avx2"))
+    return popcount_avx2(words, nb_words);
+#endif
+  return popcount_scalar(words, nb_words);
+}
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE uint64_t*
+words_of(struct sl_bitset* bitset, size_t* out_nb_words) /* May be NULL. */
+{
+  void* words = NULL;
+  ASSERT(bitset);
+  SL(vector_buffer(bitset->words, out_nb_words, NULL, NULL, &words));
+  return words;
+}
+
+static FINLINE size_t
+nb_padded_words(size_t nb_bits)
+{
+  const size_t nb_words = (nb_bits + WORD_BITS - 1) / WORD_BITS;
+  return (nb_words + BLOCK_WORDS - 1) / BLOCK_WORDS * BLOCK_WORDS;
+}
+
+static enum sl_error
+binary_op(struct sl_bitset* dst, struct sl_bitset* src, enum bitwise_op op)
+{
+  uint64_t* dst_words = NULL;
+  size_t nb_words = 0;
+
+  if(!dst || !src || dst->nb_bits != src->nb_bits)
+    return SL_INVALID_ARGUMENT;
+  dst_words = words_of(dst, &nb_words);
+  if(dst == src) {
+    switch(op) {
+      case OP_AND: case OP_OR: break;
+      case OP_XOR: case OP_ANDNOT:
+        if(nb_words)
+          memset(dst_words, 0, nb_words * sizeof(uint64_t));
+        break;
+      default: ASSERT(0); break;
+    }
+  } else if(nb_words) {
+    bitwise(dst_words, words_of(src, NULL), nb_words, op);
+  }
+  return SL_NO_ERROR;
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the bitset functions.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_bitset
+  (size_t nb_bits,
+   struct mem_allocator* specific_allocator,
+   struct sl_bitset** out_bitset)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_bitset* bitset = NULL;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!out_bitset) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  bitset = MEM_CALLOC(allocator, 1, sizeof(struct sl_bitset));
+  if(!bitset) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  bitset->allocator = allocator;
+  err = sl_create_vector
+    (sizeof(uint64_t), BLOCK_ALIGNMENT, allocator, &bitset->words);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_bitset_resize(bitset, nb_bits);
+  if(err != SL_NO_ERROR)
+    goto error;
+
+exit:
+  if(out_bitset)
+    *out_bitset = bitset;
+  return err;
+
+error:
+  if(bitset) {
+    if(bitset->words)
+      SL(free_vector(bitset->words));
+    MEM_FREE(allocator, bitset);
+    bitset = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_bitset
+  (struct sl_bitset* bitset)
+{
+  if(!bitset)
+    return SL_INVALID_ARGUMENT;
+  SL(free_vector(bitset->words));
+  MEM_FREE(bitset->allocator, bitset);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_reset
+  (struct sl_bitset* bitset)
+{
+  uint64_t* words = NULL;
+  size_t nb_words = 0;
+
+  if(!bitset)
+    return SL_INVALID_ARGUMENT;
+  words = words_of(bitset, &nb_words);
+  if(nb_words)
+    memset(words, 0, nb_words * sizeof(uint64_t));
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_resize
+  (struct sl_bitset* bitset,
+   size_t nb_bits)
+{
+  uint64_t* words = NULL;
+  size_t nb_words = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!bitset)
+    return SL_INVALID_ARGUMENT;
+  if(nb_bits > SIZE_MAX - WORD_BITS * BLOCK_WORDS)
+    return SL_OVERFLOW_ERROR;
+  /* The added words are cleared by the vector. */
+  err = sl_vector_resize(bitset->words, nb_padded_words(nb_bits), NULL);
+  if(err != SL_NO_ERROR)
+    return err;
+  if(nb_bits < bitset->nb_bits) {
+    /* Clear the bits past the new size. */
+    words = words_of(bitset, &nb_words);
+    i = nb_bits / WORD_BITS;
+    if(nb_bits % WORD_BITS) {
+      words[i] &= (1ULL << (nb_bits % WORD_BITS)) - 1;
+      ++i;
+    }
+    for(; i < nb_words; ++i)
+      words[i] = 0;
+  }
+  bitset->nb_bits = nb_bits;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_size
+  (struct sl_bitset* bitset,
+   size_t* out_nb_bits)
+{
+  if(!bitset || !out_nb_bits)
+    return SL_INVALID_ARGUMENT;
+  *out_nb_bits = bitset->nb_bits;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_set
+  (struct sl_bitset* bitset,
+   size_t id)
+{
+  if(!bitset || id >= bitset->nb_bits)
+    return SL_INVALID_ARGUMENT;
+  words_of(bitset, NULL)[id / WORD_BITS] |= 1ULL << (id % WORD_BITS);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_clear
+  (struct sl_bitset* bitset,
+   size_t id)
+{
+  if(!bitset || id >= bitset->nb_bits)
+    return SL_INVALID_ARGUMENT;
+  words_of(bitset, NULL)[id / WORD_BITS] &= ~(1ULL << (id % WORD_BITS));
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_test
+  (struct sl_bitset* bitset,
+   size_t id,
+   bool* out_is_set)
+{
+  uint64_t word = 0;
+
+  if(!bitset || id >= bitset->nb_bits || !out_is_set)
+    return SL_INVALID_ARGUMENT;
+  word = words_of(bitset, NULL)[id / WORD_BITS];
+  *out_is_set = (word >> (id % WORD_BITS)) & 1;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_count
+  (struct sl_bitset* bitset,
+   size_t* out_count)
+{
+  const uint64_t* words = NULL;
+  size_t nb_words = 0;
+
+  if(!bitset || !out_count)
+    return SL_INVALID_ARGUMENT;
+  words = words_of(bitset, &nb_words);
+  *out_count = nb_words ? popcount(words, nb_words) : 0;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_rank
+  (struct sl_bitset* bitset,
+   size_t id,
+   size_t* out_rank)
+{
+  const uint64_t* words = NULL;
+  size_t rank = 0;
+
+  if(!bitset || id > bitset->nb_bits || !out_rank)
+    return SL_INVALID_ARGUMENT;
+  words = words_of(bitset, NULL);
+  if(id / WORD_BITS)
+    rank = popcount(words, id / WORD_BITS);
+  if(id % WORD_BITS) {
+    const uint64_t mask = (1ULL << (id % WORD_BITS)) - 1;
+    rank += (size_t)__builtin_popcountll(words[id / WORD_BITS] & mask);
+  }
+  *out_rank = rank;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_select
+  (struct sl_bitset* bitset,
+   size_t rank,
+   size_t* out_id)
+{
+  const uint64_t* words = NULL;
+  size_t nb_words = 0;
+  size_t i = 0;
+
+  if(!bitset || !out_id)
+    return SL_INVALID_ARGUMENT;
+  words = words_of(bitset, &nb_words);
+  *out_id = bitset->nb_bits;
+  for(i = 0; i < nb_words; ++i) {
+    uint64_t word = words[i];
+    const size_t count = (size_t)__builtin_popcountll(word);
+    if(rank < count) {
+      /* Clear the rank lowest set bits of the word. */
+      while(rank--)
+        word &= word - 1;
+      *out_id = i * WORD_BITS + (size_t)__builtin_ctzll(word);
+      break;
+    }
+    rank -= count;
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_find_next
+  (struct sl_bitset* bitset,
+   size_t id,
+   size_t* out_id)
+{
+  const uint64_t* words = NULL;
+  size_t nb_words = 0;
+  size_t i = 0;
+  uint64_t word = 0;
+
+  if(!bitset || !out_id)
+    return SL_INVALID_ARGUMENT;
+  *out_id = bitset->nb_bits;
+  if(id >= bitset->nb_bits)
+    return SL_NO_ERROR;
+  words = words_of(bitset, &nb_words);
+  i = id / WORD_BITS;
+  word = words[i] & (~0ULL << (id % WORD_BITS));
+  for(;;) {
+    if(word) {
+      *out_id = i * WORD_BITS + (size_t)__builtin_ctzll(word);
+      break;
+    }
+    if(++i >= nb_words)
+      break;
+    word = words[i];
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_and
+  (struct sl_bitset* dst,
+   struct sl_bitset* src)
+{
+  return binary_op(dst, src, OP_AND);
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_or
+  (struct sl_bitset* dst,
+   struct sl_bitset* src)
+{
+  return binary_op(dst, src, OP_OR);
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_xor
+  (struct sl_bitset* dst,
+   struct sl_bitset* src)
+{
+  return binary_op(dst, src, OP_XOR);
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_andnot
+  (struct sl_bitset* dst,
+   struct sl_bitset* src)
+{
+  return binary_op(dst, src, OP_ANDNOT);
+}
+
+EXPORT_SYM enum sl_error
+sl_bitset_buffer
+  (struct sl_bitset* bitset,
+   size_t* out_nb_words,
+   uint64_t** out_words)
+{
+  if(!bitset || !out_words)
+    return SL_INVALID_ARGUMENT;
+  *out_words = words_of(bitset, out_nb_words);
+  return SL_NO_ERROR;
+}
+
@@ -0,0 +1,132 @@
+#ifndef SL_BITSET_H
+#define SL_BITSET_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct mem_allocator;
+
+/* Fixed size set of bits stored in a sl_vector of 64 bits words. The buffer
+ * is 32 bytes aligned and its length is padded to a multiple of 4 words; the
+ * bitwise operations and the population count process 256 bits at once with
+ * AVX2 when the processor supports it, and fall back to scalar code
+ * otherwise. */
+struct sl_bitset;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The bits are initially cleared. */
+SL_API enum sl_error
+sl_create_bitset
+  (size_t nb_bits,
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_bitset** out_bitset);
+
+SL_API enum sl_error
+sl_free_bitset
+  (struct sl_bitset* bitset);
+
+/* Clear all the bits. */
+SL_API enum sl_error
+sl_bitset_reset
+  (struct sl_bitset* bitset);
+
+/* The bits added to the set are cleared. */
+SL_API enum sl_error
+sl_bitset_resize
+  (struct sl_bitset* bitset,
+   size_t nb_bits);
+
+SL_API enum sl_error
+sl_bitset_size
+  (struct sl_bitset* bitset,
+   size_t* out_nb_bits);
+
+SL_API enum sl_error
+sl_bitset_set
+  (struct sl_bitset* bitset,
+   size_t id);
+
+SL_API enum sl_error
+sl_bitset_clear
+  (struct sl_bitset* bitset,
+   size_t id);
+
+SL_API enum sl_error
+sl_bitset_test
+  (struct sl_bitset* bitset,
+   size_t id,
+   bool* out_is_set);
+
+/* Number of set bits. */
+SL_API enum sl_error
+sl_bitset_count
+  (struct sl_bitset* bitset,
+   size_t* out_count);
+
+/* Number of set bits whose index is lower than id. */
+SL_API enum sl_error
+sl_bitset_rank
+  (struct sl_bitset* bitset,
+   size_t id, /* Must not be greater than the size of the set. */
+   size_t* out_rank);
+
+/* Index of the set bit of the given rank, i.e. preceded by rank set bits.
+ * out_id is set to the size of the set if there are not enough set bits. */
+SL_API enum sl_error
+sl_bitset_select
+  (struct sl_bitset* bitset,
+   size_t rank,
+   size_t* out_id);
+
+/* Index of the first set bit whose index is not lower than id, or the size of
+ * the set if there is none. Iterate over the set bits with:
+ * for(sl_bitset_find_next(set, 0, &i); i < size;
+ *     sl_bitset_find_next(set, i + 1, &i)) { ... } */
+SL_API enum sl_error
+sl_bitset_find_next
+  (struct sl_bitset* bitset,
+   size_t id,
+   size_t* out_id);
+
+/* In place bitwise operations. The two sets must have the same size. */
+SL_API enum sl_error
+sl_bitset_and
+  (struct sl_bitset* dst,
+   struct sl_bitset* src);
+
+SL_API enum sl_error
+sl_bitset_or
+  (struct sl_bitset* dst,
+   struct sl_bitset* src);
+
+SL_API enum sl_error
+sl_bitset_xor
+  (struct sl_bitset* dst,
+   struct sl_bitset* src);
+
+/* dst = dst & ~src. */
+SL_API enum sl_error
+sl_bitset_andnot
+  (struct sl_bitset* dst,
+   struct sl_bitset* src);
+
+/* Words of the set. The bits of the padding words, and of the last word past
+ * the size of the set, must remain cleared. */
+SL_API enum sl_error
+sl_bitset_buffer
+  (struct sl_bitset* bitset,
+   size_t* out_nb_words, /* May be NULL. */
+   uint64_t** out_words);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_BITSET_H */
+
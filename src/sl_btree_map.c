@@ -0,0 +1,922 @@
+#include "sl_btree_map.h"
+#include "sl_vector.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#define CACHE_LINE_SIZE 64
+#define NODE_SIZE (CACHE_LINE_SIZE * 8) /* Targeted size of a node. */
+#define MIN_CAPACITY 4
+#define MAX_DEPTH 64
+
+/* Header of a node. A leaf stores nb_keys keys followed by their data while
+ * an inner node stores nb_keys separators followed by nb_keys + 1 children.
+ * The keys of the child i are less than the separator i and the keys of the
+ * child i + 1 are greater or equal to it. */
+struct sl_btree_node {
+  struct sl_btree_node* next; /* Next leaf. NULL for inner nodes. */
+  size_t nb_keys;
+  bool is_leaf;
+};
+
+struct sl_btree_map {
+  int (*cmp_key)(const void*, const void*);
+  struct mem_allocator* allocator;
+  struct sl_btree_node* root; /* NULL if the map is empty. */
+  size_t length;
+  size_t key_size;
+  size_t data_size;
+  size_t keys_offset; /* Offset of the keys in a node. */
+  size_t data_offset; /* Offset of the data in a leaf. */
+  size_t children_offset; /* Offset of the children in an inner node. */
+  size_t leaf_capacity;
+  size_t inner_capacity;
+  size_t leaf_size;
+  size_t inner_size;
+  /* Inner node split scratch memory: inner_capacity + 1 keys followed by
+   * inner_capacity + 2 children. */
+  void* scratch;
+  size_t scratch_children_offset;
+  void* separator; /* Key moved up to the parent of a split node. */
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE char*
+node_key(const struct sl_btree_map* map, struct sl_btree_node* node, size_t i)
+{
+  return (char*)node + map->keys_offset + i * map->key_size;
+}
+
+static FINLINE char*
+leaf_data(const struct sl_btree_map* map, struct sl_btree_node* leaf, size_t i)
+{
+  ASSERT(leaf->is_leaf);
+  return (char*)leaf + map->data_offset + i * map->data_size;
+}
+
+static FINLINE struct sl_btree_node**
+node_children(const struct sl_btree_map* map, struct sl_btree_node* node)
+{
+  ASSERT(!node->is_leaf);
+  return (struct sl_btree_node**)((char*)node + map->children_offset);
+}
+
+/* Index of the first key of the node that is not less than key. The search
+ * is branchless, as in sl_flat_set, since the keys of a node fit in a few
+ * cache lines. */
+static FINLINE size_t
+lower_bound_id
+  (const struct sl_btree_map* map,
+   struct sl_btree_node* node,
+   const void* key)
+{
+  size_t base = 0;
+  size_t n = node->nb_keys;
+  if(!n)
+    return 0;
+  while(n > 1) {
+    const size_t half = n / 2;
+    base += (size_t)(map->cmp_key(node_key(map, node, base+half), key) < 0)
+          * half;
+    n -= half;
+  }
+  return base + (map->cmp_key(node_key(map, node, base), key) < 0);
+}
+
+/* Index of the first key of the node that is greater than key. */
+static FINLINE size_t
+upper_bound_id
+  (const struct sl_btree_map* map,
+   struct sl_btree_node* node,
+   const void* key)
+{
+  size_t base = 0;
+  size_t n = node->nb_keys;
+  if(!n)
+    return 0;
+  while(n > 1) {
+    const size_t half = n / 2;
+    base += (size_t)(map->cmp_key(key, node_key(map, node, base+half)) >= 0)
+          * half;
+    n -= half;
+  }
+  return base + (map->cmp_key(key, node_key(map, node, base)) >= 0);
+}
+
+/* Walk down to the leaf that may contain key. The visited nodes and the id
+ * of the followed children are stored in path and ids. Return the depth of
+ * the leaf. */
+static size_t
+descend
+  (const struct sl_btree_map* map,
+   const void* key,
+   struct sl_btree_node* path[MAX_DEPTH],
+   size_t ids[MAX_DEPTH])
+{
+  struct sl_btree_node* node = map->root;
+  size_t depth = 0;
+  ASSERT(node);
+  while(!node->is_leaf) {
+    const size_t id = upper_bound_id(map, node, key);
+    ASSERT(depth < MAX_DEPTH - 1);
+    path[depth] = node;
+    ids[depth] = id;
+    node = node_children(map, node)[id];
+    ++depth;
+  }
+  path[depth] = node;
+  return depth;
+}
+
+static struct sl_btree_node*
+find_leaf(const struct sl_btree_map* map, const void* key)
+{
+  struct sl_btree_node* node = map->root;
+  ASSERT(node);
+  while(!node->is_leaf)
+    node = node_children(map, node)[upper_bound_id(map, node, key)];
+  return node;
+}
+
+static struct sl_btree_node*
+alloc_node(struct sl_btree_map* map, const bool is_leaf)
+{
+  struct sl_btree_node* node = MEM_ALIGNED_ALLOC(map->allocator,
+    is_leaf ? map->leaf_size : map->inner_size, CACHE_LINE_SIZE);
+  if(node) {
+    node->next = NULL;
+    node->nb_keys = 0;
+    node->is_leaf = is_leaf;
+  }
+  return node;
+}
+
+static void
+free_subtree(struct sl_btree_map* map, struct sl_btree_node* node)
+{
+  size_t i = 0;
+  if(!node->is_leaf) {
+    for(i = 0; i <= node->nb_keys; ++i)
+      free_subtree(map, node_children(map, node)[i]);
+  }
+  MEM_FREE(map->allocator, node);
+}
+
+/* Move the pairs [from, from + count) of a leaf to the position to. */
+static FINLINE void
+leaf_move
+  (const struct sl_btree_map* map,
+   struct sl_btree_node* dst,
+   const size_t to,
+   struct sl_btree_node* src,
+   const size_t from,
+   const size_t count)
+{
+  memmove(node_key(map, dst, to), node_key(map, src, from),
+    count * map->key_size);
+  memmove(leaf_data(map, dst, to), leaf_data(map, src, from),
+    count * map->data_size);
+}
+
+static void
+leaf_insert
+  (const struct sl_btree_map* map,
+   struct sl_btree_node* leaf,
+   const size_t id,
+   const void* key,
+   const void* data)
+{
+  ASSERT(leaf->nb_keys < map->leaf_capacity && id <= leaf->nb_keys);
+  leaf_move(map, leaf, id + 1, leaf, id, leaf->nb_keys - id);
+  memcpy(node_key(map, leaf, id), key, map->key_size);
+  memcpy(leaf_data(map, leaf, id), data, map->data_size);
+  ++leaf->nb_keys;
+}
+
+/* Insert the separator key and its right child at the position id of an
+ * inner node that is not full. */
+static void
+inner_insert
+  (const struct sl_btree_map* map,
+   struct sl_btree_node* node,
+   const size_t id,
+   const void* key,
+   struct sl_btree_node* child)
+{
+  struct sl_btree_node** children = node_children(map, node);
+  ASSERT(node->nb_keys < map->inner_capacity && id <= node->nb_keys);
+  memmove(node_key(map, node, id + 1), node_key(map, node, id),
+    (node->nb_keys - id) * map->key_size);
+  memmove(children + id + 2, children + id + 1,
+    (node->nb_keys - id) * sizeof(struct sl_btree_node*));
+  memcpy(node_key(map, node, id), key, map->key_size);
+  children[id + 1] = child;
+  ++node->nb_keys;
+}
+
+/* Split a full inner node in which the separator key and its right child are
+ * inserted at the position id. The upper half is moved to right and the
+ * median key is copied in map->separator. */
+static void
+inner_split
+  (struct sl_btree_map* map,
+   struct sl_btree_node* node,
+   struct sl_btree_node* right,
+   const size_t id,
+   struct sl_btree_node* child)
+{
+  char* keys = map->scratch;
+  struct sl_btree_node** children = (struct sl_btree_node**)
+    ((char*)map->scratch + map->scratch_children_offset);
+  const size_t cap = map->inner_capacity;
+  const size_t key_size = map->key_size;
+  const size_t mid = (cap + 1) / 2;
+  ASSERT(node->nb_keys == cap && id <= cap);
+
+  memcpy(keys, node_key(map, node, 0), id * key_size);
+  memcpy(keys + id * key_size, map->separator, key_size);
+  memcpy(keys + (id + 1) * key_size, node_key(map, node, id),
+    (cap - id) * key_size);
+  memcpy(children, node_children(map, node),
+    (id + 1) * sizeof(struct sl_btree_node*));
+  children[id + 1] = child;
+  memcpy(children + id + 2, node_children(map, node) + id + 1,
+    (cap - id) * sizeof(struct sl_btree_node*));
+
+  memcpy(node_key(map, node, 0), keys, mid * key_size);
+  memcpy(node_children(map, node), children,
+    (mid + 1) * sizeof(struct sl_btree_node*));
+  node->nb_keys = mid;
+  memcpy(node_key(map, right, 0), keys + (mid + 1) * key_size,
+    (cap - mid) * key_size);
+  memcpy(node_children(map, right), children + mid + 1,
+    (cap - mid + 1) * sizeof(struct sl_btree_node*));
+  right->nb_keys = cap - mid;
+  memcpy(map->separator, keys + mid * key_size, key_size);
+}
+
+/* Remove the separator id of an inner node and its right child. */
+static void
+inner_remove
+  (const struct sl_btree_map* map,
+   struct sl_btree_node* node,
+   const size_t id)
+{
+  struct sl_btree_node** children = node_children(map, node);
+  ASSERT(id < node->nb_keys);
+  memmove(node_key(map, node, id), node_key(map, node, id + 1),
+    (node->nb_keys - id - 1) * map->key_size);
+  memmove(children + id + 1, children + id + 2,
+    (node->nb_keys - id - 1) * sizeof(struct sl_btree_node*));
+  --node->nb_keys;
+}
+
+/* Merge the child id + 1 of the parent in the child id. */
+static void
+merge_children
+  (struct sl_btree_map* map,
+   struct sl_btree_node* parent,
+   const size_t id)
+{
+  struct sl_btree_node* left = node_children(map, parent)[id];
+  struct sl_btree_node* right = node_children(map, parent)[id + 1];
+
+  if(left->is_leaf) {
+    ASSERT(left->nb_keys + right->nb_keys <= map->leaf_capacity);
+    leaf_move(map, left, left->nb_keys, right, 0, right->nb_keys);
+    left->nb_keys += right->nb_keys;
+    left->next = right->next;
+  } else {
+    ASSERT(left->nb_keys + right->nb_keys < map->inner_capacity);
+    memcpy(node_key(map, left, left->nb_keys), node_key(map, parent, id),
+      map->key_size);
+    memcpy(node_key(map, left, left->nb_keys + 1), node_key(map, right, 0),
+      right->nb_keys * map->key_size);
+    memcpy(node_children(map, left) + left->nb_keys + 1,
+      node_children(map, right),
+      (right->nb_keys + 1) * sizeof(struct sl_btree_node*));
+    left->nb_keys += right->nb_keys + 1;
+  }
+  inner_remove(map, parent, id);
+  MEM_FREE(map->allocator, right);
+}
+
+/* Move the first pair or child of the child id + 1 of the parent at the end
+ * of the child id. */
+static void
+rotate_left
+  (struct sl_btree_map* map,
+   struct sl_btree_node* parent,
+   const size_t id)
+{
+  struct sl_btree_node* left = node_children(map, parent)[id];
+  struct sl_btree_node* right = node_children(map, parent)[id + 1];
+
+  if(left->is_leaf) {
+    leaf_move(map, left, left->nb_keys, right, 0, 1);
+    leaf_move(map, right, 0, right, 1, right->nb_keys - 1);
+    memcpy(node_key(map, parent, id), node_key(map, right, 0),
+      map->key_size);
+  } else {
+    struct sl_btree_node** right_children = node_children(map, right);
+    memcpy(node_key(map, left, left->nb_keys), node_key(map, parent, id),
+      map->key_size);
+    node_children(map, left)[left->nb_keys + 1] = right_children[0];
+    memcpy(node_key(map, parent, id), node_key(map, right, 0),
+      map->key_size);
+    memmove(node_key(map, right, 0), node_key(map, right, 1),
+      (right->nb_keys - 1) * map->key_size);
+    memmove(right_children, right_children + 1,
+      right->nb_keys * sizeof(struct sl_btree_node*));
+  }
+  ++left->nb_keys;
+  --right->nb_keys;
+}
+
+/* Move the last pair or child of the child id of the parent at the beginning
+ * of the child id + 1. */
+static void
+rotate_right
+  (struct sl_btree_map* map,
+   struct sl_btree_node* parent,
+   const size_t id)
+{
+  struct sl_btree_node* left = node_children(map, parent)[id];
+  struct sl_btree_node* right = node_children(map, parent)[id + 1];
+
+  if(left->is_leaf) {
+    leaf_move(map, right, 1, right, 0, right->nb_keys);
+    leaf_move(map, right, 0, left, left->nb_keys - 1, 1);
+    memcpy(node_key(map, parent, id), node_key(map, right, 0),
+      map->key_size);
+  } else {
+    struct sl_btree_node** right_children = node_children(map, right);
+    memmove(node_key(map, right, 1), node_key(map, right, 0),
+      right->nb_keys * map->key_size);
+    memmove(right_children + 1, right_children,
+      (right->nb_keys + 1) * sizeof(struct sl_btree_node*));
+    memcpy(node_key(map, right, 0), node_key(map, parent, id),
+      map->key_size);
+    right_children[0] = node_children(map, left)[left->nb_keys];
+    memcpy(node_key(map, parent, id), node_key(map, left, left->nb_keys - 1),
+      map->key_size);
+  }
+  --left->nb_keys;
+  ++right->nb_keys;
+}
+
+static void
+set_iterator
+  (struct sl_btree_map* map,
+   struct sl_btree_node* leaf,
+   size_t id,
+   struct sl_btree_map_it* it,
+   bool* is_end_reached)
+{
+  if(leaf && id == leaf->nb_keys) {
+    leaf = leaf->next;
+    id = 0;
+  }
+  it->map = map;
+  it->leaf = leaf;
+  it->id = id;
+  if(leaf) {
+    it->pair.key = node_key(map, leaf, id);
+    it->pair.data = leaf_data(map, leaf, id);
+  } else {
+    it->pair.key = NULL;
+    it->pair.data = NULL;
+  }
+  *is_end_reached = leaf == NULL;
+}
+
+/* Distribute count items among nb_groups groups whose sizes differ by one at
+ * most. Return the size of the group id. */
+static FINLINE size_t
+group_size(const size_t count, const size_t nb_groups, const size_t id)
+{
+  return count / nb_groups + (id < count % nb_groups);
+}
+
+/*******************************************************************************
+ *
+ * B+tree map functions.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_btree_map
+  (size_t key_size,
+   size_t key_alignment,
+   size_t data_size,
+   size_t data_alignment,
+   int (*cmp_key)(const void*, const void*),
+   struct mem_allocator* specific_allocator,
+   struct sl_btree_map** out_map)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_btree_map* map = NULL;
+  size_t header_size = 0;
+  size_t cap = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!key_size || !data_size || !cmp_key || !out_map) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(!IS_POWER_OF_2(key_alignment)
+  || !IS_POWER_OF_2(data_alignment)
+  || key_alignment > CACHE_LINE_SIZE
+  || data_alignment > CACHE_LINE_SIZE) {
+    err = SL_ALIGNMENT_ERROR;
+    goto error;
+  }
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  map = MEM_CALLOC(allocator, 1, sizeof(struct sl_btree_map));
+  if(!map) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  map->cmp_key = cmp_key;
+  map->allocator = allocator;
+  map->key_size = key_size;
+  map->data_size = data_size;
+  map->keys_offset = ALIGN_SIZE(sizeof(struct sl_btree_node), key_alignment);
+  header_size = map->keys_offset;
+
+  /* Fit as many pairs as possible in NODE_SIZE bytes, the nodes being
+   * enlarged to hold MIN_CAPACITY pairs of large elements. */
+  cap = (NODE_SIZE - header_size) / (key_size + data_size);
+  for(;;) {
+    const size_t data_offset =
+      ALIGN_SIZE(header_size + cap * key_size, data_alignment);
+    if(cap <= MIN_CAPACITY || data_offset + cap * data_size <= NODE_SIZE)
+      break;
+    --cap;
+  }
+  map->leaf_capacity = MAX(cap, MIN_CAPACITY);
+  map->data_offset = ALIGN_SIZE
+    (header_size + map->leaf_capacity * key_size, data_alignment);
+  map->leaf_size = ALIGN_SIZE
+    (map->data_offset + map->leaf_capacity * data_size,
+     (size_t)CACHE_LINE_SIZE);
+
+  cap = (NODE_SIZE - header_size - sizeof(struct sl_btree_node*))
+      / (key_size + sizeof(struct sl_btree_node*));
+  for(;;) {
+    const size_t children_offset = ALIGN_SIZE
+      (header_size + cap * key_size, ALIGNOF(struct sl_btree_node*));
+    if(cap <= MIN_CAPACITY
+    || children_offset + (cap + 1) * sizeof(struct sl_btree_node*) <= NODE_SIZE)
+      break;
+    --cap;
+  }
+  map->inner_capacity = MAX(cap, MIN_CAPACITY);
+  map->children_offset = ALIGN_SIZE
+    (header_size + map->inner_capacity * key_size,
+     ALIGNOF(struct sl_btree_node*));
+  map->inner_size = ALIGN_SIZE
+    (map->children_offset
+     + (map->inner_capacity + 1) * sizeof(struct sl_btree_node*),
+     (size_t)CACHE_LINE_SIZE);
+
+  map->scratch_children_offset = ALIGN_SIZE
+    ((map->inner_capacity + 1) * key_size, ALIGNOF(struct sl_btree_node*));
+  map->scratch = MEM_ALIGNED_ALLOC(allocator, map->scratch_children_offset
+    + (map->inner_capacity + 2) * sizeof(struct sl_btree_node*),
+    MAX(key_alignment, ALIGNOF(struct sl_btree_node*)));
+  if(!map->scratch) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  map->separator = MEM_ALIGNED_ALLOC(allocator, key_size, key_alignment);
+  if(!map->separator) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+
+exit:
+  if(out_map)
+    *out_map = map;
+  return err;
+error:
+  if(map) {
+    if(map->scratch)
+      MEM_FREE(allocator, map->scratch);
+    MEM_FREE(allocator, map);
+    map = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_btree_map(struct sl_btree_map* map)
+{
+  if(!map)
+    return SL_INVALID_ARGUMENT;
+  SL(clear_btree_map(map));
+  MEM_FREE(map->allocator, map->scratch);
+  MEM_FREE(map->allocator, map->separator);
+  MEM_FREE(map->allocator, map);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_clear_btree_map(struct sl_btree_map* map)
+{
+  if(!map)
+    return SL_INVALID_ARGUMENT;
+  if(map->root)
+    free_subtree(map, map->root);
+  map->root = NULL;
+  map->length = 0;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_insert
+  (struct sl_btree_map* map,
+   const void* key,
+   const void* data)
+{
+  struct sl_btree_node* path[MAX_DEPTH];
+  struct sl_btree_node* nodes[MAX_DEPTH + 1]; /* Nodes created by the splits. */
+  struct sl_btree_node* leaf = NULL;
+  struct sl_btree_node* right = NULL;
+  size_t ids[MAX_DEPTH];
+  size_t nb_nodes = 0;
+  size_t depth = 0;
+  size_t id = 0;
+  size_t mid = 0;
+  size_t d = 0;
+  size_t i = 0;
+
+  if(!map || !key || !data)
+    return SL_INVALID_ARGUMENT;
+  if(!map->root) {
+    map->root = alloc_node(map, true);
+    if(!map->root)
+      return SL_MEMORY_ERROR;
+  }
+  depth = descend(map, key, path, ids);
+  leaf = path[depth];
+  id = lower_bound_id(map, leaf, key);
+  if(id < leaf->nb_keys && map->cmp_key(node_key(map, leaf, id), key) == 0)
+    return SL_INVALID_ARGUMENT;
+  if(leaf->nb_keys < map->leaf_capacity) {
+    leaf_insert(map, leaf, id, key, data);
+    ++map->length;
+    return SL_NO_ERROR;
+  }
+
+  /* Allocate the nodes of the splits up front so that the map is left
+   * unchanged on error: one per full node of the path from the leaf and a new
+   * root if the root is split. */
+  nb_nodes = 1;
+  for(d = depth; d > 0 && path[d-1]->nb_keys == map->inner_capacity; --d)
+    ++nb_nodes;
+  if(d == 0)
+    ++nb_nodes;
+  for(i = 0; i < nb_nodes; ++i) {
+    nodes[i] = alloc_node(map, i == 0);
+    if(!nodes[i]) {
+      while(i)
+        MEM_FREE(map->allocator, nodes[--i]);
+      return SL_MEMORY_ERROR;
+    }
+  }
+
+  /* Split the leaf. When appending past the last leaf, the new key is alone
+   * in the new leaf so that sorted insertions fill the leaves. */
+  right = nodes[0];
+  mid = id == leaf->nb_keys && !leaf->next ? leaf->nb_keys : leaf->nb_keys/2;
+  leaf_move(map, right, 0, leaf, mid, leaf->nb_keys - mid);
+  right->nb_keys = leaf->nb_keys - mid;
+  leaf->nb_keys = mid;
+  right->next = leaf->next;
+  leaf->next = right;
+  if(id < mid) {
+    leaf_insert(map, leaf, id, key, data);
+  } else {
+    leaf_insert(map, right, id - mid, key, data);
+  }
+  memcpy(map->separator, node_key(map, right, 0), map->key_size);
+  ++map->length;
+
+  /* Insert the separator in the parents, splitting the full ones. */
+  for(d = depth, i = 1; d > 0; --d) {
+    struct sl_btree_node* parent = path[d-1];
+    if(parent->nb_keys < map->inner_capacity) {
+      inner_insert(map, parent, ids[d-1], map->separator, right);
+      return SL_NO_ERROR;
+    }
+    inner_split(map, parent, nodes[i], ids[d-1], right);
+    right = nodes[i++];
+  }
+  ASSERT(i == nb_nodes - 1);
+  memcpy(node_key(map, nodes[i], 0), map->separator, map->key_size);
+  node_children(map, nodes[i])[0] = map->root;
+  node_children(map, nodes[i])[1] = right;
+  nodes[i]->nb_keys = 1;
+  map->root = nodes[i];
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_bulk_load
+  (struct sl_btree_map* map,
+   const void* keys,
+   const void* data,
+   size_t count)
+{
+  struct sl_vector* level = NULL; /* Nodes of the last built level. */
+  struct sl_vector* first_keys = NULL; /* Lowest key of each node. */
+  struct sl_btree_node** nodes = NULL;
+  const char** nodes_keys = NULL;
+  struct sl_btree_node* prev = NULL;
+  void* ptr = NULL;
+  size_t nb_children = 0;
+  size_t nb_nodes = 0;
+  size_t nb_built = 0; /* # nodes built in the level being built. */
+  size_t n = 0;
+  size_t i = 0;
+  size_t j = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!map || ((!keys || !data) && count) || map->root) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  for(i = 1; i < count; ++i) {
+    const char* key = (const char*)keys + i * map->key_size;
+    if(map->cmp_key(key - map->key_size, key) >= 0) {
+      err = SL_INVALID_ARGUMENT;
+      goto error;
+    }
+  }
+  if(!count)
+    goto exit;
+
+  err = sl_create_vector(sizeof(struct sl_btree_node*),
+    ALIGNOF(struct sl_btree_node*), map->allocator, &level);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_create_vector
+    (sizeof(char*), ALIGNOF(char*), map->allocator, &first_keys);
+  if(err != SL_NO_ERROR)
+    goto error;
+
+  /* Fill the leaves with the same number of pairs, up to their capacity. */
+  nb_nodes = (count + map->leaf_capacity - 1) / map->leaf_capacity;
+  err = sl_vector_resize(level, nb_nodes, NULL);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_vector_resize(first_keys, nb_nodes, NULL);
+  if(err != SL_NO_ERROR)
+    goto error;
+  SL(vector_buffer(level, NULL, NULL, NULL, &ptr));
+  nodes = ptr;
+  SL(vector_buffer(first_keys, NULL, NULL, NULL, &ptr));
+  nodes_keys = ptr;
+  for(i = 0, j = 0; i < nb_nodes; ++i) {
+    struct sl_btree_node* leaf = alloc_node(map, true);
+    if(!leaf) {
+      err = SL_MEMORY_ERROR;
+      goto error;
+    }
+    n = group_size(count, nb_nodes, i);
+    memcpy(node_key(map, leaf, 0), (const char*)keys + j * map->key_size,
+      n * map->key_size);
+    memcpy(leaf_data(map, leaf, 0), (const char*)data + j * map->data_size,
+      n * map->data_size);
+    leaf->nb_keys = n;
+    if(prev)
+      prev->next = leaf;
+    prev = leaf;
+    nodes[i] = leaf;
+    nodes_keys[i] = node_key(map, leaf, 0);
+    ++nb_built;
+    j += n;
+  }
+
+  /* Build the inner levels in place of the level below them. */
+  while(nb_nodes > 1) {
+    nb_children = nb_nodes;
+    nb_nodes = (nb_children + map->inner_capacity)
+             / (map->inner_capacity + 1);
+    nb_built = 0;
+    for(i = 0, j = 0; i < nb_nodes; ++i) {
+      struct sl_btree_node* node = alloc_node(map, false);
+      const char* first_key = nodes_keys[j];
+      if(!node) {
+        err = SL_MEMORY_ERROR;
+        goto error;
+      }
+      n = group_size(nb_children, nb_nodes, i);
+      memcpy(node_children(map, node), nodes + j,
+        n * sizeof(struct sl_btree_node*));
+      for(node->nb_keys = 0; node->nb_keys < n - 1; ++node->nb_keys) {
+        memcpy(node_key(map, node, node->nb_keys),
+          nodes_keys[j + node->nb_keys + 1], map->key_size);
+      }
+      nodes[i] = node;
+      nodes_keys[i] = first_key;
+      ++nb_built;
+      j += n;
+    }
+  }
+  map->root = nodes[0];
+  map->length = count;
+
+exit:
+  if(level)
+    SL(free_vector(level));
+  if(first_keys)
+    SL(free_vector(first_keys));
+  return err;
+error:
+  /* The nodes [0, nb_built) of the level being built own their children
+   * while the following entries still reference the level below. */
+  for(i = 0; i < nb_built; ++i)
+    free_subtree(map, nodes[i]);
+  for(i = j; i < nb_children; ++i)
+    free_subtree(map, nodes[i]);
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_erase(struct sl_btree_map* map, const void* key)
+{
+  struct sl_btree_node* path[MAX_DEPTH];
+  struct sl_btree_node* node = NULL;
+  size_t ids[MAX_DEPTH];
+  size_t depth = 0;
+  size_t id = 0;
+  size_t d = 0;
+
+  if(!map || !key || !map->root)
+    return SL_INVALID_ARGUMENT;
+  depth = descend(map, key, path, ids);
+  node = path[depth];
+  id = lower_bound_id(map, node, key);
+  if(id == node->nb_keys || map->cmp_key(node_key(map, node, id), key) != 0)
+    return SL_INVALID_ARGUMENT;
+  leaf_move(map, node, id, node, id + 1, node->nb_keys - id - 1);
+  --node->nb_keys;
+  --map->length;
+
+  /* Refill the nodes that are less than half full from their siblings or
+   * merge them with one of their siblings. */
+  for(d = depth; d > 0; --d) {
+    struct sl_btree_node* parent = path[d-1];
+    struct sl_btree_node** children = node_children(map, parent);
+    const size_t min_keys =
+      (node->is_leaf ? map->leaf_capacity : map->inner_capacity) / 2;
+
+    if(node->nb_keys >= min_keys)
+      break;
+    id = ids[d-1];
+    if(id < parent->nb_keys && children[id + 1]->nb_keys > min_keys) {
+      rotate_left(map, parent, id);
+      break;
+    }
+    if(id > 0 && children[id - 1]->nb_keys > min_keys) {
+      rotate_right(map, parent, id - 1);
+      break;
+    }
+    merge_children(map, parent, id < parent->nb_keys ? id : id - 1);
+    node = parent;
+  }
+
+  node = map->root;
+  if(node->is_leaf && node->nb_keys == 0) {
+    MEM_FREE(map->allocator, node);
+    map->root = NULL;
+  } else if(!node->is_leaf && node->nb_keys == 0) {
+    map->root = node_children(map, node)[0];
+    MEM_FREE(map->allocator, node);
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_find(struct sl_btree_map* map, const void* key, void** data)
+{
+  struct sl_pair pair = { NULL, NULL };
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!data)
+    return SL_INVALID_ARGUMENT;
+  err = sl_btree_map_find_pair(map, key, &pair);
+  if(err != SL_NO_ERROR)
+    return err;
+  *data = pair.data;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_find_pair
+  (struct sl_btree_map* map,
+   const void* key,
+   struct sl_pair* pair)
+{
+  struct sl_btree_node* leaf = NULL;
+  size_t id = 0;
+
+  if(!map || !key || !pair)
+    return SL_INVALID_ARGUMENT;
+  pair->key = NULL;
+  pair->data = NULL;
+  if(!map->root)
+    return SL_NO_ERROR;
+  leaf = find_leaf(map, key);
+  id = lower_bound_id(map, leaf, key);
+  if(id < leaf->nb_keys && map->cmp_key(node_key(map, leaf, id), key) == 0) {
+    pair->key = node_key(map, leaf, id);
+    pair->data = leaf_data(map, leaf, id);
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_length(struct sl_btree_map* map, size_t* out_length)
+{
+  if(!map || !out_length)
+    return SL_INVALID_ARGUMENT;
+  *out_length = map->length;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_lower_bound
+  (struct sl_btree_map* map,
+   const void* key,
+   struct sl_btree_map_it* it,
+   bool* is_end_reached)
+{
+  struct sl_btree_node* leaf = NULL;
+
+  if(!map || !key || !it || !is_end_reached)
+    return SL_INVALID_ARGUMENT;
+  if(!map->root) {
+    set_iterator(map, NULL, 0, it, is_end_reached);
+  } else {
+    leaf = find_leaf(map, key);
+    set_iterator(map, leaf, lower_bound_id(map, leaf, key), it,
+      is_end_reached);
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_upper_bound
+  (struct sl_btree_map* map,
+   const void* key,
+   struct sl_btree_map_it* it,
+   bool* is_end_reached)
+{
+  struct sl_btree_node* leaf = NULL;
+
+  if(!map || !key || !it || !is_end_reached)
+    return SL_INVALID_ARGUMENT;
+  if(!map->root) {
+    set_iterator(map, NULL, 0, it, is_end_reached);
+  } else {
+    leaf = find_leaf(map, key);
+    set_iterator(map, leaf, upper_bound_id(map, leaf, key), it,
+      is_end_reached);
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_begin
+  (struct sl_btree_map* map,
+   struct sl_btree_map_it* it,
+   bool* is_end_reached)
+{
+  struct sl_btree_node* node = NULL;
+
+  if(!map || !it || !is_end_reached)
+    return SL_INVALID_ARGUMENT;
+  node = map->root;
+  while(node && !node->is_leaf)
+    node = node_children(map, node)[0];
+  set_iterator(map, node, 0, it, is_end_reached);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_btree_map_it_next(struct sl_btree_map_it* it, bool* is_end_reached)
+{
+  if(!it || !it->map || !it->leaf || !is_end_reached)
+    return SL_INVALID_ARGUMENT;
+  set_iterator(it->map, it->leaf, it->id + 1, it, is_end_reached);
+  return SL_NO_ERROR;
+}
+
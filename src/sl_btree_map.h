@@ -0,0 +1,125 @@
+#ifndef SL_BTREE_MAP_H
+#define SL_BTREE_MAP_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include "sl_pair.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+struct mem_allocator;
+
+/* Ordered map stored in a B+tree whose nodes span a few cache lines. The
+ * pairs are stored in the leaves that are linked in the key order, the inner
+ * nodes only storing copies of keys to guide the search. Insert and erase are
+ * O(log n) rather than the O(n) moves of sl_flat_map and the ordered scans
+ * remain sequential in each leaf. The key comparator follows the contract of
+ * the sl_flat_map one. */
+struct sl_btree_map;
+
+/* Iterator on the pairs of the map in the key order. It is invalidated by any
+ * insertion or removal. */
+struct sl_btree_map_it {
+  struct sl_btree_map* map;
+  struct sl_pair pair;
+  /* Private data. */
+  struct sl_btree_node* leaf;
+  size_t id;
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SL_API enum sl_error
+sl_create_btree_map
+  (size_t key_size,
+   size_t key_alignment,
+   size_t data_size,
+   size_t data_alignment,
+   int (*cmp_key)(const void*, const void*),
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_btree_map** out_map);
+
+SL_API enum sl_error
+sl_free_btree_map
+  (struct sl_btree_map* map);
+
+SL_API enum sl_error
+sl_clear_btree_map
+  (struct sl_btree_map* map);
+
+/* Return SL_INVALID_ARGUMENT if the key is already in the map. */
+SL_API enum sl_error
+sl_btree_map_insert
+  (struct sl_btree_map* map,
+   const void* key,
+   const void* data);
+
+/* Build the map from count pairs whose keys are sorted in strictly increasing
+ * order. The map must be empty. The leaves are filled in one pass rather than
+ * split by successive insertions. */
+SL_API enum sl_error
+sl_btree_map_bulk_load
+  (struct sl_btree_map* map,
+   const void* keys,
+   const void* data,
+   size_t count);
+
+/* Return SL_INVALID_ARGUMENT if the key is not in the map. */
+SL_API enum sl_error
+sl_btree_map_erase
+  (struct sl_btree_map* map,
+   const void* key);
+
+/* The data is set to NULL if the key is not found. */
+SL_API enum sl_error
+sl_btree_map_find
+  (struct sl_btree_map* map,
+   const void* key,
+   void** data);
+
+SL_API enum sl_error
+sl_btree_map_find_pair
+  (struct sl_btree_map* map,
+   const void* key,
+   struct sl_pair* pair);
+
+SL_API enum sl_error
+sl_btree_map_length
+  (struct sl_btree_map* map,
+   size_t* out_length);
+
+/* Point the iterator to the first pair whose key is not less than key. */
+SL_API enum sl_error
+sl_btree_map_lower_bound
+  (struct sl_btree_map* map,
+   const void* key,
+   struct sl_btree_map_it* it,
+   bool* is_end_reached);
+
+/* Point the iterator to the first pair whose key is greater than key. */
+SL_API enum sl_error
+sl_btree_map_upper_bound
+  (struct sl_btree_map* map,
+   const void* key,
+   struct sl_btree_map_it* it,
+   bool* is_end_reached);
+
+SL_API enum sl_error
+sl_btree_map_begin
+  (struct sl_btree_map* map,
+   struct sl_btree_map_it* it,
+   bool* is_end_reached);
+
+SL_API enum sl_error
+sl_btree_map_it_next
+  (struct sl_btree_map_it* it,
+   bool* is_end_reached);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_BTREE_MAP_H */
+
@@ -0,0 +1,333 @@
+#include "sl_deque.h"
+#include <snlsys/math.h>
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct sl_deque {
+  struct mem_allocator* allocator;
+  size_t data_size;
+  size_t data_alignment;
+  size_t head; /* Position of the front element in the buffer. */
+  size_t length;
+  size_t capacity; /* Power of 2, in number of elements. */
+  void* buffer;
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE void*
+element(const struct sl_deque* deque, size_t id)
+{
+  ASSERT(deque && id < deque->capacity && IS_POWER_OF_2(deque->capacity));
+  return (void*)
+    ((uintptr_t)deque->buffer
+     + ((deque->head + id) & (deque->capacity - 1)) * deque->data_size);
+}
+
+/* Grow the buffer in order to store at least `capacity' elements. The elements
+ * are moved at the beginning of the new buffer. If old_buffer is not NULL, the
+ * previous buffer is returned rather than freed, letting the caller read an
+ * element that lies in it. */
+static enum sl_error
+ensure_allocated
+  (struct sl_deque* deque,
+   size_t capacity,
+   void** old_buffer)
+{
+  void* buffer = NULL;
+  size_t new_capacity = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(deque);
+
+  if(old_buffer)
+    *old_buffer = NULL;
+  if(capacity <= deque->capacity)
+    goto exit;
+
+  NEXT_POWER_OF_2(capacity, new_capacity);
+  if(new_capacity < capacity || new_capacity > SIZE_MAX / deque->data_size) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  buffer = MEM_ALIGNED_ALLOC
+    (deque->allocator, new_capacity * deque->data_size, deque->data_alignment);
+  if(!buffer) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  if(deque->length) {
+    const size_t len0 = MIN(deque->length, deque->capacity - deque->head);
+    memcpy(buffer, element(deque, 0), len0 * deque->data_size);
+    memcpy
+      ((void*)((uintptr_t)buffer + len0 * deque->data_size),
+       deque->buffer,
+       (deque->length - len0) * deque->data_size);
+  }
+  if(old_buffer) {
+    *old_buffer = deque->buffer;
+  } else if(deque->buffer) {
+    MEM_FREE(deque->allocator, deque->buffer);
+  }
+  deque->buffer = buffer;
+  deque->capacity = new_capacity;
+  deque->head = 0;
+
+exit:
+  return err;
+error:
+  goto exit;
+}
+
+static enum sl_error
+push(struct sl_deque* deque, const void* data, bool is_front)
+{
+  void* old_buffer = NULL;
+  void* dst = NULL;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!deque || !data)
+    return SL_INVALID_ARGUMENT;
+  if(!IS_ALIGNED(data, deque->data_alignment))
+    return SL_ALIGNMENT_ERROR;
+  if(deque->length == SIZE_MAX)
+    return SL_OVERFLOW_ERROR;
+  /* The data to push may lie in the deque, i.e. free the previous buffer
+   * *AFTER* the copy. */
+  err = ensure_allocated(deque, deque->length + 1, &old_buffer);
+  if(err != SL_NO_ERROR)
+    return err;
+  if(is_front) {
+    deque->head = (deque->head - 1) & (deque->capacity - 1);
+    dst = element(deque, 0);
+  } else {
+    dst = element(deque, deque->length);
+  }
+  if(dst != data)
+    memcpy(dst, data, deque->data_size);
+  ++deque->length;
+  if(old_buffer)
+    MEM_FREE(deque->allocator, old_buffer);
+  return SL_NO_ERROR;
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the deque container.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_deque
+  (size_t data_size,
+   size_t data_alignment,
+   struct mem_allocator* specific_allocator,
+   struct sl_deque** out_deque)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_deque* deque = NULL;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!out_deque || !data_size) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(!IS_POWER_OF_2(data_alignment)) {
+    err = SL_ALIGNMENT_ERROR;
+    goto error;
+  }
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  deque = MEM_CALLOC(allocator, 1, sizeof(struct sl_deque));
+  if(deque == NULL) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  deque->allocator = allocator;
+  deque->data_size = data_size;
+  deque->data_alignment = data_alignment;
+
+exit:
+  if(out_deque)
+    *out_deque = deque;
+  return err;
+
+error:
+  if(deque) {
+    ASSERT(allocator);
+    MEM_FREE(allocator, deque);
+    deque = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_deque
+  (struct sl_deque* deque)
+{
+  struct mem_allocator* allocator = NULL;
+
+  if(!deque)
+    return SL_INVALID_ARGUMENT;
+
+  allocator = deque->allocator;
+  if(deque->buffer)
+    MEM_FREE(allocator, deque->buffer);
+  MEM_FREE(allocator, deque);
+
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_clear_deque
+  (struct sl_deque* deque)
+{
+  if(!deque)
+    return SL_INVALID_ARGUMENT;
+  deque->head = 0;
+  deque->length = 0;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_push_back
+  (struct sl_deque* deque,
+   const void* data)
+{
+  return push(deque, data, false);
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_push_front
+  (struct sl_deque* deque,
+   const void* data)
+{
+  return push(deque, data, true);
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_pop_back
+  (struct sl_deque* deque)
+{
+  if(!deque)
+    return SL_INVALID_ARGUMENT;
+  deque->length -= (deque->length != 0);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_pop_front
+  (struct sl_deque* deque)
+{
+  return sl_deque_pop_front_n(deque, 1);
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_pop_front_n
+  (struct sl_deque* deque,
+   size_t count)
+{
+  if(!deque)
+    return SL_INVALID_ARGUMENT;
+  count = MIN(count, deque->length);
+  if(count) {
+    deque->head = (deque->head + count) & (deque->capacity - 1);
+    deque->length -= count;
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_front
+  (struct sl_deque* deque,
+   void** data)
+{
+  return sl_deque_at(deque, 0, data);
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_back
+  (struct sl_deque* deque,
+   void** data)
+{
+  if(!deque || !deque->length || !data)
+    return SL_INVALID_ARGUMENT;
+  *data = element(deque, deque->length - 1);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_at
+  (struct sl_deque* deque,
+   size_t id,
+   void** data)
+{
+  if(!deque || (id >= deque->length) || !data)
+    return SL_INVALID_ARGUMENT;
+  *data = element(deque, id);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_length
+  (struct sl_deque* deque,
+   size_t* length)
+{
+  if(!deque || !length)
+    return SL_INVALID_ARGUMENT;
+  *length = deque->length;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_capacity
+  (struct sl_deque* deque,
+   size_t* capacity)
+{
+  if(!deque || !capacity)
+    return SL_INVALID_ARGUMENT;
+  *capacity = deque->capacity;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_reserve
+  (struct sl_deque* deque,
+   size_t capacity)
+{
+  if(!deque)
+    return SL_INVALID_ARGUMENT;
+  return ensure_allocated(deque, capacity, NULL);
+}
+
+EXPORT_SYM enum sl_error
+sl_deque_spans
+  (struct sl_deque* deque,
+   size_t* length0,
+   void** buffer0,
+   size_t* length1,
+   void** buffer1)
+{
+  size_t len0 = 0;
+  size_t len1 = 0;
+
+  if(!deque)
+    return SL_INVALID_ARGUMENT;
+  if(deque->length) {
+    len0 = MIN(deque->length, deque->capacity - deque->head);
+    len1 = deque->length - len0;
+  }
+  if(length0)
+    *length0 = len0;
+  if(buffer0)
+    *buffer0 = len0 ? element(deque, 0) : NULL;
+  if(length1)
+    *length1 = len1;
+  if(buffer1)
+    *buffer1 = len1 ? deque->buffer : NULL;
+  return SL_NO_ERROR;
+}
+
@@ -0,0 +1,106 @@
+#ifndef SL_DEQUE_H
+#define SL_DEQUE_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stddef.h>
+
+struct mem_allocator;
+
+/* Double ended queue. The elements are stored in a ring buffer whose capacity
+ * is a power of 2; pushing or popping an element at either end is done in
+ * constant time. */
+struct sl_deque;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SL_API enum sl_error
+sl_create_deque
+  (size_t data_size,
+   size_t data_alignment,
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_deque** out_deque);
+
+SL_API enum sl_error
+sl_free_deque
+  (struct sl_deque* deque);
+
+SL_API enum sl_error
+sl_clear_deque
+  (struct sl_deque* deque);
+
+SL_API enum sl_error
+sl_deque_push_back
+  (struct sl_deque* deque,
+   const void* data);
+
+SL_API enum sl_error
+sl_deque_push_front
+  (struct sl_deque* deque,
+   const void* data);
+
+SL_API enum sl_error
+sl_deque_pop_back
+  (struct sl_deque* deque);
+
+SL_API enum sl_error
+sl_deque_pop_front
+  (struct sl_deque* deque);
+
+/* Remove the min(count, length) first elements of the deque. */
+SL_API enum sl_error
+sl_deque_pop_front_n
+  (struct sl_deque* deque,
+   size_t count);
+
+SL_API enum sl_error
+sl_deque_front
+  (struct sl_deque* deque,
+   void** out_data);
+
+SL_API enum sl_error
+sl_deque_back
+  (struct sl_deque* deque,
+   void** out_data);
+
+/* Return the element at the position `id' from the front of the deque. */
+SL_API enum sl_error
+sl_deque_at
+  (struct sl_deque* deque,
+   size_t id,
+   void** out_data);
+
+SL_API enum sl_error
+sl_deque_length
+  (struct sl_deque* deque,
+   size_t* out_length);
+
+SL_API enum sl_error
+sl_deque_capacity
+  (struct sl_deque* deque,
+   size_t* out_capacity);
+
+SL_API enum sl_error
+sl_deque_reserve
+  (struct sl_deque* deque,
+   size_t capacity);
+
+/* Return the elements of the deque as two contiguous spans. The first span
+ * starts with the front element and the second one, possibly empty, ends with
+ * the back element. An empty span is returned as a NULL buffer. */
+SL_API enum sl_error
+sl_deque_spans
+  (struct sl_deque* deque,
+   size_t* out_length0, /* May be NULL. */
+   void** out_buffer0, /* May be NULL. */
+   size_t* out_length1, /* May be NULL. */
+   void** out_buffer1); /* May be NULL. */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_DEQUE_H */
+
@@ -2,19 +2,509 @@
 #include "sl_flat_map.h"
 #include "sl_flat_set.h"
 #include "sl_pair.h"
+#include "sl_sort.h"
 #include "sl_vector.h"
 #include <snlsys/math.h>
 #include <snlsys/mem_allocator.h>
 #include <snlsys/snlsys.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <string.h>
+
+/* Number of keys looked up per call to sl_flat_set_find_n by
+ * sl_flat_map_find_n, whose ids are stored on the stack. */
+#define FIND_CHUNK_LENGTH 256
 
 struct sl_flat_map {
+  int (*cmp_key)(const void*, const void*);
   struct sl_flat_set* key_set;
   struct sl_vector* data_list;
   struct mem_allocator* allocator;
+  /* Write buffer. Sorted pairs inserted or erased since the last merge, the
+   * state of each pair being stored in delta_states. */
+  struct sl_flat_map* delta; /* May be NULL. */
+  struct sl_vector* delta_states;
+  size_t max_delta_length;
+  size_t delta_nb_inserted; /* # pairs of the delta that are not in the map. */
+  size_t delta_nb_erased; /* # tombstones. */
+};
+
+/* State of a pair of the write buffer with respect to the map. */
+enum delta_state {
+  DELTA_INSERTED, /* The key is not in the map. */
+  DELTA_UPDATED, /* The key is in the map. Its data is replaced. */
+  DELTA_ERASED /* The key is in the map. It is removed. */
+};
+
+/* Header of an inserted pair whose key is copied key_offset bytes after the
+ * beginning of the entry. The key comparator is stored in each entry since
+ * the sort comparator has no context. */
+struct entry {
+  int (*cmp_key)(const void*, const void*);
+  const void* data;
+  size_t key_offset;
+  size_t position; /* Lower bound of the key in the map before insertion. */
+  bool is_dup; /* Is the key already in the map? */
 };
 
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE const void*
+entry_key(const struct entry* entry)
+{
+  return (const char*)entry + entry->key_offset;
+}
+
+static FINLINE struct entry*
+entry_at(char* entries, const size_t entry_size, const size_t id)
+{
+  return (struct entry*)(entries + id * entry_size);
+}
+
+static int
+cmp_entry(const void* a, const void* b)
+{
+  const struct entry* e0 = a;
+  const struct entry* e1 = b;
+  return e0->cmp_key(entry_key(e0), entry_key(e1));
+}
+
+/* Lower bound of key in [from, len) found by exponential steps from `from'
+ * followed by a binary search. */
+static size_t
+gallop_forward
+  (struct sl_flat_map* map,
+   const char* keys,
+   const size_t key_size,
+   size_t from,
+   const size_t len,
+   const void* key)
+{
+  size_t step = 1;
+  size_t end = 0;
+  ASSERT(map && from <= len);
+  while(step <= len - from
+     && map->cmp_key(key, keys + (from + step - 1) * key_size) > 0) {
+    from += step;
+    step *= 2;
+  }
+  end = MIN(from + step - 1, len);
+  while(from < end) {
+    const size_t mid = from + (end - from) / 2;
+    if(map->cmp_key(key, keys + mid * key_size) > 0) {
+      from = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return from;
+}
+
+static FINLINE bool
+is_delta_enabled(const struct sl_flat_map* map)
+{
+  return map->delta != NULL;
+}
+
+/* Look for key in the write buffer. Return false if it is not buffered. */
+static bool
+delta_find
+  (struct sl_flat_map* map,
+   const void* key,
+   size_t* id,
+   enum delta_state* state)
+{
+  size_t len = 0;
+  unsigned char* states = NULL;
+  void* ptr = NULL;
+  ASSERT(is_delta_enabled(map) && key && id && state);
+
+  SL(flat_set_find(map->delta->key_set, key, id));
+  SL(flat_set_length(map->delta->key_set, &len));
+  if(*id == len)
+    return false;
+  SL(vector_buffer(map->delta_states, NULL, NULL, NULL, &ptr));
+  states = ptr;
+  *state = (enum delta_state)states[*id];
+  return true;
+}
+
+static enum sl_error
+delta_push
+  (struct sl_flat_map* map,
+   const void* key,
+   const void* data,
+   const enum delta_state state)
+{
+  const unsigned char byte = (unsigned char)state;
+  size_t id = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(is_delta_enabled(map));
+
+  err = sl_flat_map_insert(map->delta, key, data, &id);
+  if(err != SL_NO_ERROR)
+    return err;
+  err = sl_vector_insert(map->delta_states, id, &byte);
+  if(err != SL_NO_ERROR) {
+    SL(flat_map_erase(map->delta, key, NULL));
+    return err;
+  }
+  return SL_NO_ERROR;
+}
+
+static void
+delta_set_state
+  (struct sl_flat_map* map,
+   const size_t id,
+   const enum delta_state state)
+{
+  void* ptr = NULL;
+  ASSERT(is_delta_enabled(map));
+  SL(vector_at(map->delta_states, id, &ptr));
+  *(unsigned char*)ptr = (unsigned char)state;
+}
+
+/* Move the pairs [from, to) of the main arrays to dst. */
+static FINLINE void
+move_run
+  (char* keys,
+   char* data,
+   const size_t key_size,
+   const size_t data_size,
+   const size_t from,
+   const size_t to,
+   const size_t dst)
+{
+  ASSERT(from <= to);
+  if(from == dst || from == to)
+    return;
+  memmove(keys + dst * key_size, keys + from * key_size,
+    (to - from) * key_size);
+  memmove(data + dst * data_size, data + from * data_size,
+    (to - from) * data_size);
+}
+
+/* Merge the write buffer with the map in place. The inserted keys are merged
+ * in the key set by sl_flat_set_insert_n and their data are merged from the
+ * back in the same way, the data of the updated pairs being overwritten in
+ * place. The erased pairs are then compacted in one forward pass. The map is
+ * left unchanged on error. */
+static enum sl_error
+merge_delta(struct sl_flat_map* map)
+{
+  struct sl_vector* position_list = NULL;
+  struct sl_vector* inserted_key_list = NULL;
+  char* keys = NULL;
+  char* data = NULL;
+  const char* delta_keys = NULL;
+  const char* delta_data = NULL;
+  const unsigned char* states = NULL;
+  size_t* positions = NULL;
+  void* ptr = NULL;
+  size_t key_size = 0;
+  size_t key_alignment = 0;
+  size_t data_size = 0;
+  size_t len = 0;
+  size_t delta_len = 0;
+  size_t grown_len = 0;
+  size_t merged_len = 0;
+  size_t nb_inserted = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(is_delta_enabled(map));
+
+  SL(vector_length(map->delta_states, &delta_len));
+  if(!delta_len)
+    goto exit;
+  SL(flat_set_buffer(map->key_set, &len, &key_size, &key_alignment, &ptr));
+  keys = ptr;
+  SL(vector_buffer(map->data_list, NULL, &data_size, NULL, NULL));
+  SL(flat_set_buffer(map->delta->key_set, NULL, NULL, NULL, &ptr));
+  delta_keys = ptr;
+  SL(vector_buffer(map->delta->data_list, NULL, NULL, NULL, &ptr));
+  delta_data = ptr;
+  SL(vector_buffer(map->delta_states, NULL, NULL, NULL, &ptr));
+  states = ptr;
+  grown_len = len + map->delta_nb_inserted;
+  merged_len = grown_len - map->delta_nb_erased;
+
+  /* Lower bound in the map of each buffered key and copy of the inserted
+   * keys. */
+  err = sl_create_vector
+    (sizeof(size_t), ALIGNOF(size_t), map->allocator, &position_list);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_vector_resize(position_list, delta_len, NULL);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_create_vector
+    (key_size, key_alignment, map->allocator, &inserted_key_list);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_vector_reserve(inserted_key_list, map->delta_nb_inserted);
+  if(err != SL_NO_ERROR)
+    goto error;
+  SL(vector_buffer(position_list, NULL, NULL, NULL, &ptr));
+  positions = ptr;
+  for(i = 0, j = 0; j < delta_len; ++j) {
+    const char* key = delta_keys + j * key_size;
+    i = gallop_forward(map, keys, key_size, i, len, key);
+    positions[j] = i;
+    if(states[j] == DELTA_INSERTED) {
+      SL(vector_push_back(inserted_key_list, key));
+    } else {
+      ASSERT(i < len && map->cmp_key(key, keys + i * key_size) == 0);
+      ++i;
+    }
+  }
+
+  /* Grow both arrays once. Nothing can fail afterwards. */
+  err = sl_vector_reserve(map->data_list, grown_len);
+  if(err != SL_NO_ERROR)
+    goto error;
+  if(map->delta_nb_inserted) {
+    SL(vector_buffer(inserted_key_list, NULL, NULL, NULL, &ptr));
+    err = sl_flat_set_insert_n
+      (map->key_set, ptr, map->delta_nb_inserted, SL_DUPLICATE_REJECT, NULL);
+    if(err != SL_NO_ERROR)
+      goto error;
+  }
+  SL(vector_resize(map->data_list, grown_len, NULL));
+  SL(flat_set_buffer(map->key_set, NULL, NULL, NULL, &ptr));
+  keys = ptr;
+  SL(vector_buffer(map->data_list, NULL, NULL, NULL, &ptr));
+  data = ptr;
+
+  /* Merge the data from the back. The data of an updated pair is written
+   * before the run holding it is moved. */
+  i = len;
+  k = grown_len;
+  for(j = delta_len; j > 0; --j) {
+    const char* x = delta_data + (j - 1) * data_size;
+    const size_t pos = positions[j - 1];
+    switch(states[j - 1]) {
+      case DELTA_INSERTED:
+        k -= i - pos;
+        memmove(data + k * data_size, data + pos * data_size,
+          (i - pos) * data_size);
+        --k;
+        memcpy(data + k * data_size, x, data_size);
+        i = pos;
+        break;
+      case DELTA_UPDATED: memcpy(data + pos * data_size, x, data_size); break;
+      case DELTA_ERASED: break;
+      default: ASSERT(0); break;
+    }
+  }
+  ASSERT(i == k);
+
+  /* Compact the erased pairs. Their position is shifted by the number of keys
+   * inserted before them. */
+  if(map->delta_nb_erased) {
+    for(i = 0, j = 0, k = 0; j < delta_len; ++j) {
+      size_t pos = 0;
+      if(states[j] == DELTA_INSERTED) {
+        ++nb_inserted;
+        continue;
+      }
+      if(states[j] != DELTA_ERASED)
+        continue;
+      pos = positions[j] + nb_inserted;
+      move_run(keys, data, key_size, data_size, i, pos, k);
+      k += pos - i;
+      i = pos + 1;
+    }
+    move_run(keys, data, key_size, data_size, i, grown_len, k);
+    ASSERT(k + grown_len - i == merged_len);
+    SL(flat_set_erase_n(map->key_set, merged_len, map->delta_nb_erased));
+    SL(vector_erase_n(map->data_list, merged_len, map->delta_nb_erased));
+  }
+  SL(clear_flat_map(map->delta));
+  SL(clear_vector(map->delta_states));
+  map->delta_nb_inserted = 0;
+  map->delta_nb_erased = 0;
+
+exit:
+  if(position_list)
+    SL(free_vector(position_list));
+  if(inserted_key_list)
+    SL(free_vector(inserted_key_list));
+  return err;
+error:
+  goto exit;
+}
+
+/* Merge the write buffer before an access by index. */
+static FINLINE enum sl_error
+flush_delta(struct sl_flat_map* map)
+{
+  return is_delta_enabled(map) ? merge_delta(map) : SL_NO_ERROR;
+}
+
+/* Insert the pair in the main arrays, the key being expected at hint. */
+static enum sl_error
+insert_pair
+  (struct sl_flat_map* map,
+   const void* key,
+   const void* data,
+   const size_t hint,
+   size_t* insert_id)
+{
+  size_t id = 0;
+  size_t len = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  err = sl_flat_set_insert_hint(map->key_set, key, hint, &id);
+  if(err != SL_NO_ERROR)
+    return err;
+  SL(vector_length(map->data_list, &len));
+  if(id == len) {
+    err = sl_vector_push_back(map->data_list, data);
+  } else {
+    err = sl_vector_insert(map->data_list, id, data);
+  }
+  if(err != SL_NO_ERROR) {
+    SL(flat_set_erase(map->key_set, key, NULL));
+    return err;
+  }
+  if(insert_id)
+    *insert_id = id;
+  return SL_NO_ERROR;
+}
+
+/* Are the count keys strictly increasing and greater than the map keys? */
+static bool
+is_batch_appended
+  (struct sl_flat_map* map,
+   const char* keys,
+   const size_t count)
+{
+  const char* map_keys = NULL;
+  void* ptr = NULL;
+  size_t key_size = 0;
+  size_t len = 0;
+  size_t i = 0;
+  ASSERT(map && keys && count);
+
+  SL(flat_set_buffer(map->key_set, &len, &key_size, NULL, &ptr));
+  map_keys = ptr;
+  if(len && map->cmp_key(keys, map_keys + (len - 1) * key_size) <= 0)
+    return false;
+  for(i = 1; i < count; ++i) {
+    const char* key = keys + i * key_size;
+    if(map->cmp_key(key - key_size, key) >= 0)
+      return false;
+  }
+  return true;
+}
+
+/* Is the key greater than the keys of the map? */
+static bool
+is_key_appended(struct sl_flat_map* map, const void* key)
+{
+  const char* keys = NULL;
+  void* ptr = NULL;
+  size_t key_size = 0;
+  size_t len = 0;
+
+  SL(flat_set_buffer(map->key_set, &len, &key_size, NULL, &ptr));
+  keys = ptr;
+  return !len || map->cmp_key(key, keys + (len - 1) * key_size) > 0;
+}
+
+static enum sl_error
+delta_insert(struct sl_flat_map* map, const void* key, const void* data)
+{
+  size_t id = 0;
+  size_t len = 0;
+  size_t data_size = 0;
+  void* ptr = NULL;
+  enum delta_state state = DELTA_INSERTED;
+  enum sl_error err = SL_NO_ERROR;
+
+  /* Append the increasing keys to the map while nothing is buffered rather
+   * than merging them later. */
+  SL(vector_length(map->delta_states, &len));
+  if(!len && is_key_appended(map, key)) {
+    SL(flat_set_length(map->key_set, &len));
+    return insert_pair(map, key, data, len, NULL);
+  }
+  if(delta_find(map, key, &id, &state)) {
+    if(state != DELTA_ERASED)
+      return SL_INVALID_ARGUMENT;
+    delta_set_state(map, id, DELTA_UPDATED);
+    SL(vector_at(map->delta->data_list, id, &ptr));
+    SL(vector_buffer(map->data_list, NULL, &data_size, NULL, NULL));
+    memcpy(ptr, data, data_size);
+    --map->delta_nb_erased;
+    return SL_NO_ERROR;
+  }
+  SL(flat_set_find(map->key_set, key, &id));
+  SL(flat_set_length(map->key_set, &len));
+  if(id != len)
+    return SL_INVALID_ARGUMENT;
+  SL(vector_length(map->delta_states, &len));
+  if(len >= map->max_delta_length) {
+    err = merge_delta(map);
+    if(err != SL_NO_ERROR)
+      return err;
+  }
+  err = delta_push(map, key, data, DELTA_INSERTED);
+  if(err != SL_NO_ERROR)
+    return err;
+  ++map->delta_nb_inserted;
+  return SL_NO_ERROR;
+}
+
+static enum sl_error
+delta_erase(struct sl_flat_map* map, const void* key)
+{
+  size_t id = 0;
+  size_t len = 0;
+  void* ptr = NULL;
+  enum delta_state state = DELTA_INSERTED;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(delta_find(map, key, &id, &state)) {
+    switch(state) {
+      case DELTA_INSERTED:
+        SL(flat_map_erase(map->delta, key, NULL));
+        SL(vector_erase(map->delta_states, id));
+        --map->delta_nb_inserted;
+        return SL_NO_ERROR;
+      case DELTA_UPDATED:
+        delta_set_state(map, id, DELTA_ERASED);
+        ++map->delta_nb_erased;
+        return SL_NO_ERROR;
+      case DELTA_ERASED: return SL_INVALID_ARGUMENT;
+      default: ASSERT(0); return SL_INVALID_ARGUMENT;
+    }
+  }
+  SL(flat_set_find(map->key_set, key, &id));
+  SL(flat_set_length(map->key_set, &len));
+  if(id == len)
+    return SL_INVALID_ARGUMENT;
+  SL(vector_length(map->delta_states, &len));
+  if(len >= map->max_delta_length) {
+    err = merge_delta(map);
+    if(err != SL_NO_ERROR)
+      return err;
+    /* The merge moved the erased pair. */
+    SL(flat_set_find(map->key_set, key, &id));
+  }
+  SL(vector_at(map->data_list, id, &ptr));
+  err = delta_push(map, key, ptr, DELTA_ERASED);
+  if(err != SL_NO_ERROR)
+    return err;
+  ++map->delta_nb_erased;
+  return SL_NO_ERROR;
+}
+
 /*******************************************************************************
  *
  * Flat map functions.
@@ -58,6 +548,7 @@ sl_create_flat_map
   err = sl_create_vector(data_size, data_alignment, allocator, &map->data_list);
   if(err != SL_NO_ERROR)
     goto error;
+  map->cmp_key = cmp_key;
   map->allocator = allocator;
 
 exit:
@@ -83,6 +574,10 @@ sl_free_flat_map(struct sl_flat_map* map)
     return SL_INVALID_ARGUMENT;
   SL(free_flat_set(map->key_set));
   SL(free_vector(map->data_list));
+  if(is_delta_enabled(map)) {
+    SL(free_flat_map(map->delta));
+    SL(free_vector(map->delta_states));
+  }
   MEM_FREE(map->allocator, map);
   return SL_NO_ERROR;
 }
@@ -94,29 +589,235 @@ sl_flat_map_insert
    const void* data,
    size_t* insert_id)
 {
-  size_t id = 0;
+  size_t len = 0;
   enum sl_error sl_err = SL_NO_ERROR;
-  bool is_key_inserted = false;
 
   if(!map || !key|| !data) {
     sl_err = SL_INVALID_ARGUMENT;
     goto error;
   }
-  sl_err = sl_flat_set_insert(map->key_set, key, &id);
+  if(is_delta_enabled(map) && !insert_id) {
+    sl_err = delta_insert(map, key, data);
+    goto exit;
+  }
+  sl_err = flush_delta(map);
   if(sl_err != SL_NO_ERROR)
     goto error;
-  is_key_inserted = true;
-  sl_err = sl_vector_insert(map->data_list, id, data);
+  SL(flat_set_length(map->key_set, &len));
+  sl_err = insert_pair(map, key, data, len, insert_id);
   if(sl_err != SL_NO_ERROR)
     goto error;
-  if(insert_id)
-    *insert_id = id;
 
 exit:
   return sl_err;
 error:
-  if(is_key_inserted)
-    SL(flat_set_erase(map->key_set, key, NULL));
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_map_insert_hint
+  (struct sl_flat_map* map,
+   const void* key,
+   const void* data,
+   size_t hint,
+   size_t* insert_id)
+{
+  size_t len = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!map || !key|| !data) {
+    sl_err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  sl_err = flush_delta(map);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  SL(flat_set_length(map->key_set, &len));
+  if(hint > len) {
+    sl_err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  sl_err = insert_pair(map, key, data, hint, insert_id);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+
+exit:
+  return sl_err;
+error:
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_map_insert_n
+  (struct sl_flat_map* map,
+   const void* keys,
+   const void* data,
+   size_t count,
+   enum sl_duplicate_policy policy,
+   size_t* out_nb_inserted)
+{
+  struct sl_vector* entry_list = NULL;
+  struct sl_vector* key_list = NULL;
+  char* entries = NULL;
+  char* sorted_keys = NULL;
+  const char* map_keys = NULL;
+  char* map_data = NULL;
+  void* ptr = NULL;
+  size_t key_size = 0;
+  size_t key_alignment = 0;
+  size_t key_offset = 0;
+  size_t entry_size = 0;
+  size_t entry_alignment = 0;
+  size_t data_size = 0;
+  size_t len = 0;
+  size_t nb_dups = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!map || ((!keys || !data) && count)
+  || (policy != SL_DUPLICATE_KEEP_FIRST
+   && policy != SL_DUPLICATE_KEEP_LAST
+   && policy != SL_DUPLICATE_REJECT)) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(!count)
+    goto exit;
+  err = flush_delta(map);
+  if(err != SL_NO_ERROR)
+    goto error;
+  SL(flat_set_buffer(map->key_set, &len, &key_size, &key_alignment, &ptr));
+  map_keys = ptr;
+  SL(vector_buffer(map->data_list, NULL, &data_size, NULL, NULL));
+
+  /* Append a sorted batch of keys greater than the map keys as is. */
+  if(is_batch_appended(map, keys, count)) {
+    err = sl_vector_reserve(map->data_list, len + count);
+    if(err != SL_NO_ERROR)
+      goto error;
+    err = sl_flat_set_insert_n(map->key_set, keys, count, policy, NULL);
+    if(err != SL_NO_ERROR)
+      goto error;
+    SL(vector_append_range(map->data_list, count, data));
+    goto exit;
+  }
+
+  /* Sort the inserted pairs with respect to their key and remove the
+   * duplicates. The keys are copied in the entries to be compared without
+   * following a pointer. */
+  entry_alignment = MAX(ALIGNOF(struct entry), key_alignment);
+  key_offset = ALIGN_SIZE(sizeof(struct entry), key_alignment);
+  entry_size = ALIGN_SIZE(key_offset + key_size, entry_alignment);
+  err = sl_create_vector
+    (entry_size, entry_alignment, map->allocator, &entry_list);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_vector_resize(entry_list, count, NULL);
+  if(err != SL_NO_ERROR)
+    goto error;
+  SL(vector_buffer(entry_list, NULL, NULL, NULL, &ptr));
+  entries = ptr;
+  for(i = 0; i < count; ++i) {
+    struct entry* e = entry_at(entries, entry_size, i);
+    e->cmp_key = map->cmp_key;
+    e->data = (const char*)data + i * data_size;
+    e->key_offset = key_offset;
+    memcpy((char*)e + key_offset, (const char*)keys + i * key_size, key_size);
+  }
+  err = sl_stable_sort(entries, count, entry_size, entry_alignment,
+    cmp_entry, map->allocator);
+  if(err != SL_NO_ERROR)
+    goto error;
+  for(i = 0, j = 0; i < count; ++i) {
+    struct entry* e = entry_at(entries, entry_size, i);
+    struct entry* last = j ? entry_at(entries, entry_size, j - 1) : NULL;
+    if(last && cmp_entry(last, e) == 0) {
+      if(policy == SL_DUPLICATE_REJECT) {
+        err = SL_INVALID_ARGUMENT;
+        goto error;
+      }
+      if(policy == SL_DUPLICATE_KEEP_LAST)
+        memcpy(last, e, entry_size);
+    } else {
+      if(i != j)
+        memcpy(entry_at(entries, entry_size, j), e, entry_size);
+      ++j;
+    }
+  }
+  count = j;
+
+  /* Locate the inserted keys in the map. */
+  for(i = 0, j = 0; j < count; ++j) {
+    struct entry* e = entry_at(entries, entry_size, j);
+    i = gallop_forward(map, map_keys, key_size, i, len, entry_key(e));
+    e->position = i;
+    e->is_dup =
+      i < len && map->cmp_key(entry_key(e), map_keys + i * key_size) == 0;
+    if(e->is_dup) {
+      if(policy == SL_DUPLICATE_REJECT) {
+        err = SL_INVALID_ARGUMENT;
+        goto error;
+      }
+      ++nb_dups;
+    }
+  }
+
+  /* Reserve the data memory so that the keys are only inserted if the data
+   * can be too. */
+  err = sl_vector_reserve(map->data_list, len + count - nb_dups);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_create_vector(key_size, key_alignment, map->allocator, &key_list);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_vector_resize(key_list, count, NULL);
+  if(err != SL_NO_ERROR)
+    goto error;
+  SL(vector_buffer(key_list, NULL, NULL, NULL, &ptr));
+  sorted_keys = ptr;
+  for(j = 0; j < count; ++j) {
+    const struct entry* e = entry_at(entries, entry_size, j);
+    memcpy(sorted_keys + j * key_size, entry_key(e), key_size);
+  }
+  err = sl_flat_set_insert_n(map->key_set, sorted_keys, count, policy, NULL);
+  if(err != SL_NO_ERROR)
+    goto error;
+
+  /* Merge the data from the back as the keys were. */
+  SL(vector_resize(map->data_list, len + count - nb_dups, NULL));
+  SL(vector_buffer(map->data_list, NULL, NULL, NULL, &ptr));
+  map_data = ptr;
+  i = len;
+  k = len + count - nb_dups;
+  for(j = count; j > 0; --j) {
+    const struct entry* e = entry_at(entries, entry_size, j - 1);
+    const size_t begin =
+      e->position + (e->is_dup && policy == SL_DUPLICATE_KEEP_LAST);
+    const size_t n = i - begin;
+
+    k -= n;
+    memmove(map_data + k*data_size, map_data + begin*data_size, n*data_size);
+    if(!e->is_dup || policy == SL_DUPLICATE_KEEP_LAST) {
+      --k;
+      memcpy(map_data + k * data_size, e->data, data_size);
+    }
+    i = e->position;
+  }
+  ASSERT(k == i);
+
+exit:
+  if(entry_list)
+    SL(free_vector(entry_list));
+  if(key_list)
+    SL(free_vector(key_list));
+  if(out_nb_inserted)
+    *out_nb_inserted = count - nb_dups;
+  return err;
+
+error:
+  count = nb_dups = 0;
   goto exit;
 }
 
@@ -131,6 +832,13 @@ sl_flat_map_erase(struct sl_flat_map* map, const void* key, size_t* erase_id)
     sl_err = SL_INVALID_ARGUMENT;
     goto error;
   }
+  if(is_delta_enabled(map) && !erase_id) {
+    sl_err = delta_erase(map, key);
+    goto exit;
+  }
+  sl_err = flush_delta(map);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
   sl_err = sl_flat_set_erase(map->key_set, key, &id);
   if(sl_err != SL_NO_ERROR)
     goto error;
@@ -149,17 +857,175 @@ error:
   goto exit;
 }
 
+EXPORT_SYM enum sl_error
+sl_flat_map_erase_n(struct sl_flat_map* map, size_t id, size_t count)
+{
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!map) {
+    sl_err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  sl_err = flush_delta(map);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  sl_err = sl_flat_set_erase_n(map->key_set, id, count);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  SL(vector_erase_n(map->data_list, id, count));
+
+exit:
+  return sl_err;
+error:
+  goto exit;
+}
+
+/* Ids of the pairs whose key is in [lower, upper[. */
+static enum sl_error
+range_ids
+  (struct sl_flat_map* map,
+   const void* lower,
+   const void* upper,
+   size_t* begin,
+   size_t* end)
+{
+  ASSERT(map && begin && end);
+  if(lower && upper && map->cmp_key(lower, upper) > 0)
+    return SL_INVALID_ARGUMENT;
+  *begin = 0;
+  if(lower)
+    SL(flat_set_lower_bound(map->key_set, lower, begin));
+  if(upper) {
+    SL(flat_set_lower_bound(map->key_set, upper, end));
+  } else {
+    SL(flat_set_length(map->key_set, end));
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_map_erase_range
+  (struct sl_flat_map* map,
+   const void* lower,
+   const void* upper,
+   size_t* out_nb_erased)
+{
+  size_t begin = 0;
+  size_t end = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!map) {
+    sl_err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  sl_err = flush_delta(map);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  sl_err = range_ids(map, lower, upper, &begin, &end);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  if(begin < end) {
+    SL(flat_set_erase_n(map->key_set, begin, end - begin));
+    SL(vector_erase_n(map->data_list, begin, end - begin));
+  }
+  if(out_nb_erased)
+    *out_nb_erased = end - begin;
+
+exit:
+  return sl_err;
+error:
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_map_extract_range
+  (struct sl_flat_map* map,
+   const void* lower,
+   const void* upper,
+   struct sl_flat_map* dst,
+   size_t* out_nb_extracted)
+{
+  const char* keys = NULL;
+  const char* data = NULL;
+  void* ptr = NULL;
+  size_t key_size = 0;
+  size_t key_alignment = 0;
+  size_t data_size = 0;
+  size_t data_alignment = 0;
+  size_t dst_key_size = 0;
+  size_t dst_key_alignment = 0;
+  size_t dst_data_size = 0;
+  size_t dst_data_alignment = 0;
+  size_t begin = 0;
+  size_t end = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!map || !dst || map == dst || map->cmp_key != dst->cmp_key) {
+    sl_err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  SL(flat_set_buffer(map->key_set, NULL, &key_size, &key_alignment, NULL));
+  SL(vector_buffer(map->data_list, NULL, &data_size, &data_alignment, NULL));
+  SL(flat_set_buffer
+    (dst->key_set, NULL, &dst_key_size, &dst_key_alignment, NULL));
+  SL(vector_buffer
+    (dst->data_list, NULL, &dst_data_size, &dst_data_alignment, NULL));
+  if(key_size != dst_key_size || key_alignment != dst_key_alignment
+  || data_size != dst_data_size || data_alignment != dst_data_alignment) {
+    sl_err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  sl_err = flush_delta(map);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  sl_err = range_ids(map, lower, upper, &begin, &end);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  if(begin == end)
+    goto exit;
+
+  /* Insert the slice in dst before erasing it so that the maps are left
+   * unchanged on error. A slice greater than the dst keys is appended. */
+  SL(flat_set_buffer(map->key_set, NULL, NULL, NULL, &ptr));
+  keys = (const char*)ptr + begin * key_size;
+  SL(vector_buffer(map->data_list, NULL, NULL, NULL, &ptr));
+  data = (const char*)ptr + begin * data_size;
+  sl_err = sl_flat_map_insert_n
+    (dst, keys, data, end - begin, SL_DUPLICATE_REJECT, NULL);
+  if(sl_err != SL_NO_ERROR)
+    goto error;
+  SL(flat_set_erase_n(map->key_set, begin, end - begin));
+  SL(vector_erase_n(map->data_list, begin, end - begin));
+
+exit:
+  if(out_nb_extracted)
+    *out_nb_extracted = end - begin;
+  return sl_err;
+error:
+  begin = end = 0;
+  goto exit;
+}
+
 EXPORT_SYM enum sl_error
 sl_flat_map_find(struct sl_flat_map* map, const void* key, void** data)
 {
   size_t len = 0;
   size_t id = 0;
+  enum delta_state state = DELTA_INSERTED;
   enum sl_error sl_err = SL_NO_ERROR;
 
   if(!map || !data) {
     sl_err = SL_INVALID_ARGUMENT;
     goto error;
   }
+  if(is_delta_enabled(map) && key && delta_find(map, key, &id, &state)) {
+    if(state == DELTA_ERASED) {
+      *data = NULL;
+    } else {
+      SL(vector_at(map->delta->data_list, id, data));
+    }
+    goto exit;
+  }
   sl_err = sl_flat_set_find(map->key_set, key, &id);
   if(sl_err != SL_NO_ERROR)
     goto error;
@@ -176,6 +1042,66 @@ error:
   goto exit;
 }
 
+EXPORT_SYM enum sl_error
+sl_flat_map_find_n
+  (struct sl_flat_map* map,
+   const void* keys,
+   size_t count,
+   void** data)
+{
+  size_t ids[FIND_CHUNK_LENGTH];
+  size_t delta_ids[FIND_CHUNK_LENGTH];
+  char* map_data = NULL;
+  char* delta_data = NULL;
+  const unsigned char* states = NULL;
+  void* ptr = NULL;
+  size_t key_size = 0;
+  size_t data_size = 0;
+  size_t len = 0;
+  size_t delta_len = 0;
+  size_t nb = 0;
+  size_t i = 0;
+  size_t j = 0;
+  enum sl_error sl_err = SL_NO_ERROR;
+
+  if(!map || (count && (!keys || !data))) {
+    sl_err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  SL(flat_set_buffer(map->key_set, &len, &key_size, NULL, NULL));
+  SL(vector_buffer(map->data_list, NULL, &data_size, NULL, &ptr));
+  map_data = ptr;
+  if(is_delta_enabled(map)) {
+    SL(vector_buffer(map->delta_states, &delta_len, NULL, NULL, &ptr));
+    states = ptr;
+    SL(vector_buffer(map->delta->data_list, NULL, NULL, NULL, &ptr));
+    delta_data = ptr;
+  }
+  for(i = 0; i < count; i += nb) {
+    const char* chunk = (const char*)keys + i * key_size;
+    nb = MIN(count - i, FIND_CHUNK_LENGTH);
+    SL(flat_set_find_n(map->key_set, chunk, nb, ids));
+    for(j = 0; j < nb; ++j)
+      data[i + j] = ids[j] == len ? NULL : map_data + ids[j] * data_size;
+    if(!delta_len)
+      continue;
+    /* The buffered pairs override the pairs of the map. */
+    SL(flat_set_find_n(map->delta->key_set, chunk, nb, delta_ids));
+    for(j = 0; j < nb; ++j) {
+      const size_t id = delta_ids[j];
+      if(id == delta_len)
+        continue;
+      data[i + j] = states[id] == DELTA_ERASED
+        ? NULL : delta_data + id * data_size;
+    }
+  }
+
+exit:
+  return sl_err;
+error:
+  goto exit;
+}
+
 EXPORT_SYM enum sl_error
 sl_flat_map_find_pair
   (struct sl_flat_map* map, 
@@ -184,12 +1110,23 @@ sl_flat_map_find_pair
 {
   size_t id = 0;
   size_t len = 0;
+  enum delta_state state = DELTA_INSERTED;
   enum sl_error sl_err = SL_NO_ERROR;
 
   if(!map || !key || !pair) {
     sl_err = SL_INVALID_ARGUMENT;
     goto error;
   }
+  if(is_delta_enabled(map) && delta_find(map, key, &id, &state)) {
+    if(state == DELTA_ERASED) {
+      pair->key = NULL;
+      pair->data = NULL;
+    } else {
+      SL(vector_at(map->delta->data_list, id, &(pair->data)));
+      SL(flat_set_at(map->delta->key_set, id, &(pair->key)));
+    }
+    goto exit;
+  }
   sl_err = sl_flat_set_find(map->key_set, key, &id);
   if(sl_err != SL_NO_ERROR)
     goto error;
@@ -214,6 +1151,12 @@ sl_clear_flat_map(struct sl_flat_map* map)
     return SL_INVALID_ARGUMENT;
   SL(clear_flat_set(map->key_set));
   SL(clear_vector(map->data_list));
+  if(is_delta_enabled(map)) {
+    SL(clear_flat_map(map->delta));
+    SL(clear_vector(map->delta_states));
+    map->delta_nb_inserted = 0;
+    map->delta_nb_erased = 0;
+  }
   return SL_NO_ERROR;
 }
 
@@ -223,8 +1166,12 @@ sl_flat_map_lower_bound
    const void* key,
    size_t* lower_bound)
 {
+  enum sl_error err = SL_NO_ERROR;
   if(!map)
     return SL_INVALID_ARGUMENT;
+  err = flush_delta(map);
+  if(err != SL_NO_ERROR)
+    return err;
   return sl_flat_set_lower_bound(map->key_set, key, lower_bound);
 }
 
@@ -234,26 +1181,39 @@ sl_flat_map_upper_bound
    const void* key,
    size_t* upper_bound)
 {
+  enum sl_error err = SL_NO_ERROR;
   if(!map)
     return SL_INVALID_ARGUMENT;
+  err = flush_delta(map);
+  if(err != SL_NO_ERROR)
+    return err;
   return sl_flat_set_upper_bound(map->key_set, key, upper_bound);
 }
 
 EXPORT_SYM enum sl_error
 sl_flat_map_length(struct sl_flat_map* map, size_t* out_length)
 {
-  if(!map)
+  size_t len = 0;
+  if(!map || !out_length)
     return SL_INVALID_ARGUMENT;
-  return sl_vector_length(map->data_list, out_length);
+  SL(vector_length(map->data_list, &len));
+  if(is_delta_enabled(map))
+    len = len + map->delta_nb_inserted - map->delta_nb_erased;
+  *out_length = len;
+  return SL_NO_ERROR;
 }
 
 EXPORT_SYM enum sl_error
 sl_flat_map_at(struct sl_flat_map* map, size_t at, struct sl_pair* pair)
 {
   size_t len = 0;
+  enum sl_error err = SL_NO_ERROR;
 
   if(!map || !pair)
     return SL_INVALID_ARGUMENT;
+  err = flush_delta(map);
+  if(err != SL_NO_ERROR)
+    return err;
   SL(vector_length(map->data_list, &len));
   if(at >= len)
     return SL_INVALID_ARGUMENT;
@@ -270,8 +1230,12 @@ sl_flat_map_key_buffer
    size_t* key_alignment,
    void** key_buffer)
 {
+  enum sl_error err = SL_NO_ERROR;
   if(!map)
     return SL_INVALID_ARGUMENT;
+  err = flush_delta(map);
+  if(err != SL_NO_ERROR)
+    return err;
   return sl_flat_set_buffer
     (map->key_set, length, key_size, key_alignment, key_buffer);
 }
@@ -284,9 +1248,77 @@ sl_flat_map_data_buffer
    size_t* data_alignment,
    void** data_buffer)
 {
+  enum sl_error err = SL_NO_ERROR;
   if(!map)
     return SL_INVALID_ARGUMENT;
+  err = flush_delta(map);
+  if(err != SL_NO_ERROR)
+    return err;
   return sl_vector_buffer
     (map->data_list, length, data_size, data_alignment, data_buffer);
 }
 
+EXPORT_SYM enum sl_error
+sl_flat_map_enable_delta(struct sl_flat_map* map, size_t max_delta_length)
+{
+  size_t key_size = 0;
+  size_t key_alignment = 0;
+  size_t data_size = 0;
+  size_t data_alignment = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!map || !max_delta_length) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  map->max_delta_length = max_delta_length;
+  if(is_delta_enabled(map))
+    goto exit;
+  SL(flat_set_buffer(map->key_set, NULL, &key_size, &key_alignment, NULL));
+  SL(vector_buffer(map->data_list, NULL, &data_size, &data_alignment, NULL));
+  err = sl_create_flat_map(key_size, key_alignment, data_size, data_alignment,
+    map->cmp_key, map->allocator, &map->delta);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_create_vector(sizeof(unsigned char), ALIGNOF(unsigned char),
+    map->allocator, &map->delta_states);
+  if(err != SL_NO_ERROR)
+    goto error;
+
+exit:
+  return err;
+error:
+  if(map && map->delta) {
+    SL(free_flat_map(map->delta));
+    map->delta = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_map_disable_delta(struct sl_flat_map* map)
+{
+  enum sl_error err = SL_NO_ERROR;
+  if(!map)
+    return SL_INVALID_ARGUMENT;
+  if(!is_delta_enabled(map))
+    return SL_NO_ERROR;
+  err = merge_delta(map);
+  if(err != SL_NO_ERROR)
+    return err;
+  SL(free_flat_map(map->delta));
+  SL(free_vector(map->delta_states));
+  map->delta = NULL;
+  map->delta_states = NULL;
+  map->max_delta_length = 0;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_map_merge_delta(struct sl_flat_map* map)
+{
+  if(!map)
+    return SL_INVALID_ARGUMENT;
+  return flush_delta(map);
+}
+
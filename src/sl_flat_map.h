@@ -3,6 +3,7 @@
 
 #include "sl.h"
 #include "sl_error.h"
+#include "sl_flat_set.h"
 #include <stddef.h>
 
 struct mem_allocator;
@@ -38,18 +39,83 @@ sl_flat_map_insert
    const void* data,
    size_t* insert_id); /* May be NULL. */
 
+/* Insert the pair expecting it at the position hint, as done by
+ * sl_flat_set_insert_hint. As sl_flat_map_insert, it appends in O(1) the keys
+ * greater than the keys of the map. The hint is an index: the write buffer is
+ * merged first. */
+SL_API enum sl_error
+sl_flat_map_insert_hint
+  (struct sl_flat_map* map,
+   const void* key,
+   const void* data,
+   size_t hint,
+   size_t* insert_id); /* May be NULL. */
+
+/* Insert count unsorted pairs whose keys and data are stored in two arrays.
+ * The pairs are sorted with respect to their key and merged with the map
+ * pairs in one pass, as done by sl_flat_set_insert_n. The map is left
+ * unchanged on error. */
+SL_API enum sl_error
+sl_flat_map_insert_n
+  (struct sl_flat_map* map,
+   const void* keys,
+   const void* data,
+   size_t count,
+   enum sl_duplicate_policy policy,
+   size_t* out_nb_inserted); /* May be NULL. */
+
 SL_API enum sl_error
 sl_flat_map_erase
   (struct sl_flat_map* map,
    const void* key,
    size_t* erase_id); /* May be NULL. */
 
+/* Erase the pairs [id, id + count[ in one move of the keys and one of the
+ * data, count being clamped to the map length. */
+SL_API enum sl_error
+sl_flat_map_erase_n
+  (struct sl_flat_map* map,
+   size_t id,
+   size_t count);
+
+/* Erase the pairs whose key is in [lower, upper[, a NULL bound leaving the
+ * range unbounded on its side as in sl_flat_set_erase_range. */
+SL_API enum sl_error
+sl_flat_map_erase_range
+  (struct sl_flat_map* map,
+   const void* lower, /* May be NULL. */
+   const void* upper, /* May be NULL. */
+   size_t* out_nb_erased); /* May be NULL. */
+
+/* Move the pairs whose key is in [lower, upper[ into dst, which must have the
+ * same key comparator and the same key and data layouts. The slice is copied
+ * in bulk: appended if its keys are greater than the dst keys, merged as by
+ * sl_flat_map_insert_n otherwise. Return SL_INVALID_ARGUMENT, leaving both
+ * maps unchanged, if a moved key is already in dst. */
+SL_API enum sl_error
+sl_flat_map_extract_range
+  (struct sl_flat_map* map,
+   const void* lower, /* May be NULL. */
+   const void* upper, /* May be NULL. */
+   struct sl_flat_map* dst,
+   size_t* out_nb_extracted); /* May be NULL. */
+
 SL_API enum sl_error
 sl_flat_map_find
   (struct sl_flat_map* map,
    const void* key,
    void** data);
 
+/* Look for count keys at once, as done by sl_flat_set_find_n, each data
+ * pointer being set to NULL if its key is not found. The keys are also looked
+ * up at once in the write buffer, which is left unmerged. */
+SL_API enum sl_error
+sl_flat_map_find_n
+  (struct sl_flat_map* map,
+   const void* keys,
+   size_t count,
+   void** data);
+
 SL_API enum sl_error
 sl_flat_map_find_pair
   (struct sl_flat_map* map,
@@ -60,12 +126,16 @@ SL_API enum sl_error
 sl_flat_map_clear
   (struct sl_flat_map* map);
 
+/* The bound is an index: the write buffer, if enabled, is merged into the
+ * map first, which may fail with SL_MEMORY_ERROR. */
 SL_API enum sl_error
 sl_flat_map_lower_bound
   (struct sl_flat_map* map,
    const void* key,
    size_t* lower_bound);
 
+/* The bound is an index: the write buffer, if enabled, is merged into the
+ * map first, which may fail with SL_MEMORY_ERROR. */
 SL_API enum sl_error
 sl_flat_map_upper_bound
   (struct sl_flat_map* map,
@@ -77,12 +147,16 @@ sl_flat_map_length
   (struct sl_flat_map* map,
    size_t* out_length);
 
+/* The write buffer, if enabled, is merged into the map first, which may fail
+ * with SL_MEMORY_ERROR. */
 SL_API enum sl_error
 sl_flat_map_at
   (struct sl_flat_map* map,
    size_t at,
    struct sl_pair* pair);
 
+/* The write buffer, if enabled, is merged into the map first, which may fail
+ * with SL_MEMORY_ERROR. */
 SL_API enum sl_error
 sl_flat_map_key_buffer
   (struct sl_flat_map* map,
@@ -91,6 +165,8 @@ sl_flat_map_key_buffer
    size_t* key_alignment, /* May be NULL. */
    void** key_buffer); /* May be NULL. */
 
+/* The write buffer, if enabled, is merged into the map first, which may fail
+ * with SL_MEMORY_ERROR. */
 SL_API enum sl_error
 sl_flat_map_data_buffer
   (struct sl_flat_map* map,
@@ -99,6 +175,34 @@ sl_flat_map_data_buffer
    size_t* data_alignment, /* May be NULL. */
    void** data_buffer); /* May be NULL. */
 
+/*******************************************************************************
+ *
+ * Write buffer. Once enabled, sl_flat_map_insert and sl_flat_map_erase
+ * invoked with a NULL id record the pair, or a tombstone of the erased key, in
+ * a small sorted buffer rather than moving the pairs of the map. The lookups
+ * check the buffer before the map, and the buffer is merged with the map in
+ * one pass when it holds max_delta_length pairs. Functions that work on
+ * indices or buffers merge it first. A max_delta_length in the order of the
+ * square root of the map length makes inserts and erases O(sqrt n) amortized.
+ *
+ ******************************************************************************/
+/* Only sl_flat_map_insert and sl_flat_map_erase with a NULL insert_id or
+ * erase_id are buffered: a non NULL id is an index into the map, so the buffer
+ * is fully merged before the pair is inserted or erased in place. */
+SL_API enum sl_error
+sl_flat_map_enable_delta
+  (struct sl_flat_map* map,
+   size_t max_delta_length);
+
+/* Merge the write buffer and release it. */
+SL_API enum sl_error
+sl_flat_map_disable_delta
+  (struct sl_flat_map* map);
+
+SL_API enum sl_error
+sl_flat_map_merge_delta
+  (struct sl_flat_map* map);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -1,15 +1,36 @@
 #include "sl_flat_set.h"
+#include "sl_sort.h"
 #include "sl_vector.h"
 #include <snlsys/mem_allocator.h>
 #include <snlsys/snlsys.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <string.h>
 
+#ifdef __x86_64__
+  #define FLAT_SET_SIMD
+  #include <immintrin.h>
+#endif
+
+/* Size in bytes from which the frozen search prefetches the descendants of
+ * the visited nodes. Smaller layouts stay in cache and the prefetches only
+ * add instructions. */
+#define LAYOUT_PREFETCH_MIN_SIZE (1024 * 1024)
+
+/* Number of binary searches run in lockstep on an unsorted batch of queries,
+ * the latency of the memory accesses of one search being hidden by the
+ * comparisons of the others. */
+#define NB_INTERLEAVED_SEARCHES 8
+
 struct sl_flat_set {
   int (*compare)(const void*, const void*);
   struct mem_allocator* allocator;
   struct sl_vector* vector;
+  /* Frozen mode. The layout stores the elements in Eytzinger order starting
+   * at index 1. It is up to date only while the set is frozen. */
+  struct sl_vector* layout; /* May be NULL. */
+  bool is_frozen;
 };
 
 /*******************************************************************************
@@ -24,55 +45,1036 @@ enum search_type {
 };
 
 /* Let a vector vec, this function finds the index of the data in set and
- * defines if the data already lies into set. */
+ * defines if the data already lies into set. The search directly walks the
+ * vector buffer and uses a branchless lower bound loop: the range is halved
+ * with a conditional add rather than a branch on the comparison, and the two
+ * possible next probes are prefetched. */
 static bool
 data_id
   (struct sl_flat_set* set,
    const void* data,
    size_t* out_id,
    const enum search_type search_type)
-   
 {
-  size_t begin = 0;
-  size_t end = 0;
+  const char* base = NULL;
+  void* buffer = NULL;
+  size_t data_size = 0;
   size_t len = 0;
-  bool is_data_found = false;
+  size_t n = 0;
+  size_t id = 0;
+  /* The probed element is before the searched position if data is greater
+   * than it; for the upper bound, if data is greater or equal. */
+  const int threshold = search_type == UPPER_BOUND ? 0 : 1;
+  ASSERT(set && data && out_id);
+
+  SL(vector_buffer(set->vector, &len, &data_size, NULL, &buffer));
+  base = buffer;
+  n = len;
+  while(n > 1) {
+    const size_t half = n / 2;
+    const size_t next_half = (n - half) / 2;
+    __builtin_prefetch(base + next_half * data_size);
+    __builtin_prefetch(base + (half + next_half) * data_size);
+    base += (size_t)
+      (set->compare(data, base + half * data_size) >= threshold)
+      * half * data_size;
+    n -= half;
+  }
+  if(n)
+    base += (size_t)(set->compare(data, base) >= threshold) * data_size;
+  id = len ? (size_t)(base - (const char*)buffer) / data_size : 0;
+  *out_id = id;
+
+  if(search_type == UPPER_BOUND) {
+    return id > 0
+      && set->compare(data, (const char*)buffer + (id-1) * data_size) == 0;
+  } else {
+    return id < len
+      && set->compare(data, (const char*)buffer + id * data_size) == 0;
+  }
+}
+
+static FINLINE size_t
+log2_floor(const size_t i)
+{
+  ASSERT(i);
+  return sizeof(long long) * 8 - 1 - (size_t)__builtin_clzll(i);
+}
+
+/* Sorted id of the node k of an Eytzinger layout of len elements. In the
+ * perfect tree whose last level is the one of the layout, the in order rank
+ * of k is computed from its position in its level. The nodes missing in the
+ * last level are the rightmost ones, i.e. the last ranks among the even
+ * ones that the last level occupies: remove those that precede k. */
+static FINLINE size_t
+layout_rank(const size_t k, const size_t len)
+{
+  const size_t height = log2_floor(len);
+  const size_t depth = log2_floor(k);
+  const size_t last_level_len = len - ((size_t)1 << height) + 1;
+  const size_t rank =
+    (((k - ((size_t)1 << depth)) * 2 + 1) << (height - depth)) - 1;
+  const size_t nb_last_level_before = (rank + 1) / 2;
+  ASSERT(k && k <= len);
+  return nb_last_level_before > last_level_len
+    ? rank - (nb_last_level_before - last_level_len)
+    : rank;
+}
+
+/* Copy the sorted elements from id into the layout subtree rooted at k with
+ * an in order traversal. Return the id of the next element to copy. */
+static size_t
+fill_layout
+  (const char* sorted,
+   char* layout,
+   size_t data_size,
+   size_t len,
+   size_t id,
+   size_t k)
+{
+  if(k > len)
+    return id;
+  id = fill_layout(sorted, layout, data_size, len, id, 2 * k);
+  ASSERT(layout_rank(k, len) == id);
+  memcpy(layout + k * data_size, sorted + id * data_size, data_size);
+  return fill_layout(sorted, layout, data_size, len, id + 1, 2 * k + 1);
+}
+
+/* Build the Eytzinger layout of the set elements. The layout memory is kept
+ * when the set is unfrozen by a modification, and is reused here. */
+static enum sl_error
+build_layout(struct sl_flat_set* set)
+{
+  void* sorted = NULL;
+  void* layout = NULL;
+  size_t data_size = 0;
+  size_t data_alignment = 0;
+  size_t len = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && !set->is_frozen);
+
+  SL(vector_buffer(set->vector, &len, &data_size, &data_alignment, &sorted));
+  if(!set->layout) {
+    err = sl_create_vector
+      (data_size, data_alignment, set->allocator, &set->layout);
+    if(err != SL_NO_ERROR)
+      goto error;
+  }
+  err = sl_vector_resize(set->layout, len + 1, NULL);
+  if(err != SL_NO_ERROR)
+    goto error;
+  SL(vector_buffer(set->layout, NULL, NULL, NULL, &layout));
+  fill_layout(sorted, layout, data_size, len, 0, 1);
+
+exit:
+  return err;
+
+error:
+  if(set->layout) {
+    SL(free_vector(set->layout));
+    set->layout = NULL;
+  }
+  goto exit;
+}
+
+/* Search the Eytzinger layout. The descent from node k goes to 2k or 2k + 1
+ * without branching on the comparison; the lines of the descendants of a few
+ * levels below are prefetched. The searched position is the last node where
+ * the descent went left, i.e. k with its trailing ones and the following
+ * zero removed. */
+static bool
+layout_data_id
+  (struct sl_flat_set* set,
+   const void* data,
+   size_t* out_id,
+   const enum search_type search_type)
+{
+  const char* layout = NULL;
+  void* buffer = NULL;
+  size_t data_size = 0;
+  size_t nb_nodes = 0;
+  size_t len = 0;
+  size_t prefetch_shift = 1;
+  size_t k = 1;
+  const int threshold = search_type == UPPER_BOUND ? 0 : 1;
+  ASSERT(set && data && out_id && set->is_frozen);
+
+  SL(vector_buffer(set->layout, &nb_nodes, &data_size, NULL, &buffer));
+  layout = buffer;
+  len = nb_nodes - 1;
+
+  if(len * data_size <= LAYOUT_PREFETCH_MIN_SIZE) {
+    while(k <= len) {
+      k = 2 * k
+        + (size_t)(set->compare(data, layout + k * data_size) >= threshold);
+    }
+  } else {
+    /* Prefetch the level whose 2^shift nodes of a subtree lie in a cache
+     * line. */
+    while(((size_t)2 << prefetch_shift) * data_size <= 64)
+      ++prefetch_shift;
+    while(k <= len) {
+      __builtin_prefetch(layout + (k << prefetch_shift) * data_size);
+      k = 2 * k
+        + (size_t)(set->compare(data, layout + k * data_size) >= threshold);
+    }
+  }
+  k >>= __builtin_ffsll((long long)~k);
+
+  *out_id = k ? layout_rank(k, len) : len;
+  if(search_type == UPPER_BOUND) {
+    SL(vector_buffer(set->vector, NULL, NULL, NULL, &buffer));
+    return *out_id > 0 && set->compare
+      (data, (const char*)buffer + (*out_id - 1) * data_size) == 0;
+  }
+  return k && set->compare(data, layout + k * data_size) == 0;
+}
+
+/* Search the Eytzinger layout of a frozen set and the sorted elements
+ * otherwise. The layout is never built here, so that concurrent searches only
+ * read the set. */
+static FINLINE bool
+search_data_id
+  (struct sl_flat_set* set,
+   const void* data,
+   size_t* out_id,
+   const enum search_type search_type)
+{
+  ASSERT(set);
+  return set->is_frozen
+    ? layout_data_id(set, data, out_id, search_type)
+    : data_id(set, data, out_id, search_type);
+}
+
+/* Look for the insertion position of data, starting with the position hint.
+ * The hint is checked against its two neighbours and the set is searched only
+ * if data does not lie between them. Return true if data is in the set. */
+static bool
+hint_data_id
+  (struct sl_flat_set* set,
+   const void* data,
+   const size_t hint,
+   size_t* out_id)
+{
+  const char* buffer = NULL;
+  void* ptr = NULL;
+  size_t data_size = 0;
+  size_t len = 0;
+  int cmp = 0;
   ASSERT(set && data && out_id);
 
+  SL(vector_buffer(set->vector, &len, &data_size, NULL, &ptr));
+  buffer = ptr;
+  ASSERT(hint <= len);
+  cmp = hint > 0 ? set->compare(data, buffer + (hint - 1) * data_size) : 1;
+  if(cmp == 0) {
+    *out_id = hint - 1;
+    return true;
+  }
+  if(cmp > 0) {
+    cmp = hint < len ? set->compare(data, buffer + hint * data_size) : -1;
+    if(cmp <= 0) {
+      *out_id = hint;
+      return cmp == 0;
+    }
+  }
+  return data_id(set, data, out_id, EXACT_VALUE);
+}
+
+/* Are the count elements of the batch strictly increasing and greater than the
+ * set elements? */
+static bool
+is_batch_appended
+  (struct sl_flat_set* set,
+   const char* batch,
+   const size_t count)
+{
+  const char* buffer = NULL;
+  void* ptr = NULL;
+  size_t data_size = 0;
+  size_t len = 0;
+  size_t i = 0;
+  ASSERT(set && batch && count);
+
+  SL(vector_buffer(set->vector, &len, &data_size, NULL, &ptr));
+  buffer = ptr;
+  if(len && set->compare(batch, buffer + (len - 1) * data_size) <= 0)
+    return false;
+  for(i = 1; i < count; ++i) {
+    const char* x = batch + i * data_size;
+    if(set->compare(x - data_size, x) >= 0)
+      return false;
+  }
+  return true;
+}
+
+/* Ids of the range of elements in [lower, upper[, a NULL bound leaving the
+ * range unbounded on its side. */
+static enum sl_error
+range_ids
+  (struct sl_flat_set* set,
+   const void* lower,
+   const void* upper,
+   size_t* begin,
+   size_t* end)
+{
+  ASSERT(set && begin && end);
+  if(lower && upper && set->compare(lower, upper) > 0)
+    return SL_INVALID_ARGUMENT;
+  *begin = 0;
+  if(lower)
+    data_id(set, lower, begin, LOWER_BOUND);
+  if(upper) {
+    data_id(set, upper, end, LOWER_BOUND);
+  } else {
+    SL(vector_length(set->vector, end));
+  }
+  return SL_NO_ERROR;
+}
+
+static enum sl_error
+insert_hint
+  (struct sl_flat_set* set,
+   const void* data,
+   const size_t hint,
+   size_t* insert_id)
+{
+  size_t id = 0;
+  size_t len = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && data);
+
+  if(hint_data_id(set, data, hint, &id))
+    return SL_INVALID_ARGUMENT;
   SL(vector_length(set->vector, &len));
-  begin = 0;
-  end = len;
-  while(begin != end) {
-    void* tmp_data = NULL;
-    const size_t at = begin + (end - begin) / 2;
-    int cmp = 0;
-
-    SL(vector_at(set->vector, at, &tmp_data));
-    cmp = set->compare(data, tmp_data);
-    if(cmp > 0) {
-        begin = at + 1;
-    } else  if(cmp < 0) {
-        end = at;
-    } else { /* cmp == 0 */
-      is_data_found = true;
-      switch(search_type) {
-        case LOWER_BOUND:
-          end = at;
-          break;
-        case UPPER_BOUND:
-          begin = at + 1;
-          break;
-        case EXACT_VALUE: 
-          begin = end = at;
-          break;
-        default:
-          ASSERT(0);
-          break;
+  if(id == len) {
+    err = sl_vector_push_back(set->vector, data);
+  } else {
+    err = sl_vector_insert(set->vector, id, data);
+  }
+  if(err != SL_NO_ERROR)
+    return err;
+  set->is_frozen = false;
+  if(insert_id)
+    *insert_id = id;
+  return SL_NO_ERROR;
+}
+
+/* Index of the first element of [begin, end) that is not less than data. */
+static FINLINE size_t
+lower_bound_range
+  (struct sl_flat_set* set,
+   const char* buffer,
+   const size_t data_size,
+   size_t begin,
+   size_t end,
+   const void* data)
+{
+  ASSERT(set && (buffer || begin == end) && begin <= end);
+  while(begin < end) {
+    const size_t mid = begin + (end - begin) / 2;
+    if(set->compare(data, buffer + mid * data_size) > 0) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin;
+}
+
+/* Lower bound of data in [from, len) found by exponential steps from `from'
+ * followed by a binary search: O(log d) comparisons where d is the distance
+ * between from and the lower bound. */
+static size_t
+gallop_forward
+  (struct sl_flat_set* set,
+   const char* buffer,
+   const size_t data_size,
+   size_t from,
+   const size_t len,
+   const void* data)
+{
+  size_t step = 1;
+  ASSERT(from <= len);
+  while(step <= len - from
+     && set->compare(data, buffer + (from + step - 1) * data_size) > 0) {
+    from += step;
+    step *= 2;
+  }
+  return lower_bound_range
+    (set, buffer, data_size, from, MIN(from + step - 1, len), data);
+}
+
+/* Lower bound of data in [0, to) found by exponential steps from `to'. */
+static size_t
+gallop_backward
+  (struct sl_flat_set* set,
+   const char* buffer,
+   const size_t data_size,
+   size_t to,
+   const void* data)
+{
+  size_t step = 1;
+  while(step <= to && set->compare(data, buffer + (to-step) * data_size) <= 0) {
+    to -= step;
+    step *= 2;
+  }
+  return lower_bound_range
+    (set, buffer, data_size, step <= to ? to - step + 1 : 0, to, data);
+}
+
+/* Look for the count sorted queries with a galloping merge: each search starts
+ * from the lower bound of the previous query. An id is set to len if its
+ * query is not found. */
+static void
+find_sorted
+  (struct sl_flat_set* set,
+   const char* buffer,
+   const size_t data_size,
+   const size_t len,
+   const char* queries,
+   const size_t count,
+   size_t* out_ids)
+{
+  size_t i = 0;
+  size_t j = 0;
+
+  for(j = 0; j < count; ++j) {
+    const char* x = queries + j * data_size;
+    i = gallop_forward(set, buffer, data_size, i, len, x);
+    out_ids[j] = i < len && set->compare(x, buffer + i * data_size) == 0
+      ? i : len;
+  }
+}
+
+/* Look for the count unsorted queries with branchless binary searches run by
+ * groups of NB_INTERLEAVED_SEARCHES. The searches of a group halve the same
+ * range length, so that the next probe of each search is known and prefetched
+ * while the other searches of the group compare their probe. */
+static void
+find_interleaved
+  (struct sl_flat_set* set,
+   const char* buffer,
+   const size_t data_size,
+   const size_t len,
+   const char* queries,
+   const size_t count,
+   size_t* out_ids)
+{
+  const char* base[NB_INTERLEAVED_SEARCHES];
+  size_t nb = 0;
+  size_t n = 0;
+  size_t j = 0;
+  size_t k = 0;
+
+  for(j = 0; j < count; j += nb) {
+    const char* x = queries + j * data_size;
+    nb = MIN(count - j, NB_INTERLEAVED_SEARCHES);
+    for(k = 0; k < nb; ++k)
+      base[k] = buffer;
+    for(n = len; n > 1; ) {
+      const size_t half = n / 2;
+      const size_t next_half = (n - half) / 2;
+      for(k = 0; k < nb; ++k) {
+        base[k] += (size_t)
+          (set->compare(x + k * data_size, base[k] + half * data_size) > 0)
+          * half * data_size;
+        __builtin_prefetch(base[k] + next_half * data_size);
+      }
+      n -= half;
+    }
+    for(k = 0; k < nb; ++k) {
+      size_t id = 0;
+      if(n)
+        base[k] += (size_t)(set->compare(x + k * data_size, base[k]) > 0)
+          * data_size;
+      id = (size_t)(base[k] - buffer) / data_size;
+      out_ids[j + k] =
+        id < len && set->compare(x + k * data_size, base[k]) == 0 ? id : len;
+    }
+  }
+}
+
+/* Sort the batch if necessary and remove its duplicates with respect to the
+ * policy. Return the new length of the batch or SIZE_MAX if a duplicate is
+ * rejected. */
+static size_t
+sort_batch
+  (struct sl_flat_set* set,
+   char* batch,
+   const size_t count,
+   const size_t data_size,
+   const size_t data_alignment,
+   const enum sl_duplicate_policy policy,
+   enum sl_error* out_err)
+{
+  size_t i = 0;
+  size_t n = 0;
+  ASSERT(set && batch && count && out_err);
+
+  *out_err = SL_NO_ERROR;
+  for(i = 1; i < count; ++i) {
+    if(set->compare(batch + (i-1) * data_size, batch + i * data_size) > 0)
+      break;
+  }
+  if(i < count) {
+    *out_err = sl_stable_sort
+      (batch, count, data_size, data_alignment, set->compare, set->allocator);
+    if(*out_err != SL_NO_ERROR)
+      return SIZE_MAX;
+  }
+  for(i = 0; i < count; ++i) {
+    char* src = batch + i * data_size;
+    if(n && set->compare(batch + (n - 1) * data_size, src) == 0) {
+      if(policy == SL_DUPLICATE_REJECT) {
+        *out_err = SL_INVALID_ARGUMENT;
+        return SIZE_MAX;
       }
+      if(policy == SL_DUPLICATE_KEEP_LAST)
+        memcpy(batch + (n - 1) * data_size, src, data_size);
+    } else {
+      if(n != i)
+        memcpy(batch + n * data_size, src, data_size);
+      ++n;
     }
   }
-  *out_id = end;
-  return is_data_found;
+  return n;
+}
+
+/*******************************************************************************
+ *
+ * Set algebra kernels. The generic kernels compare the elements with the set
+ * comparator. The intersection of sets of 4 or 8 bytes integers compared with
+ * the built-in comparators uses typed kernels instead.
+ *
+ ******************************************************************************/
+enum set_op {
+  SET_UNION,
+  SET_INTERSECTION,
+  SET_DIFFERENCE,
+  SET_SYMMETRIC_DIFFERENCE
+};
+
+/* Galloping through the larger set is used once it is GALLOP_RATIO times
+ * larger than the smaller one. */
+#define GALLOP_RATIO 32
+
+/* Merge the a and b sorted elements into out with respect to the operation.
+ * Return the number of written elements. */
+static size_t
+merge_generic
+  (struct sl_flat_set* set,
+   const enum set_op op,
+   const char* a,
+   const size_t na,
+   const char* b,
+   const size_t nb,
+   const size_t data_size,
+   char* out)
+{
+  const bool keep_a = op != SET_INTERSECTION;
+  const bool keep_b = op == SET_UNION || op == SET_SYMMETRIC_DIFFERENCE;
+  const bool keep_both = op == SET_UNION || op == SET_INTERSECTION;
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+
+  while(i < na && j < nb) {
+    const int cmp = set->compare(a + i * data_size, b + j * data_size);
+    if(cmp < 0) {
+      if(keep_a)
+        memcpy(out + (k++) * data_size, a + i * data_size, data_size);
+      ++i;
+    } else if(cmp > 0) {
+      if(keep_b)
+        memcpy(out + (k++) * data_size, b + j * data_size, data_size);
+      ++j;
+    } else {
+      if(keep_both)
+        memcpy(out + (k++) * data_size, a + i * data_size, data_size);
+      ++i;
+      ++j;
+    }
+  }
+  if(keep_a && i < na) {
+    memcpy(out + k * data_size, a + i * data_size, (na - i) * data_size);
+    k += na - i;
+  }
+  if(keep_b && j < nb) {
+    memcpy(out + k * data_size, b + j * data_size, (nb - j) * data_size);
+    k += nb - j;
+  }
+  return k;
+}
+
+/* Intersect the small set a with the large set b by galloping through b. */
+static size_t
+intersect_gallop_generic
+  (struct sl_flat_set* set,
+   const char* a,
+   const size_t na,
+   const char* b,
+   const size_t nb,
+   const size_t data_size,
+   char* out)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+
+  for(i = 0; i < na && j < nb; ++i) {
+    const char* x = a + i * data_size;
+    j = gallop_forward(set, b, data_size, j, nb, x);
+    if(j < nb && set->compare(x, b + j * data_size) == 0)
+      memcpy(out + (k++) * data_size, x, data_size);
+  }
+  return k;
+}
+
+static size_t
+intersect_scalar_u32
+  (const uint32_t* a, size_t na,
+   const uint32_t* b, size_t nb,
+   uint32_t* out)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  while(i < na && j < nb) {
+    const uint32_t x = a[i];
+    const uint32_t y = b[j];
+    out[k] = x;
+    k += x == y;
+    i += x <= y;
+    j += y <= x;
+  }
+  return k;
+}
+
+static size_t
+intersect_scalar_u64
+  (const uint64_t* a, size_t na,
+   const uint64_t* b, size_t nb,
+   uint64_t* out)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  while(i < na && j < nb) {
+    const uint64_t x = a[i];
+    const uint64_t y = b[j];
+    out[k] = x;
+    k += x == y;
+    i += x <= y;
+    j += y <= x;
+  }
+  return k;
+}
+
+/* Gallop through b from `from' by blocks of block_size elements. Return the
+ * offset of the first block whose last element is not less than x, or the
+ * offset of the incomplete block that ends b. */
+static FINLINE size_t
+gallop_blocks_u32
+  (const uint32_t* b,
+   const size_t nb,
+   size_t from,
+   const uint32_t x,
+   const size_t block_size)
+{
+  size_t step = block_size;
+  size_t lo = 0;
+  size_t hi = 0;
+  while(from + step <= nb && b[from + step - 1] < x) {
+    from += step;
+    step *= 2;
+  }
+  hi = MIN(step, nb - from) / block_size;
+  while(lo < hi) {
+    const size_t mid = (lo + hi) / 2;
+    if(b[from + (mid + 1) * block_size - 1] < x) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return from + lo * block_size;
+}
+
+static FINLINE size_t
+gallop_blocks_u64
+  (const uint64_t* b,
+   const size_t nb,
+   size_t from,
+   const uint64_t x,
+   const size_t block_size)
+{
+  size_t step = block_size;
+  size_t lo = 0;
+  size_t hi = 0;
+  while(from + step <= nb && b[from + step - 1] < x) {
+    from += step;
+    step *= 2;
+  }
+  hi = MIN(step, nb - from) / block_size;
+  while(lo < hi) {
+    const size_t mid = (lo + hi) / 2;
+    if(b[from + (mid + 1) * block_size - 1] < x) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return from + lo * block_size;
+}
+
+#ifdef FLAT_SET_SIMD
+/* Byte shuffles that pack the 32 bits lanes selected by a 4 bits mask. */
+static const int8_t pack_u32_lanes[16][16] = {
+  {-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+  {0, 1, 2, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+  {4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+  {0, 1, 2, 3, 4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1},
+  {8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+  {0, 1, 2, 3, 8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1},
+  {4, 5, 6, 7, 8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1},
+  {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, -1, -1, -1, -1},
+  {12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+  {0, 1, 2, 3, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1},
+  {4, 5, 6, 7, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1},
+  {0, 1, 2, 3, 4, 5, 6, 7, 12, 13, 14, 15, -1, -1, -1, -1},
+  {8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1},
+  {0, 1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1},
+  {4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1},
+  {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+};
+
+/* 32 bits lanes permutations that pack the 64 bits lanes selected by a 4 bits
+ * mask. */
+static const int32_t pack_u64_lanes[16][8] = {
+  {0, 0, 0, 0, 0, 0, 0, 0}, {0, 1, 0, 0, 0, 0, 0, 0},
+  {2, 3, 0, 0, 0, 0, 0, 0}, {0, 1, 2, 3, 0, 0, 0, 0},
+  {4, 5, 0, 0, 0, 0, 0, 0}, {0, 1, 4, 5, 0, 0, 0, 0},
+  {2, 3, 4, 5, 0, 0, 0, 0}, {0, 1, 2, 3, 4, 5, 0, 0},
+  {6, 7, 0, 0, 0, 0, 0, 0}, {0, 1, 6, 7, 0, 0, 0, 0},
+  {2, 3, 6, 7, 0, 0, 0, 0}, {0, 1, 2, 3, 6, 7, 0, 0},
+  {4, 5, 6, 7, 0, 0, 0, 0}, {0, 1, 4, 5, 6, 7, 0, 0},
+  {2, 3, 4, 5, 6, 7, 0, 0}, {0, 1, 2, 3, 4, 5, 6, 7}
+};
+
+/* Compare each block of 4 elements of a with the 4 rotations of a block of b
+ * and pack the matching elements of a with a byte shuffle. The block whose
+ * last element is the lowest is then skipped. The output must have room for
+ * MIN(na, nb) elements since 4 elements are written at each step. */
+__attribute__((target("ssse3"))) static size_t
+intersect_sse_u32
+  (const uint32_t* a, size_t na,
+   const uint32_t* b, size_t nb,
+   uint32_t* out)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+
+  while(i + 4 <= na && j + 4 <= nb) {
+    const __m128i va = _mm_loadu_si128((const __m128i*)(a + i));
+    const __m128i vb = _mm_loadu_si128((const __m128i*)(b + j));
+    const __m128i eq = _mm_or_si128
+      (_mm_or_si128(_mm_cmpeq_epi32(va, vb),
+         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x39))),
+       _mm_or_si128(_mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x4E)),
+         _mm_cmpeq_epi32(va, _mm_shuffle_epi32(vb, 0x93))));
+    const int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+    const __m128i shuffle =
+      _mm_loadu_si128((const __m128i*)pack_u32_lanes[mask]);
+    const uint32_t a_max = a[i + 3];
+    const uint32_t b_max = b[j + 3];
+
+    _mm_storeu_si128((__m128i*)(out + k), _mm_shuffle_epi8(va, shuffle));
+    k += (size_t)__builtin_popcount((unsigned)mask);
+    i += (size_t)(a_max <= b_max) * 4;
+    j += (size_t)(b_max <= a_max) * 4;
+  }
+  return k + intersect_scalar_u32(a + i, na - i, b + j, nb - j, out + k);
+}
+
+/* 64 bits version of intersect_sse_u32 on 256 bits registers. */
+__attribute__((target("avx2"))) static size_t
+intersect_avx2_u64
+  (const uint64_t* a, size_t na,
+   const uint64_t* b, size_t nb,
+   uint64_t* out)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+
+  while(i + 4 <= na && j + 4 <= nb) {
+    const __m256i va = _mm256_loadu_si256((const __m256i*)(a + i));
+    const __m256i vb = _mm256_loadu_si256((const __m256i*)(b + j));
+    const __m256i eq = _mm256_or_si256
+      (_mm256_or_si256(_mm256_cmpeq_epi64(va, vb),
+         _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x39))),
+       _mm256_or_si256
+         (_mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x4E)),
+          _mm256_cmpeq_epi64(va, _mm256_permute4x64_epi64(vb, 0x93))));
+    const int mask = _mm256_movemask_pd(_mm256_castsi256_pd(eq));
+    const __m256i permutation =
+      _mm256_loadu_si256((const __m256i*)pack_u64_lanes[mask]);
+    const uint64_t a_max = a[i + 3];
+    const uint64_t b_max = b[j + 3];
+
+    _mm256_storeu_si256((__m256i*)(out + k),
+      _mm256_permutevar8x32_epi32(va, permutation));
+    k += (size_t)__builtin_popcount((unsigned)mask);
+    i += (size_t)(a_max <= b_max) * 4;
+    j += (size_t)(b_max <= a_max) * 4;
+  }
+  return k + intersect_scalar_u64(a + i, na - i, b + j, nb - j, out + k);
+}
+
+/* Intersect the small set a with the large set b: gallop through b by blocks
+ * of 8 elements and look for the element of a in the found block with one
+ * vector comparison. */
+__attribute__((target("avx2"))) static size_t
+intersect_gallop_avx2_u32
+  (const uint32_t* a, size_t na,
+   const uint32_t* b, size_t nb,
+   uint32_t* out)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+
+  for(i = 0; i < na && j < nb; ++i) {
+    const uint32_t x = a[i];
+    j = gallop_blocks_u32(b, nb, j, x, 8);
+    if(j + 8 <= nb) {
+      const __m256i eq = _mm256_cmpeq_epi32
+        (_mm256_loadu_si256((const __m256i*)(b + j)),
+         _mm256_set1_epi32((int)x));
+      out[k] = x;
+      k += _mm256_movemask_epi8(eq) != 0;
+    } else {
+      while(j < nb && b[j] < x) ++j;
+      out[k] = x;
+      k += j < nb && b[j] == x;
+    }
+  }
+  return k;
+}
+
+/* 64 bits version of intersect_gallop_avx2_u32 with blocks of 4 elements. */
+__attribute__((target("avx2"))) static size_t
+intersect_gallop_avx2_u64
+  (const uint64_t* a, size_t na,
+   const uint64_t* b, size_t nb,
+   uint64_t* out)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+
+  for(i = 0; i < na && j < nb; ++i) {
+    const uint64_t x = a[i];
+    j = gallop_blocks_u64(b, nb, j, x, 4);
+    if(j + 4 <= nb) {
+      const __m256i eq = _mm256_cmpeq_epi64
+        (_mm256_loadu_si256((const __m256i*)(b + j)),
+         _mm256_set1_epi64x((long long)x));
+      out[k] = x;
+      k += _mm256_movemask_epi8(eq) != 0;
+    } else {
+      while(j < nb && b[j] < x) ++j;
+      out[k] = x;
+      k += j < nb && b[j] == x;
+    }
+  }
+  return k;
+}
+#endif /* FLAT_SET_SIMD */
+
+/* Scalar galloping intersection of integers used without AVX2. */
+static size_t
+intersect_gallop_u32
+  (const uint32_t* a, size_t na,
+   const uint32_t* b, size_t nb,
+   uint32_t* out)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  for(i = 0; i < na && j < nb; ++i) {
+    const uint32_t x = a[i];
+    j = gallop_blocks_u32(b, nb, j, x, 1);
+    out[k] = x;
+    k += j < nb && b[j] == x;
+  }
+  return k;
+}
+
+static size_t
+intersect_gallop_u64
+  (const uint64_t* a, size_t na,
+   const uint64_t* b, size_t nb,
+   uint64_t* out)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  for(i = 0; i < na && j < nb; ++i) {
+    const uint64_t x = a[i];
+    j = gallop_blocks_u64(b, nb, j, x, 1);
+    out[k] = x;
+    k += j < nb && b[j] == x;
+  }
+  return k;
+}
+
+/* Intersect sets of 32 bits integers. The output has room for MIN(na, nb)
+ * elements. */
+static size_t
+intersect_u32
+  (const uint32_t* a, size_t na,
+   const uint32_t* b, size_t nb,
+   uint32_t* out)
+{
+  if(na > nb)
+    return intersect_u32(b, nb, a, na, out);
+  if(na * GALLOP_RATIO < nb) {
+#ifdef FLAT_SET_SIMD
+    if(__builtin_cpu_supports("avx2"))
+      return intersect_gallop_avx2_u32(a, na, b, nb, out);
+#endif
+    return intersect_gallop_u32(a, na, b, nb, out);
+  }
+#ifdef FLAT_SET_SIMD
+  if(__builtin_cpu_supports("ssse3"))
+    return intersect_sse_u32(a, na, b, nb, out);
+#endif
+  return intersect_scalar_u32(a, na, b, nb, out);
+}
+
+static size_t
+intersect_u64
+  (const uint64_t* a, size_t na,
+   const uint64_t* b, size_t nb,
+   uint64_t* out)
+{
+  if(na > nb)
+    return intersect_u64(b, nb, a, na, out);
+#ifdef FLAT_SET_SIMD
+  if(__builtin_cpu_supports("avx2")) {
+    return na * GALLOP_RATIO < nb
+      ? intersect_gallop_avx2_u64(a, na, b, nb, out)
+      : intersect_avx2_u64(a, na, b, nb, out);
+  }
+#endif
+  return na * GALLOP_RATIO < nb
+    ? intersect_gallop_u64(a, na, b, nb, out)
+    : intersect_scalar_u64(a, na, b, nb, out);
+}
+
+/* Write in dst the result of the operation on the a and b sets. The result is
+ * built in a new vector if dst is one of the operands. */
+static enum sl_error
+set_operation
+  (struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b,
+   const enum set_op op)
+{
+  struct sl_vector* result = NULL;
+  const char* a_data = NULL;
+  const char* b_data = NULL;
+  char* out = NULL;
+  void* ptr = NULL;
+  size_t na = 0;
+  size_t nb = 0;
+  size_t n = 0;
+  size_t bound = 0;
+  size_t data_size = 0;
+  size_t data_alignment = 0;
+  size_t size = 0;
+  size_t alignment = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!dst || !a || !b) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  SL(vector_buffer(a->vector, &na, &data_size, &data_alignment, &ptr));
+  a_data = ptr;
+  SL(vector_buffer(b->vector, &nb, &size, &alignment, &ptr));
+  b_data = ptr;
+  if(a->compare != b->compare
+  || a->compare != dst->compare
+  || size != data_size
+  || alignment != data_alignment) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  SL(vector_buffer(dst->vector, NULL, &size, &alignment, NULL));
+  if(size != data_size || alignment != data_alignment) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  switch(op) {
+    case SET_INTERSECTION: bound = MIN(na, nb); break;
+    case SET_DIFFERENCE: bound = na; break;
+    default: bound = na + nb; break;
+  }
+
+  if(dst == a || dst == b) {
+    err = sl_create_vector
+      (data_size, data_alignment, dst->allocator, &result);
+    if(err != SL_NO_ERROR)
+      goto error;
+  } else {
+    result = dst->vector;
+  }
+  err = sl_vector_reserve(result, bound);
+  if(err != SL_NO_ERROR)
+    goto error;
+  SL(clear_vector(result));
+  if(bound) {
+    SL(vector_append_uninit(result, bound, &ptr));
+    out = ptr;
+    /* The typed kernels load the elements as integers and so require them
+     * to be aligned on their size. */
+    if(op == SET_INTERSECTION
+    && a->compare == sl_flat_set_cmp_u32
+    && data_size == sizeof(uint32_t)
+    && data_alignment >= sizeof(uint32_t)) {
+      n = intersect_u32((const uint32_t*)a_data, na,
+        (const uint32_t*)b_data, nb, (uint32_t*)out);
+    } else if(op == SET_INTERSECTION
+    && a->compare == sl_flat_set_cmp_u64
+    && data_size == sizeof(uint64_t)
+    && data_alignment >= sizeof(uint64_t)) {
+      n = intersect_u64((const uint64_t*)a_data, na,
+        (const uint64_t*)b_data, nb, (uint64_t*)out);
+    } else if(op == SET_INTERSECTION && na * GALLOP_RATIO < nb) {
+      n = intersect_gallop_generic(a, a_data, na, b_data, nb, data_size, out);
+    } else if(op == SET_INTERSECTION && nb * GALLOP_RATIO < na) {
+      n = intersect_gallop_generic(a, b_data, nb, a_data, na, data_size, out);
+    } else {
+      n = merge_generic(a, op, a_data, na, b_data, nb, data_size, out);
+    }
+  }
+  SL(vector_resize(result, n, NULL));
+  if(result != dst->vector) {
+    SL(free_vector(dst->vector));
+    dst->vector = result;
+  }
+  dst->is_frozen = false;
+
+exit:
+  return err;
+error:
+  if(result && result != dst->vector)
+    SL(free_vector(result));
+  goto exit;
 }
 
 /*******************************************************************************
@@ -139,6 +1141,8 @@ sl_free_flat_set(struct sl_flat_set* set)
   err = sl_free_vector(set->vector);
   if(err != SL_NO_ERROR)
     goto error;
+  if(set->layout)
+    SL(free_vector(set->layout));
   allocator = set->allocator;
   MEM_FREE(allocator, set);
 
@@ -153,6 +1157,7 @@ sl_clear_flat_set(struct sl_flat_set* set)
 {
   if(!set)
     return SL_INVALID_ARGUMENT;
+  set->is_frozen = false;
   return sl_clear_vector(set->vector);
 }
 
@@ -162,21 +1167,142 @@ sl_flat_set_insert
    const void* data,
    size_t* insert_id)
 {
-  size_t id = 0;
-  enum sl_error err = SL_NO_ERROR;
-  bool is_data_found = false;
+  size_t len = 0;
 
   if(!set || !data)
     return SL_INVALID_ARGUMENT;
-  is_data_found = data_id(set, data, &id, EXACT_VALUE);
-  if(is_data_found)
+  /* Hint the end of the set so that increasing elements are appended
+   * without being searched. */
+  SL(vector_length(set->vector, &len));
+  return insert_hint(set, data, len, insert_id);
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_set_insert_hint
+  (struct sl_flat_set* set,
+   const void* data,
+   size_t hint,
+   size_t* insert_id)
+{
+  size_t len = 0;
+
+  if(!set || !data)
+    return SL_INVALID_ARGUMENT;
+  SL(vector_length(set->vector, &len));
+  if(hint > len)
     return SL_INVALID_ARGUMENT;
-  err = sl_vector_insert(set->vector, id, data);
+  return insert_hint(set, data, hint, insert_id);
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_set_insert_n
+  (struct sl_flat_set* set,
+   const void* data,
+   size_t count,
+   enum sl_duplicate_policy policy,
+   size_t* out_nb_inserted)
+{
+  struct sl_vector* batch_vector = NULL;
+  char* batch = NULL;
+  char* buffer = NULL;
+  void* ptr = NULL;
+  size_t data_size = 0;
+  size_t data_alignment = 0;
+  size_t len = 0;
+  size_t nb_dups = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!set || (!data && count)
+  || (policy != SL_DUPLICATE_KEEP_FIRST
+   && policy != SL_DUPLICATE_KEEP_LAST
+   && policy != SL_DUPLICATE_REJECT)) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  SL(vector_buffer(set->vector, &len, &data_size, &data_alignment, &ptr));
+  if(!count)
+    goto exit;
+
+  /* A sorted batch greater than the set elements is appended as is. */
+  if(is_batch_appended(set, data, count)) {
+    err = sl_vector_append_range(set->vector, count, data);
+    if(err != SL_NO_ERROR)
+      goto error;
+    set->is_frozen = false;
+    goto exit;
+  }
+
+  /* Sort a copy of the batch and remove its duplicates. */
+  err = sl_create_vector
+    (data_size, data_alignment, set->allocator, &batch_vector);
   if(err != SL_NO_ERROR)
-    return err;
-  if(insert_id)
-    *insert_id = id;
-  return SL_NO_ERROR;
+    goto error;
+  err = sl_vector_append_range(batch_vector, count, data);
+  if(err != SL_NO_ERROR)
+    goto error;
+  SL(vector_buffer(batch_vector, NULL, NULL, NULL, &ptr));
+  batch = ptr;
+  count = sort_batch
+    (set, batch, count, data_size, data_alignment, policy, &err);
+  if(err != SL_NO_ERROR)
+    goto error;
+
+  /* Count the batch elements already in the set. */
+  SL(vector_buffer(set->vector, NULL, NULL, NULL, &ptr));
+  buffer = ptr;
+  for(i = 0, j = 0; j < count && i < len; ++j) {
+    const char* x = batch + j * data_size;
+    i = gallop_forward(set, buffer, data_size, i, len, x);
+    if(i < len && set->compare(x, buffer + i * data_size) == 0) {
+      if(policy == SL_DUPLICATE_REJECT) {
+        err = SL_INVALID_ARGUMENT;
+        goto error;
+      }
+      ++nb_dups;
+    }
+  }
+
+  /* Merge from the back the batch with the set elements, moving the set
+   * elements that lie between two batch elements with one memmove. */
+  err = sl_vector_resize(set->vector, len + count - nb_dups, NULL);
+  if(err != SL_NO_ERROR)
+    goto error;
+  SL(vector_buffer(set->vector, NULL, NULL, NULL, &ptr));
+  buffer = ptr;
+  i = len;
+  k = len + count - nb_dups;
+  for(j = count; j > 0; --j) {
+    const char* x = batch + (j - 1) * data_size;
+    const size_t pos = gallop_backward(set, buffer, data_size, i, x);
+    const bool is_dup =
+      pos < i && set->compare(x, buffer + pos * data_size) == 0;
+    const size_t begin = pos + (is_dup && policy == SL_DUPLICATE_KEEP_LAST);
+    const size_t n = i - begin;
+
+    k -= n;
+    memmove(buffer + k * data_size, buffer + begin * data_size, n * data_size);
+    if(!is_dup || policy == SL_DUPLICATE_KEEP_LAST) {
+      --k;
+      memcpy(buffer + k * data_size, x, data_size);
+    }
+    i = pos;
+  }
+  ASSERT(k == i);
+  set->is_frozen = false;
+
+exit:
+  if(batch_vector)
+    SL(free_vector(batch_vector));
+  if(out_nb_inserted)
+    *out_nb_inserted = count - nb_dups;
+  return err;
+
+error:
+  count = nb_dups = 0;
+  goto exit;
 }
 
 EXPORT_SYM enum sl_error
@@ -194,7 +1320,7 @@ sl_flat_set_find
     goto error;
   }
 
-  is_data_found = data_id(set, data, &id, EXACT_VALUE);
+  is_data_found = search_data_id(set, data, &id, EXACT_VALUE);
   if(is_data_found) {
     *out_id = id;
   } else {
@@ -213,6 +1339,39 @@ error:
   goto exit;
 }
 
+EXPORT_SYM enum sl_error
+sl_flat_set_find_n
+  (struct sl_flat_set* set,
+   const void* data,
+   size_t count,
+   size_t* out_ids)
+{
+  const char* queries = data;
+  const char* buffer = NULL;
+  void* ptr = NULL;
+  size_t data_size = 0;
+  size_t len = 0;
+  size_t i = 0;
+
+  if(!set || (count && (!data || !out_ids)))
+    return SL_INVALID_ARGUMENT;
+  if(!count)
+    return SL_NO_ERROR;
+  SL(vector_buffer(set->vector, &len, &data_size, NULL, &ptr));
+  buffer = ptr;
+  for(i = 1; i < count; ++i) {
+    const char* x = queries + i * data_size;
+    if(set->compare(x - data_size, x) > 0)
+      break;
+  }
+  if(i == count) {
+    find_sorted(set, buffer, data_size, len, queries, count, out_ids);
+  } else {
+    find_interleaved(set, buffer, data_size, len, queries, count, out_ids);
+  }
+  return SL_NO_ERROR;
+}
+
 EXPORT_SYM enum sl_error
 sl_flat_set_at
   (struct sl_flat_set* set,
@@ -247,6 +1406,7 @@ sl_flat_set_erase
   err = sl_vector_erase(set->vector, id);
   if(err != SL_NO_ERROR)
     goto error;
+  set->is_frozen = false;
   if(erase_id)
     *erase_id = id;
 
@@ -256,6 +1416,45 @@ error:
   goto exit;
 }
 
+EXPORT_SYM enum sl_error
+sl_flat_set_erase_n(struct sl_flat_set* set, size_t id, size_t count)
+{
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!set)
+    return SL_INVALID_ARGUMENT;
+  err = sl_vector_erase_n(set->vector, id, count);
+  if(err != SL_NO_ERROR)
+    return err;
+  set->is_frozen = false;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_set_erase_range
+  (struct sl_flat_set* set,
+   const void* lower,
+   const void* upper,
+   size_t* out_nb_erased)
+{
+  size_t begin = 0;
+  size_t end = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!set)
+    return SL_INVALID_ARGUMENT;
+  err = range_ids(set, lower, upper, &begin, &end);
+  if(err != SL_NO_ERROR)
+    return err;
+  if(begin < end) {
+    SL(vector_erase_n(set->vector, begin, end - begin));
+    set->is_frozen = false;
+  }
+  if(out_nb_erased)
+    *out_nb_erased = end - begin;
+  return SL_NO_ERROR;
+}
+
 EXPORT_SYM enum sl_error
 sl_flat_set_reserve
   (struct sl_flat_set* set,
@@ -297,7 +1496,7 @@ sl_flat_set_lower_bound
 {
   if(!set || !data || !lower_bound)
     return SL_INVALID_ARGUMENT;
-  data_id(set, data, lower_bound, LOWER_BOUND);
+  search_data_id(set, data, lower_bound, LOWER_BOUND);
   return SL_NO_ERROR;
 }
 
@@ -309,7 +1508,7 @@ sl_flat_set_upper_bound
 {
   if(!set || !data || !upper_bound)
     return SL_INVALID_ARGUMENT;
-  data_id(set, data, upper_bound, UPPER_BOUND);
+  search_data_id(set, data, upper_bound, UPPER_BOUND);
   return SL_NO_ERROR;
 }
 
@@ -327,3 +1526,99 @@ sl_flat_set_buffer
     (set->vector, length, data_size, data_alignment, buffer);
 }
 
+EXPORT_SYM enum sl_error
+sl_flat_set_freeze(struct sl_flat_set* set)
+{
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!set)
+    return SL_INVALID_ARGUMENT;
+  if(set->is_frozen)
+    return SL_NO_ERROR;
+  err = build_layout(set);
+  if(err != SL_NO_ERROR)
+    return err;
+  set->is_frozen = true;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_set_unfreeze(struct sl_flat_set* set)
+{
+  if(!set)
+    return SL_INVALID_ARGUMENT;
+  if(set->layout) {
+    SL(free_vector(set->layout));
+    set->layout = NULL;
+  }
+  set->is_frozen = false;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_set_is_frozen
+  (struct sl_flat_set* set,
+   bool* is_frozen)
+{
+  if(!set || !is_frozen)
+    return SL_INVALID_ARGUMENT;
+  *is_frozen = set->is_frozen;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_set_union
+  (struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b)
+{
+  return set_operation(dst, a, b, SET_UNION);
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_set_intersect
+  (struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b)
+{
+  return set_operation(dst, a, b, SET_INTERSECTION);
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_set_difference
+  (struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b)
+{
+  return set_operation(dst, a, b, SET_DIFFERENCE);
+}
+
+EXPORT_SYM enum sl_error
+sl_flat_set_symmetric_difference
+  (struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b)
+{
+  return set_operation(dst, a, b, SET_SYMMETRIC_DIFFERENCE);
+}
+
+EXPORT_SYM int
+sl_flat_set_cmp_u32(const void* a, const void* b)
+{
+  uint32_t i = 0;
+  uint32_t j = 0;
+  memcpy(&i, a, sizeof(i)); /* The elements may be unaligned. */
+  memcpy(&j, b, sizeof(j));
+  return (i > j) - (i < j);
+}
+
+EXPORT_SYM int
+sl_flat_set_cmp_u64(const void* a, const void* b)
+{
+  uint64_t i = 0;
+  uint64_t j = 0;
+  memcpy(&i, a, sizeof(i)); /* The elements may be unaligned. */
+  memcpy(&j, b, sizeof(j));
+  return (i > j) - (i < j);
+}
+
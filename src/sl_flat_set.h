@@ -3,13 +3,22 @@
 
 #include "sl.h"
 #include "sl_error.h"
+#include <stdbool.h>
 #include <stddef.h>
 
-struct mem_allocator* allocator;
+struct mem_allocator;
 
 /* Associative container in which the elements themselves are the key. */
 struct sl_flat_set;
 
+/* Policy on the inserted elements that are equal to an element of the
+ * container or to another inserted element. */
+enum sl_duplicate_policy {
+  SL_DUPLICATE_KEEP_FIRST, /* Keep the stored or first inserted element. */
+  SL_DUPLICATE_KEEP_LAST, /* Keep the last inserted element. */
+  SL_DUPLICATE_REJECT /* Insert nothing and return SL_INVALID_ARGUMENT. */
+};
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -36,18 +45,72 @@ sl_flat_set_insert
    const void* data,
    size_t* insert_id); /* May be NULL. */
 
+/* Insert data expecting it at the position hint, e.g. one past the id of the
+ * previously inserted element. A right hint costs two comparisons and a wrong
+ * one falls back to the binary search. Note that sl_flat_set_insert hints the
+ * end of the set so that elements inserted in increasing order are appended in
+ * O(1). The hint must not exceed the set length. */
+SL_API enum sl_error
+sl_flat_set_insert_hint
+  (struct sl_flat_set* set,
+   const void* data,
+   size_t hint,
+   size_t* insert_id); /* May be NULL. */
+
+/* Insert count unsorted elements in O(n + m log m) rather than O(n m): the
+ * elements are sorted and then merged from the back with the set elements,
+ * whose moves are grouped between two inserted elements. A sorted batch greater
+ * than the set elements is appended in O(m). The set is left unchanged on
+ * error. */
+SL_API enum sl_error
+sl_flat_set_insert_n
+  (struct sl_flat_set* set,
+   const void* data,
+   size_t count,
+   enum sl_duplicate_policy policy,
+   size_t* out_nb_inserted); /* May be NULL. */
+
 SL_API enum sl_error
 sl_flat_set_erase
   (struct sl_flat_set* set,
    const void* data,
    size_t* erase_id); /* May be NULL. */
 
+/* Erase the elements [id, id + count[ in one move, count being clamped to the
+ * set length. */
+SL_API enum sl_error
+sl_flat_set_erase_n
+  (struct sl_flat_set* set,
+   size_t id,
+   size_t count);
+
+/* Erase the elements in [lower, upper[ in one move. A NULL bound leaves the
+ * range unbounded on its side, e.g. a NULL lower bound erases a prefix. */
+SL_API enum sl_error
+sl_flat_set_erase_range
+  (struct sl_flat_set* set,
+   const void* lower, /* May be NULL. */
+   const void* upper, /* May be NULL. */
+   size_t* out_nb_erased); /* May be NULL. */
+
 SL_API enum sl_error
 sl_flat_set_find
   (struct sl_flat_set* set,
    const void* data,
    size_t* out_id); /* set to set_length if the data is not found. */
 
+/* Look for count elements at once. Each id of out_ids is set to the set
+ * length if its element is not found. A batch sorted in ascending order is
+ * merged with the set in O(m log(n/m)) comparisons, each search galloping
+ * from the result of the previous one. Other batches are searched with
+ * interleaved binary searches that prefetch their next probe. */
+SL_API enum sl_error
+sl_flat_set_find_n
+  (struct sl_flat_set* set,
+   const void* data,
+   size_t count,
+   size_t* out_ids);
+
 SL_API enum sl_error
 sl_flat_set_at
   (struct sl_flat_set* set,
@@ -89,6 +152,77 @@ sl_flat_set_buffer
    size_t* out_data_alignment,
    void** out_buffer);
 
+/* In frozen mode, find, lower_bound and upper_bound search a copy of the
+ * elements stored in Eytzinger (breadth first) order, whose first levels share
+ * a few cache lines; the returned ids remain the sorted ids. The copy is built
+ * in O(n) by sl_flat_set_freeze, which returns SL_MEMORY_ERROR and leaves the
+ * set unfrozen if it cannot be allocated. The searches only read the copy and
+ * may thus run concurrently. Any modification of the set unfreezes it, its
+ * copy being rebuilt by the next call to sl_flat_set_freeze. The layout pays
+ * off on sets larger than the caches; smaller sets are searched faster in
+ * sorted order. */
+SL_API enum sl_error
+sl_flat_set_freeze
+  (struct sl_flat_set* set);
+
+/* Release the Eytzinger copy and search the sorted elements again. */
+SL_API enum sl_error
+sl_flat_set_unfreeze
+  (struct sl_flat_set* set);
+
+SL_API enum sl_error
+sl_flat_set_is_frozen
+  (struct sl_flat_set* set,
+   bool* is_frozen);
+
+/*******************************************************************************
+ *
+ * Set algebra. The result of the operation on the a and b sets is written in
+ * dst in one pass over their sorted elements; dst may be a or b. The three
+ * sets must store elements of the same size and share their comparator. The
+ * intersection of sets of integers compared with sl_flat_set_cmp_u32 or
+ * sl_flat_set_cmp_u64 and aligned on their size uses SIMD kernels when the CPU
+ * supports them, and the intersection of sets of very different sizes gallops
+ * through the larger.
+ *
+ ******************************************************************************/
+SL_API enum sl_error
+sl_flat_set_union
+  (struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b);
+
+SL_API enum sl_error
+sl_flat_set_intersect
+  (struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b);
+
+/* Elements of a that are not in b. */
+SL_API enum sl_error
+sl_flat_set_difference
+  (struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b);
+
+SL_API enum sl_error
+sl_flat_set_symmetric_difference
+  (struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b);
+
+/* Built-in comparators of unsigned integers of 32 and 64 bits, that may be
+ * unaligned. */
+SL_API int
+sl_flat_set_cmp_u32
+  (const void* a,
+   const void* b);
+
+SL_API int
+sl_flat_set_cmp_u64
+  (const void* a,
+   const void* b);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -0,0 +1,343 @@
+#define _GNU_SOURCE /* syscall */
+#include "sl_mpmc_queue.h"
+#include <snlsys/math.h>
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __linux__
+  #include <linux/futex.h>
+  #include <sys/syscall.h>
+  #include <unistd.h>
+#else
+  #include <sched.h>
+#endif
+
+#define CACHE_LINE_SIZE 64
+
+/* Sleep/wake up mechanism of the threads that wait for a free or a filled
+ * slot. The sequence is incremented on each notification; it is only touched
+ * when at least one thread waits. */
+struct event {
+  ALIGN(CACHE_LINE_SIZE) uint32_t seq;
+  uint32_t nb_waiters;
+};
+
+/* Each slot stores a sequence number followed by an element. A slot is free
+ * for the enqueue position `pos' when its sequence is pos and it is filled
+ * for the dequeue position `pos' when its sequence is pos + 1. */
+struct sl_mpmc_queue {
+  struct mem_allocator* allocator;
+  size_t data_size;
+  size_t data_alignment;
+  size_t data_offset; /* Offset of the element from the start of its slot. */
+  size_t slot_size;
+  size_t mask; /* Capacity - 1. */
+  void* buffer;
+
+  ALIGN(CACHE_LINE_SIZE) size_t enqueue_pos;
+  ALIGN(CACHE_LINE_SIZE) size_t dequeue_pos;
+
+  struct event not_full;
+  struct event not_empty;
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE size_t*
+slot_seq(const struct sl_mpmc_queue* queue, size_t pos)
+{
+  return (size_t*)
+    ((uintptr_t)queue->buffer + (pos & queue->mask) * queue->slot_size);
+}
+
+static FINLINE void*
+slot_data(const struct sl_mpmc_queue* queue, size_t pos)
+{
+  return (void*)((uintptr_t)slot_seq(queue, pos) + queue->data_offset);
+}
+
+static void
+futex_wait(uint32_t* addr, uint32_t val)
+{
+#ifdef __linux__
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+#else
+  (void)addr, (void)val;
+  sched_yield();
+#endif
+}
+
+static void
+futex_wake(uint32_t* addr)
+{
+#ifdef __linux__
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, 1, NULL, NULL, 0);
+#else
+  (void)addr;
+#endif
+}
+
+static FINLINE void
+notify(struct event* ev)
+{
+  /* Order the publication of the slot before the read of nb_waiters. It pairs
+   * with the increment of nb_waiters in wait_for. */
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  if(__atomic_load_n(&ev->nb_waiters, __ATOMIC_RELAXED)) {
+    __atomic_add_fetch(&ev->seq, 1, __ATOMIC_SEQ_CST);
+    futex_wake(&ev->seq);
+  }
+}
+
+static bool
+push(struct sl_mpmc_queue* queue, const void* data)
+{
+  size_t pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+  size_t* seq = NULL;
+
+  for(;;) {
+    intptr_t dif = 0;
+    seq = slot_seq(queue, pos);
+    dif = (intptr_t)__atomic_load_n(seq, __ATOMIC_ACQUIRE) - (intptr_t)pos;
+    if(dif == 0) {
+      if(__atomic_compare_exchange_n(&queue->enqueue_pos, &pos, pos + 1, true,
+         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    } else if(dif < 0) {
+      return false; /* Full queue. */
+    } else {
+      pos = __atomic_load_n(&queue->enqueue_pos, __ATOMIC_RELAXED);
+    }
+  }
+  memcpy(slot_data(queue, pos), data, queue->data_size);
+  __atomic_store_n(seq, pos + 1, __ATOMIC_RELEASE);
+  notify(&queue->not_empty);
+  return true;
+}
+
+static bool
+pop(struct sl_mpmc_queue* queue, void* data)
+{
+  size_t pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+  size_t* seq = NULL;
+
+  for(;;) {
+    intptr_t dif = 0;
+    seq = slot_seq(queue, pos);
+    dif = (intptr_t)__atomic_load_n(seq, __ATOMIC_ACQUIRE)
+        - (intptr_t)(pos + 1);
+    if(dif == 0) {
+      if(__atomic_compare_exchange_n(&queue->dequeue_pos, &pos, pos + 1, true,
+         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        break;
+    } else if(dif < 0) {
+      return false; /* Empty queue. */
+    } else {
+      pos = __atomic_load_n(&queue->dequeue_pos, __ATOMIC_RELAXED);
+    }
+  }
+  memcpy(data, slot_data(queue, pos), queue->data_size);
+  __atomic_store_n(seq, pos + queue->mask + 1, __ATOMIC_RELEASE);
+  notify(&queue->not_full);
+  return true;
+}
+
+static FINLINE bool
+push_or_pop(struct sl_mpmc_queue* queue, void* data, bool is_push)
+{
+  return is_push ? push(queue, data) : pop(queue, data);
+}
+
+/* Push or pop data until it succeeds. The thread sleeps on the event between
+ * two failed attempts. */
+static void
+wait_for
+  (struct sl_mpmc_queue* queue,
+   struct event* ev,
+   void* data,
+   bool is_push)
+{
+  while(!push_or_pop(queue, data, is_push)) {
+    const uint32_t seq = __atomic_load_n(&ev->seq, __ATOMIC_SEQ_CST);
+    bool is_done = false;
+    __atomic_add_fetch(&ev->nb_waiters, 1, __ATOMIC_SEQ_CST);
+    /* Try again once registered as waiter; a notification that precedes the
+     * registration may have been skipped. */
+    is_done = push_or_pop(queue, data, is_push);
+    if(!is_done)
+      futex_wait(&ev->seq, seq);
+    __atomic_sub_fetch(&ev->nb_waiters, 1, __ATOMIC_SEQ_CST);
+    if(is_done)
+      break;
+  }
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the multiple producers/multiple consumers queue.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_mpmc_queue
+  (size_t data_size,
+   size_t data_alignment,
+   size_t capacity,
+   struct mem_allocator* specific_allocator,
+   struct sl_mpmc_queue** out_queue)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_mpmc_queue* queue = NULL;
+  size_t pow2_capacity = 0;
+  size_t slot_alignment = 0;
+  size_t data_offset = 0;
+  size_t slot_size = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!out_queue || !data_size || !capacity) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(!IS_POWER_OF_2(data_alignment)) {
+    err = SL_ALIGNMENT_ERROR;
+    goto error;
+  }
+  capacity = MAX(capacity, 2);
+  NEXT_POWER_OF_2(capacity, pow2_capacity);
+  slot_alignment = MAX(data_alignment, ALIGNOF(size_t));
+  data_offset = ALIGN_SIZE(sizeof(size_t), data_alignment);
+  if(pow2_capacity < capacity || data_size > SIZE_MAX - slot_alignment * 2) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  slot_size = ALIGN_SIZE(data_offset + data_size, slot_alignment);
+  if(pow2_capacity > SIZE_MAX / slot_size) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  queue = MEM_ALIGNED_ALLOC
+    (allocator, sizeof(struct sl_mpmc_queue), ALIGNOF(struct sl_mpmc_queue));
+  if(queue == NULL) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  memset(queue, 0, sizeof(struct sl_mpmc_queue));
+  queue->allocator = allocator;
+  queue->data_size = data_size;
+  queue->data_alignment = data_alignment;
+  queue->data_offset = data_offset;
+  queue->slot_size = slot_size;
+  queue->mask = pow2_capacity - 1;
+  queue->buffer = MEM_ALIGNED_ALLOC
+    (allocator, pow2_capacity * slot_size,
+     MAX(slot_alignment, CACHE_LINE_SIZE));
+  if(queue->buffer == NULL) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  for(i = 0; i < pow2_capacity; ++i)
+    *slot_seq(queue, i) = i;
+
+exit:
+  if(out_queue)
+    *out_queue = queue;
+  return err;
+
+error:
+  if(queue) {
+    ASSERT(allocator);
+    MEM_FREE(allocator, queue);
+    queue = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_mpmc_queue
+  (struct sl_mpmc_queue* queue)
+{
+  struct mem_allocator* allocator = NULL;
+
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+
+  allocator = queue->allocator;
+  MEM_FREE(allocator, queue->buffer);
+  MEM_FREE(allocator, queue);
+
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_mpmc_queue_try_push
+  (struct sl_mpmc_queue* queue,
+   const void* data,
+   bool* is_pushed)
+{
+  if(!queue || !data || !is_pushed)
+    return SL_INVALID_ARGUMENT;
+  if(!IS_ALIGNED(data, queue->data_alignment))
+    return SL_ALIGNMENT_ERROR;
+  *is_pushed = push(queue, data);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_mpmc_queue_try_pop
+  (struct sl_mpmc_queue* queue,
+   void* data,
+   bool* is_popped)
+{
+  if(!queue || !data || !is_popped)
+    return SL_INVALID_ARGUMENT;
+  if(!IS_ALIGNED(data, queue->data_alignment))
+    return SL_ALIGNMENT_ERROR;
+  *is_popped = pop(queue, data);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_mpmc_queue_push
+  (struct sl_mpmc_queue* queue,
+   const void* data)
+{
+  if(!queue || !data)
+    return SL_INVALID_ARGUMENT;
+  if(!IS_ALIGNED(data, queue->data_alignment))
+    return SL_ALIGNMENT_ERROR;
+  wait_for(queue, &queue->not_full, (void*)data, true);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_mpmc_queue_pop
+  (struct sl_mpmc_queue* queue,
+   void* data)
+{
+  if(!queue || !data)
+    return SL_INVALID_ARGUMENT;
+  if(!IS_ALIGNED(data, queue->data_alignment))
+    return SL_ALIGNMENT_ERROR;
+  wait_for(queue, &queue->not_empty, data, false);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_mpmc_queue_capacity
+  (struct sl_mpmc_queue* queue,
+   size_t* capacity)
+{
+  if(!queue || !capacity)
+    return SL_INVALID_ARGUMENT;
+  *capacity = queue->mask + 1;
+  return SL_NO_ERROR;
+}
+
@@ -0,0 +1,72 @@
+#ifndef SL_MPMC_QUEUE_H
+#define SL_MPMC_QUEUE_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+struct mem_allocator;
+
+/* Bounded lock-free queue of fixed size elements shared by any number of
+ * producer and consumer threads. Each slot of the ring buffer has a sequence
+ * number that tells whether it is ready to be written or read, so that
+ * producers and consumers only contend on their own index. */
+struct sl_mpmc_queue;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SL_API enum sl_error
+sl_create_mpmc_queue
+  (size_t data_size,
+   size_t data_alignment,
+   size_t capacity, /* Rounded up to the next power of 2, at least 2. */
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_mpmc_queue** out_queue);
+
+/* Must not be invoked while threads use or wait on the queue. */
+SL_API enum sl_error
+sl_free_mpmc_queue
+  (struct sl_mpmc_queue* queue);
+
+/* Copy data at the end of the queue if it is not full. */
+SL_API enum sl_error
+sl_mpmc_queue_try_push
+  (struct sl_mpmc_queue* queue,
+   const void* data,
+   bool* out_is_pushed);
+
+/* Move the front element of the queue in data if the queue is not empty. */
+SL_API enum sl_error
+sl_mpmc_queue_try_pop
+  (struct sl_mpmc_queue* queue,
+   void* data,
+   bool* out_is_popped);
+
+/* Copy data at the end of the queue. If the queue is full, the calling thread
+ * sleeps until an element is popped. */
+SL_API enum sl_error
+sl_mpmc_queue_push
+  (struct sl_mpmc_queue* queue,
+   const void* data);
+
+/* Move the front element of the queue in data. If the queue is empty, the
+ * calling thread sleeps until an element is pushed. */
+SL_API enum sl_error
+sl_mpmc_queue_pop
+  (struct sl_mpmc_queue* queue,
+   void* data);
+
+SL_API enum sl_error
+sl_mpmc_queue_capacity
+  (struct sl_mpmc_queue* queue,
+   size_t* out_capacity);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_MPMC_QUEUE_H */
+
@@ -0,0 +1,409 @@
+#include "sl_priority_queue.h"
+#include "sl_vector.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct sl_priority_queue {
+  int (*compare)(const void*, const void*);
+  void (*on_move)(const void*, size_t, void*);
+  void* on_move_context;
+  struct mem_allocator* allocator;
+  struct sl_vector* vector;
+  size_t arity;
+  size_t data_size;
+  void* tmp; /* Copy of the element that is sifted through the heap. */
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE char*
+buffer_of(struct sl_priority_queue* queue, size_t* out_length)
+{
+  void* buffer = NULL;
+  ASSERT(queue && out_length);
+  SL(vector_buffer(queue->vector, out_length, NULL, NULL, &buffer));
+  return buffer;
+}
+
+static FINLINE void
+store
+  (struct sl_priority_queue* queue,
+   char* buffer,
+   size_t id,
+   const void* data)
+{
+  char* dst = buffer + id * queue->data_size;
+  ASSERT(queue && buffer && data);
+  memcpy(dst, data, queue->data_size);
+  if(queue->on_move)
+    queue->on_move(dst, id, queue->on_move_context);
+}
+
+/* Move the parents of the hole id down while they are greater than data and
+ * store data in the remaining hole. */
+static void
+sift_up
+  (struct sl_priority_queue* queue,
+   char* buffer,
+   size_t id,
+   const void* data)
+{
+  ASSERT(queue && buffer && data);
+  while(id > 0) {
+    const size_t parent = (id - 1) / queue->arity;
+    const char* parent_data = buffer + parent * queue->data_size;
+    if(queue->compare(data, parent_data) >= 0)
+      break;
+    store(queue, buffer, id, parent_data);
+    id = parent;
+  }
+  store(queue, buffer, id, data);
+}
+
+/* Move the smallest child of the hole id up while it is lower than data and
+ * store data in the remaining hole. */
+static void
+sift_down
+  (struct sl_priority_queue* queue,
+   char* buffer,
+   size_t length,
+   size_t id,
+   const void* data)
+{
+  const size_t size = queue->data_size;
+  ASSERT(queue && buffer && data && id < length);
+
+  for(;;) {
+    const size_t first = id * queue->arity + 1;
+    size_t last = 0;
+    size_t child = 0;
+    size_t best = first;
+
+    if(first >= length)
+      break;
+    last = MIN(first + queue->arity, length);
+    for(child = first + 1; child < last; ++child) {
+      if(queue->compare(buffer + child * size, buffer + best * size) < 0)
+        best = child;
+    }
+    if(queue->compare(buffer + best * size, data) >= 0)
+      break;
+    store(queue, buffer, id, buffer + best * size);
+    id = best;
+  }
+  store(queue, buffer, id, data);
+}
+
+/* Store data, that does not lie in the heap, at the position id and move it
+ * up or down to restore the heap order. */
+static void
+fix
+  (struct sl_priority_queue* queue,
+   char* buffer,
+   size_t length,
+   size_t id,
+   const void* data)
+{
+  const size_t parent = id ? (id - 1) / queue->arity : 0;
+  ASSERT(queue && buffer && data && id < length);
+
+  if(id && queue->compare(data, buffer + parent * queue->data_size) < 0) {
+    sift_up(queue, buffer, id, data);
+  } else {
+    sift_down(queue, buffer, length, id, data);
+  }
+}
+
+static void
+heapify(struct sl_priority_queue* queue)
+{
+  char* buffer = NULL;
+  size_t length = 0;
+  size_t id = 0;
+  ASSERT(queue && !queue->on_move);
+
+  buffer = buffer_of(queue, &length);
+  if(length < 2)
+    return;
+  /* Sift down the inner nodes, from the last one to the root. */
+  id = (length - 2) / queue->arity + 1;
+  while(id--) {
+    memcpy(queue->tmp, buffer + id * queue->data_size, queue->data_size);
+    sift_down(queue, buffer, length, id, queue->tmp);
+  }
+}
+
+static enum sl_error
+create_queue
+  (struct sl_vector* vector,
+   size_t arity,
+   int (*compare)(const void*, const void*),
+   struct mem_allocator* specific_allocator,
+   struct sl_priority_queue** out_queue)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_priority_queue* queue = NULL;
+  size_t data_size = 0;
+  size_t data_alignment = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(vector && arity >= 2 && compare && out_queue);
+
+  SL(vector_buffer(vector, NULL, &data_size, &data_alignment, NULL));
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  queue = MEM_CALLOC(allocator, 1, sizeof(struct sl_priority_queue));
+  if(!queue) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  queue->tmp = MEM_ALIGNED_ALLOC(allocator, data_size, data_alignment);
+  if(!queue->tmp) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  queue->compare = compare;
+  queue->allocator = allocator;
+  queue->vector = vector;
+  queue->arity = arity;
+  queue->data_size = data_size;
+
+exit:
+  *out_queue = queue;
+  return err;
+
+error:
+  if(queue) {
+    if(queue->tmp)
+      MEM_FREE(allocator, queue->tmp);
+    MEM_FREE(allocator, queue);
+    queue = NULL;
+  }
+  goto exit;
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the priority queue functions.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_priority_queue
+  (size_t data_size,
+   size_t data_alignment,
+   size_t arity,
+   int (*compare)(const void*, const void*),
+   struct mem_allocator* allocator,
+   struct sl_priority_queue** out_queue)
+{
+  struct sl_vector* vector = NULL;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(arity < 2 || !compare || !out_queue) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  err = sl_create_vector(data_size, data_alignment, allocator, &vector);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = create_queue(vector, arity, compare, allocator, out_queue);
+  if(err != SL_NO_ERROR)
+    goto error;
+
+exit:
+  return err;
+
+error:
+  if(vector)
+    SL(free_vector(vector));
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_create_priority_queue_from_vector
+  (struct sl_vector* vector,
+   size_t arity,
+   int (*compare)(const void*, const void*),
+   struct mem_allocator* allocator,
+   struct sl_priority_queue** out_queue)
+{
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!vector || arity < 2 || !compare || !out_queue)
+    return SL_INVALID_ARGUMENT;
+  err = create_queue(vector, arity, compare, allocator, out_queue);
+  if(err != SL_NO_ERROR)
+    return err;
+  heapify(*out_queue);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_priority_queue
+  (struct sl_priority_queue* queue)
+{
+  struct mem_allocator* allocator = NULL;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+  err = sl_free_vector(queue->vector);
+  if(err != SL_NO_ERROR)
+    return err;
+  allocator = queue->allocator;
+  MEM_FREE(allocator, queue->tmp);
+  MEM_FREE(allocator, queue);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_clear_priority_queue
+  (struct sl_priority_queue* queue)
+{
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+  return sl_clear_vector(queue->vector);
+}
+
+EXPORT_SYM enum sl_error
+sl_priority_queue_set_position_callback
+  (struct sl_priority_queue* queue,
+   void (*func)(const void* data, size_t id, void* context),
+   void* context)
+{
+  char* buffer = NULL;
+  size_t length = 0;
+  size_t id = 0;
+
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+  queue->on_move = func;
+  queue->on_move_context = context;
+  if(func) {
+    buffer = buffer_of(queue, &length);
+    for(id = 0; id < length; ++id)
+      func(buffer + id * queue->data_size, id, context);
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_priority_queue_push
+  (struct sl_priority_queue* queue,
+   const void* data)
+{
+  void* slot = NULL;
+  char* buffer = NULL;
+  size_t length = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!queue || !data)
+    return SL_INVALID_ARGUMENT;
+  /* Copy the data first since it may lie in the buffer of the queue. */
+  memcpy(queue->tmp, data, queue->data_size);
+  err = sl_vector_append_uninit(queue->vector, 1, &slot);
+  if(err != SL_NO_ERROR)
+    return err;
+  buffer = buffer_of(queue, &length);
+  sift_up(queue, buffer, length - 1, queue->tmp);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_priority_queue_pop
+  (struct sl_priority_queue* queue)
+{
+  size_t length = 0;
+
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+  SL(vector_length(queue->vector, &length));
+  if(length == 0)
+    return SL_NO_ERROR;
+  return sl_priority_queue_erase(queue, 0);
+}
+
+EXPORT_SYM enum sl_error
+sl_priority_queue_top
+  (struct sl_priority_queue* queue,
+   void** out_data)
+{
+  return sl_priority_queue_at(queue, 0, out_data);
+}
+
+EXPORT_SYM enum sl_error
+sl_priority_queue_at
+  (struct sl_priority_queue* queue,
+   size_t id,
+   void** out_data)
+{
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+  return sl_vector_at(queue->vector, id, out_data);
+}
+
+EXPORT_SYM enum sl_error
+sl_priority_queue_update
+  (struct sl_priority_queue* queue,
+   size_t id)
+{
+  char* buffer = NULL;
+  size_t length = 0;
+
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+  buffer = buffer_of(queue, &length);
+  if(id >= length)
+    return SL_INVALID_ARGUMENT;
+  memcpy(queue->tmp, buffer + id * queue->data_size, queue->data_size);
+  fix(queue, buffer, length, id, queue->tmp);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_priority_queue_erase
+  (struct sl_priority_queue* queue,
+   size_t id)
+{
+  char* buffer = NULL;
+  size_t length = 0;
+
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+  buffer = buffer_of(queue, &length);
+  if(id >= length)
+    return SL_INVALID_ARGUMENT;
+  /* Fill the hole with the last element. */
+  --length;
+  if(id != length) {
+    memcpy(queue->tmp, buffer + length * queue->data_size, queue->data_size);
+    fix(queue, buffer, length, id, queue->tmp);
+  }
+  SL(vector_pop_back(queue->vector));
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_priority_queue_reserve
+  (struct sl_priority_queue* queue,
+   size_t capacity)
+{
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+  return sl_vector_reserve(queue->vector, capacity);
+}
+
+EXPORT_SYM enum sl_error
+sl_priority_queue_length
+  (struct sl_priority_queue* queue,
+   size_t* out_length)
+{
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+  return sl_vector_length(queue->vector, out_length);
+}
+
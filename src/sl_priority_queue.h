@@ -0,0 +1,109 @@
+#ifndef SL_PRIORITY_QUEUE_H
+#define SL_PRIORITY_QUEUE_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stddef.h>
+
+struct mem_allocator;
+struct sl_vector;
+
+/* Priority queue implemented as a d-ary heap stored in a sl_vector. The top
+ * of the queue is the smallest element with respect to the comparator. A
+ * 4-ary heap is shallower than a binary one and the children of a node lie
+ * in the same cache line for small elements. */
+struct sl_priority_queue;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SL_API enum sl_error
+sl_create_priority_queue
+  (size_t data_size,
+   size_t data_alignment,
+   size_t arity, /* Number of children per node. Must be at least 2. */
+   int (*data_comparator)(const void*, const void*),
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_priority_queue** out_queue);
+
+/* Create a queue whose elements are the ones of the vector, reordered in a
+ * heap in linear time. The queue takes the ownership of the vector that is
+ * freed with the queue. */
+SL_API enum sl_error
+sl_create_priority_queue_from_vector
+  (struct sl_vector* vector,
+   size_t arity, /* Number of children per node. Must be at least 2. */
+   int (*data_comparator)(const void*, const void*),
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_priority_queue** out_queue);
+
+SL_API enum sl_error
+sl_free_priority_queue
+  (struct sl_priority_queue* queue);
+
+SL_API enum sl_error
+sl_clear_priority_queue
+  (struct sl_priority_queue* queue);
+
+/* Define the function invoked each time an element is stored at the position
+ * id of the queue. It lets the caller track the position of its elements in
+ * order to update or erase them. The function is invoked once for each
+ * element already in the queue. */
+SL_API enum sl_error
+sl_priority_queue_set_position_callback
+  (struct sl_priority_queue* queue,
+   void (*func)(const void* data, size_t id, void* context), /* May be NULL. */
+   void* context); /* May be NULL. */
+
+SL_API enum sl_error
+sl_priority_queue_push
+  (struct sl_priority_queue* queue,
+   const void* data);
+
+/* Remove the top element. Does nothing if the queue is empty. */
+SL_API enum sl_error
+sl_priority_queue_pop
+  (struct sl_priority_queue* queue);
+
+SL_API enum sl_error
+sl_priority_queue_top
+  (struct sl_priority_queue* queue,
+   void** out_data);
+
+/* The elements are not sorted; id is a position in the heap as reported by
+ * the position callback. */
+SL_API enum sl_error
+sl_priority_queue_at
+  (struct sl_priority_queue* queue,
+   size_t id,
+   void** out_data);
+
+/* Restore the heap order once the element at the position id was modified in
+ * place, e.g. to decrease or increase its key. */
+SL_API enum sl_error
+sl_priority_queue_update
+  (struct sl_priority_queue* queue,
+   size_t id);
+
+SL_API enum sl_error
+sl_priority_queue_erase
+  (struct sl_priority_queue* queue,
+   size_t id);
+
+SL_API enum sl_error
+sl_priority_queue_reserve
+  (struct sl_priority_queue* queue,
+   size_t capacity);
+
+SL_API enum sl_error
+sl_priority_queue_length
+  (struct sl_priority_queue* queue,
+   size_t* out_length);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_PRIORITY_QUEUE_H */
+
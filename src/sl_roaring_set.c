@@ -0,0 +1,1258 @@
+#include "sl_roaring_set.h"
+#include "sl_bitset.h"
+#include "sl_vector.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ARRAY_MAX 4096 /* Maximum cardinality of an array container. */
+#define BITMAP_NB_BITS 65536
+#define BITMAP_NB_WORDS (BITMAP_NB_BITS / 64)
+#define GALLOP_RATIO 32 /* Size ratio from which a binary search is used. */
+#define SERIAL_MAGIC 0x53524C53u /* "SLRS" in little endian. */
+#define SERIAL_HEADER_SIZE 8 /* Magic and number of containers. */
+#define SERIAL_CONTAINER_SIZE 12 /* Key, type, cardinality and count. */
+
+enum container_type {
+  ARRAY_CONTAINER,
+  BITMAP_CONTAINER,
+  RUN_CONTAINER
+};
+
+struct run {
+  uint16_t start;
+  uint16_t length; /* Number of values minus 1. */
+};
+
+struct container {
+  enum container_type type;
+  uint32_t cardinality;
+  uint16_t key; /* High 16 bits of the values. */
+  struct sl_vector* vector; /* Sorted uint16_t or struct run. May be NULL. */
+  struct sl_bitset* bitmap; /* May be NULL. */
+};
+
+struct sl_roaring_set {
+  struct mem_allocator* allocator;
+  struct sl_vector* containers; /* Sorted by key. */
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE void*
+vector_data(struct sl_vector* vector, size_t* out_length) /* May be NULL. */
+{
+  void* data = NULL;
+  ASSERT(vector);
+  SL(vector_buffer(vector, out_length, NULL, NULL, &data));
+  return data;
+}
+
+static FINLINE uint64_t*
+bitmap_words(const struct container* c)
+{
+  uint64_t* words = NULL;
+  ASSERT(c && c->type == BITMAP_CONTAINER);
+  SL(bitset_buffer(c->bitmap, NULL, &words));
+  return words;
+}
+
+static FINLINE struct container*
+containers_of(struct sl_roaring_set* set, size_t* out_nb) /* May be NULL. */
+{
+  ASSERT(set);
+  return vector_data(set->containers, out_nb);
+}
+
+static FINLINE size_t
+lower_bound_key(const struct container* containers, size_t n, uint16_t key)
+{
+  size_t begin = 0;
+  size_t end = n;
+  while(begin < end) {
+    const size_t mid = begin + (end - begin) / 2;
+    if(containers[mid].key < key) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin;
+}
+
+static FINLINE size_t
+lower_bound_value(const uint16_t* values, size_t n, uint16_t value)
+{
+  size_t begin = 0;
+  size_t end = n;
+  while(begin < end) {
+    const size_t mid = begin + (end - begin) / 2;
+    if(values[mid] < value) {
+      begin = mid + 1;
+    } else {
+      end = mid;
+    }
+  }
+  return begin;
+}
+
+/* Set the bits of the range [first, last]. */
+static void
+set_range(uint64_t* words, uint32_t first, uint32_t last)
+{
+  uint32_t i = first;
+  ASSERT(words && first <= last && last < BITMAP_NB_BITS);
+  while(i <= last) {
+    const uint32_t bit = i % 64;
+    const uint32_t n = MIN(64 - bit, last - i + 1);
+    words[i / 64] |= (n == 64 ? ~0ULL : ((1ULL << n) - 1) << bit);
+    i += n;
+  }
+}
+
+static void
+release_container(struct container* c)
+{
+  ASSERT(c);
+  if(c->vector)
+    SL(free_vector(c->vector));
+  if(c->bitmap)
+    SL(free_bitset(c->bitmap));
+  c->vector = NULL;
+  c->bitmap = NULL;
+}
+
+static enum sl_error
+create_vector
+  (struct sl_roaring_set* set,
+   enum container_type type,
+   size_t length,
+   struct sl_vector** out_vector)
+{
+  struct sl_vector* vector = NULL;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && type != BITMAP_CONTAINER && out_vector);
+
+  if(type == ARRAY_CONTAINER) {
+    err = sl_create_vector
+      (sizeof(uint16_t), ALIGNOF(uint16_t), set->allocator, &vector);
+  } else {
+    err = sl_create_vector
+      (sizeof(struct run), ALIGNOF(struct run), set->allocator, &vector);
+  }
+  if(err == SL_NO_ERROR) {
+    err = sl_vector_resize(vector, length, NULL);
+    if(err != SL_NO_ERROR) {
+      SL(free_vector(vector));
+      vector = NULL;
+    }
+  }
+  *out_vector = vector;
+  return err;
+}
+
+static FINLINE bool
+container_contains(const struct container* c, uint16_t value)
+{
+  const uint16_t* values = NULL;
+  const struct run* runs = NULL;
+  size_t begin = 0;
+  size_t end = 0;
+  size_t n = 0;
+  ASSERT(c);
+
+  switch(c->type) {
+    case ARRAY_CONTAINER:
+      values = vector_data(c->vector, &n);
+      begin = lower_bound_value(values, n, value);
+      return begin < n && values[begin] == value;
+    case BITMAP_CONTAINER:
+      return (bitmap_words(c)[value / 64] >> (value % 64)) & 1;
+    case RUN_CONTAINER:
+      /* Find the last run that starts before the value. */
+      runs = vector_data(c->vector, &n);
+      end = n;
+      while(begin < end) {
+        const size_t mid = begin + (end - begin) / 2;
+        if(runs[mid].start <= value) {
+          begin = mid + 1;
+        } else {
+          end = mid;
+        }
+      }
+      return begin && value - runs[begin-1].start <= runs[begin-1].length;
+    default: ASSERT(0); return false;
+  }
+}
+
+static enum sl_error
+to_bitmap(struct sl_roaring_set* set, struct container* c)
+{
+  struct sl_bitset* bitmap = NULL;
+  uint64_t* words = NULL;
+  size_t n = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && c && c->type != BITMAP_CONTAINER);
+
+  err = sl_create_bitset(BITMAP_NB_BITS, set->allocator, &bitmap);
+  if(err != SL_NO_ERROR)
+    return err;
+  SL(bitset_buffer(bitmap, NULL, &words));
+  if(c->type == ARRAY_CONTAINER) {
+    const uint16_t* values = vector_data(c->vector, &n);
+    for(i = 0; i < n; ++i)
+      words[values[i] / 64] |= 1ULL << (values[i] % 64);
+  } else {
+    const struct run* runs = vector_data(c->vector, &n);
+    for(i = 0; i < n; ++i)
+      set_range(words, runs[i].start, (uint32_t)runs[i].start+runs[i].length);
+  }
+  release_container(c);
+  c->bitmap = bitmap;
+  c->type = BITMAP_CONTAINER;
+  return SL_NO_ERROR;
+}
+
+static enum sl_error
+to_array(struct sl_roaring_set* set, struct container* c)
+{
+  struct sl_vector* vector = NULL;
+  uint16_t* values = NULL;
+  size_t k = 0;
+  size_t n = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && c && c->type != ARRAY_CONTAINER);
+
+  err = create_vector(set, ARRAY_CONTAINER, c->cardinality, &vector);
+  if(err != SL_NO_ERROR)
+    return err;
+  values = vector_data(vector, NULL);
+  if(c->type == BITMAP_CONTAINER) {
+    const uint64_t* words = bitmap_words(c);
+    for(i = 0; i < BITMAP_NB_WORDS; ++i) {
+      uint64_t word = words[i];
+      while(word) {
+        values[k++] = (uint16_t)(i * 64 + (size_t)__builtin_ctzll(word));
+        word &= word - 1;
+      }
+    }
+  } else {
+    const struct run* runs = vector_data(c->vector, &n);
+    for(i = 0; i < n; ++i) {
+      uint32_t v = 0;
+      for(v = runs[i].start; v <= (uint32_t)runs[i].start+runs[i].length; ++v)
+        values[k++] = (uint16_t)v;
+    }
+  }
+  ASSERT(k == c->cardinality);
+  release_container(c);
+  c->vector = vector;
+  c->type = ARRAY_CONTAINER;
+  return SL_NO_ERROR;
+}
+
+/* Append the value to the runs, extending the last run if possible. */
+static FINLINE void
+append_run(struct run* runs, size_t* nb_runs, uint16_t value)
+{
+  struct run* last = *nb_runs ? runs + *nb_runs - 1 : NULL;
+  if(last && (uint32_t)last->start + last->length + 1 == value) {
+    ++last->length;
+  } else {
+    runs[*nb_runs].start = value;
+    runs[*nb_runs].length = 0;
+    ++(*nb_runs);
+  }
+}
+
+static enum sl_error
+to_runs(struct sl_roaring_set* set, struct container* c, size_t nb_runs)
+{
+  const size_t nb_runs_expected = nb_runs;
+  struct sl_vector* vector = NULL;
+  struct run* runs = NULL;
+  size_t n = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && c && c->type != RUN_CONTAINER);
+
+  err = create_vector(set, RUN_CONTAINER, nb_runs, &vector);
+  if(err != SL_NO_ERROR)
+    return err;
+  runs = vector_data(vector, NULL);
+  nb_runs = 0;
+  if(c->type == ARRAY_CONTAINER) {
+    const uint16_t* values = vector_data(c->vector, &n);
+    for(i = 0; i < n; ++i)
+      append_run(runs, &nb_runs, values[i]);
+  } else {
+    const uint64_t* words = bitmap_words(c);
+    for(i = 0; i < BITMAP_NB_WORDS; ++i) {
+      uint64_t word = words[i];
+      while(word) {
+        const size_t bit = (size_t)__builtin_ctzll(word);
+        append_run(runs, &nb_runs, (uint16_t)(i * 64 + bit));
+        word &= word - 1;
+      }
+    }
+  }
+  ASSERT(nb_runs == nb_runs_expected);
+  (void)nb_runs_expected;
+  release_container(c);
+  c->vector = vector;
+  c->type = RUN_CONTAINER;
+  return SL_NO_ERROR;
+}
+
+/* Convert a run container to an array or a bitmap container. */
+static enum sl_error
+to_mutable(struct sl_roaring_set* set, struct container* c)
+{
+  ASSERT(set && c);
+  if(c->type != RUN_CONTAINER)
+    return SL_NO_ERROR;
+  return c->cardinality <= ARRAY_MAX ? to_array(set, c) : to_bitmap(set, c);
+}
+
+static enum sl_error
+copy_container
+  (struct sl_roaring_set* set,
+   const struct container* src,
+   struct container* dst)
+{
+  size_t n = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && src && dst);
+
+  memset(dst, 0, sizeof(struct container));
+  dst->type = src->type;
+  dst->cardinality = src->cardinality;
+  dst->key = src->key;
+  if(src->type == BITMAP_CONTAINER) {
+    err = sl_create_bitset(BITMAP_NB_BITS, set->allocator, &dst->bitmap);
+    if(err != SL_NO_ERROR)
+      return err;
+    memcpy(bitmap_words(dst), bitmap_words(src),
+      BITMAP_NB_WORDS * sizeof(uint64_t));
+  } else {
+    const void* data = vector_data(src->vector, &n);
+    err = create_vector(set, src->type, n, &dst->vector);
+    if(err != SL_NO_ERROR)
+      return err;
+    if(n) {
+      memcpy(vector_data(dst->vector, NULL), data, n *
+        (src->type == ARRAY_CONTAINER ? sizeof(uint16_t) : sizeof(struct run)));
+    }
+  }
+  return SL_NO_ERROR;
+}
+
+static enum sl_error
+container_insert
+  (struct sl_roaring_set* set,
+   struct container* c,
+   uint16_t value)
+{
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && c && !container_contains(c, value));
+
+  err = to_mutable(set, c);
+  if(err != SL_NO_ERROR)
+    return err;
+  if(c->type == ARRAY_CONTAINER && c->cardinality >= ARRAY_MAX) {
+    err = to_bitmap(set, c);
+    if(err != SL_NO_ERROR)
+      return err;
+  }
+  if(c->type == ARRAY_CONTAINER) {
+    size_t n = 0;
+    const uint16_t* values = vector_data(c->vector, &n);
+    err = sl_vector_insert
+      (c->vector, lower_bound_value(values, n, value), &value);
+    if(err != SL_NO_ERROR)
+      return err;
+  } else {
+    bitmap_words(c)[value / 64] |= 1ULL << (value % 64);
+  }
+  ++c->cardinality;
+  return SL_NO_ERROR;
+}
+
+/* Merge the sorted values of a and b in dst and return the number of merged
+ * values. */
+static size_t
+merge_values
+  (const uint16_t* a, size_t na,
+   const uint16_t* b, size_t nb,
+   uint16_t* dst)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  while(i < na && j < nb) {
+    if(a[i] < b[j]) {
+      dst[k++] = a[i++];
+    } else if(a[i] > b[j]) {
+      dst[k++] = b[j++];
+    } else {
+      dst[k++] = a[i++];
+      ++j;
+    }
+  }
+  while(i < na) dst[k++] = a[i++];
+  while(j < nb) dst[k++] = b[j++];
+  return k;
+}
+
+/* Keep in a the values that are also in b and return their number. When b is
+ * much larger than a, the values of a are searched in b. */
+static size_t
+intersect_values(uint16_t* a, size_t na, const uint16_t* b, size_t nb)
+{
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  if(nb / GALLOP_RATIO > na) {
+    for(i = 0; i < na && j < nb; ++i) {
+      j += lower_bound_value(b + j, nb - j, a[i]);
+      if(j < nb && b[j] == a[i])
+        a[k++] = a[i];
+    }
+  } else {
+    while(i < na && j < nb) {
+      if(a[i] < b[j]) {
+        ++i;
+      } else if(a[i] > b[j]) {
+        ++j;
+      } else {
+        a[k++] = a[i++];
+        ++j;
+      }
+    }
+  }
+  return k;
+}
+
+/* d = d | s. s is not a run container. */
+static enum sl_error
+or_container
+  (struct sl_roaring_set* set,
+   struct container* d,
+   const struct container* s)
+{
+  struct container tmp;
+  const uint16_t* values = NULL;
+  uint64_t* words = NULL;
+  size_t count = 0;
+  size_t n = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && d && s && d->type != RUN_CONTAINER);
+  ASSERT(s->type != RUN_CONTAINER);
+
+  if(d->type == BITMAP_CONTAINER && s->type == BITMAP_CONTAINER) {
+    SL(bitset_or(d->bitmap, s->bitmap));
+    SL(bitset_count(d->bitmap, &count));
+    d->cardinality = (uint32_t)count;
+  } else if(d->type == BITMAP_CONTAINER || s->type == BITMAP_CONTAINER) {
+    /* Set the values of the array in a bitmap. */
+    const struct container* array = d->type == ARRAY_CONTAINER ? d : s;
+    if(d->type == ARRAY_CONTAINER) {
+      err = copy_container(set, s, &tmp);
+      if(err != SL_NO_ERROR)
+        return err;
+      tmp.key = d->key;
+    }
+    words = bitmap_words(d->type == ARRAY_CONTAINER ? &tmp : d);
+    values = vector_data(array->vector, &n);
+    count = d->type == ARRAY_CONTAINER ? s->cardinality : d->cardinality;
+    for(i = 0; i < n; ++i) {
+      const uint64_t bit = 1ULL << (values[i] % 64);
+      count += !(words[values[i] / 64] & bit);
+      words[values[i] / 64] |= bit;
+    }
+    if(d->type == ARRAY_CONTAINER) {
+      release_container(d);
+      *d = tmp;
+    }
+    d->cardinality = (uint32_t)count;
+  } else {
+    size_t nd = 0;
+    size_t ns = 0;
+    const uint16_t* vd = vector_data(d->vector, &nd);
+    const uint16_t* vs = vector_data(s->vector, &ns);
+    memset(&tmp, 0, sizeof(tmp));
+    tmp.type = ARRAY_CONTAINER;
+    tmp.key = d->key;
+    err = create_vector(set, ARRAY_CONTAINER, nd + ns, &tmp.vector);
+    if(err != SL_NO_ERROR)
+      return err;
+    count = merge_values(vd, nd, vs, ns, vector_data(tmp.vector, NULL));
+    SL(vector_resize(tmp.vector, count, NULL));
+    tmp.cardinality = (uint32_t)count;
+    if(count > ARRAY_MAX) {
+      err = to_bitmap(set, &tmp);
+      if(err != SL_NO_ERROR) {
+        release_container(&tmp);
+        return err;
+      }
+    }
+    release_container(d);
+    *d = tmp;
+  }
+  return SL_NO_ERROR;
+}
+
+/* d = d & s. s is not a run container. On error, d is not modified. */
+static enum sl_error
+and_container
+  (struct sl_roaring_set* set,
+   struct container* d,
+   const struct container* s)
+{
+  struct sl_vector* vector = NULL;
+  const uint64_t* words = NULL;
+  uint16_t* values = NULL;
+  size_t count = 0;
+  size_t n = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && d && s && d->type != RUN_CONTAINER);
+  ASSERT(s->type != RUN_CONTAINER);
+
+  if(d->type == BITMAP_CONTAINER && s->type == BITMAP_CONTAINER) {
+    SL(bitset_and(d->bitmap, s->bitmap));
+    SL(bitset_count(d->bitmap, &count));
+    d->cardinality = (uint32_t)count;
+    /* Keep the bitmap if the conversion fails. */
+    if(count && count <= ARRAY_MAX)
+      to_array(set, d);
+  } else if(d->type == BITMAP_CONTAINER) {
+    /* Keep the values of the array of s that are set in d. */
+    const uint16_t* src = vector_data(s->vector, &n);
+    err = create_vector(set, ARRAY_CONTAINER, n, &vector);
+    if(err != SL_NO_ERROR)
+      return err;
+    values = vector_data(vector, NULL);
+    words = bitmap_words(d);
+    for(i = 0; i < n; ++i) {
+      values[count] = src[i];
+      count += (words[src[i] / 64] >> (src[i] % 64)) & 1;
+    }
+    SL(vector_resize(vector, count, NULL));
+    release_container(d);
+    d->vector = vector;
+    d->type = ARRAY_CONTAINER;
+    d->cardinality = (uint32_t)count;
+  } else if(s->type == BITMAP_CONTAINER) {
+    /* Filter the values of d in place. */
+    values = vector_data(d->vector, &n);
+    words = bitmap_words(s);
+    for(i = 0; i < n; ++i) {
+      values[count] = values[i];
+      count += (words[values[i] / 64] >> (values[i] % 64)) & 1;
+    }
+    SL(vector_resize(d->vector, count, NULL));
+    d->cardinality = (uint32_t)count;
+  } else {
+    size_t ns = 0;
+    const uint16_t* vs = vector_data(s->vector, &ns);
+    values = vector_data(d->vector, &n);
+    count = intersect_values(values, n, vs, ns);
+    SL(vector_resize(d->vector, count, NULL));
+    d->cardinality = (uint32_t)count;
+  }
+  return SL_NO_ERROR;
+}
+
+/* Number of runs of consecutive values in the container. */
+static size_t
+count_runs(const struct container* c)
+{
+  size_t nb_runs = 0;
+  size_t n = 0;
+  size_t i = 0;
+  ASSERT(c);
+
+  if(c->type == ARRAY_CONTAINER) {
+    const uint16_t* values = vector_data(c->vector, &n);
+    for(i = 0; i < n; ++i)
+      nb_runs += !i || values[i] != values[i - 1] + 1;
+  } else if(c->type == BITMAP_CONTAINER) {
+    /* A run starts at each set bit whose previous bit is not set. */
+    const uint64_t* words = bitmap_words(c);
+    uint64_t carry = 0;
+    for(i = 0; i < BITMAP_NB_WORDS; ++i) {
+      const uint64_t starts = words[i] & ~((words[i] << 1) | carry);
+      nb_runs += (size_t)__builtin_popcountll(starts);
+      carry = words[i] >> 63;
+    }
+  } else {
+    SL(vector_length(c->vector, &nb_runs));
+  }
+  return nb_runs;
+}
+
+static FINLINE void
+put_u16(unsigned char** p, uint16_t v)
+{
+  (*p)[0] = (unsigned char)(v & 0xFF);
+  (*p)[1] = (unsigned char)(v >> 8);
+  *p += 2;
+}
+
+static FINLINE void
+put_u32(unsigned char** p, uint32_t v)
+{
+  put_u16(p, (uint16_t)(v & 0xFFFF));
+  put_u16(p, (uint16_t)(v >> 16));
+}
+
+static FINLINE void
+put_u64(unsigned char** p, uint64_t v)
+{
+  put_u32(p, (uint32_t)(v & 0xFFFFFFFF));
+  put_u32(p, (uint32_t)(v >> 32));
+}
+
+static FINLINE uint16_t
+get_u16(const unsigned char** p)
+{
+  const uint16_t v = (uint16_t)((*p)[0] | (*p)[1] << 8);
+  *p += 2;
+  return v;
+}
+
+static FINLINE uint32_t
+get_u32(const unsigned char** p)
+{
+  const uint32_t lo = get_u16(p);
+  return lo | (uint32_t)get_u16(p) << 16;
+}
+
+static FINLINE uint64_t
+get_u64(const unsigned char** p)
+{
+  const uint64_t lo = get_u32(p);
+  return lo | (uint64_t)get_u32(p) << 32;
+}
+
+static FINLINE size_t
+payload_size(const struct container* c, size_t* out_count)
+{
+  size_t n = BITMAP_NB_WORDS;
+  ASSERT(c && out_count);
+  if(c->type != BITMAP_CONTAINER)
+    SL(vector_length(c->vector, &n));
+  *out_count = n;
+  switch(c->type) {
+    case ARRAY_CONTAINER: return n * 2;
+    case BITMAP_CONTAINER: return n * 8;
+    case RUN_CONTAINER: return n * 4;
+    default: ASSERT(0); return 0;
+  }
+}
+
+/* Read a container from the serialized data; p points past the container
+ * header. Return SL_INVALID_ARGUMENT if the data are inconsistent. */
+static enum sl_error
+read_container
+  (struct sl_roaring_set* set,
+   const unsigned char* p,
+   size_t count,
+   struct container* c)
+{
+  size_t i = 0;
+  size_t card = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(set && p && c);
+
+  if(c->type == BITMAP_CONTAINER) {
+    uint64_t* words = NULL;
+    if(count != BITMAP_NB_WORDS)
+      return SL_INVALID_ARGUMENT;
+    err = sl_create_bitset(BITMAP_NB_BITS, set->allocator, &c->bitmap);
+    if(err != SL_NO_ERROR)
+      return err;
+    words = bitmap_words(c);
+    for(i = 0; i < count; ++i) {
+      words[i] = get_u64(&p);
+      card += (size_t)__builtin_popcountll(words[i]);
+    }
+  } else if(c->type == ARRAY_CONTAINER) {
+    uint16_t* values = NULL;
+    if(!count || count > ARRAY_MAX)
+      return SL_INVALID_ARGUMENT;
+    err = create_vector(set, ARRAY_CONTAINER, count, &c->vector);
+    if(err != SL_NO_ERROR)
+      return err;
+    values = vector_data(c->vector, NULL);
+    for(i = 0; i < count; ++i) {
+      values[i] = get_u16(&p);
+      if(i && values[i] <= values[i - 1])
+        return SL_INVALID_ARGUMENT;
+    }
+    card = count;
+  } else if(c->type == RUN_CONTAINER) {
+    struct run* runs = NULL;
+    if(!count)
+      return SL_INVALID_ARGUMENT;
+    err = create_vector(set, RUN_CONTAINER, count, &c->vector);
+    if(err != SL_NO_ERROR)
+      return err;
+    runs = vector_data(c->vector, NULL);
+    for(i = 0; i < count; ++i) {
+      runs[i].start = get_u16(&p);
+      runs[i].length = get_u16(&p);
+      if((uint32_t)runs[i].start + runs[i].length >= BITMAP_NB_BITS
+      || (i && runs[i].start <= (uint32_t)runs[i-1].start+runs[i-1].length+1))
+        return SL_INVALID_ARGUMENT;
+      card += (size_t)runs[i].length + 1;
+    }
+  } else {
+    return SL_INVALID_ARGUMENT;
+  }
+  return card && card == c->cardinality ? SL_NO_ERROR : SL_INVALID_ARGUMENT;
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the roaring set functions.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_roaring_set
+  (struct mem_allocator* specific_allocator,
+   struct sl_roaring_set** out_set)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_roaring_set* set = NULL;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!out_set) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  set = MEM_CALLOC(allocator, 1, sizeof(struct sl_roaring_set));
+  if(!set) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  set->allocator = allocator;
+  err = sl_create_vector(sizeof(struct container), ALIGNOF(struct container),
+    allocator, &set->containers);
+  if(err != SL_NO_ERROR)
+    goto error;
+
+exit:
+  if(out_set)
+    *out_set = set;
+  return err;
+
+error:
+  if(set) {
+    MEM_FREE(allocator, set);
+    set = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_roaring_set
+  (struct sl_roaring_set* set)
+{
+  if(!set)
+    return SL_INVALID_ARGUMENT;
+  SL(clear_roaring_set(set));
+  SL(free_vector(set->containers));
+  MEM_FREE(set->allocator, set);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_clear_roaring_set
+  (struct sl_roaring_set* set)
+{
+  struct container* containers = NULL;
+  size_t n = 0;
+  size_t i = 0;
+
+  if(!set)
+    return SL_INVALID_ARGUMENT;
+  containers = containers_of(set, &n);
+  for(i = 0; i < n; ++i)
+    release_container(containers + i);
+  return sl_clear_vector(set->containers);
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_insert
+  (struct sl_roaring_set* set,
+   uint32_t value,
+   bool* out_is_inserted)
+{
+  const uint16_t key = (uint16_t)(value >> 16);
+  const uint16_t low = (uint16_t)(value & 0xFFFF);
+  struct container* containers = NULL;
+  struct container c;
+  size_t n = 0;
+  size_t id = 0;
+  bool is_inserted = false;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!set)
+    return SL_INVALID_ARGUMENT;
+  containers = containers_of(set, &n);
+  id = lower_bound_key(containers, n, key);
+  if(id < n && containers[id].key == key) {
+    if(!container_contains(containers + id, low)) {
+      err = container_insert(set, containers + id, low);
+      is_inserted = err == SL_NO_ERROR;
+    }
+  } else {
+    memset(&c, 0, sizeof(c));
+    c.type = ARRAY_CONTAINER;
+    c.cardinality = 1;
+    c.key = key;
+    err = create_vector(set, ARRAY_CONTAINER, 1, &c.vector);
+    if(err == SL_NO_ERROR) {
+      *(uint16_t*)vector_data(c.vector, NULL) = low;
+      err = sl_vector_insert(set->containers, id, &c);
+      if(err != SL_NO_ERROR)
+        release_container(&c);
+    }
+    is_inserted = err == SL_NO_ERROR;
+  }
+  if(out_is_inserted)
+    *out_is_inserted = is_inserted;
+  return err;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_erase
+  (struct sl_roaring_set* set,
+   uint32_t value,
+   bool* out_is_erased)
+{
+  const uint16_t key = (uint16_t)(value >> 16);
+  const uint16_t low = (uint16_t)(value & 0xFFFF);
+  struct container* containers = NULL;
+  struct container* c = NULL;
+  size_t n = 0;
+  size_t id = 0;
+  bool is_erased = false;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!set)
+    return SL_INVALID_ARGUMENT;
+  containers = containers_of(set, &n);
+  id = lower_bound_key(containers, n, key);
+  if(id == n || containers[id].key != key
+  || !container_contains(containers + id, low))
+    goto exit;
+
+  c = containers + id;
+  err = to_mutable(set, c);
+  if(err != SL_NO_ERROR)
+    goto exit;
+  if(c->type == ARRAY_CONTAINER) {
+    const uint16_t* values = vector_data(c->vector, &n);
+    SL(vector_erase(c->vector, lower_bound_value(values, n, low)));
+  } else {
+    bitmap_words(c)[low / 64] &= ~(1ULL << (low % 64));
+  }
+  is_erased = true;
+  --c->cardinality;
+  if(!c->cardinality) {
+    release_container(c);
+    SL(vector_erase(set->containers, id));
+  } else if(c->type == BITMAP_CONTAINER && c->cardinality <= ARRAY_MAX) {
+    /* Keep the bitmap if the conversion fails. */
+    to_array(set, c);
+  }
+
+exit:
+  if(out_is_erased)
+    *out_is_erased = is_erased;
+  return err;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_contains
+  (struct sl_roaring_set* set,
+   uint32_t value,
+   bool* out_is_contained)
+{
+  const uint16_t key = (uint16_t)(value >> 16);
+  struct container* containers = NULL;
+  size_t n = 0;
+  size_t id = 0;
+
+  if(!set || !out_is_contained)
+    return SL_INVALID_ARGUMENT;
+  containers = containers_of(set, &n);
+  id = lower_bound_key(containers, n, key);
+  *out_is_contained = id < n && containers[id].key == key
+    && container_contains(containers + id, (uint16_t)(value & 0xFFFF));
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_cardinality
+  (struct sl_roaring_set* set,
+   size_t* out_cardinality)
+{
+  const struct container* containers = NULL;
+  size_t card = 0;
+  size_t n = 0;
+  size_t i = 0;
+
+  if(!set || !out_cardinality)
+    return SL_INVALID_ARGUMENT;
+  containers = containers_of(set, &n);
+  for(i = 0; i < n; ++i)
+    card += containers[i].cardinality;
+  *out_cardinality = card;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_to_array
+  (struct sl_roaring_set* set,
+   uint32_t* dst)
+{
+  const struct container* containers = NULL;
+  size_t n = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+
+  if(!set || !dst)
+    return SL_INVALID_ARGUMENT;
+  containers = containers_of(set, &n);
+  for(i = 0; i < n; ++i) {
+    const struct container* c = containers + i;
+    const uint32_t high = (uint32_t)c->key << 16;
+    size_t len = 0;
+    if(c->type == ARRAY_CONTAINER) {
+      const uint16_t* values = vector_data(c->vector, &len);
+      for(j = 0; j < len; ++j)
+        dst[k++] = high | values[j];
+    } else if(c->type == BITMAP_CONTAINER) {
+      const uint64_t* words = bitmap_words(c);
+      for(j = 0; j < BITMAP_NB_WORDS; ++j) {
+        uint64_t word = words[j];
+        while(word) {
+          dst[k++] = high | (uint32_t)(j * 64 + (size_t)__builtin_ctzll(word));
+          word &= word - 1;
+        }
+      }
+    } else {
+      const struct run* runs = vector_data(c->vector, &len);
+      for(j = 0; j < len; ++j) {
+        uint32_t v = 0;
+        for(v = runs[j].start; v <= (uint32_t)runs[j].start+runs[j].length; ++v)
+          dst[k++] = high | v;
+      }
+    }
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_or
+  (struct sl_roaring_set* dst,
+   struct sl_roaring_set* src)
+{
+  struct container* dst_containers = NULL;
+  const struct container* src_containers = NULL;
+  size_t nb_dst = 0;
+  size_t nb_src = 0;
+  size_t id = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!dst || !src)
+    return SL_INVALID_ARGUMENT;
+  if(dst == src)
+    return SL_NO_ERROR;
+  src_containers = containers_of(src, &nb_src);
+  for(i = 0; i < nb_src && err == SL_NO_ERROR; ++i) {
+    const struct container* s = src_containers + i;
+    struct container tmp;
+    bool is_tmp = false;
+
+    /* The keys of src are sorted: search from the previous position. */
+    dst_containers = containers_of(dst, &nb_dst);
+    id += lower_bound_key(dst_containers + id, nb_dst - id, s->key);
+    if(id == nb_dst || dst_containers[id].key != s->key) {
+      err = copy_container(dst, s, &tmp);
+      if(err == SL_NO_ERROR) {
+        err = sl_vector_insert(dst->containers, id, &tmp);
+        if(err != SL_NO_ERROR)
+          release_container(&tmp);
+      } else {
+        release_container(&tmp);
+      }
+    } else {
+      if(s->type == RUN_CONTAINER) {
+        err = copy_container(dst, s, &tmp);
+        is_tmp = true;
+        if(err == SL_NO_ERROR)
+          err = to_mutable(dst, &tmp);
+        s = &tmp;
+      }
+      if(err == SL_NO_ERROR)
+        err = to_mutable(dst, dst_containers + id);
+      if(err == SL_NO_ERROR)
+        err = or_container(dst, dst_containers + id, s);
+      if(is_tmp)
+        release_container(&tmp);
+    }
+    ++id;
+  }
+  return err;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_and
+  (struct sl_roaring_set* dst,
+   struct sl_roaring_set* src)
+{
+  struct container* dst_containers = NULL;
+  const struct container* src_containers = NULL;
+  size_t nb_dst = 0;
+  size_t nb_src = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t k = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!dst || !src)
+    return SL_INVALID_ARGUMENT;
+  if(dst == src)
+    return SL_NO_ERROR;
+  dst_containers = containers_of(dst, &nb_dst);
+  src_containers = containers_of(src, &nb_src);
+  for(i = 0; i < nb_dst; ++i) {
+    struct container* d = dst_containers + i;
+    if(err == SL_NO_ERROR) {
+      const struct container* s = NULL;
+      struct container tmp;
+      bool is_tmp = false;
+
+      while(j < nb_src && src_containers[j].key < d->key)
+        ++j;
+      if(j == nb_src || src_containers[j].key != d->key) {
+        release_container(d);
+        continue;
+      }
+      s = src_containers + j;
+      if(s->type == RUN_CONTAINER) {
+        err = copy_container(dst, s, &tmp);
+        is_tmp = true;
+        if(err == SL_NO_ERROR)
+          err = to_mutable(dst, &tmp);
+        s = &tmp;
+      }
+      if(err == SL_NO_ERROR)
+        err = to_mutable(dst, d);
+      if(err == SL_NO_ERROR)
+        err = and_container(dst, d, s);
+      if(is_tmp)
+        release_container(&tmp);
+      if(err == SL_NO_ERROR && !d->cardinality) {
+        release_container(d);
+        continue;
+      }
+    }
+    dst_containers[k++] = *d;
+  }
+  SL(vector_resize(dst->containers, k, NULL));
+  return err;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_optimize
+  (struct sl_roaring_set* set)
+{
+  struct container* containers = NULL;
+  size_t n = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!set)
+    return SL_INVALID_ARGUMENT;
+  containers = containers_of(set, &n);
+  for(i = 0; i < n && err == SL_NO_ERROR; ++i) {
+    struct container* c = containers + i;
+    const size_t nb_runs = count_runs(c);
+    const size_t run_size = nb_runs * sizeof(struct run);
+    const size_t array_size = c->cardinality * sizeof(uint16_t);
+    const size_t bitmap_size = BITMAP_NB_WORDS * sizeof(uint64_t);
+
+    if(run_size < MIN(array_size, bitmap_size)) {
+      if(c->type != RUN_CONTAINER)
+        err = to_runs(set, c, nb_runs);
+    } else if(c->cardinality <= ARRAY_MAX) {
+      if(c->type != ARRAY_CONTAINER)
+        err = to_array(set, c);
+    } else if(c->type != BITMAP_CONTAINER) {
+      err = to_bitmap(set, c);
+    }
+    if(err == SL_NO_ERROR && c->vector)
+      err = sl_vector_shrink_to_fit(c->vector);
+  }
+  if(err == SL_NO_ERROR)
+    err = sl_vector_shrink_to_fit(set->containers);
+  return err;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_serialized_size
+  (struct sl_roaring_set* set,
+   size_t* out_size)
+{
+  const struct container* containers = NULL;
+  size_t size = SERIAL_HEADER_SIZE;
+  size_t count = 0;
+  size_t n = 0;
+  size_t i = 0;
+
+  if(!set || !out_size)
+    return SL_INVALID_ARGUMENT;
+  containers = containers_of(set, &n);
+  for(i = 0; i < n; ++i)
+    size += SERIAL_CONTAINER_SIZE + payload_size(containers + i, &count);
+  *out_size = size;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_serialize
+  (struct sl_roaring_set* set,
+   size_t size,
+   void* buffer)
+{
+  const struct container* containers = NULL;
+  unsigned char* p = buffer;
+  size_t required_size = 0;
+  size_t n = 0;
+  size_t i = 0;
+  size_t j = 0;
+
+  if(!set || !buffer)
+    return SL_INVALID_ARGUMENT;
+  SL(roaring_set_serialized_size(set, &required_size));
+  if(size < required_size)
+    return SL_INVALID_ARGUMENT;
+
+  containers = containers_of(set, &n);
+  put_u32(&p, SERIAL_MAGIC);
+  put_u32(&p, (uint32_t)n);
+  for(i = 0; i < n; ++i) {
+    const struct container* c = containers + i;
+    size_t count = 0;
+    payload_size(c, &count);
+    put_u16(&p, c->key);
+    put_u16(&p, (uint16_t)c->type);
+    put_u32(&p, c->cardinality);
+    put_u32(&p, (uint32_t)count);
+    if(c->type == ARRAY_CONTAINER) {
+      const uint16_t* values = vector_data(c->vector, NULL);
+      for(j = 0; j < count; ++j)
+        put_u16(&p, values[j]);
+    } else if(c->type == BITMAP_CONTAINER) {
+      const uint64_t* words = bitmap_words(c);
+      for(j = 0; j < count; ++j)
+        put_u64(&p, words[j]);
+    } else {
+      const struct run* runs = vector_data(c->vector, NULL);
+      for(j = 0; j < count; ++j) {
+        put_u16(&p, runs[j].start);
+        put_u16(&p, runs[j].length);
+      }
+    }
+  }
+  ASSERT((size_t)(p - (unsigned char*)buffer) == required_size);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_roaring_set_deserialize
+  (struct sl_roaring_set* set,
+   size_t size,
+   const void* buffer)
+{
+  const unsigned char* p = buffer;
+  const unsigned char* end = NULL;
+  uint32_t nb_containers = 0;
+  uint32_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!set || !buffer)
+    return SL_INVALID_ARGUMENT;
+  SL(clear_roaring_set(set));
+  end = p + size;
+  if(size < SERIAL_HEADER_SIZE || get_u32(&p) != SERIAL_MAGIC) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  nb_containers = get_u32(&p);
+  for(i = 0; i < nb_containers; ++i) {
+    struct container c;
+    size_t count = 0;
+    size_t payload = 0;
+    struct container* prev = NULL;
+    size_t n = 0;
+
+    if((size_t)(end - p) < SERIAL_CONTAINER_SIZE) {
+      err = SL_INVALID_ARGUMENT;
+      goto error;
+    }
+    memset(&c, 0, sizeof(c));
+    c.key = get_u16(&p);
+    c.type = (enum container_type)get_u16(&p);
+    c.cardinality = get_u32(&p);
+    count = get_u32(&p);
+    switch(c.type) {
+      case ARRAY_CONTAINER: payload = count * 2; break;
+      case BITMAP_CONTAINER: payload = count * 8; break;
+      case RUN_CONTAINER: payload = count * 4; break;
+      default: err = SL_INVALID_ARGUMENT; goto error;
+    }
+    prev = containers_of(set, &n);
+    if(count > BITMAP_NB_BITS || (size_t)(end - p) < payload
+    || (n && prev[n - 1].key >= c.key)) {
+      err = SL_INVALID_ARGUMENT;
+      goto error;
+    }
+    err = read_container(set, p, count, &c);
+    if(err == SL_NO_ERROR)
+      err = sl_vector_push_back(set->containers, &c);
+    if(err != SL_NO_ERROR) {
+      release_container(&c);
+      goto error;
+    }
+    p += payload;
+  }
+  if(p != end) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+
+exit:
+  return err;
+
+error:
+  SL(clear_roaring_set(set));
+  goto exit;
+}
+
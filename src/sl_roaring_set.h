@@ -0,0 +1,114 @@
+#ifndef SL_ROARING_SET_H
+#define SL_ROARING_SET_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct mem_allocator;
+
+/* Compressed set of 32 bits integers. The values are partitioned with respect
+ * to their 16 high bits into containers that store their 16 low bits:
+ * - an array container stores up to 4096 sorted values;
+ * - a bitmap container is a sl_bitset of 2^16 bits, used for denser sets;
+ * - a run container stores sorted intervals of consecutive values.
+ * Run containers are only created by sl_roaring_set_optimize; a run container
+ * that is modified is first converted to an array or a bitmap container. */
+struct sl_roaring_set;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SL_API enum sl_error
+sl_create_roaring_set
+  (struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_roaring_set** out_set);
+
+SL_API enum sl_error
+sl_free_roaring_set
+  (struct sl_roaring_set* set);
+
+SL_API enum sl_error
+sl_clear_roaring_set
+  (struct sl_roaring_set* set);
+
+SL_API enum sl_error
+sl_roaring_set_insert
+  (struct sl_roaring_set* set,
+   uint32_t value,
+   bool* out_is_inserted); /* May be NULL. False if value was in the set. */
+
+SL_API enum sl_error
+sl_roaring_set_erase
+  (struct sl_roaring_set* set,
+   uint32_t value,
+   bool* out_is_erased); /* May be NULL. False if value was not in the set. */
+
+SL_API enum sl_error
+sl_roaring_set_contains
+  (struct sl_roaring_set* set,
+   uint32_t value,
+   bool* out_is_contained);
+
+SL_API enum sl_error
+sl_roaring_set_cardinality
+  (struct sl_roaring_set* set,
+   size_t* out_cardinality);
+
+/* Write the values of the set in ascending order. The values array must store
+ * at least cardinality values. */
+SL_API enum sl_error
+sl_roaring_set_to_array
+  (struct sl_roaring_set* set,
+   uint32_t* values);
+
+/* dst = dst | src. The union of two bitmap containers uses the sl_bitset
+ * kernels. */
+SL_API enum sl_error
+sl_roaring_set_or
+  (struct sl_roaring_set* dst,
+   struct sl_roaring_set* src);
+
+/* dst = dst & src. */
+SL_API enum sl_error
+sl_roaring_set_and
+  (struct sl_roaring_set* dst,
+   struct sl_roaring_set* src);
+
+/* Convert each container in its most compact representation and release the
+ * unused memory. */
+SL_API enum sl_error
+sl_roaring_set_optimize
+  (struct sl_roaring_set* set);
+
+SL_API enum sl_error
+sl_roaring_set_serialized_size
+  (struct sl_roaring_set* set,
+   size_t* out_size);
+
+/* Write the set in a portable little endian format. The buffer must store at
+ * least the serialized size of the set. */
+SL_API enum sl_error
+sl_roaring_set_serialize
+  (struct sl_roaring_set* set,
+   size_t size,
+   void* buffer);
+
+/* Replace the values of the set by the ones of a serialized set. Return
+ * SL_INVALID_ARGUMENT and clear the set if the buffer is not a valid
+ * serialized set. */
+SL_API enum sl_error
+sl_roaring_set_deserialize
+  (struct sl_roaring_set* set,
+   size_t size,
+   const void* buffer);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_ROARING_SET_H */
+
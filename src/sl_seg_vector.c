@@ -0,0 +1,318 @@
+#include "sl_seg_vector.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct sl_seg_vector {
+  struct mem_allocator* allocator;
+  size_t data_size;
+  size_t data_alignment;
+  size_t chunk_shift; /* Log2 of the number of elements per chunk. */
+  size_t length;
+  size_t nb_chunks; /* Number of allocated chunks. */
+  size_t max_nb_chunks; /* Capacity of the chunk directory. */
+  void** chunks; /* Chunk directory. */
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE void*
+element(const struct sl_seg_vector* vec, size_t id)
+{
+  size_t chunk_mask = 0;
+  ASSERT(vec && (id >> vec->chunk_shift) < vec->nb_chunks);
+  chunk_mask = ((size_t)1 << vec->chunk_shift) - 1;
+  return (void*)
+    ((uintptr_t)vec->chunks[id >> vec->chunk_shift]
+     + (id & chunk_mask) * vec->data_size);
+}
+
+/* Allocate the chunks required to store `capacity' elements. Already allocated
+ * chunks are never moved; only the chunk directory may be reallocated. */
+static enum sl_error
+ensure_allocated(struct sl_seg_vector* vec, size_t capacity)
+{
+  void** chunks = NULL;
+  size_t nb_chunks = 0;
+  size_t chunk_bytes = 0;
+  enum sl_error err = SL_NO_ERROR;
+  ASSERT(vec);
+
+  nb_chunks = (capacity >> vec->chunk_shift)
+    + ((capacity & (((size_t)1 << vec->chunk_shift) - 1)) != 0);
+  if(nb_chunks <= vec->nb_chunks)
+    goto exit;
+
+  if(nb_chunks > vec->max_nb_chunks) {
+    size_t max_nb_chunks = MAX(vec->max_nb_chunks, 1);
+    while(max_nb_chunks < nb_chunks) {
+      if(max_nb_chunks > SIZE_MAX / 2) {
+        err = SL_OVERFLOW_ERROR;
+        goto error;
+      }
+      max_nb_chunks *= 2;
+    }
+    if(max_nb_chunks > SIZE_MAX / sizeof(void*)) {
+      err = SL_OVERFLOW_ERROR;
+      goto error;
+    }
+    chunks = MEM_ALLOC(vec->allocator, max_nb_chunks * sizeof(void*));
+    if(!chunks) {
+      err = SL_MEMORY_ERROR;
+      goto error;
+    }
+    if(vec->nb_chunks)
+      memcpy(chunks, vec->chunks, vec->nb_chunks * sizeof(void*));
+    if(vec->chunks)
+      MEM_FREE(vec->allocator, vec->chunks);
+    vec->chunks = chunks;
+    vec->max_nb_chunks = max_nb_chunks;
+    chunks = NULL;
+  }
+  chunk_bytes = ((size_t)1 << vec->chunk_shift) * vec->data_size;
+  while(vec->nb_chunks < nb_chunks) {
+    void* chunk = MEM_ALIGNED_ALLOC
+      (vec->allocator, chunk_bytes, vec->data_alignment);
+    if(!chunk) {
+      err = SL_MEMORY_ERROR;
+      goto error;
+    }
+    vec->chunks[vec->nb_chunks] = chunk;
+    ++vec->nb_chunks;
+  }
+
+exit:
+  return err;
+error:
+  /* The successfully allocated chunks are kept; they are valid capacity. */
+  goto exit;
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the segmented vector container.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_seg_vector
+  (size_t data_size,
+   size_t data_alignment,
+   size_t chunk_length,
+   struct mem_allocator* specific_allocator,
+   struct sl_seg_vector** out_vec)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_seg_vector* vec = NULL;
+  size_t chunk_shift = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!out_vec || !data_size || !IS_POWER_OF_2(chunk_length)) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(!IS_POWER_OF_2(data_alignment)) {
+    err = SL_ALIGNMENT_ERROR;
+    goto error;
+  }
+  if(chunk_length > SIZE_MAX / data_size) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  vec = MEM_CALLOC(allocator, 1, sizeof(struct sl_seg_vector));
+  if(vec == NULL) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  while(((size_t)1 << chunk_shift) < chunk_length)
+    ++chunk_shift;
+  vec->allocator = allocator;
+  vec->data_size = data_size;
+  vec->data_alignment = data_alignment;
+  vec->chunk_shift = chunk_shift;
+
+exit:
+  if(out_vec)
+    *out_vec = vec;
+  return err;
+
+error:
+  if(vec) {
+    ASSERT(allocator);
+    MEM_FREE(allocator, vec);
+    vec = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_seg_vector
+  (struct sl_seg_vector* vec)
+{
+  struct mem_allocator* allocator = NULL;
+  size_t i = 0;
+
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+
+  allocator = vec->allocator;
+  for(i = 0; i < vec->nb_chunks; ++i)
+    MEM_FREE(allocator, vec->chunks[i]);
+  if(vec->chunks)
+    MEM_FREE(allocator, vec->chunks);
+  MEM_FREE(allocator, vec);
+
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_clear_seg_vector
+  (struct sl_seg_vector* vec)
+{
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+  vec->length = 0;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_seg_vector_push_back
+  (struct sl_seg_vector* vec,
+   const void* data)
+{
+  void* dst = NULL;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!vec || !data)
+    return SL_INVALID_ARGUMENT;
+  if(!IS_ALIGNED(data, vec->data_alignment))
+    return SL_ALIGNMENT_ERROR;
+  /* The elements are never moved, i.e. data remains valid even though it
+   * lies in the vector. */
+  err = sl_seg_vector_emplace_back(vec, &dst);
+  if(err != SL_NO_ERROR)
+    return err;
+  memcpy(dst, data, vec->data_size);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_seg_vector_emplace_back
+  (struct sl_seg_vector* vec,
+   void** data)
+{
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!vec || !data) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(vec->length == SIZE_MAX) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  err = ensure_allocated(vec, vec->length + 1);
+  if(err != SL_NO_ERROR)
+    goto error;
+  *data = element(vec, vec->length);
+  ++vec->length;
+
+exit:
+  return err;
+error:
+  if(data)
+    *data = NULL;
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_seg_vector_pop_back
+  (struct sl_seg_vector* vec)
+{
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+  vec->length -= (vec->length != 0);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_seg_vector_reserve
+  (struct sl_seg_vector* vec,
+   size_t capacity)
+{
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+  return ensure_allocated(vec, capacity);
+}
+
+EXPORT_SYM enum sl_error
+sl_seg_vector_capacity
+  (struct sl_seg_vector* vec,
+   size_t* capacity)
+{
+  if(!vec || !capacity)
+    return SL_INVALID_ARGUMENT;
+  *capacity = vec->nb_chunks << vec->chunk_shift;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_seg_vector_at
+  (struct sl_seg_vector* vec,
+   size_t id,
+   void** data)
+{
+  if(!vec || (id >= vec->length) || !data)
+    return SL_INVALID_ARGUMENT;
+  *data = element(vec, id);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_seg_vector_length
+  (struct sl_seg_vector* vec,
+   size_t* length)
+{
+  if(!vec || !length)
+    return SL_INVALID_ARGUMENT;
+  *length = vec->length;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_seg_vector_chunk_count
+  (struct sl_seg_vector* vec,
+   size_t* nb_chunks)
+{
+  if(!vec || !nb_chunks)
+    return SL_INVALID_ARGUMENT;
+  *nb_chunks = (vec->length >> vec->chunk_shift)
+    + ((vec->length & (((size_t)1 << vec->chunk_shift) - 1)) != 0);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_seg_vector_chunk
+  (struct sl_seg_vector* vec,
+   size_t chunk_id,
+   size_t* length,
+   void** buffer)
+{
+  size_t first = 0;
+
+  if(!vec || !buffer)
+    return SL_INVALID_ARGUMENT;
+  first = chunk_id << vec->chunk_shift;
+  if((first >> vec->chunk_shift) != chunk_id || first >= vec->length)
+    return SL_INVALID_ARGUMENT;
+  if(length)
+    *length = MIN(vec->length - first, (size_t)1 << vec->chunk_shift);
+  *buffer = vec->chunks[chunk_id];
+  return SL_NO_ERROR;
+}
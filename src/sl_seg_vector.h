@@ -0,0 +1,93 @@
+#ifndef SL_SEG_VECTOR_H
+#define SL_SEG_VECTOR_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stddef.h>
+
+struct mem_allocator;
+
+/* Segmented vector. The elements are stored in fixed size chunks referenced by
+ * a chunk directory. The growth of the vector never moves its elements, i.e.
+ * the address of an element remains valid until it is removed. */
+struct sl_seg_vector;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SL_API enum sl_error
+sl_create_seg_vector
+  (size_t data_size,
+   size_t data_alignment,
+   size_t chunk_length, /* Number of elements per chunk. Power of 2. */
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_seg_vector** out_vector);
+
+SL_API enum sl_error
+sl_free_seg_vector
+  (struct sl_seg_vector* vector);
+
+/* Remove all the elements. The allocated chunks are kept for reuse. */
+SL_API enum sl_error
+sl_clear_seg_vector
+  (struct sl_seg_vector* vector);
+
+SL_API enum sl_error
+sl_seg_vector_push_back
+  (struct sl_seg_vector* vector,
+   const void* data);
+
+/* Add one element at the end of the vector and return its address. The
+ * element is not initialised. */
+SL_API enum sl_error
+sl_seg_vector_emplace_back
+  (struct sl_seg_vector* vector,
+   void** out_data);
+
+SL_API enum sl_error
+sl_seg_vector_pop_back
+  (struct sl_seg_vector* vector);
+
+SL_API enum sl_error
+sl_seg_vector_reserve
+  (struct sl_seg_vector* vector,
+   size_t capacity);
+
+SL_API enum sl_error
+sl_seg_vector_capacity
+  (struct sl_seg_vector* vector,
+   size_t* out_capacity);
+
+SL_API enum sl_error
+sl_seg_vector_at
+  (struct sl_seg_vector* vector,
+   size_t id,
+   void** out_data);
+
+SL_API enum sl_error
+sl_seg_vector_length
+  (struct sl_seg_vector* vector,
+   size_t* out_length);
+
+/* Number of chunks storing at least one element of the vector. */
+SL_API enum sl_error
+sl_seg_vector_chunk_count
+  (struct sl_seg_vector* vector,
+   size_t* out_nb_chunks);
+
+/* Return the contiguous elements stored in the chunk `chunk_id'. Only the last
+ * chunk may store less than chunk_length elements. */
+SL_API enum sl_error
+sl_seg_vector_chunk
+  (struct sl_seg_vector* vector,
+   size_t chunk_id,
+   size_t* out_length, /* May be NULL. */
+   void** out_buffer);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_SEG_VECTOR_H */
+
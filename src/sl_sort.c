@@ -0,0 +1,1000 @@
+#include "sl_sort.h"
+#include "sl_thread_pool.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Partitions below this size are sorted with an insertion sort. */
+#define INSERTION_SORT_THRESHOLD 24
+/* Partitions above this size use the pseudomedian of 9 as pivot. */
+#define NINTHER_THRESHOLD 128
+/* Maximum number of element moves of a partial insertion sort. */
+#define PARTIAL_INSERTION_SORT_LIMIT 8
+/* Length of the runs sorted by insertion before being merged. */
+#define MERGE_SORT_RUN 16
+/* Minimum number of elements sorted or merged by a thread. */
+#define PARALLEL_GRAIN 4096
+
+struct sort_context {
+  uintptr_t base;
+  size_t data_size;
+  int (*cmp)(const void*, const void*);
+  void* pivot; /* Scratch element storing the partition pivot. */
+  void* tmp; /* Scratch element used by swaps and insertions. */
+};
+
+/* Merge of the ranges a and b into dst. */
+struct merge_task {
+  uintptr_t a;
+  uintptr_t b;
+  uintptr_t dst;
+  size_t na;
+  size_t nb;
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE void*
+at(const struct sort_context* ctx, size_t id)
+{
+  return (void*)(ctx->base + id * ctx->data_size);
+}
+
+static FINLINE bool
+less(const struct sort_context* ctx, const void* a, const void* b)
+{
+  return ctx->cmp(a, b) < 0;
+}
+
+static FINLINE bool
+less_id(const struct sort_context* ctx, size_t i, size_t j)
+{
+  return ctx->cmp(at(ctx, i), at(ctx, j)) < 0;
+}
+
+/* Copy an element. The common element sizes are copied with a constant size
+ * memcpy that the compiler can inline. */
+static FINLINE void
+copy(void* dst, const void* src, size_t size)
+{
+  switch(size) {
+    case 4: memcpy(dst, src, 4); break;
+    case 8: memcpy(dst, src, 8); break;
+    case 16: memcpy(dst, src, 16); break;
+    case 32: memcpy(dst, src, 32); break;
+    default: memcpy(dst, src, size); break;
+  }
+}
+
+static FINLINE void
+move(const struct sort_context* ctx, void* dst, const void* src)
+{
+  copy(dst, src, ctx->data_size);
+}
+
+static FINLINE void
+swap(const struct sort_context* ctx, size_t i, size_t j)
+{
+  move(ctx, ctx->tmp, at(ctx, i));
+  move(ctx, at(ctx, i), at(ctx, j));
+  move(ctx, at(ctx, j), ctx->tmp);
+}
+
+static FINLINE void
+sort2(const struct sort_context* ctx, size_t a, size_t b)
+{
+  if(less_id(ctx, b, a))
+    swap(ctx, a, b);
+}
+
+static FINLINE void
+sort3(const struct sort_context* ctx, size_t a, size_t b, size_t c)
+{
+  sort2(ctx, a, b);
+  sort2(ctx, b, c);
+  sort2(ctx, a, b);
+}
+
+/* Insertion sort of [begin, end[. It is stable. If is_guarded is false, the
+ * element preceding begin must be lower or equal to all the elements of the
+ * range. */
+static void
+insertion_sort
+  (const struct sort_context* ctx,
+   size_t begin,
+   size_t end,
+   const bool is_guarded)
+{
+  size_t cur = 0;
+
+  if(begin == end)
+    return;
+  for(cur = begin + 1; cur != end; ++cur) {
+    size_t sift = cur;
+    if(less_id(ctx, sift, sift - 1)) {
+      move(ctx, ctx->tmp, at(ctx, sift));
+      do {
+        move(ctx, at(ctx, sift), at(ctx, sift - 1));
+        --sift;
+      } while((!is_guarded || sift != begin)
+            && less(ctx, ctx->tmp, at(ctx, sift - 1)));
+      move(ctx, at(ctx, sift), ctx->tmp);
+    }
+  }
+}
+
+/* Attempt an insertion sort of [begin, end[. Abort and return false if more
+ * than PARTIAL_INSERTION_SORT_LIMIT elements were moved. */
+static bool
+partial_insertion_sort
+  (const struct sort_context* ctx,
+   size_t begin,
+   size_t end)
+{
+  size_t cur = 0;
+  size_t limit = 0;
+
+  if(begin == end)
+    return true;
+  for(cur = begin + 1; cur != end; ++cur) {
+    size_t sift = cur;
+    if(less_id(ctx, sift, sift - 1)) {
+      move(ctx, ctx->tmp, at(ctx, sift));
+      do {
+        move(ctx, at(ctx, sift), at(ctx, sift - 1));
+        --sift;
+      } while(sift != begin && less(ctx, ctx->tmp, at(ctx, sift - 1)));
+      move(ctx, at(ctx, sift), ctx->tmp);
+      limit += cur - sift;
+    }
+    if(limit > PARTIAL_INSERTION_SORT_LIMIT)
+      return false;
+  }
+  return true;
+}
+
+static void
+heap_sift_down
+  (const struct sort_context* ctx,
+   size_t begin,
+   size_t root,
+   size_t n)
+{
+  size_t child = 0;
+  while((child = 2 * root + 1) < n) {
+    if(child + 1 < n && less_id(ctx, begin + child, begin + child + 1))
+      ++child;
+    if(!less_id(ctx, begin + root, begin + child))
+      break;
+    swap(ctx, begin + root, begin + child);
+    root = child;
+  }
+}
+
+static void
+heap_sort(const struct sort_context* ctx, size_t begin, size_t end)
+{
+  const size_t n = end - begin;
+  size_t i = 0;
+
+  for(i = n / 2; i-- > 0; )
+    heap_sift_down(ctx, begin, i, n);
+  for(i = n; i-- > 1; ) {
+    swap(ctx, begin, begin + i);
+    heap_sift_down(ctx, begin, 0, i);
+  }
+}
+
+/* Partition [begin, end[ around the pivot *begin. The elements equal to the
+ * pivot are placed in the right partition. Return the pivot position and
+ * define whether the range was already partitioned. */
+static size_t
+partition_right
+  (const struct sort_context* ctx,
+   size_t begin,
+   size_t end,
+   bool* is_already_partitioned)
+{
+  size_t first = begin;
+  size_t last = end;
+  size_t pivot_pos = 0;
+
+  move(ctx, ctx->pivot, at(ctx, begin));
+
+  /* The median of 3 guarantees that an element >= pivot exists. */
+  while(less(ctx, at(ctx, ++first), ctx->pivot));
+
+  /* Find the first element < pivot from the end. Guard this search only if no
+   * element was skipped on the left side. */
+  if(first - 1 == begin) {
+    while(first < last && !less(ctx, at(ctx, --last), ctx->pivot));
+  } else {
+    while(!less(ctx, at(ctx, --last), ctx->pivot));
+  }
+
+  *is_already_partitioned = first >= last;
+
+  while(first < last) {
+    swap(ctx, first, last);
+    while(less(ctx, at(ctx, ++first), ctx->pivot));
+    while(!less(ctx, at(ctx, --last), ctx->pivot));
+  }
+
+  pivot_pos = first - 1;
+  move(ctx, at(ctx, begin), at(ctx, pivot_pos));
+  move(ctx, at(ctx, pivot_pos), ctx->pivot);
+  return pivot_pos;
+}
+
+/* Partition [begin, end[ around the pivot *begin, placing the elements equal
+ * to the pivot in the left partition. Used when the pivot is equal to the
+ * element preceding the range, i.e. many equal elements. */
+static size_t
+partition_left(const struct sort_context* ctx, size_t begin, size_t end)
+{
+  size_t first = begin;
+  size_t last = end;
+  size_t pivot_pos = 0;
+
+  move(ctx, ctx->pivot, at(ctx, begin));
+
+  while(less(ctx, ctx->pivot, at(ctx, --last)));
+  if(last + 1 == end) {
+    while(first < last && !less(ctx, ctx->pivot, at(ctx, ++first)));
+  } else {
+    while(!less(ctx, ctx->pivot, at(ctx, ++first)));
+  }
+
+  while(first < last) {
+    swap(ctx, first, last);
+    while(less(ctx, ctx->pivot, at(ctx, --last)));
+    while(!less(ctx, ctx->pivot, at(ctx, ++first)));
+  }
+
+  pivot_pos = last;
+  move(ctx, at(ctx, begin), at(ctx, pivot_pos));
+  move(ctx, at(ctx, pivot_pos), ctx->pivot);
+  return pivot_pos;
+}
+
+static void
+pdq_sort
+  (const struct sort_context* ctx,
+   size_t begin,
+   size_t end,
+   int bad_allowed,
+   bool is_leftmost)
+{
+  for(;;) {
+    const size_t size = end - begin;
+    size_t half = 0;
+    size_t pivot_pos = 0;
+    size_t l_size = 0;
+    size_t r_size = 0;
+    bool is_already_partitioned = false;
+
+    if(size < INSERTION_SORT_THRESHOLD) {
+      insertion_sort(ctx, begin, end, is_leftmost);
+      return;
+    }
+
+    /* Choose the pivot as the median of 3 or the pseudomedian of 9 and move
+     * it to begin. */
+    half = size / 2;
+    if(size > NINTHER_THRESHOLD) {
+      sort3(ctx, begin, begin + half, end - 1);
+      sort3(ctx, begin + 1, begin + (half - 1), end - 2);
+      sort3(ctx, begin + 2, begin + (half + 1), end - 3);
+      sort3(ctx, begin + (half - 1), begin + half, begin + (half + 1));
+      swap(ctx, begin, begin + half);
+    } else {
+      sort3(ctx, begin + half, begin, end - 1);
+    }
+
+    /* If the pivot is equal to the element preceding the range, this element
+     * is the pivot of a previous partition and all the elements equal to it
+     * can be put in place at once. */
+    if(!is_leftmost && !less_id(ctx, begin - 1, begin)) {
+      begin = partition_left(ctx, begin, end) + 1;
+      continue;
+    }
+
+    pivot_pos = partition_right(ctx, begin, end, &is_already_partitioned);
+    l_size = pivot_pos - begin;
+    r_size = end - (pivot_pos + 1);
+
+    if(l_size < size / 8 || r_size < size / 8) {
+      /* Highly unbalanced partition. Fall back on a heap sort if too many
+       * bad partitions occurred; otherwise break the patterns of the input. */
+      if(--bad_allowed == 0) {
+        heap_sort(ctx, begin, end);
+        return;
+      }
+      if(l_size >= INSERTION_SORT_THRESHOLD) {
+        swap(ctx, begin, begin + l_size / 4);
+        swap(ctx, pivot_pos - 1, pivot_pos - l_size / 4);
+        if(l_size > NINTHER_THRESHOLD) {
+          swap(ctx, begin + 1, begin + (l_size / 4 + 1));
+          swap(ctx, begin + 2, begin + (l_size / 4 + 2));
+          swap(ctx, pivot_pos - 2, pivot_pos - (l_size / 4 + 1));
+          swap(ctx, pivot_pos - 3, pivot_pos - (l_size / 4 + 2));
+        }
+      }
+      if(r_size >= INSERTION_SORT_THRESHOLD) {
+        swap(ctx, pivot_pos + 1, pivot_pos + (1 + r_size / 4));
+        swap(ctx, end - 1, end - r_size / 4);
+        if(r_size > NINTHER_THRESHOLD) {
+          swap(ctx, pivot_pos + 2, pivot_pos + (2 + r_size / 4));
+          swap(ctx, pivot_pos + 3, pivot_pos + (3 + r_size / 4));
+          swap(ctx, end - 2, end - (1 + r_size / 4));
+          swap(ctx, end - 3, end - (2 + r_size / 4));
+        }
+      }
+    } else if(is_already_partitioned
+           && partial_insertion_sort(ctx, begin, pivot_pos)
+           && partial_insertion_sort(ctx, pivot_pos + 1, end)) {
+      /* The range seems already sorted. */
+      return;
+    }
+
+    /* Recurse on the left partition and loop on the right one. */
+    pdq_sort(ctx, begin, pivot_pos, bad_allowed, is_leftmost);
+    begin = pivot_pos + 1;
+    is_leftmost = false;
+  }
+}
+
+/* Stable merge of the sorted ranges a and b into dst. On equality, the
+ * elements of a precede the ones of b. */
+static void
+merge
+  (const struct sort_context* ctx,
+   uintptr_t a,
+   size_t na,
+   uintptr_t b,
+   size_t nb,
+   uintptr_t dst)
+{
+  const size_t sz = ctx->data_size;
+  size_t i = 0;
+  size_t j = 0;
+
+  /* The two ranges are already ordered. */
+  if(!na || !nb || !less(ctx, (void*)b, (void*)(a + (na - 1) * sz))) {
+    if(na)
+      memcpy((void*)dst, (void*)a, na * sz);
+    if(nb)
+      memcpy((void*)(dst + na * sz), (void*)b, nb * sz);
+    return;
+  }
+  while(i < na && j < nb) {
+    if(less(ctx, (void*)(b + j * sz), (void*)(a + i * sz))) {
+      copy((void*)dst, (void*)(b + j * sz), sz);
+      ++j;
+    } else {
+      copy((void*)dst, (void*)(a + i * sz), sz);
+      ++i;
+    }
+    dst += sz;
+  }
+  if(i < na)
+    memcpy((void*)dst, (void*)(a + i * sz), (na - i) * sz);
+  if(j < nb)
+    memcpy((void*)dst, (void*)(b + j * sz), (nb - j) * sz);
+}
+
+/* Return the number of elements of a among the `diag' first elements of the
+ * stable merge of a and b. */
+static size_t
+merge_path
+  (const struct sort_context* ctx,
+   uintptr_t a,
+   size_t na,
+   uintptr_t b,
+   size_t nb,
+   size_t diag)
+{
+  const size_t sz = ctx->data_size;
+  size_t lo = diag > nb ? diag - nb : 0;
+  size_t hi = MIN(diag, na);
+
+  ASSERT(diag <= na + nb);
+  while(lo < hi) {
+    const size_t mid = lo + (hi - lo) / 2;
+    /* a[mid] precedes b[diag - mid - 1] in the merge if it is not greater. */
+    if(!less(ctx, (void*)(b + (diag - mid - 1) * sz), (void*)(a + mid * sz))) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return lo;
+}
+
+/* Split the merge of a and b into dst in nb_tasks merges of similar size. */
+static void
+split_merge
+  (const struct sort_context* ctx,
+   uintptr_t a,
+   size_t na,
+   uintptr_t b,
+   size_t nb,
+   uintptr_t dst,
+   size_t nb_tasks,
+   struct merge_task* tasks)
+{
+  const size_t sz = ctx->data_size;
+  const size_t n = na + nb;
+  size_t i0 = 0;
+  size_t d0 = 0;
+  size_t itask = 0;
+
+  for(itask = 0; itask < nb_tasks; ++itask) {
+    const size_t d1 = itask + 1 == nb_tasks ? n : (itask + 1) * (n / nb_tasks);
+    const size_t i1 = merge_path(ctx, a, na, b, nb, d1);
+    tasks[itask].a = a + i0 * sz;
+    tasks[itask].na = i1 - i0;
+    tasks[itask].b = b + (d0 - i0) * sz;
+    tasks[itask].nb = (d1 - i1) - (d0 - i0);
+    tasks[itask].dst = dst + d0 * sz;
+    i0 = i1;
+    d0 = d1;
+  }
+}
+
+static FINLINE uint64_t
+radix_key(const void* key, size_t key_size, enum sl_sort_key_type key_type)
+{
+  uint64_t k = 0;
+  uint64_t sign = 0;
+
+  switch(key_size) {
+    case 1: { uint8_t k8; memcpy(&k8, key, 1); k = k8; } break;
+    case 2: { uint16_t k16; memcpy(&k16, key, 2); k = k16; } break;
+    case 4: { uint32_t k32; memcpy(&k32, key, 4); k = k32; } break;
+    case 8: memcpy(&k, key, 8); break;
+    default: ASSERT(0); break;
+  }
+  /* Map the key to an unsigned integer with the same ordering. */
+  sign = (uint64_t)1 << (key_size * 8 - 1);
+  switch(key_type) {
+    case SL_SORT_KEY_UINT:
+      break;
+    case SL_SORT_KEY_INT:
+      k ^= sign;
+      break;
+    case SL_SORT_KEY_FLOAT:
+      k = (k & sign) ? (~k & (sign | (sign - 1))) : (k | sign);
+      break;
+    default: ASSERT(0); break;
+  }
+  return k;
+}
+
+static enum sl_error
+check_sort_args
+  (const void* base,
+   size_t count,
+   size_t data_size,
+   size_t data_alignment)
+{
+  if((!base && count) || !data_size)
+    return SL_INVALID_ARGUMENT;
+  if(!IS_POWER_OF_2(data_alignment) || !IS_ALIGNED(base, data_alignment))
+    return SL_ALIGNMENT_ERROR;
+  if(count > SIZE_MAX / data_size)
+    return SL_OVERFLOW_ERROR;
+  return SL_NO_ERROR;
+}
+
+/*******************************************************************************
+ *
+ * Sort functions.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_sort
+  (void* base,
+   size_t count,
+   size_t data_size,
+   size_t data_alignment,
+   int (*cmp)(const void*, const void*),
+   struct mem_allocator* specific_allocator)
+{
+  struct sort_context ctx;
+  struct mem_allocator* allocator = NULL;
+  void* scratch = NULL;
+  size_t slot_size = 0;
+  size_t n = 0;
+  int log2_count = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!cmp) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  err = check_sort_args(base, count, data_size, data_alignment);
+  if(err != SL_NO_ERROR)
+    goto error;
+  if(count < 2)
+    goto exit;
+
+  /* Scratch memory of the pivot and of the temporary element. */
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  slot_size = (data_size + data_alignment - 1) & ~(data_alignment - 1);
+  scratch = MEM_ALIGNED_ALLOC(allocator, 2 * slot_size, data_alignment);
+  if(!scratch) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  ctx.base = (uintptr_t)base;
+  ctx.data_size = data_size;
+  ctx.cmp = cmp;
+  ctx.pivot = scratch;
+  ctx.tmp = (void*)((uintptr_t)scratch + slot_size);
+
+  for(n = count; n > 1; n >>= 1)
+    ++log2_count;
+  pdq_sort(&ctx, 0, count, log2_count, true);
+
+exit:
+  if(scratch)
+    MEM_FREE(allocator, scratch);
+  return err;
+error:
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_stable_sort
+  (void* base,
+   size_t count,
+   size_t data_size,
+   size_t data_alignment,
+   int (*cmp)(const void*, const void*),
+   struct mem_allocator* specific_allocator)
+{
+  struct sort_context ctx;
+  struct mem_allocator* allocator = NULL;
+  void* buffer = NULL;
+  uintptr_t src = 0;
+  uintptr_t dst = 0;
+  size_t slot_size = 0;
+  size_t tmp_offset = 0;
+  size_t width = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!cmp) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  err = check_sort_args(base, count, data_size, data_alignment);
+  if(err != SL_NO_ERROR)
+    goto error;
+  if(count < 2)
+    goto exit;
+
+  /* Temporary copy of the elements followed by one scratch element. */
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  slot_size = (data_size + data_alignment - 1) & ~(data_alignment - 1);
+  if(count * data_size > SIZE_MAX - 2 * slot_size) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  tmp_offset = (count * data_size + data_alignment - 1) & ~(data_alignment - 1);
+  buffer = MEM_ALIGNED_ALLOC(allocator, tmp_offset + slot_size, data_alignment);
+  if(!buffer) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  ctx.base = (uintptr_t)base;
+  ctx.data_size = data_size;
+  ctx.cmp = cmp;
+  ctx.pivot = NULL;
+  ctx.tmp = (void*)((uintptr_t)buffer + tmp_offset);
+
+  /* Sort small runs by insertion and then merge them bottom-up, alternating
+   * between the input array and the temporary buffer. */
+  for(i = 0; i < count; i += MERGE_SORT_RUN)
+    insertion_sort(&ctx, i, MIN(i + MERGE_SORT_RUN, count), true);
+
+  src = (uintptr_t)base;
+  dst = (uintptr_t)buffer;
+  for(width = MERGE_SORT_RUN; width < count; width *= 2) {
+    uintptr_t tmp = 0;
+    for(i = 0; i < count; i += 2 * width) {
+      const size_t mid = MIN(i + width, count);
+      const size_t hi = count - i > 2 * width ? i + 2 * width : count;
+      merge
+        (&ctx,
+         src + i * data_size, mid - i,
+         src + mid * data_size, hi - mid,
+         dst + i * data_size);
+    }
+    tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  if(src != (uintptr_t)base)
+    memcpy(base, (void*)src, count * data_size);
+
+exit:
+  if(buffer)
+    MEM_FREE(allocator, buffer);
+  return err;
+error:
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_radix_sort
+  (void* base,
+   size_t count,
+   size_t data_size,
+   size_t key_offset,
+   size_t key_size,
+   enum sl_sort_key_type key_type,
+   struct mem_allocator* specific_allocator)
+{
+  size_t histogram[8][256];
+  struct mem_allocator* allocator = NULL;
+  void* buffer = NULL;
+  uintptr_t src = 0;
+  uintptr_t dst = 0;
+  size_t digit = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if((!base && count)
+  || !data_size
+  || key_offset > data_size
+  || key_size > data_size - key_offset) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  switch(key_type) {
+    case SL_SORT_KEY_UINT:
+    case SL_SORT_KEY_INT:
+      if(key_size != 1 && key_size != 2 && key_size != 4 && key_size != 8)
+        err = SL_INVALID_ARGUMENT;
+      break;
+    case SL_SORT_KEY_FLOAT:
+      if(key_size != sizeof(float) && key_size != sizeof(double))
+        err = SL_INVALID_ARGUMENT;
+      break;
+    default:
+      err = SL_INVALID_ARGUMENT;
+      break;
+  }
+  if(err != SL_NO_ERROR)
+    goto error;
+  if(count > SIZE_MAX / data_size) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  if(count < 2)
+    goto exit;
+
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  buffer = MEM_ALIGNED_ALLOC(allocator, count * data_size, 16);
+  if(!buffer) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+
+  /* Compute the histograms of all the digits in a single pass. */
+  memset(histogram, 0, sizeof(histogram));
+  for(i = 0; i < count; ++i) {
+    const uint64_t key = radix_key
+      ((void*)((uintptr_t)base + i * data_size + key_offset),
+       key_size, key_type);
+    for(digit = 0; digit < key_size; ++digit)
+      ++histogram[digit][(key >> (digit * 8)) & 0xFF];
+  }
+
+  #define RADIX_SCATTER(KeySize)                                              \
+    for(i = 0; i < count; ++i) {                                               \
+      const uintptr_t elmt = src + i * data_size;                              \
+      const uint64_t key = radix_key                                           \
+        ((void*)(elmt + key_offset), KeySize, key_type);                       \
+      const size_t id = offsets[(key >> (digit * 8)) & 0xFF]++;                \
+      copy((void*)(dst + id * data_size), (void*)elmt, data_size);             \
+    } (void)0
+
+  src = (uintptr_t)base;
+  dst = (uintptr_t)buffer;
+  for(digit = 0; digit < key_size; ++digit) {
+    size_t* offsets = histogram[digit];
+    const uint64_t key0 = radix_key
+      ((void*)(src + key_offset), key_size, key_type);
+    size_t sum = 0;
+    uintptr_t tmp = 0;
+
+    /* Skip the digits shared by all the keys. */
+    if(offsets[(key0 >> (digit * 8)) & 0xFF] == count)
+      continue;
+
+    for(i = 0; i < 256; ++i) {
+      const size_t n = offsets[i];
+      offsets[i] = sum;
+      sum += n;
+    }
+    /* Let the compiler specialise the scatter on the key size. */
+    switch(key_size) {
+      case 1: RADIX_SCATTER(1); break;
+      case 2: RADIX_SCATTER(2); break;
+      case 4: RADIX_SCATTER(4); break;
+      case 8: RADIX_SCATTER(8); break;
+      default: ASSERT(0); break;
+    }
+    tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  #undef RADIX_SCATTER
+  if(src != (uintptr_t)base)
+    memcpy(base, (void*)src, count * data_size);
+
+exit:
+  if(buffer)
+    MEM_FREE(allocator, buffer);
+  return err;
+error:
+  goto exit;
+}
+
+/*******************************************************************************
+ *
+ * Parallel sort functions.
+ *
+ ******************************************************************************/
+struct parallel_sort {
+  struct sort_context* contexts; /* Per run sort context. */
+  const size_t* bounds; /* Bounds of the runs sorted in parallel. */
+  const struct merge_task* tasks; /* Merge tasks of the current round. */
+  int log2_run;
+};
+
+static void
+sort_runs(size_t begin, size_t end, void* data)
+{
+  struct parallel_sort* psort = data;
+  size_t irun = 0;
+  for(irun = begin; irun < end; ++irun) {
+    pdq_sort
+      (psort->contexts + irun,
+       psort->bounds[irun],
+       psort->bounds[irun + 1],
+       psort->log2_run,
+       true);
+  }
+}
+
+static void
+merge_runs(size_t begin, size_t end, void* data)
+{
+  struct parallel_sort* psort = data;
+  size_t itask = 0;
+  for(itask = begin; itask < end; ++itask) {
+    const struct merge_task* task = psort->tasks + itask;
+    merge(psort->contexts, task->a, task->na, task->b, task->nb, task->dst);
+  }
+}
+
+EXPORT_SYM enum sl_error
+sl_parallel_sort
+  (void* base,
+   size_t count,
+   size_t data_size,
+   size_t data_alignment,
+   int (*cmp)(const void*, const void*),
+   struct sl_thread_pool* pool,
+   struct mem_allocator* specific_allocator)
+{
+  struct parallel_sort psort;
+  struct mem_allocator* allocator = NULL;
+  struct sort_context* contexts = NULL;
+  struct merge_task* tasks = NULL;
+  size_t* bounds = NULL;
+  void* buffer = NULL;
+  void* scratch = NULL;
+  uintptr_t src = 0;
+  uintptr_t dst = 0;
+  size_t slot_size = 0;
+  size_t nb_threads = 0;
+  size_t nb_runs = 0;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!cmp) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  err = check_sort_args(base, count, data_size, data_alignment);
+  if(err != SL_NO_ERROR)
+    goto error;
+
+  /* The calling thread works with the threads of the pool. */
+  if(pool)
+    SL(thread_pool_thread_count(pool, &nb_threads));
+  nb_threads = MIN(nb_threads + 1, count / PARALLEL_GRAIN);
+  if(nb_threads <= 1) {
+    err = sl_sort
+      (base, count, data_size, data_alignment, cmp, specific_allocator);
+    goto exit;
+  }
+
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  slot_size = (data_size + data_alignment - 1) & ~(data_alignment - 1);
+  buffer = MEM_ALIGNED_ALLOC(allocator, count * data_size, data_alignment);
+  scratch = MEM_ALIGNED_ALLOC
+    (allocator, 2 * nb_threads * slot_size, data_alignment);
+  contexts = MEM_ALLOC(allocator, nb_threads * sizeof(struct sort_context));
+  bounds = MEM_ALLOC(allocator, (nb_threads + 1) * sizeof(size_t));
+  tasks = MEM_ALLOC(allocator, 2 * nb_threads * sizeof(struct merge_task));
+  if(!buffer || !scratch || !contexts || !bounds || !tasks) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+
+  for(i = 0; i < nb_threads; ++i) {
+    contexts[i].base = (uintptr_t)base;
+    contexts[i].data_size = data_size;
+    contexts[i].cmp = cmp;
+    contexts[i].pivot = (void*)((uintptr_t)scratch + (2 * i) * slot_size);
+    contexts[i].tmp = (void*)((uintptr_t)scratch + (2 * i + 1) * slot_size);
+  }
+  psort.contexts = contexts;
+  psort.bounds = bounds;
+
+  /* Sort one run per thread. */
+  for(i = 0; i <= nb_threads; ++i)
+    bounds[i] = i == nb_threads ? count : i * (count / nb_threads);
+  psort.log2_run = 0;
+  for(i = count / nb_threads; i > 1; i >>= 1)
+    ++psort.log2_run;
+  SL(thread_pool_parallel_for(pool, 0, nb_threads, 1, sort_runs, &psort));
+
+  /* Merge the runs pairwise. Each round splits the merges in nb_threads tasks
+   * of similar size. */
+  src = (uintptr_t)base;
+  dst = (uintptr_t)buffer;
+  nb_runs = nb_threads;
+  while(nb_runs > 1) {
+    size_t nb_tasks = 0;
+    uintptr_t tmp = 0;
+
+    for(i = 0; i + 1 < nb_runs; i += 2) {
+      const size_t na = bounds[i + 1] - bounds[i];
+      const size_t nb = bounds[i + 2] - bounds[i + 1];
+      const size_t n = (nb_threads * (na + nb)) / count;
+      const size_t nb_split = MAX(n, 1);
+      split_merge
+        (contexts,
+         src + bounds[i] * data_size, na,
+         src + bounds[i + 1] * data_size, nb,
+         dst + bounds[i] * data_size,
+         nb_split, tasks + nb_tasks);
+      nb_tasks += nb_split;
+    }
+    if(nb_runs % 2) { /* Copy the last run. */
+      tasks[nb_tasks].a = src + bounds[nb_runs - 1] * data_size;
+      tasks[nb_tasks].na = bounds[nb_runs] - bounds[nb_runs - 1];
+      tasks[nb_tasks].b = 0;
+      tasks[nb_tasks].nb = 0;
+      tasks[nb_tasks].dst = dst + bounds[nb_runs - 1] * data_size;
+      ++nb_tasks;
+    }
+    ASSERT(nb_tasks <= 2 * nb_threads);
+    psort.tasks = tasks;
+    SL(thread_pool_parallel_for(pool, 0, nb_tasks, 1, merge_runs, &psort));
+
+    for(i = 0; i < nb_runs; i += 2)
+      bounds[i / 2] = bounds[i];
+    nb_runs = (nb_runs + 1) / 2;
+    bounds[nb_runs] = count;
+    tmp = src;
+    src = dst;
+    dst = tmp;
+  }
+  if(src != (uintptr_t)base)
+    memcpy(base, (void*)src, count * data_size);
+
+exit:
+  if(buffer)
+    MEM_FREE(allocator, buffer);
+  if(scratch)
+    MEM_FREE(allocator, scratch);
+  if(contexts)
+    MEM_FREE(allocator, contexts);
+  if(bounds)
+    MEM_FREE(allocator, bounds);
+  if(tasks)
+    MEM_FREE(allocator, tasks);
+  return err;
+error:
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_parallel_merge
+  (const void* a,
+   size_t count_a,
+   const void* b,
+   size_t count_b,
+   void* dst,
+   size_t data_size,
+   int (*cmp)(const void*, const void*),
+   struct sl_thread_pool* pool,
+   struct mem_allocator* specific_allocator)
+{
+  struct parallel_sort pmerge;
+  struct sort_context ctx;
+  struct mem_allocator* allocator = NULL;
+  struct merge_task* tasks = NULL;
+  size_t nb_threads = 0;
+  size_t count = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if((!a && count_a) || (!b && count_b) || !dst || !data_size || !cmp) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(count_a > SIZE_MAX - count_b
+  || count_a + count_b > SIZE_MAX / data_size) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  count = count_a + count_b;
+  if((count_a && IS_MEMORY_OVERLAPPED
+      (a, count_a * data_size, dst, count * data_size))
+  || (count_b && IS_MEMORY_OVERLAPPED
+      (b, count_b * data_size, dst, count * data_size))) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  ctx.base = (uintptr_t)dst;
+  ctx.data_size = data_size;
+  ctx.cmp = cmp;
+  ctx.pivot = NULL;
+  ctx.tmp = NULL;
+
+  if(pool)
+    SL(thread_pool_thread_count(pool, &nb_threads));
+  nb_threads = MIN(nb_threads + 1, count / PARALLEL_GRAIN);
+  if(nb_threads <= 1) {
+    merge(&ctx, (uintptr_t)a, count_a, (uintptr_t)b, count_b, (uintptr_t)dst);
+    goto exit;
+  }
+
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  tasks = MEM_ALLOC(allocator, nb_threads * sizeof(struct merge_task));
+  if(!tasks) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+
+  split_merge
+    (&ctx, (uintptr_t)a, count_a, (uintptr_t)b, count_b, (uintptr_t)dst,
+     nb_threads, tasks);
+  pmerge.contexts = &ctx;
+  pmerge.bounds = NULL;
+  pmerge.tasks = tasks;
+  pmerge.log2_run = 0;
+  SL(thread_pool_parallel_for(pool, 0, nb_threads, 1, merge_runs, &pmerge));
+
+exit:
+  if(tasks)
+    MEM_FREE(allocator, tasks);
+  return err;
+error:
+  goto exit;
+}
+
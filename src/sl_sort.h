@@ -0,0 +1,94 @@
+#ifndef SL_SORT_H
+#define SL_SORT_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stddef.h>
+
+struct mem_allocator;
+struct sl_thread_pool;
+
+/* Type of the key on which a radix sort is performed. */
+enum sl_sort_key_type {
+  SL_SORT_KEY_UINT, /* Unsigned integer of 1, 2, 4 or 8 bytes. */
+  SL_SORT_KEY_INT, /* Two's complement signed integer of 1, 2, 4 or 8 bytes. */
+  SL_SORT_KEY_FLOAT /* IEEE 754 float or double. */
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Sort in ascending order the count elements of `data_size' bytes pointed by
+ * base. The sort is a pattern-defeating quicksort: O(n log n) in the worst
+ * case, linear on sorted, reversed or all equal inputs, not stable. */
+SL_API enum sl_error
+sl_sort
+  (void* base,
+   size_t count,
+   size_t data_size,
+   size_t data_alignment,
+   int (*data_comparator)(const void*, const void*),
+   struct mem_allocator* allocator); /* May be NULL. */
+
+/* Sort the elements while preserving the order of the equal ones. It is a
+ * merge sort that allocates a temporary copy of the elements. */
+SL_API enum sl_error
+sl_stable_sort
+  (void* base,
+   size_t count,
+   size_t data_size,
+   size_t data_alignment,
+   int (*data_comparator)(const void*, const void*),
+   struct mem_allocator* allocator); /* May be NULL. */
+
+/* Sort the elements with respect to the key of `key_size' bytes stored at
+ * `key_offset' bytes from the beginning of each element. The sort is a stable
+ * least significant digit radix sort on bytes; it allocates a temporary copy
+ * of the elements. */
+SL_API enum sl_error
+sl_radix_sort
+  (void* base,
+   size_t count,
+   size_t data_size,
+   size_t key_offset,
+   size_t key_size,
+   enum sl_sort_key_type key_type,
+   struct mem_allocator* allocator); /* May be NULL. */
+
+/* Sort the elements with the threads of the pool and the calling thread. Each
+ * thread sorts a part of the elements with the sl_sort algorithm and the
+ * sorted parts are then merged in parallel. The sort is not stable and
+ * allocates a temporary copy of the elements. The allocator is only used by
+ * the calling thread. */
+SL_API enum sl_error
+sl_parallel_sort
+  (void* base,
+   size_t count,
+   size_t data_size,
+   size_t data_alignment,
+   int (*data_comparator)(const void*, const void*),
+   struct sl_thread_pool* pool, /* May be NULL <=> single threaded. */
+   struct mem_allocator* allocator); /* May be NULL. */
+
+/* Merge with the threads of the pool the sorted arrays a and b into dst that
+ * must not overlap them. On equality, the elements of a precede the ones of
+ * b. */
+SL_API enum sl_error
+sl_parallel_merge
+  (const void* a,
+   size_t count_a,
+   const void* b,
+   size_t count_b,
+   void* dst, /* Must store at least count_a + count_b elements. */
+   size_t data_size,
+   int (*data_comparator)(const void*, const void*),
+   struct sl_thread_pool* pool, /* May be NULL <=> single threaded. */
+   struct mem_allocator* allocator); /* May be NULL. */
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_SORT_H */
+
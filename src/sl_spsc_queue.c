@@ -0,0 +1,276 @@
+#include "sl_spsc_queue.h"
+#include <snlsys/math.h>
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CACHE_LINE_SIZE 64
+
+/* The producer and the consumer indices lie in distinct cache lines in order
+ * to avoid false sharing. Each thread keeps a cached copy of the index of the
+ * other thread and reloads it only when the queue looks full or empty. The
+ * indices are never wrapped; their difference is the length of the queue. */
+struct sl_spsc_queue {
+  struct mem_allocator* allocator;
+  size_t data_size;
+  size_t data_alignment;
+  size_t mask; /* Capacity - 1. */
+  void* buffer;
+
+  /* Producer data. */
+  ALIGN(CACHE_LINE_SIZE) size_t tail;
+  size_t cached_head;
+
+  /* Consumer data. */
+  ALIGN(CACHE_LINE_SIZE) size_t head;
+  size_t cached_tail;
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE size_t
+load_acquire(const size_t* index)
+{
+  return __atomic_load_n(index, __ATOMIC_ACQUIRE);
+}
+
+static FINLINE void
+store_release(size_t* index, size_t val)
+{
+  __atomic_store_n(index, val, __ATOMIC_RELEASE);
+}
+
+/* Copy count elements between the ring buffer, from the position `id', and
+ * the contiguous array data. */
+static void
+copy_ring
+  (struct sl_spsc_queue* queue,
+   size_t id,
+   size_t count,
+   void* data,
+   bool is_write)
+{
+  const size_t pos = id & queue->mask;
+  const size_t len0 = MIN(count, queue->mask + 1 - pos);
+  void* ring = (void*)((uintptr_t)queue->buffer + pos * queue->data_size);
+  void* array1 = (void*)((uintptr_t)data + len0 * queue->data_size);
+
+  if(is_write) {
+    memcpy(ring, data, len0 * queue->data_size);
+    if(count != len0)
+      memcpy(queue->buffer, array1, (count - len0) * queue->data_size);
+  } else {
+    memcpy(data, ring, len0 * queue->data_size);
+    if(count != len0)
+      memcpy(array1, queue->buffer, (count - len0) * queue->data_size);
+  }
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the single producer/single consumer queue.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_spsc_queue
+  (size_t data_size,
+   size_t data_alignment,
+   size_t capacity,
+   struct mem_allocator* specific_allocator,
+   struct sl_spsc_queue** out_queue)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_spsc_queue* queue = NULL;
+  size_t pow2_capacity = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!out_queue || !data_size || !capacity) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(!IS_POWER_OF_2(data_alignment)) {
+    err = SL_ALIGNMENT_ERROR;
+    goto error;
+  }
+  NEXT_POWER_OF_2(capacity, pow2_capacity);
+  if(pow2_capacity < capacity || pow2_capacity > SIZE_MAX / data_size) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  queue = MEM_ALIGNED_ALLOC
+    (allocator, sizeof(struct sl_spsc_queue), ALIGNOF(struct sl_spsc_queue));
+  if(queue == NULL) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  memset(queue, 0, sizeof(struct sl_spsc_queue));
+  queue->allocator = allocator;
+  queue->data_size = data_size;
+  queue->data_alignment = data_alignment;
+  queue->mask = pow2_capacity - 1;
+  queue->buffer = MEM_ALIGNED_ALLOC
+    (allocator, pow2_capacity * data_size,
+     MAX(data_alignment, CACHE_LINE_SIZE));
+  if(queue->buffer == NULL) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+
+exit:
+  if(out_queue)
+    *out_queue = queue;
+  return err;
+
+error:
+  if(queue) {
+    ASSERT(allocator);
+    MEM_FREE(allocator, queue);
+    queue = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_spsc_queue
+  (struct sl_spsc_queue* queue)
+{
+  struct mem_allocator* allocator = NULL;
+
+  if(!queue)
+    return SL_INVALID_ARGUMENT;
+
+  allocator = queue->allocator;
+  MEM_FREE(allocator, queue->buffer);
+  MEM_FREE(allocator, queue);
+
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_spsc_queue_enqueue
+  (struct sl_spsc_queue* queue,
+   const void* data,
+   bool* is_enqueued)
+{
+  size_t n = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!is_enqueued)
+    return SL_INVALID_ARGUMENT;
+  err = sl_spsc_queue_enqueue_n(queue, 1, data, &n);
+  *is_enqueued = n != 0;
+  return err;
+}
+
+EXPORT_SYM enum sl_error
+sl_spsc_queue_enqueue_n
+  (struct sl_spsc_queue* queue,
+   size_t count,
+   const void* data,
+   size_t* out_count)
+{
+  size_t tail = 0;
+  size_t n = 0;
+
+  if(!queue || (count && !data))
+    return SL_INVALID_ARGUMENT;
+  if(!IS_ALIGNED(data, queue->data_alignment))
+    return SL_ALIGNMENT_ERROR;
+
+  tail = queue->tail;
+  n = queue->mask + 1 - (tail - queue->cached_head);
+  if(n < count) {
+    queue->cached_head = load_acquire(&queue->head);
+    n = queue->mask + 1 - (tail - queue->cached_head);
+  }
+  n = MIN(n, count);
+  if(n) {
+    copy_ring(queue, tail, n, (void*)data, true);
+    store_release(&queue->tail, tail + n);
+  }
+  if(out_count)
+    *out_count = n;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_spsc_queue_dequeue
+  (struct sl_spsc_queue* queue,
+   void* data,
+   bool* is_dequeued)
+{
+  size_t n = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!is_dequeued)
+    return SL_INVALID_ARGUMENT;
+  err = sl_spsc_queue_dequeue_n(queue, 1, data, &n);
+  *is_dequeued = n != 0;
+  return err;
+}
+
+EXPORT_SYM enum sl_error
+sl_spsc_queue_dequeue_n
+  (struct sl_spsc_queue* queue,
+   size_t count,
+   void* data,
+   size_t* out_count)
+{
+  size_t head = 0;
+  size_t n = 0;
+
+  if(!queue || (count && !data))
+    return SL_INVALID_ARGUMENT;
+  if(!IS_ALIGNED(data, queue->data_alignment))
+    return SL_ALIGNMENT_ERROR;
+
+  head = queue->head;
+  n = queue->cached_tail - head;
+  if(n < count) {
+    queue->cached_tail = load_acquire(&queue->tail);
+    n = queue->cached_tail - head;
+  }
+  n = MIN(n, count);
+  if(n) {
+    copy_ring(queue, head, n, data, false);
+    store_release(&queue->head, head + n);
+  }
+  if(out_count)
+    *out_count = n;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_spsc_queue_length
+  (struct sl_spsc_queue* queue,
+   size_t* length)
+{
+  size_t head = 0;
+  size_t tail = 0;
+
+  if(!queue || !length)
+    return SL_INVALID_ARGUMENT;
+  /* Load the head first so that the length is never negative. */
+  head = load_acquire(&queue->head);
+  tail = load_acquire(&queue->tail);
+  *length = tail - head;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_spsc_queue_capacity
+  (struct sl_spsc_queue* queue,
+   size_t* capacity)
+{
+  if(!queue || !capacity)
+    return SL_INVALID_ARGUMENT;
+  *capacity = queue->mask + 1;
+  return SL_NO_ERROR;
+}
+
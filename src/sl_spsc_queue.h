@@ -0,0 +1,81 @@
+#ifndef SL_SPSC_QUEUE_H
+#define SL_SPSC_QUEUE_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+struct mem_allocator;
+
+/* Bounded lock-free queue of fixed size elements shared by one producer thread
+ * and one consumer thread. The enqueue functions must be invoked by the
+ * producer only and the dequeue functions by the consumer only. */
+struct sl_spsc_queue;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SL_API enum sl_error
+sl_create_spsc_queue
+  (size_t data_size,
+   size_t data_alignment,
+   size_t capacity, /* Rounded up to the next power of 2. */
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_spsc_queue** out_queue);
+
+/* Must not be invoked while the producer or the consumer uses the queue. */
+SL_API enum sl_error
+sl_free_spsc_queue
+  (struct sl_spsc_queue* queue);
+
+/* Copy data at the end of the queue if it is not full. */
+SL_API enum sl_error
+sl_spsc_queue_enqueue
+  (struct sl_spsc_queue* queue,
+   const void* data,
+   bool* out_is_enqueued);
+
+/* Copy at the end of the queue as many as possible of the count contiguous
+ * elements pointed by data. */
+SL_API enum sl_error
+sl_spsc_queue_enqueue_n
+  (struct sl_spsc_queue* queue,
+   size_t count,
+   const void* data,
+   size_t* out_count); /* Number of enqueued elements. May be NULL. */
+
+/* Move the front element of the queue in data if the queue is not empty. */
+SL_API enum sl_error
+sl_spsc_queue_dequeue
+  (struct sl_spsc_queue* queue,
+   void* data,
+   bool* out_is_dequeued);
+
+/* Move at most count front elements of the queue in the array data. */
+SL_API enum sl_error
+sl_spsc_queue_dequeue_n
+  (struct sl_spsc_queue* queue,
+   size_t count,
+   void* data,
+   size_t* out_count); /* Number of dequeued elements. May be NULL. */
+
+/* Number of queued elements. It is only a snapshot when it is invoked while
+ * the queue is used by the other thread. */
+SL_API enum sl_error
+sl_spsc_queue_length
+  (struct sl_spsc_queue* queue,
+   size_t* out_length);
+
+SL_API enum sl_error
+sl_spsc_queue_capacity
+  (struct sl_spsc_queue* queue,
+   size_t* out_capacity);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_SPSC_QUEUE_H */
+
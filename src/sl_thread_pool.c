@@ -0,0 +1,572 @@
+#define _POSIX_C_SOURCE 200112L /* sysconf */
+#include "sl_mpmc_queue.h"
+#include "sl_thread_pool.h"
+#include <snlsys/math.h>
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define CACHE_LINE_SIZE 64
+#define DEQUE_CAPACITY 1024 /* Power of 2. */
+#define SHARED_QUEUE_CAPACITY 1024
+/* Number of tasks per thread produced by the adaptive grain of parallel_for. */
+#define TASKS_PER_THREAD 8
+
+/* A task either invokes func(data) or processes the range [begin, end[ with
+ * range_func. Its fields are read and written with atomic operations since a
+ * thief may read a task while its slot is reused by the owner of the deque;
+ * the thief then discards what it read. */
+struct task {
+  void (*func)(void*);
+  void (*range_func)(size_t, size_t, void*);
+  void* data;
+  size_t begin;
+  size_t end;
+  size_t grain;
+  struct sl_task_group* group;
+};
+
+/* Chase-Lev work stealing deque of fixed capacity. The owner pushes and pops
+ * tasks at the bottom; the thieves steal them at the top. */
+struct task_deque {
+  ALIGN(CACHE_LINE_SIZE) size_t top;
+  ALIGN(CACHE_LINE_SIZE) size_t bottom;
+  struct task tasks[DEQUE_CAPACITY];
+};
+
+struct worker {
+  struct task_deque deque;
+  struct sl_thread_pool* pool;
+  pthread_t thread;
+  uint64_t rng; /* State of the generator of the victims to steal. */
+};
+
+struct sl_thread_pool {
+  struct mem_allocator* allocator;
+  struct worker* workers;
+  size_t nb_workers;
+  size_t nb_started_workers;
+  struct sl_mpmc_queue* shared_queue; /* Tasks spawned by other threads. */
+
+  /* Sleep mechanism of the idle threads. The epoch is incremented each time
+   * new work is available or a task group is completed. */
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+  ALIGN(CACHE_LINE_SIZE) size_t epoch;
+  size_t nb_sleepers;
+  bool is_stopping;
+};
+
+struct sl_task_group {
+  struct sl_thread_pool* pool;
+  size_t nb_pending_tasks;
+};
+
+/* Worker executed by the current thread. NULL if it is not a worker thread. */
+static __thread struct worker* current_worker = NULL;
+
+/*******************************************************************************
+ *
+ * Task functions.
+ *
+ ******************************************************************************/
+static FINLINE void
+write_task(struct task* dst, const struct task* src)
+{
+  __atomic_store_n(&dst->func, src->func, __ATOMIC_RELAXED);
+  __atomic_store_n(&dst->range_func, src->range_func, __ATOMIC_RELAXED);
+  __atomic_store_n(&dst->data, src->data, __ATOMIC_RELAXED);
+  __atomic_store_n(&dst->begin, src->begin, __ATOMIC_RELAXED);
+  __atomic_store_n(&dst->end, src->end, __ATOMIC_RELAXED);
+  __atomic_store_n(&dst->grain, src->grain, __ATOMIC_RELAXED);
+  __atomic_store_n(&dst->group, src->group, __ATOMIC_RELAXED);
+}
+
+static FINLINE void
+read_task(struct task* dst, struct task* src)
+{
+  dst->func = __atomic_load_n(&src->func, __ATOMIC_RELAXED);
+  dst->range_func = __atomic_load_n(&src->range_func, __ATOMIC_RELAXED);
+  dst->data = __atomic_load_n(&src->data, __ATOMIC_RELAXED);
+  dst->begin = __atomic_load_n(&src->begin, __ATOMIC_RELAXED);
+  dst->end = __atomic_load_n(&src->end, __ATOMIC_RELAXED);
+  dst->grain = __atomic_load_n(&src->grain, __ATOMIC_RELAXED);
+  dst->group = __atomic_load_n(&src->group, __ATOMIC_RELAXED);
+}
+
+/*******************************************************************************
+ *
+ * Work stealing deque functions.
+ *
+ ******************************************************************************/
+static bool
+deque_push(struct task_deque* deque, const struct task* task)
+{
+  const size_t b = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED);
+  const size_t t = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+  if(b - t >= DEQUE_CAPACITY)
+    return false;
+  write_task(deque->tasks + (b & (DEQUE_CAPACITY - 1)), task);
+  __atomic_store_n(&deque->bottom, b + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+static bool
+deque_pop(struct task_deque* deque, struct task* task)
+{
+  const size_t b = __atomic_load_n(&deque->bottom, __ATOMIC_RELAXED) - 1;
+  size_t t = 0;
+  bool is_popped = true;
+
+  __atomic_store_n(&deque->bottom, b, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  t = __atomic_load_n(&deque->top, __ATOMIC_RELAXED);
+  if((ptrdiff_t)(b - t) < 0) { /* Empty deque. */
+    __atomic_store_n(&deque->bottom, b + 1, __ATOMIC_RELAXED);
+    return false;
+  }
+  read_task(task, deque->tasks + (b & (DEQUE_CAPACITY - 1)));
+  if(t == b) { /* Last task. Race against the thieves. */
+    is_popped = __atomic_compare_exchange_n
+      (&deque->top, &t, t + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+    __atomic_store_n(&deque->bottom, b + 1, __ATOMIC_RELAXED);
+  }
+  return is_popped;
+}
+
+static bool
+deque_steal(struct task_deque* deque, struct task* task)
+{
+  size_t t = __atomic_load_n(&deque->top, __ATOMIC_ACQUIRE);
+  size_t b = 0;
+
+  __atomic_thread_fence(__ATOMIC_SEQ_CST);
+  b = __atomic_load_n(&deque->bottom, __ATOMIC_ACQUIRE);
+  if((ptrdiff_t)(b - t) <= 0)
+    return false;
+  read_task(task, deque->tasks + (t & (DEQUE_CAPACITY - 1)));
+  return __atomic_compare_exchange_n
+    (&deque->top, &t, t + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED);
+}
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static size_t
+hardware_concurrency(void)
+{
+  const long n = sysconf(_SC_NPROCESSORS_ONLN);
+  return n > 0 ? (size_t)n : 1;
+}
+
+static FINLINE uint64_t
+next_random(uint64_t* state)
+{
+  /* Xorshift generator. */
+  uint64_t x = *state;
+  x ^= x << 13;
+  x ^= x >> 7;
+  x ^= x << 17;
+  return *state = x;
+}
+
+/* Wake up one idle thread since new work is available. */
+static void
+wake_one(struct sl_thread_pool* pool)
+{
+  __atomic_add_fetch(&pool->epoch, 1, __ATOMIC_SEQ_CST);
+  if(__atomic_load_n(&pool->nb_sleepers, __ATOMIC_SEQ_CST)) {
+    pthread_mutex_lock(&pool->mutex);
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+  }
+}
+
+/* Wake up all the idle threads. Used when a task group is completed since the
+ * thread that waits for it is not known. */
+static void
+wake_all(struct sl_thread_pool* pool)
+{
+  __atomic_add_fetch(&pool->epoch, 1, __ATOMIC_SEQ_CST);
+  if(__atomic_load_n(&pool->nb_sleepers, __ATOMIC_SEQ_CST)) {
+    pthread_mutex_lock(&pool->mutex);
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+  }
+}
+
+/* Sleep until the epoch differs from the submitted one, i.e. until something
+ * happens after the last unsuccessful search of a task. */
+static void
+sleep_until_new_epoch
+  (struct sl_thread_pool* pool,
+   size_t epoch,
+   const struct sl_task_group* group) /* May be NULL. */
+{
+  pthread_mutex_lock(&pool->mutex);
+  __atomic_add_fetch(&pool->nb_sleepers, 1, __ATOMIC_SEQ_CST);
+  while(__atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST) == epoch
+     && !pool->is_stopping
+     && (!group
+      || __atomic_load_n(&group->nb_pending_tasks, __ATOMIC_ACQUIRE) != 0)) {
+    pthread_cond_wait(&pool->cond, &pool->mutex);
+  }
+  __atomic_sub_fetch(&pool->nb_sleepers, 1, __ATOMIC_SEQ_CST);
+  pthread_mutex_unlock(&pool->mutex);
+}
+
+static bool
+find_task
+  (struct sl_thread_pool* pool,
+   struct worker* worker, /* May be NULL. */
+   struct task* task)
+{
+  size_t first = 0;
+  size_t i = 0;
+  bool is_found = false;
+
+  if(worker && deque_pop(&worker->deque, task))
+    return true;
+  SL(mpmc_queue_try_pop(pool->shared_queue, task, &is_found));
+  if(is_found)
+    return true;
+  if(worker)
+    first = (size_t)(next_random(&worker->rng) % pool->nb_workers);
+  for(i = 0; i < pool->nb_workers; ++i) {
+    struct worker* victim = pool->workers + (first + i) % pool->nb_workers;
+    if(victim != worker && deque_steal(&victim->deque, task))
+      return true;
+  }
+  return false;
+}
+
+static void execute_task(struct sl_thread_pool* pool, const struct task* task);
+
+/* Push the task in the deque of the current worker or in the shared queue. If
+ * the queue is full, the task is executed by the calling thread. */
+static void
+spawn_task(struct sl_thread_pool* pool, const struct task* task)
+{
+  bool is_pushed = false;
+
+  __atomic_add_fetch(&task->group->nb_pending_tasks, 1, __ATOMIC_RELAXED);
+  if(current_worker && current_worker->pool == pool) {
+    is_pushed = deque_push(&current_worker->deque, task);
+  } else {
+    SL(mpmc_queue_try_push(pool->shared_queue, task, &is_pushed));
+  }
+  if(is_pushed) {
+    wake_one(pool);
+  } else {
+    execute_task(pool, task);
+  }
+}
+
+static void
+execute_task(struct sl_thread_pool* pool, const struct task* task)
+{
+  struct sl_task_group* group = task->group;
+
+  if(task->func) {
+    task->func(task->data);
+  } else {
+    /* Split the range and spawn its upper halves until it is small enough. */
+    struct task split = *task;
+    while(split.end - split.begin > split.grain) {
+      struct task half = split;
+      half.begin = split.begin + (split.end - split.begin) / 2;
+      split.end = half.begin;
+      spawn_task(pool, &half);
+    }
+    split.range_func(split.begin, split.end, split.data);
+  }
+  if(__atomic_sub_fetch(&group->nb_pending_tasks, 1, __ATOMIC_ACQ_REL) == 0)
+    wake_all(pool);
+}
+
+/* Execute tasks until the group has no more pending tasks. */
+static void
+wait_group(struct sl_task_group* group)
+{
+  struct sl_thread_pool* pool = group->pool;
+  struct worker* worker = NULL;
+  struct task task;
+
+  if(current_worker && current_worker->pool == pool)
+    worker = current_worker;
+  while(__atomic_load_n(&group->nb_pending_tasks, __ATOMIC_ACQUIRE)) {
+    const size_t epoch = __atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST);
+    if(find_task(pool, worker, &task)) {
+      execute_task(pool, &task);
+    } else {
+      sleep_until_new_epoch(pool, epoch, group);
+    }
+  }
+}
+
+static void*
+worker_entry(void* arg)
+{
+  struct worker* worker = arg;
+  struct sl_thread_pool* pool = worker->pool;
+  struct task task;
+
+  current_worker = worker;
+  while(!__atomic_load_n(&pool->is_stopping, __ATOMIC_ACQUIRE)) {
+    const size_t epoch = __atomic_load_n(&pool->epoch, __ATOMIC_SEQ_CST);
+    if(find_task(pool, worker, &task)) {
+      execute_task(pool, &task);
+    } else {
+      sleep_until_new_epoch(pool, epoch, NULL);
+    }
+  }
+  current_worker = NULL;
+  return NULL;
+}
+
+static void
+stop_workers(struct sl_thread_pool* pool)
+{
+  size_t i = 0;
+  ASSERT(pool);
+
+  pthread_mutex_lock(&pool->mutex);
+  __atomic_store_n(&pool->is_stopping, true, __ATOMIC_RELEASE);
+  pthread_cond_broadcast(&pool->cond);
+  pthread_mutex_unlock(&pool->mutex);
+  for(i = 0; i < pool->nb_started_workers; ++i)
+    pthread_join(pool->workers[i].thread, NULL);
+  pool->nb_started_workers = 0;
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the thread pool.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_thread_pool
+  (size_t nb_threads,
+   struct mem_allocator* specific_allocator,
+   struct sl_thread_pool** out_pool)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_thread_pool* pool = NULL;
+  bool is_sync_init = false;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!out_pool) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(!nb_threads)
+    nb_threads = hardware_concurrency();
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  pool = MEM_ALIGNED_ALLOC
+    (allocator, sizeof(struct sl_thread_pool), ALIGNOF(struct sl_thread_pool));
+  if(pool == NULL) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  memset(pool, 0, sizeof(struct sl_thread_pool));
+  pool->allocator = allocator;
+  pool->nb_workers = nb_threads;
+  if(pthread_mutex_init(&pool->mutex, NULL)) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  if(pthread_cond_init(&pool->cond, NULL)) {
+    pthread_mutex_destroy(&pool->mutex);
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  is_sync_init = true;
+  err = sl_create_mpmc_queue
+    (sizeof(struct task), ALIGNOF(struct task), SHARED_QUEUE_CAPACITY,
+     allocator, &pool->shared_queue);
+  if(err != SL_NO_ERROR)
+    goto error;
+  if(nb_threads > SIZE_MAX / sizeof(struct worker)) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  pool->workers = MEM_ALIGNED_ALLOC
+    (allocator, nb_threads * sizeof(struct worker), ALIGNOF(struct worker));
+  if(!pool->workers) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  memset(pool->workers, 0, nb_threads * sizeof(struct worker));
+  for(i = 0; i < nb_threads; ++i) {
+    struct worker* worker = pool->workers + i;
+    worker->pool = pool;
+    worker->rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+    if(pthread_create(&worker->thread, NULL, worker_entry, worker)) {
+      err = SL_MEMORY_ERROR;
+      goto error;
+    }
+    ++pool->nb_started_workers;
+  }
+
+exit:
+  if(out_pool)
+    *out_pool = pool;
+  return err;
+
+error:
+  if(pool) {
+    if(is_sync_init) {
+      stop_workers(pool);
+      pthread_cond_destroy(&pool->cond);
+      pthread_mutex_destroy(&pool->mutex);
+    }
+    if(pool->workers)
+      MEM_FREE(allocator, pool->workers);
+    if(pool->shared_queue)
+      SL(free_mpmc_queue(pool->shared_queue));
+    MEM_FREE(allocator, pool);
+    pool = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_thread_pool
+  (struct sl_thread_pool* pool)
+{
+  struct mem_allocator* allocator = NULL;
+
+  if(!pool)
+    return SL_INVALID_ARGUMENT;
+
+  allocator = pool->allocator;
+  stop_workers(pool);
+  pthread_cond_destroy(&pool->cond);
+  pthread_mutex_destroy(&pool->mutex);
+  SL(free_mpmc_queue(pool->shared_queue));
+  MEM_FREE(allocator, pool->workers);
+  MEM_FREE(allocator, pool);
+
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_thread_pool_thread_count
+  (struct sl_thread_pool* pool,
+   size_t* nb_threads)
+{
+  if(!pool || !nb_threads)
+    return SL_INVALID_ARGUMENT;
+  *nb_threads = pool->nb_workers;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_thread_pool_parallel_for
+  (struct sl_thread_pool* pool,
+   size_t begin,
+   size_t end,
+   size_t grain,
+   void (*func)(size_t, size_t, void*),
+   void* data)
+{
+  struct sl_task_group group;
+  struct task task;
+
+  if(!pool || !func || begin > end)
+    return SL_INVALID_ARGUMENT;
+  if(begin == end)
+    return SL_NO_ERROR;
+
+  if(!grain) {
+    /* Split the range in enough tasks to balance the load between the worker
+     * threads and the calling thread. */
+    grain = (end - begin) / ((pool->nb_workers + 1) * TASKS_PER_THREAD);
+    grain = MAX(grain, 1);
+  }
+  group.pool = pool;
+  group.nb_pending_tasks = 1;
+  task.func = NULL;
+  task.range_func = func;
+  task.data = data;
+  task.begin = begin;
+  task.end = end;
+  task.grain = grain;
+  task.group = &group;
+  execute_task(pool, &task);
+  wait_group(&group);
+  return SL_NO_ERROR;
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the task group.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_task_group
+  (struct sl_thread_pool* pool,
+   struct sl_task_group** out_group)
+{
+  struct sl_task_group* group = NULL;
+
+  if(!pool || !out_group)
+    return SL_INVALID_ARGUMENT;
+  group = MEM_CALLOC(pool->allocator, 1, sizeof(struct sl_task_group));
+  if(!group)
+    return SL_MEMORY_ERROR;
+  group->pool = pool;
+  *out_group = group;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_task_group
+  (struct sl_task_group* group)
+{
+  if(!group)
+    return SL_INVALID_ARGUMENT;
+  ASSERT(!__atomic_load_n(&group->nb_pending_tasks, __ATOMIC_ACQUIRE));
+  MEM_FREE(group->pool->allocator, group);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_task_group_run
+  (struct sl_task_group* group,
+   void (*func)(void*),
+   void* data)
+{
+  struct task task;
+
+  if(!group || !func)
+    return SL_INVALID_ARGUMENT;
+  task.func = func;
+  task.range_func = NULL;
+  task.data = data;
+  task.begin = 0;
+  task.end = 0;
+  task.grain = 0;
+  task.group = group;
+  spawn_task(group->pool, &task);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_task_group_wait
+  (struct sl_task_group* group)
+{
+  if(!group)
+    return SL_INVALID_ARGUMENT;
+  wait_group(group);
+  return SL_NO_ERROR;
+}
+
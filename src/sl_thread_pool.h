@@ -0,0 +1,94 @@
+#ifndef SL_THREAD_POOL_H
+#define SL_THREAD_POOL_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stddef.h>
+
+struct mem_allocator;
+
+/* Pool of worker threads. Each worker owns a deque of tasks; a worker whose
+ * deque is empty steals the oldest tasks of the other workers. Tasks spawned
+ * from a thread that is not a worker of the pool are pushed in a shared
+ * queue. */
+struct sl_thread_pool;
+
+/* Set of tasks that can be waited for. A thread that waits for a task group
+ * executes pending tasks until all the tasks of the group are completed. */
+struct sl_task_group;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*******************************************************************************
+ *
+ * Thread pool functions.
+ *
+ ******************************************************************************/
+SL_API enum sl_error
+sl_create_thread_pool
+  (size_t nb_threads, /* 0 <=> number of online processors. */
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_thread_pool** out_pool);
+
+/* Wait for the completion of the running tasks and join the worker threads.
+ * No task group of the pool may have pending tasks. */
+SL_API enum sl_error
+sl_free_thread_pool
+  (struct sl_thread_pool* pool);
+
+SL_API enum sl_error
+sl_thread_pool_thread_count
+  (struct sl_thread_pool* pool,
+   size_t* out_nb_threads);
+
+/* Invoke func on sub-ranges of [begin, end[ in parallel and return once the
+ * whole range is processed. The range is recursively split in two halves
+ * until the sub-ranges have at most grain indices; the idle workers steal the
+ * largest pending halves. A grain of 0 lets the pool choose it with respect
+ * to the size of the range and the number of threads. */
+SL_API enum sl_error
+sl_thread_pool_parallel_for
+  (struct sl_thread_pool* pool,
+   size_t begin,
+   size_t end,
+   size_t grain,
+   void (*func)(size_t begin, size_t end, void* data),
+   void* data); /* May be NULL. */
+
+/*******************************************************************************
+ *
+ * Task group functions.
+ *
+ ******************************************************************************/
+SL_API enum sl_error
+sl_create_task_group
+  (struct sl_thread_pool* pool,
+   struct sl_task_group** out_group);
+
+/* The group must not have pending tasks. */
+SL_API enum sl_error
+sl_free_task_group
+  (struct sl_task_group* group);
+
+/* Spawn a task that invokes func(data). The task may be executed by the
+ * calling thread if the task queues are full. */
+SL_API enum sl_error
+sl_task_group_run
+  (struct sl_task_group* group,
+   void (*func)(void* data),
+   void* data); /* May be NULL. */
+
+/* Execute tasks of the pool until all the tasks of the group are completed,
+ * including the tasks spawned by the tasks of the group. */
+SL_API enum sl_error
+sl_task_group_wait
+  (struct sl_task_group* group);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_THREAD_POOL_H */
+
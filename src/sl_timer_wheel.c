@@ -0,0 +1,408 @@
+#include "sl_timer_wheel.h"
+#include "sl_vector.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK ((uint64_t)WHEEL_SIZE - 1)
+#define NB_LEVELS ((64 + WHEEL_BITS - 1) / WHEEL_BITS)
+#define NB_SLOTS (NB_LEVELS * WHEEL_SIZE)
+#define NIL UINT32_MAX
+
+struct entry {
+  uint64_t deadline;
+  uint32_t generation; /* Incremented each time the entry is released. */
+  uint32_t slot; /* NIL if the entry is free. */
+  uint32_t prev;
+  uint32_t next; /* Next entry of the slot or of the free list. */
+};
+
+struct sl_timer_wheel {
+  struct mem_allocator* allocator;
+  struct sl_vector* entries; /* Pool of struct entry. */
+  struct sl_vector* data; /* Data of the entries. */
+  struct sl_vector* expired;
+  uint32_t heads[NB_SLOTS]; /* First entry of each slot. */
+  uint64_t occupancy[NB_LEVELS]; /* Bit i is set if the slot i is not empty. */
+  uint64_t tick;
+  uint32_t free_list;
+  size_t length;
+  size_t data_size;
+};
+
+/*******************************************************************************
+ *
+ * Helper functions.
+ *
+ ******************************************************************************/
+static FINLINE struct entry*
+entries_of(struct sl_timer_wheel* wheel)
+{
+  void* buffer = NULL;
+  ASSERT(wheel);
+  SL(vector_buffer(wheel->entries, NULL, NULL, NULL, &buffer));
+  return buffer;
+}
+
+static FINLINE char*
+data_of(struct sl_timer_wheel* wheel)
+{
+  void* buffer = NULL;
+  ASSERT(wheel);
+  SL(vector_buffer(wheel->data, NULL, NULL, NULL, &buffer));
+  return buffer;
+}
+
+/* Insert the entry in the slot defined by the highest bits that differ
+ * between its deadline and the current tick. */
+static void
+link_entry(struct sl_timer_wheel* wheel, struct entry* entries, uint32_t id)
+{
+  struct entry* entry = entries + id;
+  const uint64_t diff = entry->deadline ^ wheel->tick;
+  uint32_t level = 0;
+  uint32_t digit = 0;
+  ASSERT(wheel && entries && entry->deadline >= wheel->tick);
+
+  level = diff ? (uint32_t)(63 - __builtin_clzll(diff)) / WHEEL_BITS : 0;
+  digit = (uint32_t)((entry->deadline >> (level * WHEEL_BITS)) & WHEEL_MASK);
+  entry->slot = level * WHEEL_SIZE + digit;
+  entry->prev = NIL;
+  entry->next = wheel->heads[entry->slot];
+  if(entry->next != NIL)
+    entries[entry->next].prev = id;
+  wheel->heads[entry->slot] = id;
+  wheel->occupancy[level] |= 1ULL << digit;
+}
+
+static void
+unlink_entry(struct sl_timer_wheel* wheel, struct entry* entries, uint32_t id)
+{
+  struct entry* entry = entries + id;
+  ASSERT(wheel && entries && entry->slot != NIL);
+
+  if(entry->prev != NIL) {
+    entries[entry->prev].next = entry->next;
+  } else {
+    wheel->heads[entry->slot] = entry->next;
+    if(entry->next == NIL) {
+      wheel->occupancy[entry->slot / WHEEL_SIZE] &=
+        ~(1ULL << (entry->slot % WHEEL_SIZE));
+    }
+  }
+  if(entry->next != NIL)
+    entries[entry->next].prev = entry->prev;
+}
+
+static void
+release_entry(struct sl_timer_wheel* wheel, struct entry* entries, uint32_t id)
+{
+  struct entry* entry = entries + id;
+  ASSERT(wheel && entries && wheel->length);
+
+  entry->slot = NIL;
+  ++entry->generation;
+  entry->next = wheel->free_list;
+  wheel->free_list = id;
+  --wheel->length;
+}
+
+/* Return the level of the first non empty slot after the current tick and
+ * set out_tick to the tick at which this slot is reached, or return -1 if
+ * the wheel is empty. */
+static int
+next_slot(struct sl_timer_wheel* wheel, uint64_t* out_tick)
+{
+  int level = 0;
+  ASSERT(wheel && out_tick);
+
+  for(level = 0; level < NB_LEVELS; ++level) {
+    const uint32_t shift = (uint32_t)level * WHEEL_BITS;
+    const uint64_t digit = (wheel->tick >> shift) & WHEEL_MASK;
+    /* Slots strictly after the digit of the current tick. */
+    const uint64_t mask = wheel->occupancy[level] & ~((2ULL << digit) - 1);
+    if(mask) {
+      const uint32_t upper_shift = shift + WHEEL_BITS;
+      uint64_t upper = 0;
+      if(upper_shift < 64)
+        upper = (wheel->tick >> upper_shift) << upper_shift;
+      *out_tick = upper | ((uint64_t)__builtin_ctzll(mask) << shift);
+      return level;
+    }
+  }
+  return -1;
+}
+
+/* Move the entries of the slot to the lower levels. */
+static void
+cascade(struct sl_timer_wheel* wheel, uint32_t slot)
+{
+  struct entry* entries = entries_of(wheel);
+  uint32_t id = wheel->heads[slot];
+  ASSERT(slot >= WHEEL_SIZE);
+
+  wheel->heads[slot] = NIL;
+  wheel->occupancy[slot / WHEEL_SIZE] &= ~(1ULL << (slot % WHEEL_SIZE));
+  while(id != NIL) {
+    const uint32_t next = entries[id].next;
+    link_entry(wheel, entries, id);
+    id = next;
+  }
+}
+
+/* Append the data of the entries of the first level slot to the expired
+ * entries. On error, the entries not yet expired remain in the slot. */
+static enum sl_error
+expire(struct sl_timer_wheel* wheel, uint32_t slot)
+{
+  struct entry* entries = entries_of(wheel);
+  const char* data = data_of(wheel);
+  ASSERT(slot < WHEEL_SIZE);
+
+  while(wheel->heads[slot] != NIL) {
+    const uint32_t id = wheel->heads[slot];
+    const enum sl_error err = sl_vector_push_back
+      (wheel->expired, data + id * wheel->data_size);
+    if(err != SL_NO_ERROR)
+      return err;
+    unlink_entry(wheel, entries, id);
+    release_entry(wheel, entries, id);
+  }
+  return SL_NO_ERROR;
+}
+
+/*******************************************************************************
+ *
+ * Implementation of the timer wheel functions.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_timer_wheel
+  (size_t data_size,
+   size_t data_alignment,
+   uint64_t tick,
+   struct mem_allocator* specific_allocator,
+   struct sl_timer_wheel** out_wheel)
+{
+  struct mem_allocator* allocator = NULL;
+  struct sl_timer_wheel* wheel = NULL;
+  size_t i = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!out_wheel || !data_size) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(!IS_POWER_OF_2(data_alignment)) {
+    err = SL_ALIGNMENT_ERROR;
+    goto error;
+  }
+  allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
+  wheel = MEM_CALLOC(allocator, 1, sizeof(struct sl_timer_wheel));
+  if(!wheel) {
+    err = SL_MEMORY_ERROR;
+    goto error;
+  }
+  wheel->allocator = allocator;
+  err = sl_create_vector
+    (sizeof(struct entry), ALIGNOF(struct entry), allocator, &wheel->entries);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_create_vector(data_size, data_alignment, allocator, &wheel->data);
+  if(err != SL_NO_ERROR)
+    goto error;
+  err = sl_create_vector
+    (data_size, data_alignment, allocator, &wheel->expired);
+  if(err != SL_NO_ERROR)
+    goto error;
+  for(i = 0; i < NB_SLOTS; ++i)
+    wheel->heads[i] = NIL;
+  wheel->tick = tick;
+  wheel->free_list = NIL;
+  wheel->data_size = data_size;
+
+exit:
+  if(out_wheel)
+    *out_wheel = wheel;
+  return err;
+
+error:
+  if(wheel) {
+    if(wheel->entries)
+      SL(free_vector(wheel->entries));
+    if(wheel->data)
+      SL(free_vector(wheel->data));
+    if(wheel->expired)
+      SL(free_vector(wheel->expired));
+    MEM_FREE(allocator, wheel);
+    wheel = NULL;
+  }
+  goto exit;
+}
+
+EXPORT_SYM enum sl_error
+sl_free_timer_wheel
+  (struct sl_timer_wheel* wheel)
+{
+  if(!wheel)
+    return SL_INVALID_ARGUMENT;
+  SL(free_vector(wheel->entries));
+  SL(free_vector(wheel->data));
+  SL(free_vector(wheel->expired));
+  MEM_FREE(wheel->allocator, wheel);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_clear_timer_wheel
+  (struct sl_timer_wheel* wheel)
+{
+  struct entry* entries = NULL;
+  size_t slot = 0;
+
+  if(!wheel)
+    return SL_INVALID_ARGUMENT;
+  entries = entries_of(wheel);
+  for(slot = 0; slot < NB_SLOTS; ++slot) {
+    while(wheel->heads[slot] != NIL) {
+      const uint32_t id = wheel->heads[slot];
+      wheel->heads[slot] = entries[id].next;
+      release_entry(wheel, entries, id);
+    }
+  }
+  memset(wheel->occupancy, 0, sizeof(wheel->occupancy));
+  SL(clear_vector(wheel->expired));
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_timer_wheel_schedule
+  (struct sl_timer_wheel* wheel,
+   uint64_t deadline,
+   const void* data,
+   uint64_t* out_timer_id)
+{
+  struct entry* entries = NULL;
+  uint32_t id = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!wheel || !data)
+    return SL_INVALID_ARGUMENT;
+
+  if(wheel->free_list != NIL) {
+    id = wheel->free_list;
+    entries = entries_of(wheel);
+    wheel->free_list = entries[id].next;
+    memcpy(data_of(wheel) + id * wheel->data_size, data, wheel->data_size);
+  } else {
+    struct entry entry;
+    size_t nb_entries = 0;
+
+    SL(vector_length(wheel->entries, &nb_entries));
+    if(nb_entries >= NIL)
+      return SL_MEMORY_ERROR;
+    memset(&entry, 0, sizeof(entry));
+    err = sl_vector_push_back(wheel->entries, &entry);
+    if(err != SL_NO_ERROR)
+      return err;
+    err = sl_vector_push_back(wheel->data, data);
+    if(err != SL_NO_ERROR) {
+      SL(vector_pop_back(wheel->entries));
+      return err;
+    }
+    id = (uint32_t)nb_entries;
+    entries = entries_of(wheel);
+  }
+  entries[id].deadline = MAX(deadline, wheel->tick);
+  link_entry(wheel, entries, id);
+  ++wheel->length;
+  if(out_timer_id)
+    *out_timer_id = ((uint64_t)entries[id].generation << 32) | id;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_timer_wheel_cancel
+  (struct sl_timer_wheel* wheel,
+   uint64_t timer_id)
+{
+  const uint32_t id = (uint32_t)(timer_id & 0xFFFFFFFF);
+  struct entry* entries = NULL;
+  size_t nb_entries = 0;
+
+  if(!wheel)
+    return SL_INVALID_ARGUMENT;
+  SL(vector_length(wheel->entries, &nb_entries));
+  if(id >= nb_entries)
+    return SL_INVALID_ARGUMENT;
+  entries = entries_of(wheel);
+  if(entries[id].slot == NIL || entries[id].generation != timer_id >> 32)
+    return SL_INVALID_ARGUMENT;
+  unlink_entry(wheel, entries, id);
+  release_entry(wheel, entries, id);
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_timer_wheel_advance
+  (struct sl_timer_wheel* wheel,
+   uint64_t tick,
+   size_t* out_count,
+   void** out_expired)
+{
+  void* expired = NULL;
+  uint64_t next_tick = 0;
+  int level = 0;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!wheel || !out_count || !out_expired || tick < wheel->tick)
+    return SL_INVALID_ARGUMENT;
+
+  SL(clear_vector(wheel->expired));
+  /* Timers scheduled at or before the current tick. */
+  err = expire(wheel, (uint32_t)(wheel->tick & WHEEL_MASK));
+  while(err == SL_NO_ERROR) {
+    level = next_slot(wheel, &next_tick);
+    if(level < 0 || next_tick > tick) {
+      wheel->tick = tick;
+      break;
+    }
+    wheel->tick = next_tick;
+    if(level > 0) {
+      const uint32_t shift = (uint32_t)level * WHEEL_BITS;
+      cascade(wheel, (uint32_t)level * WHEEL_SIZE
+        + (uint32_t)((next_tick >> shift) & WHEEL_MASK));
+    }
+    err = expire(wheel, (uint32_t)(next_tick & WHEEL_MASK));
+  }
+  SL(vector_buffer(wheel->expired, out_count, NULL, NULL, &expired));
+  *out_expired = expired;
+  return err;
+}
+
+EXPORT_SYM enum sl_error
+sl_timer_wheel_tick
+  (struct sl_timer_wheel* wheel,
+   uint64_t* out_tick)
+{
+  if(!wheel || !out_tick)
+    return SL_INVALID_ARGUMENT;
+  *out_tick = wheel->tick;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_timer_wheel_length
+  (struct sl_timer_wheel* wheel,
+   size_t* out_length)
+{
+  if(!wheel || !out_length)
+    return SL_INVALID_ARGUMENT;
+  *out_length = wheel->length;
+  return SL_NO_ERROR;
+}
+
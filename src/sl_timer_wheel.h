@@ -0,0 +1,83 @@
+#ifndef SL_TIMER_WHEEL_H
+#define SL_TIMER_WHEEL_H
+
+#include "sl.h"
+#include "sl_error.h"
+#include <stddef.h>
+#include <stdint.h>
+
+struct mem_allocator;
+
+/* Hierarchical timing wheel. Each level splits the time in 64 slots and a
+ * slot of a level covers the whole span of the level below. A timer is stored
+ * in the level of the highest bits that differ between its deadline and the
+ * current tick, and moves down the levels as the time advances. Scheduling
+ * and cancelling a timer are done in constant time; the timers are linked in
+ * their slot and come from a pool of entries recycled on expiry or cancel. */
+struct sl_timer_wheel;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+SL_API enum sl_error
+sl_create_timer_wheel
+  (size_t data_size,
+   size_t data_alignment,
+   uint64_t tick, /* Initial current tick. */
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_timer_wheel** out_wheel);
+
+SL_API enum sl_error
+sl_free_timer_wheel
+  (struct sl_timer_wheel* wheel);
+
+/* Remove all the timers without expiring them. */
+SL_API enum sl_error
+sl_clear_timer_wheel
+  (struct sl_timer_wheel* wheel);
+
+/* Register data to expire at the deadline tick. A deadline that is not after
+ * the current tick expires on the next advance. The returned id identifies
+ * the timer until it expires or is cancelled. */
+SL_API enum sl_error
+sl_timer_wheel_schedule
+  (struct sl_timer_wheel* wheel,
+   uint64_t deadline,
+   const void* data,
+   uint64_t* out_timer_id); /* May be NULL. */
+
+/* Return SL_INVALID_ARGUMENT if the timer already expired or was cancelled. */
+SL_API enum sl_error
+sl_timer_wheel_cancel
+  (struct sl_timer_wheel* wheel,
+   uint64_t timer_id);
+
+/* Move the current tick to tick and expire the timers whose deadline is not
+ * after it. The data of the expired timers are returned in a contiguous array,
+ * ordered by deadline, that is valid until the next call to a function of the
+ * wheel. Idle periods are skipped in one step per non empty slot. */
+SL_API enum sl_error
+sl_timer_wheel_advance
+  (struct sl_timer_wheel* wheel,
+   uint64_t tick, /* Must not be lower than the current tick. */
+   size_t* out_count,
+   void** out_expired); /* Set to NULL if count is 0. */
+
+SL_API enum sl_error
+sl_timer_wheel_tick
+  (struct sl_timer_wheel* wheel,
+   uint64_t* out_tick);
+
+/* Number of pending timers. */
+SL_API enum sl_error
+sl_timer_wheel_length
+  (struct sl_timer_wheel* wheel,
+   size_t* out_length);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* SL_TIMER_WHEEL_H */
+
@@ -13,6 +13,14 @@ struct sl_vector {
   size_t length;
   size_t capacity; /* In number of vector elements, not in bytes. */
   void* buffer;
+  /* Growth policy. */
+  enum sl_vector_growth_policy growth_policy;
+  size_t chunk_threshold; /* In number of vector elements. */
+  size_t chunk_size; /* In number of vector elements. */
+  /* Storage allocated with the vector itself. NULL if the vector is not a
+   * small vector. */
+  void* inline_buffer;
+  size_t inline_capacity; /* In number of vector elements. */
 };
 
 /*******************************************************************************
@@ -20,6 +28,54 @@ struct sl_vector {
  * Helper functions.
  *
  ******************************************************************************/
+/* Compute the capacity to allocate in order to store at least `capacity'
+ * elements with respect to the growth policy of the vector. */
+static size_t
+next_capacity(const struct sl_vector* vec, size_t capacity)
+{
+  size_t new_capacity = 0;
+  ASSERT(vec && capacity > vec->capacity);
+
+  switch(vec->growth_policy) {
+    case SL_VECTOR_GROWTH_FACTOR_2:
+      NEXT_POWER_OF_2(capacity, new_capacity);
+      break;
+    case SL_VECTOR_GROWTH_FACTOR_1_5:
+      new_capacity = vec->capacity + vec->capacity / 2;
+      new_capacity = MAX(new_capacity, capacity);
+      break;
+    case SL_VECTOR_GROWTH_EXACT:
+      new_capacity = capacity;
+      break;
+    case SL_VECTOR_GROWTH_CHUNKED:
+      if(capacity <= vec->chunk_threshold) {
+        NEXT_POWER_OF_2(capacity, new_capacity);
+        new_capacity = MIN(new_capacity, vec->chunk_threshold);
+      } else {
+        /* Linear growth by a multiple of chunk_size elements. */
+        const size_t mod = capacity % vec->chunk_size;
+        new_capacity = mod == 0 ? capacity : capacity - mod + vec->chunk_size;
+      }
+      break;
+    default:
+      ASSERT(0);
+      break;
+  }
+  /* Handle the overflow of the growth. */
+  if(new_capacity < capacity)
+    new_capacity = capacity;
+  return new_capacity;
+}
+
+/* Free the buffer of the vector unless it is its inline storage. */
+static void
+release_buffer(struct sl_vector* vec)
+{
+  ASSERT(vec);
+  if(vec->buffer && vec->buffer != vec->inline_buffer)
+    MEM_FREE(vec->allocator, vec->buffer);
+}
+
 static enum sl_error
 ensure_allocated(struct sl_vector* vec, size_t capacity, bool keep_data)
 {
@@ -28,18 +84,21 @@ ensure_allocated(struct sl_vector* vec, size_t capacity, bool keep_data)
   ASSERT(vec);
 
   if(capacity > vec->capacity) {
-    size_t new_capacity = 0;
-    NEXT_POWER_OF_2(capacity, new_capacity);
+    const size_t new_capacity = next_capacity(vec, capacity);
+    if(new_capacity > SIZE_MAX / vec->data_size) {
+      sl_err = SL_OVERFLOW_ERROR;
+      goto error;
+    }
     buffer = MEM_ALIGNED_ALLOC
       (vec->allocator, new_capacity * vec->data_size, vec->data_alignment);
     if(!buffer) {
       sl_err = SL_MEMORY_ERROR;
       goto error;
     }
-    if(keep_data) {
-      buffer = memcpy(buffer, vec->buffer, vec->capacity * vec->data_size);
+    if(keep_data && vec->length) {
+      buffer = memcpy(buffer, vec->buffer, vec->length * vec->data_size);
     }
-    MEM_FREE(vec->allocator, vec->buffer);
+    release_buffer(vec);
     vec->buffer = buffer;
     vec->capacity = new_capacity;
     buffer = NULL;
@@ -55,20 +114,159 @@ error:
   goto exit;
 }
 
-/*******************************************************************************
- *
- * Implementation of the vector container.
- *
- ******************************************************************************/
-EXPORT_SYM enum sl_error
-sl_create_vector
+/* Copy the element pointed by data into the count contiguous elements starting
+ * at dst. Rather than copying the element count times, the already filled
+ * elements are used as the source of the next copy, i.e. 1, 2, 4, ... elements
+ * are copied at each step. */
+static void
+fill(void* dst, const void* data, size_t count, size_t data_size)
+{
+  size_t nb_filled = 0;
+  ASSERT(dst && data && data_size);
+  ASSERT(!IS_MEMORY_OVERLAPPED(dst, count * data_size, data, data_size));
+
+  if(count == 0)
+    return;
+  memcpy(dst, data, data_size);
+  nb_filled = 1;
+  while(nb_filled < count) {
+    const size_t nb_copies = MIN(nb_filled, count - nb_filled);
+    memcpy
+      ((void*)((uintptr_t)dst + nb_filled * data_size),
+       dst,
+       nb_copies * data_size);
+    nb_filled += nb_copies;
+  }
+}
+
+/* Insert count elements at the position id. If is_range is true, data points
+ * toward an array of count elements; otherwise data points toward one element
+ * that is replicated count times. */
+static enum sl_error
+insert
+  (struct sl_vector* vec,
+   size_t id,
+   size_t count,
+   const void* data,
+   const bool is_range)
+{
+  void* buffer = NULL;
+  const void* src = NULL;
+  void* dst = NULL;
+  size_t new_capacity = 0;
+  size_t src_size = 0;
+  bool is_data_in_vec = false;
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!vec || (id > vec->length) || !data) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(0 == count) {
+    goto exit;
+  }
+  if(!IS_ALIGNED(data, vec->data_alignment)) {
+    err = SL_ALIGNMENT_ERROR;
+    goto error;
+  }
+  if(count > SIZE_MAX - vec->length
+  || (is_range && count > SIZE_MAX / vec->data_size)) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  src_size = is_range ? count * vec->data_size : vec->data_size;
+  is_data_in_vec = vec->length && IS_MEMORY_OVERLAPPED
+    (data, src_size, vec->buffer, vec->length * vec->data_size);
+
+  /* An inserted range that lies in the vector may overlap both the moved and
+   * the unmoved parts of the vector. Build the result in a new buffer rather
+   * than tracking the two parts of the source range. */
+  if(vec->length + count > vec->capacity || (is_range && is_data_in_vec)) {
+    if(vec->length + count > vec->capacity) {
+      new_capacity = next_capacity(vec, vec->length + count);
+    } else {
+      new_capacity = vec->capacity;
+    }
+    if(new_capacity > SIZE_MAX / vec->data_size) {
+      err = SL_OVERFLOW_ERROR;
+      goto error;
+    }
+    buffer = MEM_ALIGNED_ALLOC
+      (vec->allocator, new_capacity * vec->data_size, vec->data_alignment);
+    if(!buffer) {
+      err = SL_MEMORY_ERROR;
+      goto error;
+    }
+
+    /* Copy the vector data ranging from [0, id[ into the new buffer. */
+    if(id > 0)
+      memcpy(buffer, vec->buffer, vec->data_size * id);
+
+    if(id < vec->length) {
+      /* Copy from the vector data [id, length[ to the new buffer
+       * [id+count, length + count[. */
+      src = (void*)((uintptr_t)(vec->buffer) + vec->data_size * id);
+      dst = (void*)((uintptr_t)(buffer) + vec->data_size * (id + count));
+      memcpy(dst, src, vec->data_size * (vec->length - id));
+    }
+
+    /* The data to insert may be contained in vec, i.e. free vec->buffer
+     * *AFTER* the insertion. */
+    dst = (void*)((uintptr_t)(buffer) + vec->data_size * id);
+    if(is_range) {
+      memcpy(dst, data, src_size);
+    } else {
+      fill(dst, data, count, vec->data_size);
+    }
+    release_buffer(vec);
+
+    vec->buffer = buffer;
+    vec->capacity = new_capacity;
+    buffer = NULL;
+
+  } else {
+    if(id < vec->length) {
+      src = (void*)((uintptr_t)(vec->buffer) + vec->data_size * id);
+      dst = (void*)((uintptr_t)(vec->buffer) + vec->data_size * (id + count));
+      memmove(dst, src, vec->data_size * (vec->length - id));
+    }
+
+    /* Note that if the data to insert lies in the vector range
+     * [id, vec.length[ then it was previously memoved. Its new address is
+     * offseted by count * data_size bytes. */
+    dst = (void*)((uintptr_t)(vec->buffer) + vec->data_size * id);
+    if(is_data_in_vec && (uintptr_t)data >= (uintptr_t)dst) {
+      src = (void*)((uintptr_t)data + count * vec->data_size);
+    } else {
+      src = data;
+    }
+    if(is_range) {
+      memcpy(dst, src, src_size);
+    } else {
+      fill(dst, src, count, vec->data_size);
+    }
+  }
+  vec->length += count;
+
+exit:
+  return err;
+error:
+  if(buffer)
+    MEM_FREE(vec->allocator, buffer);
+  goto exit;
+}
+
+static enum sl_error
+create_vector
   (size_t data_size,
    size_t data_alignment,
+   size_t inline_capacity,
    struct mem_allocator* specific_allocator,
    struct sl_vector** out_vec)
 {
   struct mem_allocator* allocator = NULL;
   struct sl_vector* vec = NULL;
+  size_t header_size = sizeof(struct sl_vector);
   enum sl_error err = SL_NO_ERROR;
 
   if(!out_vec || !data_size) {
@@ -80,7 +278,21 @@ sl_create_vector
     goto error;
   }
   allocator = specific_allocator ? specific_allocator : &mem_default_allocator;
-  vec = MEM_CALLOC(allocator, 1, sizeof(struct sl_vector));
+  if(!inline_capacity) {
+    vec = MEM_CALLOC(allocator, 1, sizeof(struct sl_vector));
+  } else {
+    /* The inline storage follows the vector header in the same allocation. */
+    const size_t align = MAX(data_alignment, ALIGNOF(struct sl_vector));
+    header_size = (header_size + data_alignment - 1) & ~(data_alignment - 1);
+    if(inline_capacity > (SIZE_MAX - header_size) / data_size) {
+      err = SL_OVERFLOW_ERROR;
+      goto error;
+    }
+    vec = MEM_ALIGNED_ALLOC
+      (allocator, header_size + inline_capacity * data_size, align);
+    if(vec)
+      memset(vec, 0, sizeof(struct sl_vector));
+  }
   if(vec == NULL) {
     err = SL_MEMORY_ERROR;
     goto error;
@@ -88,6 +300,13 @@ sl_create_vector
   vec->allocator = allocator;
   vec->data_size = data_size;
   vec->data_alignment = data_alignment;
+  vec->growth_policy = SL_VECTOR_GROWTH_FACTOR_2;
+  if(inline_capacity) {
+    vec->inline_buffer = (void*)((uintptr_t)vec + header_size);
+    vec->inline_capacity = inline_capacity;
+    vec->buffer = vec->inline_buffer;
+    vec->capacity = inline_capacity;
+  }
 
 exit:
   if(out_vec)
@@ -103,6 +322,38 @@ error:
   goto exit;
 }
 
+/*******************************************************************************
+ *
+ * Implementation of the vector container.
+ *
+ ******************************************************************************/
+EXPORT_SYM enum sl_error
+sl_create_vector
+  (size_t data_size,
+   size_t data_alignment,
+   struct mem_allocator* allocator,
+   struct sl_vector** out_vec)
+{
+  return create_vector(data_size, data_alignment, 0, allocator, out_vec);
+}
+
+EXPORT_SYM enum sl_error
+sl_create_small_vector
+  (size_t data_size,
+   size_t data_alignment,
+   size_t inline_capacity,
+   struct mem_allocator* allocator,
+   struct sl_vector** out_vec)
+{
+  if(!inline_capacity) {
+    if(out_vec)
+      *out_vec = NULL;
+    return SL_INVALID_ARGUMENT;
+  }
+  return create_vector
+    (data_size, data_alignment, inline_capacity, allocator, out_vec);
+}
+
 EXPORT_SYM enum sl_error
 sl_free_vector
   (struct sl_vector* vec)
@@ -113,8 +364,7 @@ sl_free_vector
     return SL_INVALID_ARGUMENT;
 
   allocator = vec->allocator;
-  if(vec->buffer)
-    MEM_FREE(allocator, vec->buffer);
+  release_buffer(vec);
   MEM_FREE(allocator, vec);
 
   return SL_NO_ERROR;
@@ -139,22 +389,39 @@ sl_vector_push_back(struct sl_vector* vec, const void* data)
 EXPORT_SYM enum sl_error
 sl_vector_push_back_n(struct sl_vector* vec, size_t count, const void* data)
 {
-  void* ptr = NULL;
-  size_t i = 0;
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+  return insert(vec, vec->length, count, data, false);
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_append_range(struct sl_vector* vec, size_t count, const void* data)
+{
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+  return insert(vec, vec->length, count, data, true);
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_emplace_back(struct sl_vector* vec, void** data)
+{
+  return sl_vector_append_uninit(vec, 1, data);
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_append_uninit(struct sl_vector* vec, size_t count, void** data)
+{
   enum sl_error err = SL_NO_ERROR;
 
   if(!vec || !data) {
     err = SL_INVALID_ARGUMENT;
     goto error;
   }
-  if(!IS_ALIGNED(data, vec->data_alignment)) {
-    err = SL_ALIGNMENT_ERROR;
-    goto error;
-  }
   if(count == 0) {
+    *data = NULL;
     goto exit;
   }
-  if(vec->length == SIZE_MAX) {
+  if(count > SIZE_MAX - vec->length) {
     err = SL_OVERFLOW_ERROR;
     goto error;
   }
@@ -163,14 +430,13 @@ sl_vector_push_back_n(struct sl_vector* vec, size_t count, const void* data)
   if(SL_NO_ERROR != err)
     goto error;
 
-  for(i = 0; i < count; ++i) {
-    ptr = (void*)((uintptr_t)vec->buffer + (vec->length + i) * vec->data_size);
-    memcpy(ptr, data, vec->data_size);
-  }
+  *data = (void*)((uintptr_t)vec->buffer + vec->length * vec->data_size);
   vec->length += count;
 exit:
   return err;
 error:
+  if(data)
+    *data = NULL;
   goto exit;
 }
 
@@ -200,115 +466,17 @@ sl_vector_insert_n
    size_t count,
    const void* data)
 {
-  void* buffer = NULL;
-  const void* src = NULL;
-  void* dst = NULL;
-  size_t i = 0;
-  enum sl_error err = SL_NO_ERROR;
-
-  if(!vec || (id > vec->length) || !data) {
-    err = SL_INVALID_ARGUMENT;
-    goto error;
-  }
-  if(0 == count) {
-    goto exit;
-  }
-  if(!IS_ALIGNED(data, vec->data_alignment)) {
-    err = SL_ALIGNMENT_ERROR;
-    goto error;
-  }
-  if(vec->length == SIZE_MAX) {
-    err = SL_OVERFLOW_ERROR;
-    goto error;
-  }
-  if(id == vec->length) {
-    err = ensure_allocated(vec, vec->length + count, true);
-    if(err != SL_NO_ERROR)
-      goto error;
-
-    dst = (void*)((uintptr_t)(vec->buffer) + vec->data_size * id);
-    src = data;
-    for(i = 0; i < count; ++i) {
-      dst = memcpy(dst, src, vec->data_size);
-      dst = (void*)((uintptr_t)(dst) + vec->data_size);
-    }
-  } else {
-    if(vec->length + count >= vec->capacity) {
-      size_t new_capacity = 0;
-      NEXT_POWER_OF_2(vec->length + count, new_capacity);
-
-      buffer = MEM_ALIGNED_ALLOC
-        (vec->allocator, new_capacity * vec->data_size, vec->data_alignment);
-      if(!buffer) {
-        err = SL_MEMORY_ERROR;
-        goto error;
-      }
-
-      /* Copy the vector data ranging from [0, id[ into the new buffer. */
-      if(id > 0)
-        memcpy(buffer, vec->buffer, vec->data_size * id);
-
-      if(id < vec->length) {
-        /* Copy from the vector data [id, length[ to the new buffer
-         * [id+count, length + count[. */
-        src = (void*)((uintptr_t)(vec->buffer) + vec->data_size * id);
-        dst = (void*)((uintptr_t)(buffer) + vec->data_size * (id + count));
-        dst = memcpy(dst, src, vec->data_size * (vec->length - id));
-      }
-
-      /* Set the src/dst pointer of the data insertion process. */
-      dst = (void*)((uintptr_t)(buffer) + vec->data_size * id);
-      src = data;
-      for(i = 0; i < count; ++i) {
-        dst = memcpy(dst, src, vec->data_size);
-        dst = (void*)((uintptr_t)(dst) + vec->data_size);
-      }
-
-      /* The data to insert may be contained in vec, i.e. free vec->buffer
-       * *AFTER* the insertion. */
-      if(vec->buffer)
-        MEM_FREE(vec->allocator, vec->buffer);
-
-      vec->buffer = buffer;
-      vec->capacity = new_capacity;
-      buffer = NULL;
-
-    } else {
-      if(id < vec->length) {
-        src = (void*)((uintptr_t)(vec->buffer) + vec->data_size * id);
-        dst = (void*)((uintptr_t)(vec->buffer) + vec->data_size * (id + count));
-        dst = memmove(dst, src, vec->data_size * (vec->length - id));
-      }
-
-      /* Set the src/dst pointer of the data insertion process. Note that If the
-       * data to insert lies in the vector range [id, vec.length[ then it was
-       * previously memoved. Its new address is offseted by count * data_size
-       * bytes. */
-      dst = (void*)((uintptr_t)(vec->buffer) + vec->data_size * id);
-      if(IS_MEMORY_OVERLAPPED
-         (data,
-          vec->data_size,
-          (void*)((uintptr_t)(vec->buffer) + vec->data_size * id),
-          (vec->length - id) * vec->data_size)) {
-        src = (void*)((uintptr_t)data + count * vec->data_size);
-      } else {
-        src = data;
-      }
-      for(i = 0; i < count; ++i) {
-        dst = memcpy(dst, src, vec->data_size);
-        dst = (void*)((uintptr_t)(dst) + vec->data_size);
-      }
-    }
-  }
-  vec->length += count;
-
-exit:
-  return err;
-error:
-  if(buffer)
-    MEM_FREE(vec->allocator, buffer);
-  goto exit;
+  return insert(vec, id, count, data, false);
+}
 
+EXPORT_SYM enum sl_error
+sl_vector_insert_range
+  (struct sl_vector* vec,
+   size_t id,
+   size_t count,
+   const void* data)
+{
+  return insert(vec, id, count, data, true);
 }
 
 EXPORT_SYM enum sl_error
@@ -344,6 +512,54 @@ error:
   goto exit;
 }
 
+EXPORT_SYM enum sl_error
+sl_vector_swap_remove(struct sl_vector* vec, size_t id)
+{
+  if(!vec || id >= vec->length)
+    return SL_INVALID_ARGUMENT;
+  --vec->length;
+  if(id != vec->length) {
+    memcpy
+      ((void*)((uintptr_t)vec->buffer + vec->data_size * id),
+       (void*)((uintptr_t)vec->buffer + vec->data_size * vec->length),
+       vec->data_size);
+  }
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_erase_if
+  (struct sl_vector* vec,
+   bool (*predicate)(const void*, void*),
+   void* context)
+{
+  uintptr_t buffer = 0;
+  size_t dst = 0;
+  size_t run = 0;
+  size_t src = 0;
+
+  if(!vec || !predicate)
+    return SL_INVALID_ARGUMENT;
+
+  buffer = (uintptr_t)vec->buffer;
+  /* Test each element once. The run of kept elements [run, src[ is moved
+   * toward the front of the vector when a removed element ends it. */
+  for(src = 0; src <= vec->length; ++src) {
+    if(src < vec->length
+    && !predicate((void*)(buffer + src * vec->data_size), context))
+      continue;
+    if(run != dst && src != run) {
+      memmove
+        ((void*)(buffer + dst * vec->data_size),
+         (void*)(buffer + run * vec->data_size),
+         (src - run) * vec->data_size);
+    }
+    dst += src - run;
+    run = src + 1;
+  }
+  vec->length = dst;
+  return SL_NO_ERROR;
+}
 
 EXPORT_SYM enum sl_error
 sl_vector_resize
@@ -358,24 +574,14 @@ sl_vector_resize
     err = SL_INVALID_ARGUMENT;
     goto error;
   }
-  if(size > vec->capacity) {
-    size_t new_capacity = MAX(vec->capacity, 1);
-
-    for( /* Nothing */ ; new_capacity < size; new_capacity *= 2);
-    err = ensure_allocated(vec, new_capacity, true);
-    if(err != SL_NO_ERROR)
-      goto error;
-  }
+  err = ensure_allocated(vec, size, true);
+  if(err != SL_NO_ERROR)
+    goto error;
 
   if(size > vec->length) {
     buffer = (void*)((uintptr_t)vec->buffer + vec->length * vec->data_size);
     if(data) {
-      size_t i = 0;
-
-      for(i = vec->length; i < size; ++i) {
-        buffer = memcpy(buffer, data, vec->data_size);
-        buffer = (void*)((uintptr_t)buffer + vec->data_size);
-      }
+      fill(buffer, data, size - vec->length, vec->data_size);
     } else {
       memset(buffer, 0, (size - vec->length) * vec->data_size);
     }
@@ -411,6 +617,158 @@ error:
   goto exit;
 }
 
+EXPORT_SYM enum sl_error
+sl_vector_shrink_to_fit
+  (struct sl_vector* vec)
+{
+  void* buffer = NULL;
+
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+
+  if(vec->capacity == vec->length || vec->buffer == vec->inline_buffer)
+    return SL_NO_ERROR;
+
+  /* Move back the elements in the inline storage if they fit in it. */
+  if(vec->inline_buffer && vec->length <= vec->inline_capacity) {
+    memcpy(vec->inline_buffer, vec->buffer, vec->length * vec->data_size);
+    release_buffer(vec);
+    vec->buffer = vec->inline_buffer;
+    vec->capacity = vec->inline_capacity;
+    return SL_NO_ERROR;
+  }
+
+  if(vec->length) {
+    buffer = MEM_ALIGNED_ALLOC
+      (vec->allocator, vec->length * vec->data_size, vec->data_alignment);
+    if(!buffer)
+      return SL_MEMORY_ERROR;
+    buffer = memcpy(buffer, vec->buffer, vec->length * vec->data_size);
+  }
+  release_buffer(vec);
+  vec->buffer = buffer;
+  vec->capacity = vec->length;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_set_growth_policy
+  (struct sl_vector* vec,
+   enum sl_vector_growth_policy policy,
+   size_t chunk_threshold,
+   size_t chunk_size)
+{
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+
+  switch(policy) {
+    case SL_VECTOR_GROWTH_FACTOR_2:
+    case SL_VECTOR_GROWTH_FACTOR_1_5:
+    case SL_VECTOR_GROWTH_EXACT:
+      chunk_threshold = 0;
+      chunk_size = 0;
+      break;
+    case SL_VECTOR_GROWTH_CHUNKED:
+      if(!chunk_size)
+        return SL_INVALID_ARGUMENT;
+      break;
+    default:
+      return SL_INVALID_ARGUMENT;
+  }
+  vec->growth_policy = policy;
+  vec->chunk_threshold = chunk_threshold;
+  vec->chunk_size = chunk_size;
+  return SL_NO_ERROR;
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_sort
+  (struct sl_vector* vec,
+   int (*cmp)(const void*, const void*))
+{
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+  return sl_sort
+    (vec->buffer, vec->length, vec->data_size, vec->data_alignment, cmp,
+     vec->allocator);
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_stable_sort
+  (struct sl_vector* vec,
+   int (*cmp)(const void*, const void*))
+{
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+  return sl_stable_sort
+    (vec->buffer, vec->length, vec->data_size, vec->data_alignment, cmp,
+     vec->allocator);
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_radix_sort
+  (struct sl_vector* vec,
+   size_t key_offset,
+   size_t key_size,
+   enum sl_sort_key_type key_type)
+{
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+  return sl_radix_sort
+    (vec->buffer, vec->length, vec->data_size, key_offset, key_size, key_type,
+     vec->allocator);
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_parallel_sort
+  (struct sl_vector* vec,
+   int (*cmp)(const void*, const void*),
+   struct sl_thread_pool* pool)
+{
+  if(!vec)
+    return SL_INVALID_ARGUMENT;
+  return sl_parallel_sort
+    (vec->buffer, vec->length, vec->data_size, vec->data_alignment, cmp,
+     pool, vec->allocator);
+}
+
+EXPORT_SYM enum sl_error
+sl_vector_parallel_merge
+  (struct sl_vector* dst,
+   struct sl_vector* a,
+   struct sl_vector* b,
+   int (*cmp)(const void*, const void*),
+   struct sl_thread_pool* pool)
+{
+  enum sl_error err = SL_NO_ERROR;
+
+  if(!dst || !a || !b || dst == a || dst == b || !cmp
+  || a->data_size != dst->data_size || b->data_size != dst->data_size) {
+    err = SL_INVALID_ARGUMENT;
+    goto error;
+  }
+  if(a->length > SIZE_MAX - b->length) {
+    err = SL_OVERFLOW_ERROR;
+    goto error;
+  }
+  err = ensure_allocated(dst, a->length + b->length, false);
+  if(err != SL_NO_ERROR)
+    goto error;
+  /* The former elements of dst are not kept by the allocation. */
+  dst->length = 0;
+  err = sl_parallel_merge
+    (a->buffer, a->length, b->buffer, b->length, dst->buffer, dst->data_size,
+     cmp, pool, dst->allocator);
+  if(err != SL_NO_ERROR)
+    goto error;
+  dst->length = a->length + b->length;
+
+exit:
+  return err;
+error:
+  goto exit;
+}
+
 EXPORT_SYM enum sl_error
 sl_vector_capacity
   (struct sl_vector* vec,
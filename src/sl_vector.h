@@ -3,10 +3,26 @@
 
 #include "sl.h"
 #include "sl_error.h"
+#include "sl_sort.h"
+#include <stdbool.h>
 #include <stddef.h>
 
 struct mem_allocator;
 struct sl_vector;
+struct sl_thread_pool;
+
+/* Define how the capacity of a vector grows when its length exceeds it. */
+enum sl_vector_growth_policy {
+  /* Round the required capacity up to the next power of 2. Default policy. */
+  SL_VECTOR_GROWTH_FACTOR_2,
+  /* Grow the capacity by half of its current value. */
+  SL_VECTOR_GROWTH_FACTOR_1_5,
+  /* Allocate exactly the required capacity. */
+  SL_VECTOR_GROWTH_EXACT,
+  /* Grow as SL_VECTOR_GROWTH_FACTOR_2 up to a threshold capacity and then
+   * linearly, by multiples of a chunk size. */
+  SL_VECTOR_GROWTH_CHUNKED
+};
 
 #ifdef __cplusplus
 extern "C" {
@@ -19,6 +35,17 @@ sl_create_vector
    struct mem_allocator* allocator, /* May be NULL. */
    struct sl_vector** out_vector);
 
+/* Create a vector whose first `inline_capacity' elements are stored in the
+ * allocation of the vector itself. The elements move to the heap when the
+ * length of the vector exceeds the inline capacity. */
+SL_API enum sl_error
+sl_create_small_vector
+  (size_t data_size,
+   size_t data_alignment,
+   size_t inline_capacity, /* Must be greater than 0. */
+   struct mem_allocator* allocator, /* May be NULL. */
+   struct sl_vector** out_vector);
+
 SL_API enum sl_error
 sl_free_vector
   (struct sl_vector* vector);
@@ -38,6 +65,28 @@ sl_vector_push_back_n
    size_t count,
    const void* data);
 
+/* Add the count contiguous elements pointed by data at the vector end. */
+SL_API enum sl_error
+sl_vector_append_range
+  (struct sl_vector* vector,
+   size_t count,
+   const void* data);
+
+/* Add one element at the end of the vector and return its address. The
+ * element is not initialised. */
+SL_API enum sl_error
+sl_vector_emplace_back
+  (struct sl_vector* vector,
+   void** out_data);
+
+/* Add count elements at the end of the vector and return the address of the
+ * first one. The elements are not initialised and are contiguous in memory. */
+SL_API enum sl_error
+sl_vector_append_uninit
+  (struct sl_vector* vector,
+   size_t count,
+   void** out_data); /* Set to NULL if count is 0. */
+
 SL_API enum sl_error
 sl_vector_pop_back
   (struct sl_vector* vector);
@@ -55,6 +104,14 @@ sl_vector_insert_n
    size_t count,
    const void* data);
 
+/* Insert at the position id the count contiguous elements pointed by data. */
+SL_API enum sl_error
+sl_vector_insert_range
+  (struct sl_vector* vector,
+   size_t id,
+   size_t count,
+   const void* data);
+
 SL_API enum sl_error
 sl_vector_erase
   (struct sl_vector* vector,
@@ -66,6 +123,22 @@ sl_vector_erase_n
    size_t id,
    size_t count);
 
+/* Remove the element `id' by moving the last element in its place. Constant
+ * time but the order of the elements is not preserved. */
+SL_API enum sl_error
+sl_vector_swap_remove
+  (struct sl_vector* vector,
+   size_t id);
+
+/* Remove the elements for which the predicate returns true. The predicate is
+ * invoked once per element, in order. The order of the remaining elements is
+ * preserved and each element is moved at most once. */
+SL_API enum sl_error
+sl_vector_erase_if
+  (struct sl_vector* vector,
+   bool (*predicate)(const void* data, void* context),
+   void* context); /* May be NULL. */
+
 SL_API enum sl_error
 sl_vector_resize
   (struct sl_vector* vector,
@@ -77,6 +150,59 @@ sl_vector_reserve
   (struct sl_vector* vector,
    size_t capacity);
 
+/* Release the memory of the vector that is not used by its elements, i.e.
+ * the capacity of the vector is adjusted to its length. The elements of a small
+ * vector move back to its inline storage if they fit in it. */
+SL_API enum sl_error
+sl_vector_shrink_to_fit
+  (struct sl_vector* vector);
+
+SL_API enum sl_error
+sl_vector_set_growth_policy
+  (struct sl_vector* vector,
+   enum sl_vector_growth_policy policy,
+   size_t chunk_threshold, /* Used by SL_VECTOR_GROWTH_CHUNKED only. */
+   size_t chunk_size); /* Used by SL_VECTOR_GROWTH_CHUNKED only. */
+
+/* Sort the vector elements with sl_sort. */
+SL_API enum sl_error
+sl_vector_sort
+  (struct sl_vector* vector,
+   int (*data_comparator)(const void*, const void*));
+
+/* Sort the vector elements with sl_stable_sort. */
+SL_API enum sl_error
+sl_vector_stable_sort
+  (struct sl_vector* vector,
+   int (*data_comparator)(const void*, const void*));
+
+/* Sort the vector elements with sl_radix_sort. */
+SL_API enum sl_error
+sl_vector_radix_sort
+  (struct sl_vector* vector,
+   size_t key_offset,
+   size_t key_size,
+   enum sl_sort_key_type key_type);
+
+/* Sort the vector elements with sl_parallel_sort. */
+SL_API enum sl_error
+sl_vector_parallel_sort
+  (struct sl_vector* vector,
+   int (*data_comparator)(const void*, const void*),
+   struct sl_thread_pool* pool); /* May be NULL. */
+
+/* Set the elements of dst to the merge of the sorted vectors a and b, as done
+ * by sl_parallel_merge. The three vectors must store elements of the same size
+ * and dst must be distinct from a and b. The former elements of dst are lost
+ * once the merge starts: dst is left empty if the merge fails. */
+SL_API enum sl_error
+sl_vector_parallel_merge
+  (struct sl_vector* dst,
+   struct sl_vector* a,
+   struct sl_vector* b,
+   int (*data_comparator)(const void*, const void*),
+   struct sl_thread_pool* pool); /* May be NULL. */
+
 SL_API enum sl_error
 sl_vector_capacity
   (struct sl_vector* vector,
@@ -0,0 +1,176 @@
+#include "../sl_bitset.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+#define MAX_NB_BITS 5000
+
+/* Check the bitset against an array of booleans. */
+static void
+check_bitset(struct sl_bitset* bitset, const bool* ref, size_t nb_bits)
+{
+  uint64_t* words = NULL;
+  size_t count = 0;
+  size_t rank = 0;
+  size_t id = 0;
+  size_t i = 0;
+  size_t n = 0;
+  bool b = false;
+
+  CHECK(sl_bitset_size(bitset, &n), OK);
+  CHECK(n, nb_bits);
+  for(i = 0; i < nb_bits; ++i) {
+    CHECK(sl_bitset_rank(bitset, i, &rank), OK);
+    CHECK(rank, count);
+    CHECK(sl_bitset_test(bitset, i, &b), OK);
+    CHECK(b, ref[i]);
+    if(ref[i]) {
+      CHECK(sl_bitset_select(bitset, count, &id), OK);
+      CHECK(id, i);
+      ++count;
+    }
+  }
+  CHECK(sl_bitset_rank(bitset, nb_bits, &rank), OK);
+  CHECK(rank, count);
+  CHECK(sl_bitset_select(bitset, count, &id), OK);
+  CHECK(id, nb_bits);
+  CHECK(sl_bitset_count(bitset, &n), OK);
+  CHECK(n, count);
+
+  /* Iterate over the set bits. */
+  n = 0;
+  for(sl_bitset_find_next(bitset, 0, &i); i < nb_bits;
+      sl_bitset_find_next(bitset, i + 1, &i)) {
+    CHECK(ref[i], true);
+    ++n;
+  }
+  CHECK(n, count);
+
+  /* The bits past the size are cleared. */
+  CHECK(sl_bitset_buffer(bitset, &n, &words), OK);
+  CHECK(n % 4, 0);
+  CHECK(n * 64 >= nb_bits, true);
+  CHECK((n * 64 - nb_bits) < 256, true);
+  if(n)
+    CHECK(IS_ALIGNED(words, 32), true);
+  for(i = nb_bits; i < n * 64; ++i)
+    CHECK((words[i / 64] >> (i % 64)) & 1, 0);
+}
+
+static void
+fill_random
+  (struct sl_bitset* bitset, bool* ref, size_t nb_bits, int density)
+{
+  size_t i = 0;
+  CHECK(sl_bitset_reset(bitset), OK);
+  for(i = 0; i < nb_bits; ++i) {
+    ref[i] = rand() % 100 < density;
+    if(ref[i])
+      CHECK(sl_bitset_set(bitset, i), OK);
+  }
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  const size_t sizes[] = { 0, 1, 63, 64, 65, 255, 256, 257, 1000, 4099 };
+  struct sl_bitset* a = NULL;
+  struct sl_bitset* b = NULL;
+  bool ref_a[MAX_NB_BITS];
+  bool ref_b[MAX_NB_BITS];
+  size_t isize = 0;
+  size_t n = 0;
+  size_t i = 0;
+  bool is_set = false;
+
+  CHECK(sl_create_bitset(10, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_bitset(70, NULL, &a), OK);
+  CHECK(sl_create_bitset(71, NULL, &b), OK);
+
+  CHECK(sl_bitset_size(NULL, &n), BAD_ARG);
+  CHECK(sl_bitset_size(a, NULL), BAD_ARG);
+  CHECK(sl_bitset_set(NULL, 0), BAD_ARG);
+  CHECK(sl_bitset_set(a, 70), BAD_ARG);
+  CHECK(sl_bitset_set(a, 69), OK);
+  CHECK(sl_bitset_clear(NULL, 0), BAD_ARG);
+  CHECK(sl_bitset_clear(a, 70), BAD_ARG);
+  CHECK(sl_bitset_test(NULL, 0, &is_set), BAD_ARG);
+  CHECK(sl_bitset_test(a, 70, &is_set), BAD_ARG);
+  CHECK(sl_bitset_test(a, 0, NULL), BAD_ARG);
+  CHECK(sl_bitset_test(a, 69, &is_set), OK);
+  CHECK(is_set, true);
+  CHECK(sl_bitset_clear(a, 69), OK);
+  CHECK(sl_bitset_test(a, 69, &is_set), OK);
+  CHECK(is_set, false);
+  CHECK(sl_bitset_count(NULL, &n), BAD_ARG);
+  CHECK(sl_bitset_count(a, NULL), BAD_ARG);
+  CHECK(sl_bitset_rank(NULL, 0, &n), BAD_ARG);
+  CHECK(sl_bitset_rank(a, 71, &n), BAD_ARG);
+  CHECK(sl_bitset_rank(a, 0, NULL), BAD_ARG);
+  CHECK(sl_bitset_select(NULL, 0, &n), BAD_ARG);
+  CHECK(sl_bitset_select(a, 0, NULL), BAD_ARG);
+  CHECK(sl_bitset_find_next(NULL, 0, &n), BAD_ARG);
+  CHECK(sl_bitset_find_next(a, 0, NULL), BAD_ARG);
+  CHECK(sl_bitset_find_next(a, 1000, &n), OK);
+  CHECK(n, 70);
+  CHECK(sl_bitset_and(NULL, b), BAD_ARG);
+  CHECK(sl_bitset_and(a, NULL), BAD_ARG);
+  CHECK(sl_bitset_and(a, b), BAD_ARG);
+  CHECK(sl_bitset_or(a, b), BAD_ARG);
+  CHECK(sl_bitset_xor(a, b), BAD_ARG);
+  CHECK(sl_bitset_andnot(a, b), BAD_ARG);
+  CHECK(sl_bitset_buffer(NULL, &n, NULL), BAD_ARG);
+  CHECK(sl_bitset_buffer(a, &n, NULL), BAD_ARG);
+  CHECK(sl_bitset_reset(NULL), BAD_ARG);
+  CHECK(sl_bitset_resize(NULL, 0), BAD_ARG);
+  CHECK(sl_free_bitset(NULL), BAD_ARG);
+
+  for(isize = 0; isize < sizeof(sizes)/sizeof(size_t); ++isize) {
+    const size_t nb_bits = sizes[isize];
+    CHECK(sl_bitset_resize(a, nb_bits), OK);
+    CHECK(sl_bitset_resize(b, nb_bits), OK);
+    fill_random(a, ref_a, nb_bits, 50);
+    fill_random(b, ref_b, nb_bits, 10);
+    check_bitset(a, ref_a, nb_bits);
+    check_bitset(b, ref_b, nb_bits);
+
+    CHECK(sl_bitset_and(a, b), OK);
+    for(i = 0; i < nb_bits; ++i) ref_a[i] = ref_a[i] && ref_b[i];
+    check_bitset(a, ref_a, nb_bits);
+    fill_random(a, ref_a, nb_bits, 50);
+    CHECK(sl_bitset_or(a, b), OK);
+    for(i = 0; i < nb_bits; ++i) ref_a[i] = ref_a[i] || ref_b[i];
+    check_bitset(a, ref_a, nb_bits);
+    CHECK(sl_bitset_xor(a, b), OK);
+    for(i = 0; i < nb_bits; ++i) ref_a[i] = ref_a[i] != ref_b[i];
+    check_bitset(a, ref_a, nb_bits);
+    fill_random(a, ref_a, nb_bits, 90);
+    CHECK(sl_bitset_andnot(a, b), OK);
+    for(i = 0; i < nb_bits; ++i) ref_a[i] = ref_a[i] && !ref_b[i];
+    check_bitset(a, ref_a, nb_bits);
+    CHECK(sl_bitset_or(b, b), OK);
+    check_bitset(b, ref_b, nb_bits);
+    CHECK(sl_bitset_xor(b, b), OK);
+    for(i = 0; i < nb_bits; ++i) ref_b[i] = false;
+    check_bitset(b, ref_b, nb_bits);
+
+    /* Shrink and grow the set back; the removed bits are not restored. */
+    fill_random(a, ref_a, nb_bits, 100);
+    CHECK(sl_bitset_resize(a, nb_bits / 2), OK);
+    check_bitset(a, ref_a, nb_bits / 2);
+    CHECK(sl_bitset_resize(a, nb_bits), OK);
+    for(i = nb_bits / 2; i < nb_bits; ++i) ref_a[i] = false;
+    check_bitset(a, ref_a, nb_bits);
+  }
+  CHECK(sl_free_bitset(a), OK);
+  CHECK(sl_free_bitset(b), OK);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
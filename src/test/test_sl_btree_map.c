@@ -0,0 +1,307 @@
+#include "../sl_btree_map.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+#define NB_KEYS 20000
+
+/* Data larger than a node to check the enlarged nodes. */
+struct big_data {
+  int key;
+  char payload[700];
+};
+
+static int
+cmp_int(const void* p0, const void* p1)
+{
+  const int i = *(const int*)p0;
+  const int j = *(const int*)p1;
+  return (i > j) - (i < j);
+}
+
+/* Check that the map holds the keys whose ref is not negative, with ref as
+ * data, by scanning the map and looking for each key. */
+static void
+check_map(struct sl_btree_map* map, const int* ref, const int nb_keys)
+{
+  struct sl_btree_map_it it;
+  struct sl_pair pair;
+  bool is_end_reached = false;
+  size_t len = 0;
+  size_t n = 0;
+  void* data = NULL;
+  int key = 0;
+
+  CHECK(sl_btree_map_begin(map, &it, &is_end_reached), OK);
+  for(key = 0; key < nb_keys; ++key) {
+    if(ref[key] < 0)
+      continue;
+    CHECK(is_end_reached, false);
+    CHECK(*(int*)it.pair.key, key);
+    CHECK(*(int*)it.pair.data, ref[key]);
+    CHECK(sl_btree_map_it_next(&it, &is_end_reached), OK);
+    ++n;
+  }
+  CHECK(is_end_reached, true);
+  CHECK(sl_btree_map_length(map, &len), OK);
+  CHECK(len, n);
+
+  for(key = 0; key < nb_keys; ++key) {
+    CHECK(sl_btree_map_find(map, &key, &data), OK);
+    CHECK(sl_btree_map_find_pair(map, &key, &pair), OK);
+    if(ref[key] < 0) {
+      CHECK(data, NULL);
+      CHECK(SL_IS_PAIR_VALID(&pair), false);
+    } else {
+      NCHECK(data, NULL);
+      CHECK(*(int*)data, ref[key]);
+      CHECK(*(int*)pair.key, key);
+      CHECK(pair.data, data);
+    }
+  }
+}
+
+static void
+check_bounds(struct sl_btree_map* map, const int* ref, const int nb_keys)
+{
+  struct sl_btree_map_it it;
+  bool is_end_reached = false;
+  int key = 0;
+  int next = 0;
+
+  for(key = -1; key < nb_keys; key += 7) {
+    /* First key not less than key. */
+    for(next = MAX(key, 0); next < nb_keys && ref[next] < 0; ++next);
+    CHECK(sl_btree_map_lower_bound(map, &key, &it, &is_end_reached), OK);
+    CHECK(is_end_reached, next == nb_keys);
+    if(!is_end_reached)
+      CHECK(*(int*)it.pair.key, next);
+
+    /* First key greater than key. */
+    for(next = key + 1; next < nb_keys && ref[next] < 0; ++next);
+    CHECK(sl_btree_map_upper_bound(map, &key, &it, &is_end_reached), OK);
+    CHECK(is_end_reached, next == nb_keys);
+    if(!is_end_reached)
+      CHECK(*(int*)it.pair.key, next);
+  }
+}
+
+static void
+check_bulk_load(void)
+{
+  struct sl_btree_map* map = NULL;
+  int* keys = NULL;
+  int* ref = NULL;
+  size_t len = 0;
+  size_t count = 0;
+  int i = 0;
+
+  keys = malloc(NB_KEYS * sizeof(int));
+  ref = malloc(NB_KEYS * sizeof(int));
+  NCHECK(keys, NULL);
+  NCHECK(ref, NULL);
+  CHECK(sl_create_btree_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), cmp_int, NULL, &map), OK);
+
+  for(i = 0; i < NB_KEYS; ++i)
+    keys[i] = i * 2;
+  CHECK(sl_btree_map_bulk_load(NULL, keys, keys, 1), BAD_ARG);
+  CHECK(sl_btree_map_bulk_load(map, NULL, keys, 1), BAD_ARG);
+  CHECK(sl_btree_map_bulk_load(map, keys, NULL, 1), BAD_ARG);
+  CHECK(sl_btree_map_bulk_load(map, NULL, NULL, 0), OK);
+  keys[10] = keys[9];
+  CHECK(sl_btree_map_bulk_load(map, keys, keys, NB_KEYS), BAD_ARG);
+  keys[10] = 7;
+  CHECK(sl_btree_map_bulk_load(map, keys, keys, NB_KEYS), BAD_ARG);
+  keys[10] = 20;
+  CHECK(sl_btree_map_length(map, &len), OK);
+  CHECK(len, 0);
+
+  /* Load trees of one leaf up to several levels. */
+  for(count = 1; count <= NB_KEYS / 2; count = count * 3 + 1) {
+    for(i = 0; i < NB_KEYS; ++i)
+      ref[i] = i % 2 == 0 && (size_t)i < count * 2 ? i : -1;
+    CHECK(sl_btree_map_bulk_load(map, keys, keys, count), OK);
+    CHECK(sl_btree_map_bulk_load(map, keys, keys, count), BAD_ARG);
+    check_map(map, ref, NB_KEYS);
+    check_bounds(map, ref, NB_KEYS);
+
+    /* The loaded tree supports the insertions and the removals. */
+    for(i = 1; i < NB_KEYS; i += 4) {
+      CHECK(sl_btree_map_insert(map, &i, &i), OK);
+      ref[i] = i;
+    }
+    for(i = 0; i < NB_KEYS; i += 3) {
+      if(ref[i] >= 0) {
+        CHECK(sl_btree_map_erase(map, &i), OK);
+        ref[i] = -1;
+      }
+    }
+    check_map(map, ref, NB_KEYS);
+    CHECK(sl_clear_btree_map(map), OK);
+  }
+  CHECK(sl_free_btree_map(map), OK);
+  free(keys);
+  free(ref);
+}
+
+static void
+check_big_data(void)
+{
+  struct sl_btree_map* map = NULL;
+  struct big_data data;
+  void* ptr = NULL;
+  size_t len = 0;
+  int i = 0;
+
+  CHECK(sl_create_btree_map(sizeof(int), ALIGNOF(int),
+    sizeof(struct big_data), ALIGNOF(struct big_data), cmp_int, NULL, &map),
+    OK);
+  memset(&data, 0, sizeof(data));
+  for(i = 0; i < 1000; ++i) {
+    const int key = (i * 7919) % 1000;
+    data.key = key;
+    data.payload[sizeof(data.payload) - 1] = (char)key;
+    CHECK(sl_btree_map_insert(map, &key, &data), OK);
+  }
+  for(i = 0; i < 1000; i += 2)
+    CHECK(sl_btree_map_erase(map, &i), OK);
+  CHECK(sl_btree_map_length(map, &len), OK);
+  CHECK(len, 500);
+  for(i = 0; i < 1000; ++i) {
+    CHECK(sl_btree_map_find(map, &i, &ptr), OK);
+    if(i % 2 == 0) {
+      CHECK(ptr, NULL);
+    } else {
+      CHECK(((struct big_data*)ptr)->key, i);
+      CHECK(((struct big_data*)ptr)->payload[sizeof(data.payload)-1], (char)i);
+    }
+  }
+  CHECK(sl_free_btree_map(map), OK);
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_btree_map* map = NULL;
+  struct sl_btree_map_it it;
+  struct sl_pair pair;
+  bool is_end_reached = false;
+  int* ref = NULL;
+  size_t len = 0;
+  void* data = NULL;
+  int key = 0;
+  int i = 0;
+
+  ref = malloc(NB_KEYS * sizeof(int));
+  NCHECK(ref, NULL);
+  for(i = 0; i < NB_KEYS; ++i)
+    ref[i] = -1;
+
+  CHECK(sl_create_btree_map(0, 0, 0, 0, NULL, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_btree_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), cmp_int, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_btree_map(0, ALIGNOF(int), sizeof(int), ALIGNOF(int),
+    cmp_int, NULL, &map), BAD_ARG);
+  CHECK(sl_create_btree_map(sizeof(int), ALIGNOF(int), 0, ALIGNOF(int),
+    cmp_int, NULL, &map), BAD_ARG);
+  CHECK(sl_create_btree_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), NULL, NULL, &map), BAD_ARG);
+  CHECK(sl_create_btree_map(sizeof(int), 3, sizeof(int), ALIGNOF(int),
+    cmp_int, NULL, &map), SL_ALIGNMENT_ERROR);
+  CHECK(sl_create_btree_map(sizeof(int), ALIGNOF(int), sizeof(int), 0,
+    cmp_int, NULL, &map), SL_ALIGNMENT_ERROR);
+  CHECK(sl_create_btree_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), cmp_int, NULL, &map), OK);
+
+  CHECK(sl_btree_map_length(NULL, &len), BAD_ARG);
+  CHECK(sl_btree_map_length(map, NULL), BAD_ARG);
+  CHECK(sl_btree_map_length(map, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_btree_map_begin(NULL, &it, &is_end_reached), BAD_ARG);
+  CHECK(sl_btree_map_begin(map, NULL, &is_end_reached), BAD_ARG);
+  CHECK(sl_btree_map_begin(map, &it, NULL), BAD_ARG);
+  CHECK(sl_btree_map_begin(map, &it, &is_end_reached), OK);
+  CHECK(is_end_reached, true);
+  CHECK(sl_btree_map_it_next(&it, &is_end_reached), BAD_ARG);
+  CHECK(sl_btree_map_lower_bound(map, &key, &it, &is_end_reached), OK);
+  CHECK(is_end_reached, true);
+  CHECK(sl_btree_map_upper_bound(map, NULL, &it, &is_end_reached), BAD_ARG);
+  CHECK(sl_btree_map_find(map, &key, &data), OK);
+  CHECK(data, NULL);
+  CHECK(sl_btree_map_find(map, &key, NULL), BAD_ARG);
+  CHECK(sl_btree_map_find_pair(map, NULL, &pair), BAD_ARG);
+  CHECK(sl_btree_map_erase(map, &key), BAD_ARG);
+
+  CHECK(sl_btree_map_insert(NULL, &key, &key), BAD_ARG);
+  CHECK(sl_btree_map_insert(map, NULL, &key), BAD_ARG);
+  CHECK(sl_btree_map_insert(map, &key, NULL), BAD_ARG);
+  CHECK(sl_btree_map_insert(map, &key, &key), OK);
+  CHECK(sl_btree_map_insert(map, &key, &key), BAD_ARG);
+  CHECK(sl_btree_map_erase(NULL, &key), BAD_ARG);
+  CHECK(sl_btree_map_erase(map, NULL), BAD_ARG);
+  CHECK(sl_btree_map_erase(map, &key), OK);
+  CHECK(sl_btree_map_erase(map, &key), BAD_ARG);
+  CHECK(sl_btree_map_length(map, &len), OK);
+  CHECK(len, 0);
+
+  /* Sorted insertions. */
+  for(i = 0; i < NB_KEYS; i += 2) {
+    CHECK(sl_btree_map_insert(map, &i, &i), OK);
+    ref[i] = i;
+  }
+  check_map(map, ref, NB_KEYS);
+  check_bounds(map, ref, NB_KEYS);
+
+  /* Random insertions and removals. */
+  for(i = 0; i < NB_KEYS * 4; ++i) {
+    key = rand() % NB_KEYS;
+    if(rand() % 2) {
+      CHECK(sl_btree_map_insert(map, &key, &i), ref[key] < 0 ? OK : BAD_ARG);
+      if(ref[key] < 0)
+        ref[key] = i;
+    } else {
+      CHECK(sl_btree_map_erase(map, &key), ref[key] < 0 ? BAD_ARG : OK);
+      ref[key] = -1;
+    }
+  }
+  check_map(map, ref, NB_KEYS);
+  check_bounds(map, ref, NB_KEYS);
+
+  /* Remove everything in decreasing order. */
+  for(key = NB_KEYS - 1; key >= 0; --key) {
+    if(ref[key] >= 0) {
+      CHECK(sl_btree_map_erase(map, &key), OK);
+      ref[key] = -1;
+    }
+  }
+  check_map(map, ref, NB_KEYS);
+
+  for(i = 0; i < NB_KEYS; ++i) {
+    key = (i * 7919) % NB_KEYS;
+    CHECK(sl_btree_map_insert(map, &key, &i), OK);
+  }
+  CHECK(sl_btree_map_length(map, &len), OK);
+  CHECK(len, NB_KEYS);
+  CHECK(sl_clear_btree_map(NULL), BAD_ARG);
+  CHECK(sl_clear_btree_map(map), OK);
+  CHECK(sl_btree_map_length(map, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_btree_map_begin(map, &it, &is_end_reached), OK);
+  CHECK(is_end_reached, true);
+  CHECK(sl_free_btree_map(NULL), BAD_ARG);
+  CHECK(sl_free_btree_map(map), OK);
+
+  check_bulk_load();
+  check_big_data();
+
+  free(ref);
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+  return 0;
+}
+
@@ -0,0 +1,157 @@
+#include "../sl_deque.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_deque* deque = NULL;
+  void* data = NULL;
+  void* buf0 = NULL;
+  void* buf1 = NULL;
+  size_t len = 0;
+  size_t len0 = 0;
+  size_t len1 = 0;
+  size_t i = 0;
+  int k = 0;
+
+  CHECK(sl_create_deque(0, 0, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_deque(sizeof(int), ALIGNOF(int), NULL, NULL), BAD_ARG);
+  CHECK(sl_create_deque(0, ALIGNOF(int), NULL, &deque), BAD_ARG);
+  CHECK(sl_create_deque(sizeof(int), 3, NULL, &deque), SL_ALIGNMENT_ERROR);
+  CHECK(sl_create_deque(sizeof(int), ALIGNOF(int), NULL, &deque), OK);
+
+  CHECK(sl_deque_length(NULL, &len), BAD_ARG);
+  CHECK(sl_deque_length(deque, NULL), BAD_ARG);
+  CHECK(sl_deque_length(deque, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_deque_capacity(NULL, &len), BAD_ARG);
+  CHECK(sl_deque_capacity(deque, NULL), BAD_ARG);
+  CHECK(sl_deque_capacity(deque, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_deque_front(deque, &data), BAD_ARG);
+  CHECK(sl_deque_back(deque, &data), BAD_ARG);
+  CHECK(sl_deque_pop_front(deque), OK);
+  CHECK(sl_deque_pop_back(deque), OK);
+  CHECK(sl_deque_spans(NULL, &len0, &buf0, &len1, &buf1), BAD_ARG);
+  CHECK(sl_deque_spans(deque, &len0, &buf0, &len1, &buf1), OK);
+  CHECK(len0, 0);
+  CHECK(buf0, NULL);
+  CHECK(len1, 0);
+  CHECK(buf1, NULL);
+
+  CHECK(sl_deque_push_back(NULL, (int[]){0}), BAD_ARG);
+  CHECK(sl_deque_push_back(deque, NULL), BAD_ARG);
+  CHECK(sl_deque_push_front(NULL, (int[]){0}), BAD_ARG);
+  CHECK(sl_deque_push_front(deque, NULL), BAD_ARG);
+
+  /* Push 3 4 5 at the back and 2 1 0 at the front. */
+  for(k = 3; k < 6; ++k)
+    CHECK(sl_deque_push_back(deque, &k), OK);
+  for(k = 2; k >= 0; --k)
+    CHECK(sl_deque_push_front(deque, &k), OK);
+  CHECK(sl_deque_length(deque, &len), OK);
+  CHECK(len, 6);
+  CHECK(sl_deque_capacity(deque, &len), OK);
+  CHECK(len, 8);
+  for(i = 0; i < 6; ++i) {
+    CHECK(sl_deque_at(deque, i, &data), OK);
+    CHECK(*(int*)data, (int)i);
+  }
+  CHECK(sl_deque_at(NULL, 0, &data), BAD_ARG);
+  CHECK(sl_deque_at(deque, 6, &data), BAD_ARG);
+  CHECK(sl_deque_at(deque, 0, NULL), BAD_ARG);
+  CHECK(sl_deque_front(NULL, &data), BAD_ARG);
+  CHECK(sl_deque_front(deque, NULL), BAD_ARG);
+  CHECK(sl_deque_front(deque, &data), OK);
+  CHECK(*(int*)data, 0);
+  CHECK(sl_deque_back(NULL, &data), BAD_ARG);
+  CHECK(sl_deque_back(deque, NULL), BAD_ARG);
+  CHECK(sl_deque_back(deque, &data), OK);
+  CHECK(*(int*)data, 5);
+
+  /* The front elements wrap around the end of the buffer. */
+  CHECK(sl_deque_spans(deque, &len0, &buf0, &len1, &buf1), OK);
+  CHECK(len0 + len1, 6);
+  CHECK(len0, 2);
+  CHECK(((int*)buf0)[0], 0);
+  CHECK(((int*)buf0)[1], 1);
+  CHECK(((int*)buf1)[0], 2);
+  CHECK(((int*)buf1)[3], 5);
+  CHECK(sl_deque_spans(deque, NULL, NULL, NULL, NULL), OK);
+
+  /* Grow a wrapped deque. The elements are kept in order. */
+  for(k = 6; k < 20; ++k)
+    CHECK(sl_deque_push_back(deque, &k), OK);
+  CHECK(sl_deque_capacity(deque, &len), OK);
+  CHECK(len, 32);
+  CHECK(sl_deque_spans(deque, &len0, &buf0, &len1, &buf1), OK);
+  CHECK(len0, 20);
+  CHECK(len1, 0);
+  CHECK(buf1, NULL);
+  for(i = 0; i < len0; ++i)
+    CHECK(((int*)buf0)[i], (int)i);
+
+  /* Push an element that lies in the deque while it grows. */
+  for(k = 20; k < 32; ++k)
+    CHECK(sl_deque_push_back(deque, &k), OK);
+  CHECK(sl_deque_front(deque, &data), OK);
+  CHECK(sl_deque_push_back(deque, data), OK);
+  CHECK(sl_deque_back(deque, &data), OK);
+  CHECK(*(int*)data, 0);
+  CHECK(sl_deque_pop_back(NULL), BAD_ARG);
+  CHECK(sl_deque_pop_back(deque), OK);
+
+  /* Use the deque as a FIFO. */
+  CHECK(sl_deque_pop_front(NULL), BAD_ARG);
+  for(k = 0; k < 1000; ++k) {
+    CHECK(sl_deque_front(deque, &data), OK);
+    CHECK(*(int*)data, k);
+    CHECK(sl_deque_pop_front(deque), OK);
+    i = (size_t)k + 32;
+    CHECK(sl_deque_push_back(deque, (int[]){(int)i}), OK);
+  }
+  CHECK(sl_deque_length(deque, &len), OK);
+  CHECK(len, 32);
+  CHECK(sl_deque_capacity(deque, &len), OK);
+  CHECK(len, 64);
+
+  CHECK(sl_deque_pop_front_n(NULL, 1), BAD_ARG);
+  CHECK(sl_deque_pop_front_n(deque, 30), OK);
+  CHECK(sl_deque_front(deque, &data), OK);
+  CHECK(*(int*)data, 1030);
+  CHECK(sl_deque_pop_front_n(deque, 10), OK);
+  CHECK(sl_deque_length(deque, &len), OK);
+  CHECK(len, 0);
+
+  CHECK(sl_deque_reserve(NULL, 0), BAD_ARG);
+  CHECK(sl_deque_reserve(deque, 65), OK);
+  CHECK(sl_deque_capacity(deque, &len), OK);
+  CHECK(len, 128);
+
+  CHECK(sl_deque_push_back(deque, (int[]){1}), OK);
+  CHECK(sl_clear_deque(NULL), BAD_ARG);
+  CHECK(sl_clear_deque(deque), OK);
+  CHECK(sl_deque_length(deque, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_deque_capacity(deque, &len), OK);
+  CHECK(len, 128);
+
+  CHECK(sl_free_deque(NULL), BAD_ARG);
+  CHECK(sl_free_deque(deque), OK);
+
+  CHECK(sl_create_deque(sizeof(int), 16, NULL, &deque), OK);
+  CHECK(sl_deque_push_back(deque, (int*)((uintptr_t)(int[8]){0} | 4)),
+    SL_ALIGNMENT_ERROR);
+  CHECK(sl_free_deque(deque), OK);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
@@ -4,6 +4,7 @@
 #include <snlsys/snlsys.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdlib.h>
 
 #define BAD_ARG SL_INVALID_ARGUMENT
 #define BAD_AL SL_ALIGNMENT_ERROR
@@ -19,6 +20,459 @@ cmp(const void* p0, const void* p1)
   return *((const int*)p0) - *((const int*)p1);
 }
 
+#define NB_KEYS 2000
+
+/* Insert random batches with the policy and check the map against the data
+ * of each key, -1 meaning that the key is not in the map. */
+static void
+check_insert_n(const enum sl_duplicate_policy policy)
+{
+  const size_t batch_sizes[] = { 1, 2, 7, 60, 500, 3, 500 };
+  int keys[500];
+  int data[500];
+  int ref[NB_KEYS];
+  struct sl_flat_map* map = NULL;
+  int* map_keys = NULL;
+  int* map_data = NULL;
+  size_t len = 0;
+  size_t n = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t nb_inserted = 0;
+
+  for(i = 0; i < NB_KEYS; ++i) ref[i] = -1;
+  CHECK(sl_create_flat_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), cmp, NULL, &map), OK);
+  CHECK(sl_flat_map_insert_n(NULL, keys, data, 1, policy, NULL), BAD_ARG);
+  CHECK(sl_flat_map_insert_n(map, NULL, data, 1, policy, NULL), BAD_ARG);
+  CHECK(sl_flat_map_insert_n(map, keys, NULL, 1, policy, NULL), BAD_ARG);
+  CHECK(sl_flat_map_insert_n(map, NULL, NULL, 0, policy, &n), OK);
+  CHECK(n, 0);
+
+  for(i = 0; i < sizeof(batch_sizes)/sizeof(size_t); ++i) {
+    int new_ref[NB_KEYS];
+    bool is_rejected = false;
+    const size_t count = batch_sizes[i];
+
+    for(j = 0; j < NB_KEYS; ++j) new_ref[j] = ref[j];
+    nb_inserted = 0;
+    for(j = 0; j < count; ++j) {
+      keys[j] = rand() % NB_KEYS;
+      data[j] = (int)(i * 1000 + j);
+      if(new_ref[keys[j]] < 0) {
+        new_ref[keys[j]] = data[j];
+        ++nb_inserted;
+      } else if(policy == SL_DUPLICATE_KEEP_LAST) {
+        new_ref[keys[j]] = data[j];
+      } else if(policy == SL_DUPLICATE_REJECT) {
+        is_rejected = true;
+      }
+    }
+    if(is_rejected) {
+      CHECK(sl_flat_map_insert_n(map, keys, data, count, policy, &n),
+        BAD_ARG);
+      CHECK(n, 0);
+    } else {
+      CHECK(sl_flat_map_insert_n(map, keys, data, count, policy, &n), OK);
+      CHECK(n, nb_inserted);
+      for(j = 0; j < NB_KEYS; ++j) ref[j] = new_ref[j];
+    }
+
+    CHECK(sl_flat_map_key_buffer(map, &len, NULL, NULL, (void**)&map_keys),
+      OK);
+    CHECK(sl_flat_map_data_buffer(map, &n, NULL, NULL, (void**)&map_data),
+      OK);
+    CHECK(n, len);
+    for(j = 0, n = 0; j < NB_KEYS; ++j) {
+      if(ref[j] >= 0) {
+        CHECK(n < len, true);
+        CHECK(map_keys[n], (int)j);
+        CHECK(map_data[n], ref[j]);
+        ++n;
+      }
+    }
+    CHECK(n, len);
+  }
+  CHECK(sl_free_flat_map(map), OK);
+}
+
+/* Insert and erase random keys through the write buffer and check the map
+ * against the data of each key, -1 meaning that the key is not in the map. */
+static void
+check_delta(void)
+{
+  int ref[NB_KEYS];
+  struct sl_flat_map* map = NULL;
+  struct sl_pair pair = { NULL, NULL };
+  int* map_keys = NULL;
+  int* map_data = NULL;
+  void* ptr = NULL;
+  size_t nb_keys = 0;
+  size_t len = 0;
+  size_t n = 0;
+  size_t i = 0;
+  size_t j = 0;
+
+  for(i = 0; i < NB_KEYS; ++i) ref[i] = -1;
+  CHECK(sl_create_flat_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), cmp, NULL, &map), OK);
+  CHECK(sl_flat_map_enable_delta(NULL, 16), BAD_ARG);
+  CHECK(sl_flat_map_enable_delta(map, 0), BAD_ARG);
+  CHECK(sl_flat_map_enable_delta(map, 16), OK);
+  CHECK(sl_flat_map_enable_delta(map, 32), OK);
+  CHECK(sl_flat_map_merge_delta(NULL), BAD_ARG);
+  CHECK(sl_flat_map_merge_delta(map), OK);
+
+  for(i = 0; i < 20000; ++i) {
+    const int key = rand() % NB_KEYS;
+    const int data = (int)i;
+
+    if(rand() % 3) {
+      if(ref[key] < 0) {
+        CHECK(sl_flat_map_insert(map, &key, &data, NULL), OK);
+        ref[key] = data;
+        ++nb_keys;
+      } else {
+        CHECK(sl_flat_map_insert(map, &key, &data, NULL), BAD_ARG);
+      }
+    } else {
+      if(ref[key] >= 0) {
+        CHECK(sl_flat_map_erase(map, &key, NULL), OK);
+        ref[key] = -1;
+        --nb_keys;
+      } else {
+        CHECK(sl_flat_map_erase(map, &key, NULL), BAD_ARG);
+      }
+    }
+    CHECK(sl_flat_map_find(map, &key, &ptr), OK);
+    if(ref[key] < 0) {
+      CHECK(ptr, NULL);
+    } else {
+      NCHECK(ptr, NULL);
+      CHECK(*(int*)ptr, ref[key]);
+    }
+    CHECK(sl_flat_map_find_pair(map, &key, &pair), OK);
+    CHECK(pair.data, ptr);
+    CHECK(sl_flat_map_length(map, &len), OK);
+    CHECK(len, nb_keys);
+
+    if(i % 1000 == 999) {
+      /* Accesses by index merge the write buffer. */
+      CHECK(sl_flat_map_key_buffer
+        (map, &len, NULL, NULL, (void**)&map_keys), OK);
+      CHECK(sl_flat_map_data_buffer
+        (map, &n, NULL, NULL, (void**)&map_data), OK);
+      CHECK(n, len);
+      CHECK(len, nb_keys);
+      for(j = 0, n = 0; j < NB_KEYS; ++j) {
+        if(ref[j] >= 0) {
+          CHECK(map_keys[n], (int)j);
+          CHECK(map_data[n], ref[j]);
+          ++n;
+        }
+      }
+    }
+  }
+
+  /* Insertion and removal by id bypass the write buffer. */
+  for(i = 0; i < NB_KEYS && ref[i] >= 0; ++i);
+  if(i < NB_KEYS) {
+    const int key = (int)i;
+    const int data = -2;
+    CHECK(sl_flat_map_insert(map, &key, &data, &n), OK);
+    CHECK(sl_flat_map_at(map, n, &pair), OK);
+    CHECK(*(int*)pair.key, key);
+    CHECK(*(int*)pair.data, data);
+    CHECK(sl_flat_map_erase(map, &key, &j), OK);
+    CHECK(j, n);
+  }
+
+  CHECK(sl_flat_map_disable_delta(NULL), BAD_ARG);
+  CHECK(sl_flat_map_disable_delta(map), OK);
+  CHECK(sl_flat_map_disable_delta(map), OK);
+  CHECK(sl_flat_map_length(map, &len), OK);
+  CHECK(len, nb_keys);
+  for(i = 0; i < NB_KEYS; ++i) {
+    const int key = (int)i;
+    CHECK(sl_flat_map_find(map, &key, &ptr), OK);
+    if(ref[i] < 0) {
+      CHECK(ptr, NULL);
+    } else {
+      CHECK(*(int*)ptr, ref[i]);
+    }
+  }
+  CHECK(sl_flat_map_enable_delta(map, 8), OK);
+  for(i = 0; i < NB_KEYS && ref[i] >= 0; ++i);
+  if(i < NB_KEYS) {
+    const int key = (int)i;
+    CHECK(sl_flat_map_insert(map, &key, &key, NULL), OK);
+  }
+  CHECK(sl_clear_flat_map(map), OK);
+  CHECK(sl_flat_map_length(map, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_free_flat_map(map), OK);
+}
+
+/* Append increasing keys, with or without write buffer, insert the keys in
+ * between with hints and check the pairs of the map. */
+static void
+check_insert_hint(const bool use_delta)
+{
+  struct sl_flat_map* map = NULL;
+  int* map_keys = NULL;
+  int* map_data = NULL;
+  size_t len = 0;
+  size_t id = 0;
+  size_t i = 0;
+  int key = 0;
+
+  CHECK(sl_create_flat_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), cmp, NULL, &map), OK);
+  if(use_delta)
+    CHECK(sl_flat_map_enable_delta(map, 16), OK);
+  CHECK(sl_flat_map_insert_hint(NULL, &key, &key, 0, NULL), BAD_ARG);
+  CHECK(sl_flat_map_insert_hint(map, NULL, &key, 0, NULL), BAD_ARG);
+  CHECK(sl_flat_map_insert_hint(map, &key, NULL, 0, NULL), BAD_ARG);
+  CHECK(sl_flat_map_insert_hint(map, &key, &key, 1, NULL), BAD_ARG);
+
+  for(key = 0; key < NB_KEYS; key += 2) {
+    const int data = -key;
+    CHECK(sl_flat_map_insert(map, &key, &data, NULL), OK);
+    CHECK(sl_flat_map_insert(map, &key, &data, NULL), BAD_ARG);
+    if(key == NB_KEYS / 2) {
+      /* Buffer a tombstone: the next keys are not appended directly. */
+      CHECK(sl_flat_map_erase(map, &key, NULL), OK);
+      CHECK(sl_flat_map_insert(map, &key, &data, NULL), OK);
+    }
+  }
+  CHECK(sl_flat_map_length(map, &len), OK);
+  CHECK(len, NB_KEYS / 2);
+  for(key = 1, id = 0; key < NB_KEYS; key += 2) {
+    const int data = -key;
+    CHECK(sl_flat_map_insert_hint(map, &key, &data, id + 1, &id), OK);
+    CHECK(id, (size_t)key);
+  }
+  key = NB_KEYS / 2;
+  CHECK(sl_flat_map_insert_hint(map, &key, &key, 0, NULL), BAD_ARG);
+  CHECK(sl_flat_map_insert_hint(map, &key, &key, NB_KEYS + 1, NULL), BAD_ARG);
+
+  CHECK(sl_flat_map_key_buffer(map, &len, NULL, NULL, (void**)&map_keys), OK);
+  CHECK(sl_flat_map_data_buffer(map, &id, NULL, NULL, (void**)&map_data), OK);
+  CHECK(len, NB_KEYS);
+  CHECK(id, NB_KEYS);
+  for(i = 0; i < NB_KEYS; ++i) {
+    CHECK(map_keys[i], (int)i);
+    CHECK(map_data[i], -(int)i);
+  }
+  CHECK(sl_free_flat_map(map), OK);
+}
+
+/* Check that the pairs of the map are the pairs of ref, in which -1 means
+ * that the key is not in the map. */
+static void
+check_pairs(struct sl_flat_map* map, const int* ref)
+{
+  int* map_keys = NULL;
+  int* map_data = NULL;
+  size_t len = 0;
+  size_t n = 0;
+  size_t i = 0;
+
+  CHECK(sl_flat_map_key_buffer(map, &len, NULL, NULL, (void**)&map_keys), OK);
+  CHECK(sl_flat_map_data_buffer(map, &n, NULL, NULL, (void**)&map_data), OK);
+  CHECK(n, len);
+  for(i = 0, n = 0; i < NB_KEYS; ++i) {
+    if(ref[i] >= 0) {
+      CHECK(n < len, true);
+      CHECK(map_keys[n], (int)i);
+      CHECK(map_data[n], ref[i]);
+      ++n;
+    }
+  }
+  CHECK(n, len);
+}
+
+/* Erase and extract ranges of pairs, with or without write buffer. */
+static void
+check_erase_range(const bool use_delta)
+{
+  int ref[NB_KEYS];
+  int dst_ref[NB_KEYS];
+  struct sl_flat_map* map = NULL;
+  struct sl_flat_map* dst = NULL;
+  struct sl_flat_map* other = NULL;
+  size_t n = 0;
+  size_t i = 0;
+  int lower = 0;
+  int upper = 0;
+  int key = 0;
+
+  CHECK(sl_create_flat_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), cmp, NULL, &map), OK);
+  CHECK(sl_create_flat_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), cmp, NULL, &dst), OK);
+  CHECK(sl_create_flat_map(sizeof(int), ALIGNOF(int), sizeof(char),
+    ALIGNOF(char), cmp, NULL, &other), OK);
+  if(use_delta) {
+    CHECK(sl_flat_map_enable_delta(map, 16), OK);
+    CHECK(sl_flat_map_enable_delta(dst, 16), OK);
+  }
+  for(i = 0; i < NB_KEYS; ++i) {
+    key = (int)i;
+    ref[i] = key * 2;
+    dst_ref[i] = -1;
+    CHECK(sl_flat_map_insert(map, &key, ref + i, NULL), OK);
+  }
+
+  CHECK(sl_flat_map_erase_n(NULL, 0, 1), BAD_ARG);
+  CHECK(sl_flat_map_erase_n(map, NB_KEYS, 1), BAD_ARG);
+  CHECK(sl_flat_map_erase_range(NULL, NULL, NULL, NULL), BAD_ARG);
+  lower = 10;
+  upper = 9;
+  CHECK(sl_flat_map_erase_range(map, &lower, &upper, NULL), BAD_ARG);
+
+  /* Buffer an erase before erasing ranges. */
+  key = 5;
+  CHECK(sl_flat_map_erase(map, &key, NULL), OK);
+  ref[key] = -1;
+  upper = 20;
+  CHECK(sl_flat_map_erase_range(map, NULL, &upper, &n), OK);
+  CHECK(n, 19);
+  for(i = 0; i < 20; ++i) ref[i] = -1;
+  lower = 100;
+  upper = 150;
+  CHECK(sl_flat_map_erase_range(map, &lower, &upper, &n), OK);
+  CHECK(n, 50);
+  for(i = 100; i < 150; ++i) ref[i] = -1;
+  CHECK(sl_flat_map_erase_n(map, 0, 10), OK);
+  for(i = 20; i < 30; ++i) ref[i] = -1;
+  check_pairs(map, ref);
+
+  CHECK(sl_flat_map_extract_range(NULL, NULL, NULL, dst, NULL), BAD_ARG);
+  CHECK(sl_flat_map_extract_range(map, NULL, NULL, NULL, NULL), BAD_ARG);
+  CHECK(sl_flat_map_extract_range(map, NULL, NULL, map, NULL), BAD_ARG);
+  CHECK(sl_flat_map_extract_range(map, NULL, NULL, other, NULL), BAD_ARG);
+  CHECK(sl_flat_map_extract_range(other, NULL, NULL, map, NULL), BAD_ARG);
+
+  /* Appended slices, then slices merged before the dst keys. */
+  lower = 400;
+  upper = 500;
+  CHECK(sl_flat_map_extract_range(map, &lower, &upper, dst, &n), OK);
+  CHECK(n, 100);
+  lower = 600;
+  upper = 700;
+  CHECK(sl_flat_map_extract_range(map, &lower, &upper, dst, &n), OK);
+  CHECK(n, 100);
+  lower = 120;
+  upper = 450;
+  CHECK(sl_flat_map_extract_range(map, &lower, &upper, dst, &n), OK);
+  CHECK(n, 250);
+  lower = 0;
+  upper = 120;
+  CHECK(sl_flat_map_extract_range(map, &lower, &upper, dst, &n), OK);
+  CHECK(n, 70);
+  for(i = 30; i < 700; ++i) {
+    if(i >= 100 && i < 150)
+      continue;
+    if(i >= 500 && i < 600)
+      continue;
+    dst_ref[i] = ref[i];
+    ref[i] = -1;
+  }
+  check_pairs(map, ref);
+  check_pairs(dst, dst_ref);
+
+  /* A key of the slice already in dst. */
+  key = 1000;
+  CHECK(sl_flat_map_insert(dst, &key, &key, NULL), OK);
+  dst_ref[key] = key;
+  lower = 900;
+  upper = 1100;
+  CHECK(sl_flat_map_extract_range(map, &lower, &upper, dst, &n), BAD_ARG);
+  CHECK(n, 0);
+  check_pairs(map, ref);
+  check_pairs(dst, dst_ref);
+
+  /* Extract all the remaining pairs. */
+  CHECK(sl_flat_map_erase(dst, &key, NULL), OK);
+  dst_ref[key] = -1;
+  CHECK(sl_flat_map_length(map, &n), OK);
+  CHECK(sl_flat_map_extract_range(map, NULL, NULL, dst, &i), OK);
+  CHECK(i, n);
+  for(i = 0; i < NB_KEYS; ++i) {
+    if(ref[i] >= 0)
+      dst_ref[i] = ref[i];
+    ref[i] = -1;
+  }
+  check_pairs(map, ref);
+  check_pairs(dst, dst_ref);
+
+  CHECK(sl_free_flat_map(map), OK);
+  CHECK(sl_free_flat_map(dst), OK);
+  CHECK(sl_free_flat_map(other), OK);
+}
+
+/* Look for batches of keys in a map whose write buffer holds inserted and
+ * erased pairs, and check that the buffer is not merged. */
+static void
+check_find_n(void)
+{
+  int keys[NB_KEYS];
+  void* data[NB_KEYS];
+  struct sl_flat_map* map = NULL;
+  void* buffered = NULL;
+  void* ptr = NULL;
+  size_t i = 0;
+  int key = 0;
+
+  CHECK(sl_create_flat_map(sizeof(int), ALIGNOF(int), sizeof(int),
+    ALIGNOF(int), cmp, NULL, &map), OK);
+  CHECK(sl_flat_map_find_n(NULL, keys, 1, data), BAD_ARG);
+  CHECK(sl_flat_map_find_n(map, NULL, 1, data), BAD_ARG);
+  CHECK(sl_flat_map_find_n(map, keys, 1, NULL), BAD_ARG);
+  CHECK(sl_flat_map_find_n(map, NULL, 0, NULL), OK);
+  for(key = 0; key < NB_KEYS; key += 2) {
+    const int value = key * 3;
+    CHECK(sl_flat_map_insert(map, &key, &value, NULL), OK);
+  }
+  CHECK(sl_flat_map_enable_delta(map, 64), OK);
+  for(key = 1; key < 40; key += 2) {
+    const int value = key * 3;
+    CHECK(sl_flat_map_insert(map, &key, &value, NULL), OK);
+  }
+  for(key = 100; key < 120; key += 2)
+    CHECK(sl_flat_map_erase(map, &key, NULL), OK);
+  /* A merge would move the buffered pair into the map arrays. */
+  key = 1;
+  CHECK(sl_flat_map_find(map, &key, &buffered), OK);
+  NCHECK(buffered, NULL);
+
+  for(i = 0; i < NB_KEYS; ++i)
+    keys[i] = rand() % NB_KEYS;
+  CHECK(sl_flat_map_find_n(map, keys, NB_KEYS, data), OK);
+  for(i = 0; i < NB_KEYS; ++i) {
+    CHECK(sl_flat_map_find(map, keys + i, &ptr), OK);
+    CHECK(data[i], ptr);
+    if(ptr)
+      CHECK(*(int*)ptr, keys[i] * 3);
+  }
+  for(i = 0; i < NB_KEYS; ++i)
+    keys[i] = (int)i;
+  CHECK(sl_flat_map_find_n(map, keys, NB_KEYS, data), OK);
+  for(i = 0; i < NB_KEYS; ++i) {
+    if((i % 2 == 0 && (i < 100 || i >= 120)) || i < 40) {
+      NCHECK(data[i], NULL);
+      CHECK(*(int*)data[i], (int)i * 3);
+    } else {
+      CHECK(data[i], NULL);
+    }
+  }
+  CHECK(data[1], buffered);
+  CHECK(sl_flat_map_find(map, &key, &ptr), OK);
+  CHECK(ptr, buffered);
+  CHECK(sl_free_flat_map(map), OK);
+}
+
 int
 main(int argc UNUSED, char** argv UNUSED)
 {
@@ -342,6 +796,16 @@ main(int argc UNUSED, char** argv UNUSED)
 
   CHECK(sl_free_flat_map(NULL), BAD_ARG);
   CHECK(sl_free_flat_map(map), OK);
+
+  check_insert_n(SL_DUPLICATE_KEEP_FIRST);
+  check_insert_n(SL_DUPLICATE_KEEP_LAST);
+  check_insert_n(SL_DUPLICATE_REJECT);
+  check_delta();
+  check_insert_hint(false);
+  check_insert_hint(true);
+  check_erase_range(false);
+  check_erase_range(true);
+  check_find_n();
   CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
   return 0;
 }
@@ -2,7 +2,9 @@
 #include <snlsys/mem_allocator.h>
 #include <snlsys/snlsys.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* Shortened expressions. */
 #define SZ sizeof
@@ -28,9 +30,465 @@ cmp(const void* i0, const void* i1)
     return 0;
 }
 
+#define NB_KEYS 2000
+
+/* Elements compared on their key only, to check which of two equal elements
+ * is kept by sl_flat_set_insert_n. */
+struct item {
+  int key;
+  int tag;
+};
+
+static int
+cmp_item(const void* a, const void* b)
+{
+  return cmp(&((const struct item*)a)->key, &((const struct item*)b)->key);
+}
+
+/* Insert random batches with the policy and check the set against the tag of
+ * each key, -1 meaning that the key is not in the set. */
+static void
+check_insert_n(const enum sl_duplicate_policy policy)
+{
+  struct item batch[500];
+  const size_t batch_sizes[] = { 1, 2, 7, 60, 500, 3, 500 };
+  int ref[NB_KEYS];
+  struct sl_flat_set* set = NULL;
+  struct item* items = NULL;
+  size_t len = 0;
+  size_t n = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t nb_inserted = 0;
+
+  for(i = 0; i < NB_KEYS; ++i) ref[i] = -1;
+  CHECK(sl_create_flat_set(SZ(struct item), AL(struct item), cmp_item, NULL,
+    &set), OK);
+
+  for(i = 0; i < sizeof(batch_sizes)/sizeof(size_t); ++i) {
+    int new_ref[NB_KEYS];
+    bool is_rejected = false;
+    const size_t count = batch_sizes[i];
+
+    for(j = 0; j < NB_KEYS; ++j) new_ref[j] = ref[j];
+    nb_inserted = 0;
+    for(j = 0; j < count; ++j) {
+      batch[j].key = rand() % NB_KEYS;
+      batch[j].tag = (int)(i * 1000 + j);
+      if(new_ref[batch[j].key] < 0) {
+        new_ref[batch[j].key] = batch[j].tag;
+        ++nb_inserted;
+      } else if(policy == SL_DUPLICATE_KEEP_LAST) {
+        new_ref[batch[j].key] = batch[j].tag;
+      } else if(policy == SL_DUPLICATE_REJECT) {
+        is_rejected = true;
+      }
+    }
+    CHECK(sl_flat_set_length(set, &len), OK);
+    if(is_rejected) {
+      CHECK(sl_flat_set_insert_n(set, batch, count, policy, &n), BAD_ARG);
+      CHECK(n, 0);
+    } else {
+      CHECK(sl_flat_set_insert_n(set, batch, count, policy, &n), OK);
+      CHECK(n, nb_inserted);
+      for(j = 0; j < NB_KEYS; ++j) ref[j] = new_ref[j];
+    }
+
+    CHECK(sl_flat_set_buffer(set, &len, NULL, NULL, (void**)&items), OK);
+    for(j = 0, n = 0; j < NB_KEYS; ++j) {
+      if(ref[j] >= 0) {
+        CHECK(n < len, true);
+        CHECK(items[n].key, (int)j);
+        CHECK(items[n].tag, ref[j]);
+        ++n;
+      }
+    }
+    CHECK(n, len);
+  }
+  CHECK(sl_free_flat_set(set), OK);
+}
+
+/* Append increasing keys, insert the keys in between with right hints and
+ * random keys with random hints, and check the set against the reference. */
+static void
+check_insert_hint(void)
+{
+  bool ref[NB_KEYS];
+  struct sl_flat_set* set = NULL;
+  int* keys = NULL;
+  size_t len = 0;
+  size_t id = 0;
+  size_t i = 0;
+  int key = 0;
+
+  for(i = 0; i < NB_KEYS; ++i) ref[i] = false;
+  CHECK(sl_create_flat_set(SZ(int), AL(int), cmp, NULL, &set), OK);
+  CHECK(sl_flat_set_insert_hint(NULL, NULL, 0, NULL), BAD_ARG);
+  CHECK(sl_flat_set_insert_hint(set, NULL, 0, NULL), BAD_ARG);
+  CHECK(sl_flat_set_insert_hint(NULL, &key, 0, NULL), BAD_ARG);
+  CHECK(sl_flat_set_insert_hint(set, &key, 1, NULL), BAD_ARG);
+
+  for(key = 0; key < NB_KEYS; key += 4) {
+    CHECK(sl_flat_set_insert(set, &key, &id), OK);
+    CHECK(id, (size_t)key / 4);
+    ref[key] = true;
+  }
+  /* The hint is the id following the previously inserted key. */
+  for(key = 2, id = 0; key < NB_KEYS; key += 4) {
+    CHECK(sl_flat_set_insert_hint(set, &key, id + 1, &id), OK);
+    CHECK(id, (size_t)key / 2);
+    ref[key] = true;
+  }
+  CHECK(sl_flat_set_length(set, &len), OK);
+  key = 0;
+  CHECK(sl_flat_set_insert_hint(set, &key, 0, NULL), BAD_ARG);
+  CHECK(sl_flat_set_insert_hint(set, &key, 1, NULL), BAD_ARG);
+  CHECK(sl_flat_set_insert_hint(set, &key, len, NULL), BAD_ARG);
+  CHECK(sl_flat_set_insert_hint(set, &key, len + 1, NULL), BAD_ARG);
+
+  for(i = 0; i < NB_KEYS; ++i) {
+    key = rand() % NB_KEYS;
+    CHECK(sl_flat_set_length(set, &len), OK);
+    CHECK(sl_flat_set_insert_hint(set, &key, (size_t)rand() % (len + 1),
+      NULL), ref[key] ? BAD_ARG : OK);
+    ref[key] = true;
+  }
+  CHECK(sl_flat_set_buffer(set, &len, NULL, NULL, (void**)&keys), OK);
+  for(i = 0, id = 0; i < NB_KEYS; ++i) {
+    if(ref[i]) {
+      CHECK(id < len, true);
+      CHECK(keys[id], (int)i);
+      ++id;
+    }
+  }
+  CHECK(id, len);
+  CHECK(sl_free_flat_set(set), OK);
+}
+
+/* Erase random ranges of keys and of ids, and check the set against the
+ * reference. */
+static void
+check_erase_range(void)
+{
+  bool ref[NB_KEYS];
+  struct sl_flat_set* set = NULL;
+  int* keys = NULL;
+  size_t nb_erased = 0;
+  size_t len = 0;
+  size_t id = 0;
+  size_t i = 0;
+  int lower = 0;
+  int upper = 0;
+  int key = 0;
+
+  CHECK(sl_create_flat_set(SZ(int), AL(int), cmp, NULL, &set), OK);
+  CHECK(sl_flat_set_erase_range(NULL, NULL, NULL, NULL), BAD_ARG);
+  CHECK(sl_flat_set_erase_range(set, NULL, NULL, &nb_erased), OK);
+  CHECK(nb_erased, 0);
+  CHECK(sl_flat_set_erase_n(NULL, 0, 0), BAD_ARG);
+  CHECK(sl_flat_set_erase_n(set, 0, 0), OK);
+  CHECK(sl_flat_set_erase_n(set, 0, 1), BAD_ARG);
+
+  for(key = 0; key < NB_KEYS; ++key) {
+    ref[key] = key % 3 != 0;
+    if(ref[key])
+      CHECK(sl_flat_set_insert(set, &key, NULL), OK);
+  }
+  lower = 10;
+  upper = 9;
+  CHECK(sl_flat_set_erase_range(set, &lower, &upper, NULL), BAD_ARG);
+  CHECK(sl_flat_set_erase_range(set, &lower, &lower, &nb_erased), OK);
+  CHECK(nb_erased, 0);
+
+  for(i = 0; i < 64; ++i) {
+    lower = rand() % (NB_KEYS + 2) - 1;
+    upper = lower + rand() % (NB_KEYS / 32);
+    CHECK(sl_flat_set_erase_range(set, &lower, &upper, &nb_erased), OK);
+    for(key = MAX(lower, 0); key < MIN(upper, NB_KEYS); ++key) {
+      nb_erased -= ref[key];
+      ref[key] = false;
+    }
+    CHECK(nb_erased, 0);
+
+    CHECK(sl_flat_set_length(set, &len), OK);
+    if(!len)
+      break;
+    id = (size_t)rand() % len;
+    CHECK(sl_flat_set_buffer(set, NULL, NULL, NULL, (void**)&keys), OK);
+    for(nb_erased = 0; nb_erased < 8 && id + nb_erased < len; ++nb_erased)
+      ref[keys[id + nb_erased]] = false;
+    CHECK(sl_flat_set_erase_n(set, id, 8), OK);
+  }
+  /* Erase a prefix and a suffix. */
+  key = NB_KEYS / 4;
+  CHECK(sl_flat_set_erase_range(set, NULL, &key, NULL), OK);
+  for(i = 0; i < (size_t)key; ++i) ref[i] = false;
+  key = NB_KEYS / 2;
+  CHECK(sl_flat_set_erase_range(set, &key, NULL, NULL), OK);
+  for(i = (size_t)key; i < NB_KEYS; ++i) ref[i] = false;
+
+  CHECK(sl_flat_set_buffer(set, &len, NULL, NULL, (void**)&keys), OK);
+  for(i = 0, id = 0; i < NB_KEYS; ++i) {
+    if(ref[i]) {
+      CHECK(id < len, true);
+      CHECK(keys[id], (int)i);
+      ++id;
+    }
+  }
+  CHECK(id, len);
+  CHECK(sl_flat_set_erase_range(set, NULL, NULL, &nb_erased), OK);
+  CHECK(nb_erased, len);
+  CHECK(sl_flat_set_length(set, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_free_flat_set(set), OK);
+}
+
+/* Look for sorted and unsorted batches of keys, and check the ids against
+ * the ones of sl_flat_set_find. */
+static void
+check_find_n(void)
+{
+  const size_t counts[] = { 1, 2, 7, 8, 9, 100, NB_KEYS };
+  int queries[NB_KEYS];
+  size_t ids[NB_KEYS];
+  struct sl_flat_set* set = NULL;
+  size_t id = 0;
+  size_t len = 0;
+  size_t i = 0;
+  size_t j = 0;
+  int key = 0;
+
+  CHECK(sl_create_flat_set(SZ(int), AL(int), cmp, NULL, &set), OK);
+  CHECK(sl_flat_set_find_n(NULL, queries, 1, ids), BAD_ARG);
+  CHECK(sl_flat_set_find_n(set, NULL, 1, ids), BAD_ARG);
+  CHECK(sl_flat_set_find_n(set, queries, 1, NULL), BAD_ARG);
+  CHECK(sl_flat_set_find_n(set, NULL, 0, NULL), OK);
+  queries[0] = 3;
+  queries[1] = 1;
+  CHECK(sl_flat_set_find_n(set, queries, 2, ids), OK);
+  CHECK(ids[0], 0);
+  CHECK(ids[1], 0);
+
+  for(key = 0; key < NB_KEYS; ++key) {
+    if(key % 3)
+      CHECK(sl_flat_set_insert(set, &key, NULL), OK);
+  }
+  CHECK(sl_flat_set_length(set, &len), OK);
+  for(i = 0; i < sizeof(counts)/sizeof(size_t); ++i) {
+    const size_t count = counts[i];
+    /* Unsorted queries, then sorted ones with duplicates. */
+    for(j = 0; j < count; ++j)
+      queries[j] = rand() % (NB_KEYS + 20) - 10;
+    CHECK(sl_flat_set_find_n(set, queries, count, ids), OK);
+    for(j = 0; j < count; ++j) {
+      CHECK(sl_flat_set_find(set, queries + j, &id), OK);
+      CHECK(ids[j], id);
+    }
+    for(j = 0; j < count; ++j)
+      queries[j] = (int)(j * NB_KEYS / count) - (int)(j % 2);
+    CHECK(sl_flat_set_find_n(set, queries, count, ids), OK);
+    for(j = 0; j < count; ++j) {
+      CHECK(sl_flat_set_find(set, queries + j, &id), OK);
+      CHECK(ids[j], id);
+      CHECK(ids[j] == len, queries[j] % 3 == 0 || queries[j] < 0);
+    }
+  }
+  CHECK(sl_free_flat_set(set), OK);
+}
+
+/* Check the searches against the sorted buffer of the set, frozen or not. */
+static void
+check_search(struct sl_flat_set* set, int max_value)
+{
+  int* buffer = NULL;
+  size_t len = 0;
+  size_t id = 0;
+  size_t i = 0;
+  int value = 0;
+
+  CHECK(sl_flat_set_buffer(set, &len, NULL, NULL, (void**)&buffer), OK);
+  for(value = -1; value <= max_value + 1; ++value) {
+    for(i = 0; i < len && buffer[i] < value; ++i);
+    CHECK(sl_flat_set_lower_bound(set, &value, &id), OK);
+    CHECK(id, i);
+    CHECK(sl_flat_set_find(set, &value, &id), OK);
+    CHECK(id, i < len && buffer[i] == value ? i : len);
+    for(; i < len && buffer[i] <= value; ++i);
+    CHECK(sl_flat_set_upper_bound(set, &value, &id), OK);
+    CHECK(id, i);
+  }
+}
+
+#define NB_VALUES 4000
+
+/* Element types of the set algebra checks. */
+enum kind {
+  KIND_INT, /* Compared with a user comparator. */
+  KIND_U32,
+  KIND_U64
+};
+
+/* Write in elt the element of the value-th rank. */
+static void
+value_to_element(const enum kind kind, const int value, void* elt)
+{
+  switch(kind) {
+    case KIND_INT: *(int*)elt = value - NB_VALUES / 2; break;
+    case KIND_U32: *(uint32_t*)elt = (uint32_t)value * 1000003u; break;
+    case KIND_U64:
+      *(uint64_t*)elt = (uint64_t)value * UINT64_C(0x100000001);
+      break;
+    default: ASSERT(0); break;
+  }
+}
+
+static bool
+is_in_result(const int op, const bool is_in_a, const bool is_in_b)
+{
+  switch(op) {
+    case 0: return is_in_a || is_in_b;
+    case 1: return is_in_a && is_in_b;
+    case 2: return is_in_a && !is_in_b;
+    default: return is_in_a != is_in_b;
+  }
+}
+
+static enum sl_error
+set_op
+  (const int op,
+   struct sl_flat_set* dst,
+   struct sl_flat_set* a,
+   struct sl_flat_set* b)
+{
+  switch(op) {
+    case 0: return sl_flat_set_union(dst, a, b);
+    case 1: return sl_flat_set_intersect(dst, a, b);
+    case 2: return sl_flat_set_difference(dst, a, b);
+    default: return sl_flat_set_symmetric_difference(dst, a, b);
+  }
+}
+
+/* Check the content of the set against the values flagged in is_in. */
+static void
+check_values
+  (struct sl_flat_set* set,
+   const enum kind kind,
+   const bool* is_in)
+{
+  char elt[8];
+  char* buffer = NULL;
+  size_t len = 0;
+  size_t sz = 0;
+  size_t n = 0;
+  int value = 0;
+
+  CHECK(sl_flat_set_buffer(set, &len, &sz, NULL, (void**)&buffer), OK);
+  for(value = 0; value < NB_VALUES; ++value) {
+    if(!is_in[value])
+      continue;
+    CHECK(n < len, true);
+    value_to_element(kind, value, elt);
+    CHECK(memcmp(buffer + n * sz, elt, sz), 0);
+    ++n;
+  }
+  CHECK(n, len);
+}
+
+static void
+check_set_algebra(const enum kind kind, const size_t alignment)
+{
+  const size_t sizes[][2] = {
+    {0, 0}, {0, 100}, {100, 0}, {5, 7}, {1000, 1000}, {2000, 1500},
+    {30, 3000}, {3000, 20}, {1, 4000}
+  };
+  int (*compare)(const void*, const void*) = NULL;
+  struct sl_flat_set* a = NULL;
+  struct sl_flat_set* b = NULL;
+  struct sl_flat_set* dst = NULL;
+  struct sl_flat_set* other = NULL;
+  bool is_in_a[NB_VALUES];
+  bool is_in_b[NB_VALUES];
+  bool expected[NB_VALUES];
+  bool is_frozen = true;
+  ALIGN(8) char elt[8];
+  size_t sz = 0;
+  size_t i = 0;
+  size_t j = 0;
+  int value = 0;
+  int op = 0;
+
+  switch(kind) {
+    case KIND_INT: sz = sizeof(int); compare = cmp; break;
+    case KIND_U32: sz = sizeof(uint32_t); compare = sl_flat_set_cmp_u32; break;
+    case KIND_U64: sz = sizeof(uint64_t); compare = sl_flat_set_cmp_u64; break;
+    default: ASSERT(0); break;
+  }
+  CHECK(sl_create_flat_set(sz, alignment, compare, NULL, &a), OK);
+  CHECK(sl_create_flat_set(sz, alignment, compare, NULL, &b), OK);
+  CHECK(sl_create_flat_set(sz, alignment, compare, NULL, &dst), OK);
+  CHECK(sl_create_flat_set(sz, alignment, cmp_item, NULL, &other), OK);
+
+  CHECK(sl_flat_set_union(NULL, a, b), BAD_ARG);
+  CHECK(sl_flat_set_intersect(dst, NULL, b), BAD_ARG);
+  CHECK(sl_flat_set_difference(dst, a, NULL), BAD_ARG);
+  CHECK(sl_flat_set_symmetric_difference(other, a, b), BAD_ARG);
+  CHECK(sl_flat_set_intersect(dst, other, b), BAD_ARG);
+
+  for(i = 0; i < sizeof(sizes)/sizeof(sizes[0]); ++i) {
+    CHECK(sl_clear_flat_set(a), OK);
+    CHECK(sl_clear_flat_set(b), OK);
+    memset(is_in_a, 0, sizeof(is_in_a));
+    memset(is_in_b, 0, sizeof(is_in_b));
+    for(j = 0; j < sizes[i][0]; ++j) {
+      value = rand() % NB_VALUES;
+      value_to_element(kind, value, elt);
+      CHECK(sl_flat_set_insert(a, elt, NULL), is_in_a[value] ? BAD_ARG : OK);
+      is_in_a[value] = true;
+    }
+    for(j = 0; j < sizes[i][1]; ++j) {
+      value = rand() % NB_VALUES;
+      value_to_element(kind, value, elt);
+      CHECK(sl_flat_set_insert(b, elt, NULL), is_in_b[value] ? BAD_ARG : OK);
+      is_in_b[value] = true;
+    }
+
+    for(op = 0; op < 4; ++op) {
+      for(value = 0; value < NB_VALUES; ++value)
+        expected[value] = is_in_result(op, is_in_a[value], is_in_b[value]);
+      CHECK(set_op(op, dst, a, b), OK);
+      check_values(dst, kind, expected);
+      CHECK(sl_flat_set_freeze(dst), OK);
+      CHECK(set_op(op, dst, a, b), OK);
+      check_values(dst, kind, expected);
+      CHECK(sl_flat_set_is_frozen(dst, &is_frozen), OK);
+      CHECK(is_frozen, false);
+
+      /* The destination is one of the operands. */
+      for(value = 0; value < NB_VALUES; ++value)
+        expected[value] = is_in_result(op, is_in_a[value], is_in_a[value]);
+      CHECK(set_op(op, dst, a, a), OK);
+      check_values(dst, kind, expected);
+      CHECK(sl_flat_set_union(dst, a, b), OK);
+      for(value = 0; value < NB_VALUES; ++value)
+        expected[value] = is_in_a[value] || is_in_b[value];
+      CHECK(set_op(op, dst, dst, b), OK);
+      for(value = 0; value < NB_VALUES; ++value) {
+        expected[value] = is_in_result
+          (op, is_in_a[value] || is_in_b[value], is_in_b[value]);
+      }
+      check_values(dst, kind, expected);
+    }
+  }
+  CHECK(sl_free_flat_set(a), OK);
+  CHECK(sl_free_flat_set(b), OK);
+  CHECK(sl_free_flat_set(dst), OK);
+  CHECK(sl_free_flat_set(other), OK);
+}
+
 int
 main(int argc UNUSED, char** argv UNUSED)
 {
+  bool is_frozen = false;
   ALIGN(16) int array[4];
   struct sl_flat_set* vec = NULL;
   void* buffer = NULL;
@@ -334,6 +792,93 @@ main(int argc UNUSED, char** argv UNUSED)
   CHECK(sl_free_flat_set(NULL), BAD_ARG);
   CHECK(sl_free_flat_set(vec), OK);
 
+  /* Bulk insertion. */
+  CHECK(sl_create_flat_set(SZ(int), AL(int), cmp, NULL, &vec), OK);
+  CHECK(sl_flat_set_insert_n(NULL, array, 1, SL_DUPLICATE_KEEP_FIRST, NULL),
+    BAD_ARG);
+  CHECK(sl_flat_set_insert_n(vec, NULL, 1, SL_DUPLICATE_KEEP_FIRST, NULL),
+    BAD_ARG);
+  CHECK(sl_flat_set_insert_n(vec, array, 1, (enum sl_duplicate_policy)42,
+    NULL), BAD_ARG);
+  CHECK(sl_flat_set_insert_n(vec, NULL, 0, SL_DUPLICATE_KEEP_FIRST, &len), OK);
+  CHECK(len, 0);
+  array[0] = 3;
+  array[1] = 1;
+  array[2] = 3;
+  array[3] = 2;
+  CHECK(sl_flat_set_insert_n(vec, array, 4, SL_DUPLICATE_REJECT, &len),
+    BAD_ARG);
+  CHECK(sl_flat_set_insert_n(vec, array, 4, SL_DUPLICATE_KEEP_FIRST, &len),
+    OK);
+  CHECK(len, 3);
+  CHECK(sl_flat_set_insert_n(vec, array, 2, SL_DUPLICATE_REJECT, &len),
+    BAD_ARG);
+  CHECK(sl_flat_set_length(vec, &len), OK);
+  CHECK(len, 3);
+  CHECK(sl_flat_set_buffer(vec, &len, NULL, NULL, &buffer), OK);
+  CHECK(((int*)buffer)[0], 1);
+  CHECK(((int*)buffer)[1], 2);
+  CHECK(((int*)buffer)[2], 3);
+  CHECK(sl_free_flat_set(vec), OK);
+  check_insert_n(SL_DUPLICATE_KEEP_FIRST);
+  check_insert_n(SL_DUPLICATE_KEEP_LAST);
+  check_insert_n(SL_DUPLICATE_REJECT);
+
+  /* Frozen mode. */
+  CHECK(sl_create_flat_set(SZ(int), AL(int), cmp, NULL, &vec), OK);
+  CHECK(sl_flat_set_freeze(NULL), BAD_ARG);
+  CHECK(sl_flat_set_unfreeze(NULL), BAD_ARG);
+  CHECK(sl_flat_set_is_frozen(NULL, &is_frozen), BAD_ARG);
+  CHECK(sl_flat_set_is_frozen(vec, NULL), BAD_ARG);
+  CHECK(sl_flat_set_is_frozen(vec, &is_frozen), OK);
+  CHECK(is_frozen, false);
+  CHECK(sl_flat_set_freeze(vec), OK);
+  CHECK(sl_flat_set_is_frozen(vec, &is_frozen), OK);
+  CHECK(is_frozen, true);
+  CHECK(sl_flat_set_freeze(vec), OK);
+  check_search(vec, 0);
+  for(len = 1; len < 70; ++len) {
+    const int value = (int)len * 3;
+    CHECK(sl_flat_set_insert(vec, &value, NULL), OK);
+    /* A modification unfreezes the set. */
+    CHECK(sl_flat_set_is_frozen(vec, &is_frozen), OK);
+    CHECK(is_frozen, false);
+    check_search(vec, (int)len * 3);
+    CHECK(sl_flat_set_freeze(vec), OK);
+    check_search(vec, (int)len * 3);
+  }
+  /* A failed modification leaves the set frozen. */
+  CHECK(sl_flat_set_insert(vec, (int[]){3}, NULL), BAD_ARG);
+  CHECK(sl_flat_set_erase(vec, (int[]){1}, NULL), BAD_ARG);
+  CHECK(sl_flat_set_is_frozen(vec, &is_frozen), OK);
+  CHECK(is_frozen, true);
+  /* Insert and erase random values, some of which are already (or not) in
+   * the set. */
+  for(id = 0; id < 300; ++id) {
+    const int value = rand() % 3000;
+    sl_flat_set_insert(vec, &value, NULL);
+  }
+  check_search(vec, 3000);
+  CHECK(sl_flat_set_freeze(vec), OK);
+  check_search(vec, 3000);
+  for(id = 0; id < 1000; ++id) {
+    const int value = rand() % 3000;
+    sl_flat_set_erase(vec, &value, NULL);
+  }
+  CHECK(sl_flat_set_freeze(vec), OK);
+  check_search(vec, 3000);
+  CHECK(sl_flat_set_unfreeze(vec), OK);
+  CHECK(sl_flat_set_is_frozen(vec, &is_frozen), OK);
+  CHECK(is_frozen, false);
+  check_search(vec, 3000);
+  CHECK(sl_flat_set_freeze(vec), OK);
+  CHECK(sl_clear_flat_set(vec), OK);
+  CHECK(sl_flat_set_is_frozen(vec, &is_frozen), OK);
+  CHECK(is_frozen, false);
+  CHECK(sl_flat_set_freeze(vec), OK);
+  check_search(vec, 0);
+  CHECK(sl_free_flat_set(vec), OK);
+
   CHECK(sl_create_flat_set
         (SZ(int), 16, cmp, &mem_default_allocator, &vec), OK);
   array[0] = 0;
@@ -344,6 +889,16 @@ main(int argc UNUSED, char** argv UNUSED)
   CHECK(sl_flat_set_insert(vec, &array[1], NULL), BAD_ALIGN);
   CHECK(sl_free_flat_set(vec), OK);
 
+  check_insert_hint();
+  check_erase_range();
+  check_find_n();
+  check_set_algebra(KIND_INT, sizeof(int));
+  check_set_algebra(KIND_U32, sizeof(uint32_t));
+  check_set_algebra(KIND_U64, sizeof(uint64_t));
+  /* Unaligned integers use the generic intersection. */
+  check_set_algebra(KIND_U32, 1);
+  check_set_algebra(KIND_U64, 1);
+
   CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
 
   return 0;
@@ -0,0 +1,169 @@
+#include "../sl_mpmc_queue.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+#define NB_THREADS 4
+#define NB_MSGS 100000 /* Per producer. */
+
+struct msg {
+  uint32_t producer;
+  uint32_t id;
+  char payload[24];
+};
+
+struct consumer {
+  struct sl_mpmc_queue* queue;
+  uint64_t sum;
+  bool is_blocking;
+};
+
+static void*
+produce(void* arg)
+{
+  struct sl_mpmc_queue* queue = arg;
+  static uint32_t producer_id = 0;
+  struct msg msg;
+  uint32_t i = 0;
+
+  msg.producer = __atomic_fetch_add(&producer_id, 1, __ATOMIC_RELAXED);
+  for(i = 0; i < NB_MSGS; ++i) {
+    msg.id = i;
+    msg.payload[0] = (char)i;
+    if(i % 2) {
+      CHECK(sl_mpmc_queue_push(queue, &msg), OK);
+    } else {
+      bool b = false;
+      do {
+        CHECK(sl_mpmc_queue_try_push(queue, &msg, &b), OK);
+        if(!b)
+          sched_yield();
+      } while(!b);
+    }
+  }
+  return NULL;
+}
+
+static void*
+consume(void* arg)
+{
+  struct consumer* consumer = arg;
+  uint32_t last_ids[NB_THREADS];
+  struct msg msg;
+  uint32_t i = 0;
+
+  for(i = 0; i < NB_THREADS; ++i)
+    last_ids[i] = UINT32_MAX;
+  for(i = 0; i < NB_MSGS; ++i) {
+    if(consumer->is_blocking) {
+      CHECK(sl_mpmc_queue_pop(consumer->queue, &msg), OK);
+    } else {
+      bool b = false;
+      do {
+        CHECK(sl_mpmc_queue_try_pop(consumer->queue, &msg, &b), OK);
+        if(!b)
+          sched_yield();
+      } while(!b);
+    }
+    CHECK(msg.producer < NB_THREADS, true);
+    CHECK(msg.payload[0], (char)msg.id);
+    /* The messages of a producer are received in order. */
+    if(last_ids[msg.producer] != UINT32_MAX)
+      CHECK(msg.id > last_ids[msg.producer], true);
+    last_ids[msg.producer] = msg.id;
+    consumer->sum += msg.id;
+  }
+  return NULL;
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_mpmc_queue* queue = NULL;
+  struct consumer consumers[NB_THREADS];
+  pthread_t producers[NB_THREADS];
+  pthread_t threads[NB_THREADS];
+  struct msg msg;
+  uint64_t sum = 0;
+  size_t len = 0;
+  int i = 0;
+  bool b = false;
+
+  CHECK(sl_create_mpmc_queue(0, 0, 0, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_mpmc_queue(sizeof(int), ALIGNOF(int), 4, NULL, NULL),
+    BAD_ARG);
+  CHECK(sl_create_mpmc_queue(0, ALIGNOF(int), 4, NULL, &queue), BAD_ARG);
+  CHECK(sl_create_mpmc_queue(sizeof(int), ALIGNOF(int), 0, NULL, &queue),
+    BAD_ARG);
+  CHECK(sl_create_mpmc_queue(sizeof(int), 3, 4, NULL, &queue),
+    SL_ALIGNMENT_ERROR);
+  CHECK(sl_create_mpmc_queue(sizeof(int), ALIGNOF(int), 1, NULL, &queue), OK);
+
+  CHECK(sl_mpmc_queue_capacity(NULL, &len), BAD_ARG);
+  CHECK(sl_mpmc_queue_capacity(queue, NULL), BAD_ARG);
+  CHECK(sl_mpmc_queue_capacity(queue, &len), OK);
+  CHECK(len, 2);
+
+  CHECK(sl_mpmc_queue_try_pop(NULL, &i, &b), BAD_ARG);
+  CHECK(sl_mpmc_queue_try_pop(queue, NULL, &b), BAD_ARG);
+  CHECK(sl_mpmc_queue_try_pop(queue, &i, NULL), BAD_ARG);
+  CHECK(sl_mpmc_queue_try_pop(queue, &i, &b), OK);
+  CHECK(b, false);
+  CHECK(sl_mpmc_queue_try_push(NULL, &i, &b), BAD_ARG);
+  CHECK(sl_mpmc_queue_try_push(queue, NULL, &b), BAD_ARG);
+  CHECK(sl_mpmc_queue_try_push(queue, &i, NULL), BAD_ARG);
+  CHECK(sl_mpmc_queue_try_push(queue, (int[]){1}, &b), OK);
+  CHECK(b, true);
+  CHECK(sl_mpmc_queue_push(NULL, (int[]){2}), BAD_ARG);
+  CHECK(sl_mpmc_queue_push(queue, NULL), BAD_ARG);
+  CHECK(sl_mpmc_queue_push(queue, (int[]){2}), OK);
+  CHECK(sl_mpmc_queue_try_push(queue, (int[]){3}, &b), OK);
+  CHECK(b, false);
+  CHECK(sl_mpmc_queue_pop(NULL, &i), BAD_ARG);
+  CHECK(sl_mpmc_queue_pop(queue, NULL), BAD_ARG);
+  CHECK(sl_mpmc_queue_pop(queue, &i), OK);
+  CHECK(i, 1);
+  CHECK(sl_mpmc_queue_try_push(queue, (int[]){3}, &b), OK);
+  CHECK(b, true);
+  CHECK(sl_mpmc_queue_try_pop(queue, &i, &b), OK);
+  CHECK(b, true);
+  CHECK(i, 2);
+  CHECK(sl_mpmc_queue_pop(queue, &i), OK);
+  CHECK(i, 3);
+  CHECK(sl_mpmc_queue_try_pop(queue, &i, &b), OK);
+  CHECK(b, false);
+  CHECK(sl_free_mpmc_queue(NULL), BAD_ARG);
+  CHECK(sl_free_mpmc_queue(queue), OK);
+
+  /* Exchange messages between several producers and consumers through a small
+   * queue, so that both producers and consumers have to wait. */
+  CHECK(sl_create_mpmc_queue
+    (sizeof(struct msg), ALIGNOF(struct msg), 16, NULL, &queue), OK);
+  for(i = 0; i < NB_THREADS; ++i) {
+    consumers[i].queue = queue;
+    consumers[i].sum = 0;
+    consumers[i].is_blocking = i % 2 == 0;
+    CHECK(pthread_create(threads + i, NULL, consume, consumers + i), 0);
+    CHECK(pthread_create(producers + i, NULL, produce, queue), 0);
+  }
+  for(i = 0; i < NB_THREADS; ++i) {
+    CHECK(pthread_join(producers[i], NULL), 0);
+    CHECK(pthread_join(threads[i], NULL), 0);
+    sum += consumers[i].sum;
+  }
+  CHECK(sum, (uint64_t)NB_THREADS * NB_MSGS * (NB_MSGS - 1) / 2);
+  CHECK(sl_mpmc_queue_try_pop(queue, &msg, &b), OK);
+  CHECK(b, false);
+  CHECK(sl_free_mpmc_queue(queue), OK);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
@@ -0,0 +1,218 @@
+#include "../sl_priority_queue.h"
+#include "../sl_vector.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+#define NB_TIMERS 1000
+
+struct timer {
+  uint64_t deadline;
+  size_t handle;
+};
+
+static int
+cmp_int(const void* a, const void* b)
+{
+  const int i = *(const int*)a;
+  const int j = *(const int*)b;
+  return (i > j) - (i < j);
+}
+
+static int
+cmp_timer(const void* a, const void* b)
+{
+  const uint64_t i = ((const struct timer*)a)->deadline;
+  const uint64_t j = ((const struct timer*)b)->deadline;
+  return (i > j) - (i < j);
+}
+
+static void
+track_timer(const void* data, size_t id, void* context)
+{
+  ((size_t*)context)[((const struct timer*)data)->handle] = id;
+}
+
+static void
+check_positions(struct sl_priority_queue* queue, const size_t* positions)
+{
+  struct timer* timer = NULL;
+  size_t len = 0;
+  size_t i = 0;
+
+  CHECK(sl_priority_queue_length(queue, &len), OK);
+  for(i = 0; i < len; ++i) {
+    CHECK(sl_priority_queue_at(queue, i, (void**)&timer), OK);
+    CHECK(positions[timer->handle], i);
+  }
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_priority_queue* queue = NULL;
+  struct sl_vector* vec = NULL;
+  struct timer* timer = NULL;
+  size_t positions[NB_TIMERS];
+  bool is_erased[NB_TIMERS];
+  void* data = NULL;
+  size_t len = 0;
+  size_t arity = 0;
+  size_t i = 0;
+  int prev = 0;
+  int k = 0;
+
+  CHECK(sl_create_priority_queue(0, 0, 0, NULL, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_priority_queue
+    (sizeof(int), ALIGNOF(int), 4, cmp_int, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_priority_queue
+    (sizeof(int), ALIGNOF(int), 1, cmp_int, NULL, &queue), BAD_ARG);
+  CHECK(sl_create_priority_queue
+    (sizeof(int), ALIGNOF(int), 4, NULL, NULL, &queue), BAD_ARG);
+  CHECK(sl_create_priority_queue
+    (sizeof(int), ALIGNOF(int), 4, cmp_int, NULL, &queue), OK);
+
+  CHECK(sl_priority_queue_length(NULL, &len), BAD_ARG);
+  CHECK(sl_priority_queue_length(queue, NULL), BAD_ARG);
+  CHECK(sl_priority_queue_length(queue, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_priority_queue_top(NULL, &data), BAD_ARG);
+  CHECK(sl_priority_queue_top(queue, NULL), BAD_ARG);
+  CHECK(sl_priority_queue_top(queue, &data), BAD_ARG);
+  CHECK(sl_priority_queue_pop(NULL), BAD_ARG);
+  CHECK(sl_priority_queue_pop(queue), OK);
+  CHECK(sl_priority_queue_push(NULL, (int[]){3}), BAD_ARG);
+  CHECK(sl_priority_queue_push(queue, NULL), BAD_ARG);
+  CHECK(sl_priority_queue_push(queue, (int[]){3}), OK);
+  CHECK(sl_priority_queue_push(queue, (int[]){1}), OK);
+  CHECK(sl_priority_queue_push(queue, (int[]){2}), OK);
+  CHECK(sl_priority_queue_top(queue, &data), OK);
+  CHECK(*(int*)data, 1);
+  /* Push an element of the queue itself. */
+  CHECK(sl_priority_queue_push(queue, data), OK);
+  CHECK(sl_priority_queue_length(queue, &len), OK);
+  CHECK(len, 4);
+  CHECK(sl_priority_queue_pop(queue), OK);
+  CHECK(sl_priority_queue_top(queue, &data), OK);
+  CHECK(*(int*)data, 1);
+  CHECK(sl_priority_queue_pop(queue), OK);
+  CHECK(sl_priority_queue_top(queue, &data), OK);
+  CHECK(*(int*)data, 2);
+  CHECK(sl_priority_queue_reserve(NULL, 16), BAD_ARG);
+  CHECK(sl_priority_queue_reserve(queue, 16), OK);
+  CHECK(sl_clear_priority_queue(NULL), BAD_ARG);
+  CHECK(sl_clear_priority_queue(queue), OK);
+  CHECK(sl_priority_queue_length(queue, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_free_priority_queue(NULL), BAD_ARG);
+  CHECK(sl_free_priority_queue(queue), OK);
+
+  /* Heap sort with several arities. */
+  for(arity = 2; arity < 10; ++arity) {
+    CHECK(sl_create_priority_queue
+      (sizeof(int), ALIGNOF(int), arity, cmp_int, NULL, &queue), OK);
+    for(i = 0; i < 2000; ++i) {
+      k = rand() % 500;
+      CHECK(sl_priority_queue_push(queue, &k), OK);
+    }
+    prev = -1;
+    for(i = 0; i < 2000; ++i) {
+      CHECK(sl_priority_queue_top(queue, &data), OK);
+      CHECK(*(int*)data >= prev, true);
+      prev = *(int*)data;
+      CHECK(sl_priority_queue_pop(queue), OK);
+    }
+    CHECK(sl_priority_queue_length(queue, &len), OK);
+    CHECK(len, 0);
+    CHECK(sl_free_priority_queue(queue), OK);
+  }
+
+  /* Heapify the elements of a vector. */
+  CHECK(sl_create_vector(sizeof(int), ALIGNOF(int), NULL, &vec), OK);
+  for(i = 0; i < 1000; ++i) {
+    k = rand();
+    CHECK(sl_vector_push_back(vec, &k), OK);
+  }
+  CHECK(sl_create_priority_queue_from_vector
+    (NULL, 4, cmp_int, NULL, &queue), BAD_ARG);
+  CHECK(sl_create_priority_queue_from_vector
+    (vec, 1, cmp_int, NULL, &queue), BAD_ARG);
+  CHECK(sl_create_priority_queue_from_vector
+    (vec, 4, NULL, NULL, &queue), BAD_ARG);
+  CHECK(sl_create_priority_queue_from_vector
+    (vec, 4, cmp_int, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_priority_queue_from_vector
+    (vec, 4, cmp_int, NULL, &queue), OK);
+  CHECK(sl_priority_queue_length(queue, &len), OK);
+  CHECK(len, 1000);
+  prev = -1;
+  for(i = 0; i < 1000; ++i) {
+    CHECK(sl_priority_queue_top(queue, &data), OK);
+    CHECK(*(int*)data >= prev, true);
+    prev = *(int*)data;
+    CHECK(sl_priority_queue_pop(queue), OK);
+  }
+  CHECK(sl_free_priority_queue(queue), OK);
+
+  /* Track the position of timers to update and cancel them. */
+  CHECK(sl_create_priority_queue(sizeof(struct timer), ALIGNOF(struct timer),
+    4, cmp_timer, NULL, &queue), OK);
+  CHECK(sl_priority_queue_set_position_callback(NULL, track_timer, positions),
+    BAD_ARG);
+  CHECK(sl_priority_queue_set_position_callback(queue, track_timer, positions),
+    OK);
+  for(i = 0; i < NB_TIMERS; ++i) {
+    struct timer t;
+    t.deadline = (uint64_t)(rand() % 100000);
+    t.handle = i;
+    is_erased[i] = false;
+    CHECK(sl_priority_queue_push(queue, &t), OK);
+  }
+  check_positions(queue, positions);
+
+  CHECK(sl_priority_queue_update(NULL, 0), BAD_ARG);
+  CHECK(sl_priority_queue_update(queue, NB_TIMERS), BAD_ARG);
+  CHECK(sl_priority_queue_erase(NULL, 0), BAD_ARG);
+  CHECK(sl_priority_queue_erase(queue, NB_TIMERS), BAD_ARG);
+  CHECK(sl_priority_queue_at(NULL, 0, &data), BAD_ARG);
+  CHECK(sl_priority_queue_at(queue, NB_TIMERS, &data), BAD_ARG);
+  for(i = 0; i < NB_TIMERS; i += 3) {
+    CHECK(sl_priority_queue_at(queue, positions[i], (void**)&timer), OK);
+    CHECK(timer->handle, i);
+    if(i % 2) { /* Decrease key. */
+      timer->deadline /= 2;
+    } else { /* Increase key. */
+      timer->deadline += 50000;
+    }
+    CHECK(sl_priority_queue_update(queue, positions[i]), OK);
+    check_positions(queue, positions);
+  }
+  for(i = 1; i < NB_TIMERS; i += 7) {
+    CHECK(sl_priority_queue_erase(queue, positions[i]), OK);
+    is_erased[i] = true;
+  }
+  check_positions(queue, positions);
+
+  CHECK(sl_priority_queue_length(queue, &len), OK);
+  prev = 0;
+  while(len--) {
+    CHECK(sl_priority_queue_top(queue, (void**)&timer), OK);
+    CHECK(timer->deadline >= (uint64_t)prev, true);
+    CHECK(is_erased[timer->handle], false);
+    CHECK(positions[timer->handle], 0);
+    prev = (int)timer->deadline;
+    CHECK(sl_priority_queue_pop(queue), OK);
+    check_positions(queue, positions);
+  }
+  CHECK(sl_priority_queue_set_position_callback(queue, NULL, NULL), OK);
+  CHECK(sl_free_priority_queue(queue), OK);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
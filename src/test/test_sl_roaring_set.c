@@ -0,0 +1,294 @@
+#include "../sl_roaring_set.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+#define NB_VALUES (1 << 18) /* Size of the reference domain: 4 containers. */
+
+/* Check the set against an array of booleans over [0, NB_VALUES[. */
+static void
+check_set(struct sl_roaring_set* set, const bool* ref)
+{
+  uint32_t* values = NULL;
+  size_t card = 0;
+  size_t count = 0;
+  size_t i = 0;
+  bool b = false;
+
+  for(i = 0; i < NB_VALUES; ++i) {
+    CHECK(sl_roaring_set_contains(set, (uint32_t)i, &b), OK);
+    CHECK(b, ref[i]);
+    count += ref[i];
+  }
+  CHECK(sl_roaring_set_cardinality(set, &card), OK);
+  CHECK(card, count);
+
+  values = malloc((count + 1) * sizeof(uint32_t));
+  NCHECK(values, NULL);
+  CHECK(sl_roaring_set_to_array(set, values), OK);
+  for(i = 0; i < count; ++i) {
+    CHECK(values[i] < NB_VALUES, true);
+    CHECK(ref[values[i]], true);
+    if(i)
+      CHECK(values[i] > values[i - 1], true);
+  }
+  free(values);
+}
+
+/* Fill the set with values of [0, NB_VALUES[. The first container is sparse,
+ * the second is dense, the third is made of long runs and the last one is
+ * empty. */
+static void
+fill_set(struct sl_roaring_set* set, bool* ref, int seed)
+{
+  size_t i = 0;
+  bool b = false;
+
+  srand((unsigned)seed);
+  CHECK(sl_clear_roaring_set(set), OK);
+  memset(ref, 0, NB_VALUES * sizeof(bool));
+  for(i = 0; i < 65536; ++i)
+    ref[i] = rand() % 100 < 3;
+  for(i = 65536; i < 2 * 65536; ++i)
+    ref[i] = rand() % 100 < 60;
+  for(i = 2 * 65536; i < 3 * 65536; ++i)
+    ref[i] = (i / 1000) % 2 == (size_t)seed % 2;
+  for(i = 0; i < NB_VALUES; ++i) {
+    if(ref[i]) {
+      CHECK(sl_roaring_set_insert(set, (uint32_t)i, &b), OK);
+      CHECK(b, true);
+    }
+  }
+}
+
+static void
+check_serialization(struct sl_roaring_set* set, const bool* ref)
+{
+  struct sl_roaring_set* copy = NULL;
+  unsigned char* buffer = NULL;
+  size_t size = 0;
+  size_t card = 0;
+
+  CHECK(sl_create_roaring_set(NULL, &copy), OK);
+  CHECK(sl_roaring_set_serialized_size(set, &size), OK);
+  buffer = malloc(size);
+  NCHECK(buffer, NULL);
+  CHECK(sl_roaring_set_serialize(set, size - 1, buffer), BAD_ARG);
+  CHECK(sl_roaring_set_serialize(set, size, buffer), OK);
+  CHECK(sl_roaring_set_deserialize(copy, size, buffer), OK);
+  check_set(copy, ref);
+
+  /* Truncated or corrupted buffers are rejected. */
+  CHECK(sl_roaring_set_deserialize(copy, size - 1, buffer), BAD_ARG);
+  CHECK(sl_roaring_set_cardinality(copy, &card), OK);
+  CHECK(card, 0);
+  buffer[0] ^= 1;
+  CHECK(sl_roaring_set_deserialize(copy, size, buffer), BAD_ARG);
+  buffer[0] ^= 1;
+  if(size > 8) {
+    buffer[12] ^= 1; /* Cardinality of the first container. */
+    CHECK(sl_roaring_set_deserialize(copy, size, buffer), BAD_ARG);
+    buffer[12] ^= 1;
+  }
+  CHECK(sl_roaring_set_deserialize(copy, size, buffer), OK);
+  check_set(copy, ref);
+
+  free(buffer);
+  CHECK(sl_free_roaring_set(copy), OK);
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_roaring_set* a = NULL;
+  struct sl_roaring_set* b = NULL;
+  bool* ref_a = NULL;
+  bool* ref_b = NULL;
+  unsigned char buffer[64];
+  uint32_t values[4];
+  size_t size = 0;
+  size_t n = 0;
+  size_t i = 0;
+  bool is = false;
+
+  ref_a = malloc(NB_VALUES * sizeof(bool));
+  ref_b = malloc(NB_VALUES * sizeof(bool));
+  NCHECK(ref_a, NULL);
+  NCHECK(ref_b, NULL);
+
+  CHECK(sl_create_roaring_set(NULL, NULL), BAD_ARG);
+  CHECK(sl_create_roaring_set(NULL, &a), OK);
+  CHECK(sl_create_roaring_set(NULL, &b), OK);
+
+  CHECK(sl_roaring_set_insert(NULL, 0, NULL), BAD_ARG);
+  CHECK(sl_roaring_set_erase(NULL, 0, NULL), BAD_ARG);
+  CHECK(sl_roaring_set_contains(NULL, 0, &is), BAD_ARG);
+  CHECK(sl_roaring_set_contains(a, 0, NULL), BAD_ARG);
+  CHECK(sl_roaring_set_cardinality(NULL, &n), BAD_ARG);
+  CHECK(sl_roaring_set_cardinality(a, NULL), BAD_ARG);
+  CHECK(sl_roaring_set_to_array(NULL, values), BAD_ARG);
+  CHECK(sl_roaring_set_to_array(a, NULL), BAD_ARG);
+  CHECK(sl_roaring_set_or(NULL, b), BAD_ARG);
+  CHECK(sl_roaring_set_or(a, NULL), BAD_ARG);
+  CHECK(sl_roaring_set_and(NULL, b), BAD_ARG);
+  CHECK(sl_roaring_set_and(a, NULL), BAD_ARG);
+  CHECK(sl_roaring_set_optimize(NULL), BAD_ARG);
+  CHECK(sl_roaring_set_serialized_size(NULL, &size), BAD_ARG);
+  CHECK(sl_roaring_set_serialized_size(a, NULL), BAD_ARG);
+  CHECK(sl_roaring_set_serialize(NULL, 64, buffer), BAD_ARG);
+  CHECK(sl_roaring_set_serialize(a, 64, NULL), BAD_ARG);
+  CHECK(sl_roaring_set_deserialize(NULL, 64, buffer), BAD_ARG);
+  CHECK(sl_roaring_set_deserialize(a, 64, NULL), BAD_ARG);
+  CHECK(sl_clear_roaring_set(NULL), BAD_ARG);
+  CHECK(sl_free_roaring_set(NULL), BAD_ARG);
+
+  CHECK(sl_roaring_set_insert(a, 0xFFFFFFFF, &is), OK);
+  CHECK(is, true);
+  CHECK(sl_roaring_set_insert(a, 0xFFFFFFFF, &is), OK);
+  CHECK(is, false);
+  CHECK(sl_roaring_set_insert(a, 7, NULL), OK);
+  CHECK(sl_roaring_set_insert(a, 0x10000, NULL), OK);
+  CHECK(sl_roaring_set_contains(a, 0x10000, &is), OK);
+  CHECK(is, true);
+  CHECK(sl_roaring_set_contains(a, 0x10001, &is), OK);
+  CHECK(is, false);
+  CHECK(sl_roaring_set_cardinality(a, &n), OK);
+  CHECK(n, 3);
+  CHECK(sl_roaring_set_to_array(a, values), OK);
+  CHECK(values[0], 7);
+  CHECK(values[1], 0x10000);
+  CHECK(values[2], 0xFFFFFFFF);
+  CHECK(sl_roaring_set_erase(a, 8, &is), OK);
+  CHECK(is, false);
+  CHECK(sl_roaring_set_erase(a, 0x10000, &is), OK);
+  CHECK(is, true);
+  CHECK(sl_roaring_set_erase(a, 0x10000, NULL), OK);
+  CHECK(sl_roaring_set_cardinality(a, &n), OK);
+  CHECK(n, 2);
+
+  /* Serialization of an empty set. */
+  CHECK(sl_roaring_set_serialized_size(b, &size), OK);
+  CHECK(size, 8);
+  CHECK(sl_roaring_set_serialize(b, size, buffer), OK);
+  CHECK(sl_roaring_set_deserialize(a, size, buffer), OK);
+  CHECK(sl_roaring_set_cardinality(a, &n), OK);
+  CHECK(n, 0);
+
+  /* Random operations in all kinds of containers. */
+  fill_set(a, ref_a, 0);
+  check_set(a, ref_a);
+  for(i = 0; i < 20000; ++i) {
+    const uint32_t v = (uint32_t)(rand() % NB_VALUES);
+    if(rand() % 2) {
+      CHECK(sl_roaring_set_insert(a, v, &is), OK);
+      CHECK(is, !ref_a[v]);
+      ref_a[v] = true;
+    } else {
+      CHECK(sl_roaring_set_erase(a, v, &is), OK);
+      CHECK(is, ref_a[v]);
+      ref_a[v] = false;
+    }
+  }
+  check_set(a, ref_a);
+  check_serialization(a, ref_a);
+
+  /* Empty the dense container to convert it back to an array and then remove
+   * it. */
+  for(i = 65536; i < 2 * 65536; ++i) {
+    CHECK(sl_roaring_set_erase(a, (uint32_t)i, &is), OK);
+    CHECK(is, ref_a[i]);
+    ref_a[i] = false;
+  }
+  check_set(a, ref_a);
+
+  /* Set algebra on plain and optimized containers. */
+  for(i = 0; i < 8; ++i) {
+    const bool optimize_a = (i & 1) != 0;
+    const bool optimize_b = (i & 2) != 0;
+    const bool is_and = (i & 4) != 0;
+    size_t j = 0;
+
+    fill_set(a, ref_a, (int)i);
+    fill_set(b, ref_b, (int)i + 1);
+    if(optimize_a) {
+      CHECK(sl_roaring_set_optimize(a), OK);
+      check_set(a, ref_a);
+      check_serialization(a, ref_a);
+    }
+    if(optimize_b) {
+      CHECK(sl_roaring_set_optimize(b), OK);
+      check_set(b, ref_b);
+    }
+    if(is_and) {
+      CHECK(sl_roaring_set_and(a, b), OK);
+      for(j = 0; j < NB_VALUES; ++j) ref_a[j] = ref_a[j] && ref_b[j];
+    } else {
+      CHECK(sl_roaring_set_or(a, b), OK);
+      for(j = 0; j < NB_VALUES; ++j) ref_a[j] = ref_a[j] || ref_b[j];
+    }
+    check_set(a, ref_a);
+    check_set(b, ref_b);
+    CHECK(sl_roaring_set_or(a, a), OK);
+    CHECK(sl_roaring_set_and(a, a), OK);
+    check_set(a, ref_a);
+
+    /* Modify the optimized containers. */
+    for(j = 0; j < 1000; ++j) {
+      const uint32_t v = (uint32_t)(rand() % NB_VALUES);
+      CHECK(sl_roaring_set_insert(b, v, NULL), OK);
+      ref_b[v] = true;
+      CHECK(sl_roaring_set_erase(b, (v * 7) % NB_VALUES, NULL), OK);
+      ref_b[(v * 7) % NB_VALUES] = false;
+    }
+    check_set(b, ref_b);
+    check_serialization(b, ref_b);
+  }
+
+  /* Intersection of a small array with a large one. */
+  CHECK(sl_clear_roaring_set(a), OK);
+  CHECK(sl_clear_roaring_set(b), OK);
+  memset(ref_a, 0, NB_VALUES * sizeof(bool));
+  for(i = 0; i < 4000; ++i)
+    CHECK(sl_roaring_set_insert(b, (uint32_t)i * 3, NULL), OK);
+  for(i = 0; i < 50; ++i) {
+    CHECK(sl_roaring_set_insert(a, (uint32_t)i * 5, NULL), OK);
+    ref_a[i * 5] = i * 5 % 3 == 0;
+  }
+  CHECK(sl_roaring_set_and(a, b), OK);
+  check_set(a, ref_a);
+
+  /* One million of consecutive ids are stored in a few runs. */
+  CHECK(sl_clear_roaring_set(a), OK);
+  for(i = 0; i < 1000000; ++i)
+    CHECK(sl_roaring_set_insert(a, (uint32_t)i + 100, NULL), OK);
+  CHECK(sl_roaring_set_serialized_size(a, &size), OK);
+  CHECK(size > 1000000 / 8, true);
+  CHECK(sl_roaring_set_optimize(a), OK);
+  CHECK(sl_roaring_set_serialized_size(a, &size), OK);
+  CHECK(size < 512, true);
+  CHECK(sl_roaring_set_cardinality(a, &n), OK);
+  CHECK(n, 1000000);
+  CHECK(sl_roaring_set_contains(a, 99, &is), OK);
+  CHECK(is, false);
+  CHECK(sl_roaring_set_contains(a, 100, &is), OK);
+  CHECK(is, true);
+  CHECK(sl_roaring_set_contains(a, 1000099, &is), OK);
+  CHECK(is, true);
+  CHECK(sl_roaring_set_contains(a, 1000100, &is), OK);
+  CHECK(is, false);
+
+  CHECK(sl_free_roaring_set(a), OK);
+  CHECK(sl_free_roaring_set(b), OK);
+  free(ref_a);
+  free(ref_b);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
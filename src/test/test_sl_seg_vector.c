@@ -0,0 +1,136 @@
+#include "../sl_seg_vector.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_seg_vector* vec = NULL;
+  void* data = NULL;
+  void* first = NULL;
+  size_t len = 0;
+  size_t i = 0;
+  size_t j = 0;
+  size_t n = 0;
+  int k = 0;
+
+  CHECK(sl_create_seg_vector(0, 0, 0, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_seg_vector(sizeof(int), ALIGNOF(int), 4, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_seg_vector(0, ALIGNOF(int), 4, NULL, &vec), BAD_ARG);
+  CHECK(sl_create_seg_vector(sizeof(int), ALIGNOF(int), 0, NULL, &vec), BAD_ARG);
+  CHECK(sl_create_seg_vector(sizeof(int), ALIGNOF(int), 3, NULL, &vec), BAD_ARG);
+  CHECK(sl_create_seg_vector(sizeof(int), 3, 4, NULL, &vec), SL_ALIGNMENT_ERROR);
+  CHECK(sl_create_seg_vector(sizeof(int), ALIGNOF(int), 4, NULL, &vec), OK);
+
+  CHECK(sl_seg_vector_length(NULL, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_length(vec, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_length(NULL, &len), BAD_ARG);
+  CHECK(sl_seg_vector_length(vec, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_seg_vector_capacity(NULL, &len), BAD_ARG);
+  CHECK(sl_seg_vector_capacity(vec, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_capacity(vec, &len), OK);
+  CHECK(len, 0);
+
+  CHECK(sl_seg_vector_push_back(NULL, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_push_back(vec, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_push_back(NULL, (int[]){0}), BAD_ARG);
+  CHECK(sl_seg_vector_push_back(vec, (int[]){0}), OK);
+  CHECK(sl_seg_vector_at(vec, 0, &first), OK);
+  CHECK(*(int*)first, 0);
+
+  for(k = 1; k < 37; ++k)
+    CHECK(sl_seg_vector_push_back(vec, &k), OK);
+  CHECK(sl_seg_vector_length(vec, &len), OK);
+  CHECK(len, 37);
+  CHECK(sl_seg_vector_capacity(vec, &len), OK);
+  CHECK(len, 40);
+
+  /* The address of the elements does not change on growth. */
+  CHECK(sl_seg_vector_at(vec, 0, &data), OK);
+  CHECK(data, first);
+
+  CHECK(sl_seg_vector_at(NULL, 0, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_at(vec, 0, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_at(NULL, 0, &data), BAD_ARG);
+  CHECK(sl_seg_vector_at(vec, 37, &data), BAD_ARG);
+  for(i = 0; i < 37; ++i) {
+    CHECK(sl_seg_vector_at(vec, i, &data), OK);
+    CHECK(*(int*)data, (int)i);
+  }
+
+  CHECK(sl_seg_vector_chunk_count(NULL, &n), BAD_ARG);
+  CHECK(sl_seg_vector_chunk_count(vec, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_chunk_count(vec, &n), OK);
+  CHECK(n, 10);
+  CHECK(sl_seg_vector_chunk(NULL, 0, &len, &data), BAD_ARG);
+  CHECK(sl_seg_vector_chunk(vec, 0, &len, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_chunk(vec, 10, &len, &data), BAD_ARG);
+  CHECK(sl_seg_vector_chunk(vec, 0, NULL, &data), OK);
+  CHECK(data, first);
+  k = 0;
+  for(i = 0; i < n; ++i) {
+    CHECK(sl_seg_vector_chunk(vec, i, &len, &data), OK);
+    CHECK(len, i == n - 1 ? 1 : 4);
+    for(j = 0; j < len; ++j)
+      CHECK(((int*)data)[j], k++);
+  }
+  CHECK(k, 37);
+
+  CHECK(sl_seg_vector_at(vec, 36, &data), OK);
+  CHECK(sl_seg_vector_push_back(vec, data), OK);
+  CHECK(sl_seg_vector_at(vec, 37, &data), OK);
+  CHECK(*(int*)data, 36);
+
+  CHECK(sl_seg_vector_pop_back(NULL), BAD_ARG);
+  CHECK(sl_seg_vector_pop_back(vec), OK);
+  CHECK(sl_seg_vector_pop_back(vec), OK);
+  CHECK(sl_seg_vector_length(vec, &len), OK);
+  CHECK(len, 36);
+
+  CHECK(sl_seg_vector_emplace_back(NULL, &data), BAD_ARG);
+  CHECK(sl_seg_vector_emplace_back(vec, NULL), BAD_ARG);
+  CHECK(sl_seg_vector_emplace_back(vec, &data), OK);
+  *(int*)data = -1;
+  CHECK(sl_seg_vector_at(vec, 36, &data), OK);
+  CHECK(*(int*)data, -1);
+
+  CHECK(sl_clear_seg_vector(NULL), BAD_ARG);
+  CHECK(sl_clear_seg_vector(vec), OK);
+  CHECK(sl_seg_vector_length(vec, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_seg_vector_chunk_count(vec, &n), OK);
+  CHECK(n, 0);
+  CHECK(sl_seg_vector_capacity(vec, &len), OK);
+  CHECK(len, 40);
+  CHECK(sl_seg_vector_push_back(vec, (int[]){5}), OK);
+  CHECK(sl_seg_vector_at(vec, 0, &data), OK);
+  CHECK(data, first);
+  CHECK(*(int*)data, 5);
+
+  CHECK(sl_seg_vector_reserve(NULL, 0), BAD_ARG);
+  CHECK(sl_seg_vector_reserve(vec, 2), OK);
+  CHECK(sl_seg_vector_capacity(vec, &len), OK);
+  CHECK(len, 40);
+  CHECK(sl_seg_vector_reserve(vec, 41), OK);
+  CHECK(sl_seg_vector_capacity(vec, &len), OK);
+  CHECK(len, 44);
+  /* The chunk directory cannot be sized. */
+  CHECK(sl_seg_vector_reserve(vec, SIZE_MAX), SL_OVERFLOW_ERROR);
+  CHECK(sl_seg_vector_capacity(vec, &len), OK);
+  CHECK(len, 44);
+
+  CHECK(sl_free_seg_vector(NULL), BAD_ARG);
+  CHECK(sl_free_seg_vector(vec), OK);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
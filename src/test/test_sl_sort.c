@@ -0,0 +1,279 @@
+#include "../sl_sort.h"
+#include "../sl_thread_pool.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define BAD_AL SL_ALIGNMENT_ERROR
+#define OK SL_NO_ERROR
+#define NB_ELMTS 5000
+#define NB_PARALLEL_ELMTS 100000
+#define NB_POOLS 5
+
+struct record {
+  int64_t i64;
+  int32_t i32;
+  float f;
+  uint32_t id;
+  uint8_t u8;
+};
+
+static int
+cmp_int(const void* p0, const void* p1)
+{
+  const int a = *(const int*)p0;
+  const int b = *(const int*)p1;
+  return -(a < b) | (a > b);
+}
+
+static int
+cmp_record_i32(const void* p0, const void* p1)
+{
+  const struct record* a = p0;
+  const struct record* b = p1;
+  return -(a->i32 < b->i32) | (a->i32 > b->i32);
+}
+
+static void
+check_sorted(const int* array, size_t count)
+{
+  size_t i = 0;
+  for(i = 1; i < count; ++i)
+    CHECK(array[i - 1] <= array[i], true);
+}
+
+static void
+check_records
+  (const struct record* records,
+   size_t count,
+   int (*cmp)(const void*, const void*),
+   bool is_stable)
+{
+  size_t i = 0;
+  for(i = 1; i < count; ++i) {
+    const int c = cmp(records + i - 1, records + i);
+    CHECK(c <= 0, true);
+    if(is_stable && c == 0)
+      CHECK(records[i - 1].id < records[i].id, true);
+  }
+}
+
+static int
+cmp_record_i64(const void* p0, const void* p1)
+{
+  const struct record* a = p0;
+  const struct record* b = p1;
+  return -(a->i64 < b->i64) | (a->i64 > b->i64);
+}
+
+static int
+cmp_record_f(const void* p0, const void* p1)
+{
+  const struct record* a = p0;
+  const struct record* b = p1;
+  return -(a->f < b->f) | (a->f > b->f);
+}
+
+static int
+cmp_record_u8(const void* p0, const void* p1)
+{
+  const struct record* a = p0;
+  const struct record* b = p1;
+  return -(a->u8 < b->u8) | (a->u8 > b->u8);
+}
+
+static void
+fill_records(struct record* records, size_t count)
+{
+  size_t i = 0;
+  for(i = 0; i < count; ++i) {
+    records[i].i64 = ((int64_t)rand() - RAND_MAX / 2) * (int64_t)rand();
+    records[i].i32 = rand() % 64 - 32;
+    records[i].f = (float)(rand() - RAND_MAX / 2) / 1000.f;
+    records[i].id = (uint32_t)i;
+    records[i].u8 = (uint8_t)(rand() % 256);
+  }
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  int* array = NULL;
+  int* merged = NULL;
+  struct sl_thread_pool* pools[NB_POOLS];
+  size_t ithread = 0;
+  struct record* records = NULL;
+  size_t i = 0;
+  int pattern = 0;
+
+  array = malloc(NB_ELMTS * sizeof(int));
+  records = malloc(NB_ELMTS * sizeof(struct record));
+  NCHECK(array, NULL);
+  NCHECK(records, NULL);
+
+  CHECK(sl_sort(NULL, 1, sizeof(int), ALIGNOF(int), cmp_int, NULL), BAD_ARG);
+  CHECK(sl_sort(array, 1, 0, ALIGNOF(int), cmp_int, NULL), BAD_ARG);
+  CHECK(sl_sort(array, 1, sizeof(int), ALIGNOF(int), NULL, NULL), BAD_ARG);
+  CHECK(sl_sort(array, 1, sizeof(int), 3, cmp_int, NULL), BAD_AL);
+  CHECK(sl_sort(NULL, 0, sizeof(int), ALIGNOF(int), cmp_int, NULL), OK);
+  CHECK(sl_stable_sort
+    (NULL, 1, sizeof(int), ALIGNOF(int), cmp_int, NULL), BAD_ARG);
+  CHECK(sl_stable_sort
+    (array, 1, sizeof(int), ALIGNOF(int), NULL, NULL), BAD_ARG);
+  CHECK(sl_stable_sort
+    (NULL, 0, sizeof(int), ALIGNOF(int), cmp_int, NULL), OK);
+
+  /* Sort inputs with different patterns. */
+  for(pattern = 0; pattern < 6; ++pattern) {
+    const size_t counts[] = { 2, 23, 24, 100, 129, NB_ELMTS };
+    size_t icount = 0;
+    for(icount = 0; icount < sizeof(counts)/sizeof(size_t); ++icount) {
+      const size_t count = counts[icount];
+      int stable = 0;
+      for(stable = 0; stable < 2; ++stable) {
+        for(i = 0; i < count; ++i) {
+          switch(pattern) {
+            case 0: array[i] = rand(); break; /* Random. */
+            case 1: array[i] = (int)i; break; /* Sorted. */
+            case 2: array[i] = (int)(count - i); break; /* Reversed. */
+            case 3: array[i] = 7; break; /* All equal. */
+            case 4: array[i] = rand() % 4; break; /* Few distinct values. */
+            case 5: array[i] = (int)(i % 2 ? i : count - i); break; /* Organ. */
+          }
+        }
+        if(stable) {
+          CHECK(sl_stable_sort
+            (array, count, sizeof(int), ALIGNOF(int), cmp_int, NULL), OK);
+        } else {
+          CHECK(sl_sort
+            (array, count, sizeof(int), ALIGNOF(int), cmp_int, NULL), OK);
+        }
+        check_sorted(array, count);
+      }
+    }
+  }
+
+  fill_records(records, NB_ELMTS);
+  CHECK(sl_stable_sort
+    (records, NB_ELMTS, sizeof(struct record), ALIGNOF(struct record),
+     cmp_record_i32, &mem_default_allocator), OK);
+  check_records(records, NB_ELMTS, cmp_record_i32, true);
+  CHECK(sl_sort
+    (records, NB_ELMTS, sizeof(struct record), ALIGNOF(struct record),
+     cmp_record_i64, &mem_default_allocator), OK);
+  check_records(records, NB_ELMTS, cmp_record_i64, false);
+
+  #define RADIX_SORT(Count, Member, Type) \
+    sl_radix_sort \
+      (records, (Count), sizeof(struct record), \
+       offsetof(struct record, Member), \
+       sizeof(((struct record*)NULL)->Member), (Type), NULL)
+  CHECK(sl_radix_sort
+    (NULL, 1, sizeof(struct record), 0, 8, SL_SORT_KEY_INT, NULL), BAD_ARG);
+  CHECK(sl_radix_sort
+    (records, 1, 0, 0, 8, SL_SORT_KEY_INT, NULL), BAD_ARG);
+  CHECK(sl_radix_sort
+    (records, 1, sizeof(struct record), 0, 3, SL_SORT_KEY_INT, NULL), BAD_ARG);
+  CHECK(sl_radix_sort
+    (records, 1, sizeof(struct record), 0, 2, SL_SORT_KEY_FLOAT, NULL),
+     BAD_ARG);
+  CHECK(sl_radix_sort
+    (records, 1, sizeof(struct record), sizeof(struct record) - 2, 4,
+     SL_SORT_KEY_UINT, NULL), BAD_ARG);
+  CHECK(RADIX_SORT(0, i64, SL_SORT_KEY_INT), OK);
+
+  fill_records(records, NB_ELMTS);
+  CHECK(RADIX_SORT(NB_ELMTS, i32, SL_SORT_KEY_INT), OK);
+  check_records(records, NB_ELMTS, cmp_record_i32, true);
+  CHECK(RADIX_SORT(NB_ELMTS, i64, SL_SORT_KEY_INT), OK);
+  check_records(records, NB_ELMTS, cmp_record_i64, false);
+  CHECK(RADIX_SORT(NB_ELMTS, f, SL_SORT_KEY_FLOAT), OK);
+  check_records(records, NB_ELMTS, cmp_record_f, false);
+  for(i = 0; i < NB_ELMTS; ++i)
+    records[i].id = (uint32_t)i;
+  CHECK(RADIX_SORT(NB_ELMTS, u8, SL_SORT_KEY_UINT), OK);
+  check_records(records, NB_ELMTS, cmp_record_u8, true);
+  CHECK(RADIX_SORT(NB_ELMTS, id, SL_SORT_KEY_UINT), OK);
+  for(i = 0; i < NB_ELMTS; ++i)
+    CHECK(records[i].id, (uint32_t)i);
+  #undef RADIX_SORT
+
+  /* Parallel sort and merge. */
+  array = realloc(array, 2 * NB_PARALLEL_ELMTS * sizeof(int));
+  NCHECK(array, NULL);
+  CHECK(sl_parallel_sort
+    (NULL, 1, sizeof(int), ALIGNOF(int), cmp_int, NULL, NULL), BAD_ARG);
+  CHECK(sl_parallel_sort
+    (array, 1, sizeof(int), ALIGNOF(int), NULL, 0, NULL), BAD_ARG);
+  CHECK(sl_parallel_sort
+    (array, 1, sizeof(int), 3, cmp_int, NULL, NULL), BAD_AL);
+  CHECK(sl_parallel_sort
+    (NULL, 0, sizeof(int), ALIGNOF(int), cmp_int, NULL, NULL), OK);
+  for(ithread = 0; ithread < NB_POOLS; ++ithread) {
+    const size_t nb_threads[NB_POOLS] = { 1, 2, 3, 7, 16 };
+    CHECK(sl_create_thread_pool
+      (nb_threads[ithread], NULL, pools + ithread), OK);
+  }
+  for(pattern = 0; pattern < 3; ++pattern) {
+    for(ithread = 0; ithread <= NB_POOLS; ++ithread) {
+      struct sl_thread_pool* pool = ithread ? pools[ithread - 1] : NULL;
+      for(i = 0; i < NB_PARALLEL_ELMTS; ++i) {
+        switch(pattern) {
+          case 0: array[i] = rand(); break;
+          case 1: array[i] = (int)(NB_PARALLEL_ELMTS - i); break;
+          case 2: array[i] = rand() % 4; break;
+        }
+      }
+      CHECK(sl_parallel_sort
+        (array, NB_PARALLEL_ELMTS, sizeof(int), ALIGNOF(int), cmp_int,
+         pool, &mem_default_allocator), OK);
+      check_sorted(array, NB_PARALLEL_ELMTS);
+    }
+  }
+
+  for(i = 0; i < NB_PARALLEL_ELMTS; ++i) {
+    array[i] = (int)(i * 2);
+    array[i + NB_PARALLEL_ELMTS] = (int)(i * 3);
+  }
+  merged = malloc(2 * NB_PARALLEL_ELMTS * sizeof(int));
+  NCHECK(merged, NULL);
+  CHECK(sl_parallel_merge
+    (NULL, 1, array, 1, merged, sizeof(int), cmp_int, NULL, NULL), BAD_ARG);
+  CHECK(sl_parallel_merge
+    (array, 1, array, 1, NULL, sizeof(int), cmp_int, NULL, NULL), BAD_ARG);
+  CHECK(sl_parallel_merge
+    (array, 1, array, 1, merged, 0, cmp_int, NULL, NULL), BAD_ARG);
+  CHECK(sl_parallel_merge
+    (array, 1, array, 1, merged, sizeof(int), NULL, 0, NULL), BAD_ARG);
+  CHECK(sl_parallel_merge
+    (array, 2, array + 2, 2, array + 3, sizeof(int), cmp_int, NULL, NULL),
+     BAD_ARG);
+  CHECK(sl_parallel_merge
+    (NULL, 0, NULL, 0, merged, sizeof(int), cmp_int, NULL, NULL), OK);
+  CHECK(sl_parallel_merge
+    (array, NB_PARALLEL_ELMTS, array + NB_PARALLEL_ELMTS, NB_PARALLEL_ELMTS,
+     merged, sizeof(int), cmp_int, pools[3], &mem_default_allocator), OK);
+  check_sorted(merged, 2 * NB_PARALLEL_ELMTS);
+  CHECK(merged[0], 0);
+  CHECK(merged[2 * NB_PARALLEL_ELMTS - 1],
+    (int)((NB_PARALLEL_ELMTS - 1) * 3));
+  CHECK(sl_parallel_merge
+    (array, NB_PARALLEL_ELMTS, NULL, 0, merged, sizeof(int), cmp_int, NULL,
+     NULL), OK);
+  CHECK(memcmp(merged, array, NB_PARALLEL_ELMTS * sizeof(int)), 0);
+
+  for(ithread = 0; ithread < NB_POOLS; ++ithread)
+    CHECK(sl_free_thread_pool(pools[ithread]), OK);
+  free(array);
+  free(records);
+  free(merged);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
@@ -0,0 +1,135 @@
+#include "../sl_spsc_queue.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+#define NB_MSGS 1000000
+
+static void*
+produce(void* arg)
+{
+  struct sl_spsc_queue* queue = arg;
+  uint64_t batch[7];
+  uint64_t i = 0;
+
+  while(i < NB_MSGS) {
+    size_t n = 0;
+    size_t j = 0;
+    const size_t count = MIN(NB_MSGS - i, (uint64_t)(i % 7 + 1));
+    for(j = 0; j < count; ++j)
+      batch[j] = i + j;
+    CHECK(sl_spsc_queue_enqueue_n(queue, count, batch, &n), OK);
+    if(!n)
+      sched_yield();
+    i += n;
+  }
+  return NULL;
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_spsc_queue* queue = NULL;
+  pthread_t producer;
+  uint64_t batch[16];
+  int ints[16];
+  uint64_t i = 0;
+  size_t len = 0;
+  size_t n = 0;
+  int k = 0;
+  bool b = false;
+
+  CHECK(sl_create_spsc_queue(0, 0, 0, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_spsc_queue(sizeof(int), ALIGNOF(int), 4, NULL, NULL),
+    BAD_ARG);
+  CHECK(sl_create_spsc_queue(0, ALIGNOF(int), 4, NULL, &queue), BAD_ARG);
+  CHECK(sl_create_spsc_queue(sizeof(int), ALIGNOF(int), 0, NULL, &queue),
+    BAD_ARG);
+  CHECK(sl_create_spsc_queue(sizeof(int), 3, 4, NULL, &queue),
+    SL_ALIGNMENT_ERROR);
+  CHECK(sl_create_spsc_queue(sizeof(int), ALIGNOF(int), 3, NULL, &queue), OK);
+
+  CHECK(sl_spsc_queue_capacity(NULL, &len), BAD_ARG);
+  CHECK(sl_spsc_queue_capacity(queue, NULL), BAD_ARG);
+  CHECK(sl_spsc_queue_capacity(queue, &len), OK);
+  CHECK(len, 4);
+  CHECK(sl_spsc_queue_length(NULL, &len), BAD_ARG);
+  CHECK(sl_spsc_queue_length(queue, NULL), BAD_ARG);
+  CHECK(sl_spsc_queue_length(queue, &len), OK);
+  CHECK(len, 0);
+
+  CHECK(sl_spsc_queue_dequeue(NULL, &k, &b), BAD_ARG);
+  CHECK(sl_spsc_queue_dequeue(queue, NULL, &b), BAD_ARG);
+  CHECK(sl_spsc_queue_dequeue(queue, &k, NULL), BAD_ARG);
+  CHECK(sl_spsc_queue_dequeue(queue, &k, &b), OK);
+  CHECK(b, false);
+
+  CHECK(sl_spsc_queue_enqueue(NULL, &k, &b), BAD_ARG);
+  CHECK(sl_spsc_queue_enqueue(queue, NULL, &b), BAD_ARG);
+  CHECK(sl_spsc_queue_enqueue(queue, &k, NULL), BAD_ARG);
+  for(k = 0; k < 4; ++k) {
+    CHECK(sl_spsc_queue_enqueue(queue, &k, &b), OK);
+    CHECK(b, true);
+  }
+  CHECK(sl_spsc_queue_enqueue(queue, &k, &b), OK);
+  CHECK(b, false);
+  CHECK(sl_spsc_queue_length(queue, &len), OK);
+  CHECK(len, 4);
+  CHECK(sl_spsc_queue_dequeue(queue, &k, &b), OK);
+  CHECK(b, true);
+  CHECK(k, 0);
+
+  /* Wrap around the end of the ring buffer. */
+  CHECK(sl_spsc_queue_enqueue_n(NULL, 1, (int[]){0}, &n), BAD_ARG);
+  CHECK(sl_spsc_queue_enqueue_n(queue, 1, NULL, &n), BAD_ARG);
+  CHECK(sl_spsc_queue_enqueue_n(queue, 0, NULL, &n), OK);
+  CHECK(n, 0);
+  CHECK(sl_spsc_queue_enqueue_n(queue, 3, (int[]){4, 5, 6}, &n), OK);
+  CHECK(n, 1);
+  CHECK(sl_spsc_queue_dequeue_n(NULL, 2, ints, &n), BAD_ARG);
+  CHECK(sl_spsc_queue_dequeue_n(queue, 2, NULL, &n), BAD_ARG);
+  CHECK(sl_spsc_queue_dequeue_n(queue, 2, ints, &n), OK);
+  CHECK(n, 2);
+  CHECK(ints[0], 1);
+  CHECK(ints[1], 2);
+  CHECK(sl_spsc_queue_enqueue_n(queue, 3, (int[]){5, 6, 7}, NULL), OK);
+  CHECK(sl_spsc_queue_length(queue, &len), OK);
+  CHECK(len, 4);
+  CHECK(sl_spsc_queue_dequeue_n(queue, 16, ints, &n), OK);
+  CHECK(n, 4);
+  for(k = 0; k < 4; ++k)
+    CHECK(ints[k], k + 3);
+  CHECK(sl_spsc_queue_dequeue_n(queue, 16, ints, NULL), OK);
+
+  CHECK(sl_free_spsc_queue(NULL), BAD_ARG);
+  CHECK(sl_free_spsc_queue(queue), OK);
+
+  /* Transfer messages between two threads. */
+  CHECK(sl_create_spsc_queue
+    (sizeof(uint64_t), ALIGNOF(uint64_t), 64, NULL, &queue), OK);
+  CHECK(pthread_create(&producer, NULL, produce, queue), 0);
+  while(i < NB_MSGS) {
+    size_t j = 0;
+    CHECK(sl_spsc_queue_dequeue_n(queue, 16, batch, &n), OK);
+    if(!n)
+      sched_yield();
+    for(j = 0; j < n; ++j)
+      CHECK(batch[j], i + j);
+    i += n;
+  }
+  CHECK(pthread_join(producer, NULL), 0);
+  CHECK(sl_spsc_queue_length(queue, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_free_spsc_queue(queue), OK);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
@@ -0,0 +1,145 @@
+#include "../sl_thread_pool.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+#define NB_ITEMS 100000
+
+struct fib {
+  struct sl_thread_pool* pool;
+  unsigned n;
+  uint64_t result;
+};
+
+static void
+fill_range(size_t begin, size_t end, void* data)
+{
+  unsigned char* items = data;
+  size_t i = 0;
+  CHECK(begin < end, true);
+  for(i = begin; i < end; ++i)
+    ++items[i];
+}
+
+static void
+check_grain(size_t begin, size_t end, void* data)
+{
+  CHECK(end - begin <= *(size_t*)data, true);
+}
+
+static void
+add(void* data)
+{
+  __atomic_add_fetch((uint64_t*)data, 1, __ATOMIC_RELAXED);
+}
+
+/* Compute the Fibonacci numbers with nested fork-join. */
+static void
+fib(void* data)
+{
+  struct fib* f = data;
+  struct sl_task_group* group = NULL;
+  struct fib sub[2];
+
+  if(f->n < 2) {
+    f->result = f->n;
+    return;
+  }
+  sub[0].pool = sub[1].pool = f->pool;
+  sub[0].n = f->n - 1;
+  sub[1].n = f->n - 2;
+  CHECK(sl_create_task_group(f->pool, &group), OK);
+  CHECK(sl_task_group_run(group, fib, sub + 0), OK);
+  CHECK(sl_task_group_run(group, fib, sub + 1), OK);
+  CHECK(sl_task_group_wait(group), OK);
+  CHECK(sl_free_task_group(group), OK);
+  f->result = sub[0].result + sub[1].result;
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_thread_pool* pool = NULL;
+  struct sl_task_group* group = NULL;
+  unsigned char* items = NULL;
+  uint64_t counter = 0;
+  size_t n = 0;
+  size_t i = 0;
+  size_t nb_threads = 0;
+
+  items = calloc(NB_ITEMS, 1);
+  NCHECK(items, NULL);
+
+  CHECK(sl_create_thread_pool(4, NULL, NULL), BAD_ARG);
+  CHECK(sl_free_thread_pool(NULL), BAD_ARG);
+
+  for(nb_threads = 0; nb_threads < 5; ++nb_threads) {
+    CHECK(sl_create_thread_pool(nb_threads, NULL, &pool), OK);
+    CHECK(sl_thread_pool_thread_count(NULL, &n), BAD_ARG);
+    CHECK(sl_thread_pool_thread_count(pool, NULL), BAD_ARG);
+    CHECK(sl_thread_pool_thread_count(pool, &n), OK);
+    CHECK(n != 0, true);
+    if(nb_threads)
+      CHECK(n, nb_threads);
+
+    CHECK(sl_thread_pool_parallel_for(NULL, 0, 1, 0, fill_range, items),
+      BAD_ARG);
+    CHECK(sl_thread_pool_parallel_for(pool, 0, 1, 0, NULL, items), BAD_ARG);
+    CHECK(sl_thread_pool_parallel_for(pool, 2, 1, 0, fill_range, items),
+      BAD_ARG);
+    CHECK(sl_thread_pool_parallel_for(pool, 1, 1, 0, fill_range, items), OK);
+
+    /* Each item is processed exactly once. */
+    CHECK(sl_thread_pool_parallel_for
+      (pool, 0, NB_ITEMS, 0, fill_range, items), OK);
+    CHECK(sl_thread_pool_parallel_for
+      (pool, 10, NB_ITEMS, 1, fill_range, items), OK);
+    for(i = 0; i < NB_ITEMS; ++i)
+      CHECK(items[i], (unsigned char)(i < 10 ? 1 : 2));
+    n = 37;
+    CHECK(sl_thread_pool_parallel_for
+      (pool, 0, NB_ITEMS, n, check_grain, &n), OK);
+
+    CHECK(sl_create_task_group(NULL, &group), BAD_ARG);
+    CHECK(sl_create_task_group(pool, NULL), BAD_ARG);
+    CHECK(sl_create_task_group(pool, &group), OK);
+    CHECK(sl_task_group_run(NULL, add, &counter), BAD_ARG);
+    CHECK(sl_task_group_run(group, NULL, &counter), BAD_ARG);
+    CHECK(sl_task_group_wait(NULL), BAD_ARG);
+    CHECK(sl_task_group_wait(group), OK);
+    counter = 0;
+    /* Spawn more tasks than the queues can store. */
+    for(i = 0; i < 5000; ++i)
+      CHECK(sl_task_group_run(group, add, &counter), OK);
+    CHECK(sl_task_group_wait(group), OK);
+    CHECK(counter, 5000);
+    CHECK(sl_free_task_group(NULL), BAD_ARG);
+    CHECK(sl_free_task_group(group), OK);
+
+    /* Nested fork-join. */
+    {
+      struct fib f;
+      CHECK(sl_create_task_group(pool, &group), OK);
+      f.pool = pool;
+      f.n = 16;
+      CHECK(sl_task_group_run(group, fib, &f), OK);
+      CHECK(sl_task_group_wait(group), OK);
+      CHECK(f.result, 987);
+      CHECK(sl_free_task_group(group), OK);
+    }
+
+    CHECK(sl_free_thread_pool(pool), OK);
+    for(i = 0; i < NB_ITEMS; ++i)
+      items[i] = 0;
+  }
+  free(items);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
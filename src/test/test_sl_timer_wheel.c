@@ -0,0 +1,181 @@
+#include "../sl_timer_wheel.h"
+#include <snlsys/mem_allocator.h>
+#include <snlsys/snlsys.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#define BAD_ARG SL_INVALID_ARGUMENT
+#define OK SL_NO_ERROR
+#define NB_TIMERS 20000
+
+struct timer {
+  uint64_t deadline;
+  uint32_t handle;
+};
+
+static uint64_t
+random_delay(void)
+{
+  /* Mix short and very long delays to fill the upper levels. */
+  switch(rand() % 4) {
+    case 0: return (uint64_t)(rand() % 64);
+    case 1: return (uint64_t)(rand() % 5000);
+    case 2: return (uint64_t)rand() * 1000;
+    default: return (uint64_t)rand() << 20;
+  }
+}
+
+int
+main(int argc UNUSED, char** argv UNUSED)
+{
+  struct sl_timer_wheel* wheel = NULL;
+  struct timer* expired = NULL;
+  struct timer timer;
+  uint64_t* ids = NULL;
+  char* states = NULL; /* 0: pending, 1: cancelled, 2: expired. */
+  uint64_t id = 0;
+  uint64_t tick = 0;
+  uint64_t prev_tick = 0;
+  size_t count = 0;
+  size_t len = 0;
+  size_t nb_pending = 0;
+  size_t i = 0;
+  int k = 0;
+  void* data = NULL;
+
+  ids = malloc(NB_TIMERS * sizeof(uint64_t));
+  states = malloc(NB_TIMERS);
+  NCHECK(ids, NULL);
+  NCHECK(states, NULL);
+
+  CHECK(sl_create_timer_wheel(0, 0, 0, NULL, NULL), BAD_ARG);
+  CHECK(sl_create_timer_wheel(sizeof(int), ALIGNOF(int), 0, NULL, NULL),
+    BAD_ARG);
+  CHECK(sl_create_timer_wheel(0, ALIGNOF(int), 0, NULL, &wheel), BAD_ARG);
+  CHECK(sl_create_timer_wheel(sizeof(int), 3, 0, NULL, &wheel),
+    SL_ALIGNMENT_ERROR);
+  CHECK(sl_create_timer_wheel(sizeof(int), ALIGNOF(int), 100, NULL, &wheel),
+    OK);
+
+  CHECK(sl_timer_wheel_tick(NULL, &tick), BAD_ARG);
+  CHECK(sl_timer_wheel_tick(wheel, NULL), BAD_ARG);
+  CHECK(sl_timer_wheel_tick(wheel, &tick), OK);
+  CHECK(tick, 100);
+  CHECK(sl_timer_wheel_length(NULL, &len), BAD_ARG);
+  CHECK(sl_timer_wheel_length(wheel, NULL), BAD_ARG);
+  CHECK(sl_timer_wheel_length(wheel, &len), OK);
+  CHECK(len, 0);
+
+  CHECK(sl_timer_wheel_schedule(NULL, 110, (int[]){1}, &id), BAD_ARG);
+  CHECK(sl_timer_wheel_schedule(wheel, 110, NULL, &id), BAD_ARG);
+  CHECK(sl_timer_wheel_schedule(wheel, 110, (int[]){1}, NULL), OK);
+  CHECK(sl_timer_wheel_schedule(wheel, 50, (int[]){0}, NULL), OK);
+  CHECK(sl_timer_wheel_schedule(wheel, 5000, (int[]){3}, &id), OK);
+  CHECK(sl_timer_wheel_schedule(wheel, 200, (int[]){2}, NULL), OK);
+  CHECK(sl_timer_wheel_length(wheel, &len), OK);
+  CHECK(len, 4);
+
+  CHECK(sl_timer_wheel_advance(NULL, 100, &count, &data), BAD_ARG);
+  CHECK(sl_timer_wheel_advance(wheel, 99, &count, &data), BAD_ARG);
+  CHECK(sl_timer_wheel_advance(wheel, 100, NULL, &data), BAD_ARG);
+  CHECK(sl_timer_wheel_advance(wheel, 100, &count, NULL), BAD_ARG);
+  /* The timer scheduled in the past expires on the next advance. */
+  CHECK(sl_timer_wheel_advance(wheel, 100, &count, &data), OK);
+  CHECK(count, 1);
+  CHECK(((int*)data)[0], 0);
+  CHECK(sl_timer_wheel_advance(wheel, 109, &count, &data), OK);
+  CHECK(count, 0);
+  CHECK(data, NULL);
+  CHECK(sl_timer_wheel_advance(wheel, 300, &count, &data), OK);
+  CHECK(count, 2);
+  CHECK(((int*)data)[0], 1);
+  CHECK(((int*)data)[1], 2);
+  CHECK(sl_timer_wheel_tick(wheel, &tick), OK);
+  CHECK(tick, 300);
+
+  CHECK(sl_timer_wheel_cancel(NULL, id), BAD_ARG);
+  CHECK(sl_timer_wheel_cancel(wheel, id + 1), BAD_ARG);
+  CHECK(sl_timer_wheel_cancel(wheel, id), OK);
+  CHECK(sl_timer_wheel_cancel(wheel, id), BAD_ARG);
+  CHECK(sl_timer_wheel_length(wheel, &len), OK);
+  CHECK(len, 0);
+  /* The entry of the cancelled timer is reused with a new id. */
+  CHECK(sl_timer_wheel_schedule(wheel, 400, (int[]){4}, &ids[0]), OK);
+  CHECK(ids[0] != id, true);
+  CHECK(sl_timer_wheel_cancel(wheel, id), BAD_ARG);
+  CHECK(sl_clear_timer_wheel(NULL), BAD_ARG);
+  CHECK(sl_clear_timer_wheel(wheel), OK);
+  CHECK(sl_timer_wheel_length(wheel, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_timer_wheel_cancel(wheel, ids[0]), BAD_ARG);
+  CHECK(sl_timer_wheel_advance(wheel, UINT64_MAX, &count, &data), OK);
+  CHECK(count, 0);
+  CHECK(sl_free_timer_wheel(NULL), BAD_ARG);
+  CHECK(sl_free_timer_wheel(wheel), OK);
+
+  /* Schedule many timers, cancel most of them and check that the others
+   * expire exactly once, in order and not before their deadline. */
+  CHECK(sl_create_timer_wheel(sizeof(struct timer), ALIGNOF(struct timer),
+    12345, NULL, &wheel), OK);
+  tick = 12345;
+  for(i = 0; i < NB_TIMERS; ++i) {
+    timer.deadline = tick + random_delay();
+    timer.handle = (uint32_t)i;
+    states[i] = 0;
+    CHECK(sl_timer_wheel_schedule(wheel, timer.deadline, &timer, ids + i), OK);
+    if(i % 3 == 0) {
+      CHECK(sl_timer_wheel_advance(wheel, ++tick, &count, &data), OK);
+      expired = data;
+      for(k = 0; k < (int)count; ++k) {
+        CHECK(expired[k].deadline <= tick, true);
+        CHECK(states[expired[k].handle], 0);
+        states[expired[k].handle] = 2;
+      }
+    }
+  }
+  for(i = 0; i < NB_TIMERS; ++i) {
+    if(rand() % 10 != 0) {
+      if(states[i] == 0) {
+        CHECK(sl_timer_wheel_cancel(wheel, ids[i]), OK);
+        states[i] = 1;
+      } else {
+        CHECK(sl_timer_wheel_cancel(wheel, ids[i]), BAD_ARG);
+      }
+    }
+  }
+  nb_pending = 0;
+  for(i = 0; i < NB_TIMERS; ++i)
+    nb_pending += states[i] == 0;
+  CHECK(sl_timer_wheel_length(wheel, &len), OK);
+  CHECK(len, nb_pending);
+
+  while(nb_pending) {
+    prev_tick = tick;
+    tick += (uint64_t)rand() * (uint64_t)(1 + rand() % 4096);
+    CHECK(sl_timer_wheel_advance(wheel, tick, &count, &data), OK);
+    expired = data;
+    for(k = 0; k < (int)count; ++k) {
+      CHECK(expired[k].deadline <= tick, true);
+      CHECK(expired[k].deadline >= prev_tick, true);
+      if(k)
+        CHECK(expired[k].deadline >= expired[k-1].deadline, true);
+      CHECK(states[expired[k].handle], 0);
+      states[expired[k].handle] = 2;
+    }
+    nb_pending -= count;
+    CHECK(sl_timer_wheel_length(wheel, &len), OK);
+    CHECK(len, nb_pending);
+  }
+  for(i = 0; i < NB_TIMERS; ++i)
+    CHECK(states[i] != 0, true);
+  CHECK(sl_free_timer_wheel(wheel), OK);
+
+  free(ids);
+  free(states);
+
+  CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
+
+  return 0;
+}
+
@@ -7,14 +7,40 @@
 #define BAD_ARG SL_INVALID_ARGUMENT
 #define OK SL_NO_ERROR
 
+static int
+cmp(const void* p0, const void* p1)
+{
+  const int a = *(const int*)p0;
+  const int b = *(const int*)p1;
+  return -(a < b) | (a > b);
+}
+
+static bool
+is_multiple(const void* data, void* ctx)
+{
+  return (*(const int*)data % *(const int*)ctx) == 0;
+}
+
+/* Count its invocations in ctx. */
+static bool
+is_odd(const void* data, void* ctx)
+{
+  ++*(size_t*)ctx;
+  return (*(const int*)data % 2) != 0;
+}
+
 int
 main(int argc UNUSED, char** argv UNUSED)
 {
   struct sl_vector* vec = NULL;
+  struct sl_vector* vec1 = NULL;
+  struct sl_vector* vec2 = NULL;
   void* data = NULL;
+  void* buf = NULL;
   size_t len = 0;
   size_t size = 0;
   size_t alignment = 0;
+  size_t nb_calls = 0;
   ALIGN(16) int i[4] = {0, 0, 0, 0};
 
 
@@ -562,20 +588,20 @@ main(int argc UNUSED, char** argv UNUSED)
   CHECK(len, 4);
   CHECK(sl_vector_length(vec, &len), OK);
   CHECK(len, 0);
-  CHECK(sl_vector_push_back(vec, (int[]){0}), OK);
-  CHECK(sl_vector_push_back(vec, (int[]){1}), OK);
-  CHECK(sl_vector_push_back(vec, (int[]){2}), OK);
-  CHECK(sl_vector_push_back(vec, (int[]){3}), OK);
+  CHECK(sl_vector_push_back(vec, i), OK);
+  CHECK(sl_vector_push_back(vec, i), OK);
+  CHECK(sl_vector_push_back(vec, i), OK);
+  CHECK(sl_vector_push_back(vec, i), OK);
   CHECK(sl_vector_capacity(vec, &len), OK);
   CHECK(len, 4);
   CHECK(sl_vector_length(vec, &len), OK);
   CHECK(len, 4);
-  CHECK(sl_vector_push_back(vec, (int[]){4}), OK);
+  CHECK(sl_vector_push_back(vec, i), OK);
   CHECK(sl_vector_capacity(vec, &len), OK);
   NCHECK(len, 4);
 
   CHECK(sl_vector_push_back(vec, i + 1), SL_ALIGNMENT_ERROR);
-  CHECK(sl_vector_push_back(vec, (int[]){1}), OK);
+  CHECK(sl_vector_push_back(vec, i), OK);
   CHECK(sl_vector_insert(vec, 0, i + 1), SL_ALIGNMENT_ERROR);
   CHECK(sl_free_vector(vec), OK);
 
@@ -587,6 +613,353 @@ main(int argc UNUSED, char** argv UNUSED)
   CHECK(len >= 16, true);
   CHECK(sl_free_vector(vec), OK);
 
+  CHECK(sl_create_vector(sizeof(int), ALIGNOF(int), NULL, &vec), OK);
+  CHECK(sl_vector_set_growth_policy
+    (NULL, SL_VECTOR_GROWTH_EXACT, 0, 0), BAD_ARG);
+  CHECK(sl_vector_set_growth_policy
+    (vec, SL_VECTOR_GROWTH_CHUNKED, 8, 0), BAD_ARG);
+  CHECK(sl_vector_set_growth_policy(vec, SL_VECTOR_GROWTH_EXACT, 0, 0), OK);
+  CHECK(sl_vector_resize(vec, 5, (int[]){1}), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 5);
+  CHECK(sl_vector_push_back(vec, (int[]){2}), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 6);
+
+  CHECK(sl_vector_set_growth_policy
+    (vec, SL_VECTOR_GROWTH_FACTOR_1_5, 0, 0), OK);
+  CHECK(sl_vector_push_back(vec, (int[]){3}), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 9);
+  CHECK(sl_vector_insert(vec, 0, (int[]){0}), OK);
+  CHECK(sl_vector_insert(vec, 0, (int[]){0}), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 9);
+  CHECK(sl_vector_push_back(vec, (int[]){4}), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 13);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 10);
+  CHECK(((int*)data)[0], 0);
+  CHECK(((int*)data)[1], 0);
+  CHECK(((int*)data)[2], 1);
+  CHECK(((int*)data)[6], 1);
+  CHECK(((int*)data)[7], 2);
+  CHECK(((int*)data)[8], 3);
+  CHECK(((int*)data)[9], 4);
+
+  CHECK(sl_vector_set_growth_policy
+    (vec, SL_VECTOR_GROWTH_CHUNKED, 16, 10), OK);
+  CHECK(sl_vector_resize(vec, 14, NULL), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 16);
+  CHECK(sl_vector_resize(vec, 17, NULL), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 20);
+  CHECK(sl_vector_resize(vec, 21, NULL), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 30);
+
+  CHECK(sl_vector_shrink_to_fit(NULL), BAD_ARG);
+  CHECK(sl_vector_resize(vec, 10, NULL), OK);
+  CHECK(sl_vector_shrink_to_fit(vec), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 10);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 10);
+  CHECK(((int*)data)[0], 0);
+  CHECK(((int*)data)[2], 1);
+  CHECK(((int*)data)[8], 3);
+  CHECK(((int*)data)[9], 4);
+  CHECK(sl_clear_vector(vec), OK);
+  CHECK(sl_vector_shrink_to_fit(vec), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_vector_push_back(vec, (int[]){4}), OK);
+  CHECK(sl_vector_at(vec, 0, &data), OK);
+  CHECK(*(int*)data, 4);
+  CHECK(sl_free_vector(vec), OK);
+
+  CHECK(sl_create_vector(sizeof(int), ALIGNOF(int), NULL, &vec), OK);
+  CHECK(sl_vector_emplace_back(NULL, NULL), BAD_ARG);
+  CHECK(sl_vector_emplace_back(vec, NULL), BAD_ARG);
+  CHECK(sl_vector_emplace_back(NULL, &data), BAD_ARG);
+  CHECK(sl_vector_emplace_back(vec, &data), OK);
+  *(int*)data = 7;
+  CHECK(sl_vector_length(vec, &len), OK);
+  CHECK(len, 1);
+  CHECK(sl_vector_append_uninit(NULL, 3, NULL), BAD_ARG);
+  CHECK(sl_vector_append_uninit(vec, 3, NULL), BAD_ARG);
+  CHECK(sl_vector_append_uninit(NULL, 3, &data), BAD_ARG);
+  CHECK(sl_vector_append_uninit(vec, 0, &data), OK);
+  CHECK(data, NULL);
+  CHECK(sl_vector_length(vec, &len), OK);
+  CHECK(len, 1);
+  CHECK(sl_vector_append_uninit(vec, 3, &data), OK);
+  ((int*)data)[0] = 8;
+  ((int*)data)[1] = 9;
+  ((int*)data)[2] = 10;
+  CHECK(sl_vector_append_uninit(vec, SIZE_MAX, &data), SL_OVERFLOW_ERROR);
+  CHECK(data, NULL);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 4);
+  CHECK(((int*)data)[0], 7);
+  CHECK(((int*)data)[1], 8);
+  CHECK(((int*)data)[2], 9);
+  CHECK(((int*)data)[3], 10);
+  CHECK(sl_free_vector(vec), OK);
+
+  CHECK(sl_create_vector(sizeof(int), ALIGNOF(int), NULL, &vec), OK);
+  CHECK(sl_vector_append_range(NULL, 3, NULL), BAD_ARG);
+  CHECK(sl_vector_append_range(vec, 3, NULL), BAD_ARG);
+  CHECK(sl_vector_append_range(NULL, 3, (int[]){0, 1, 2}), BAD_ARG);
+  CHECK(sl_vector_append_range(vec, 0, (int[]){0, 1, 2}), OK);
+  CHECK(sl_vector_length(vec, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_vector_append_range(vec, 3, (int[]){0, 1, 2}), OK);
+  CHECK(sl_vector_append_range(vec, 2, (int[]){3, 4}), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 5);
+  CHECK(((int*)data)[0], 0);
+  CHECK(((int*)data)[1], 1);
+  CHECK(((int*)data)[2], 2);
+  CHECK(((int*)data)[3], 3);
+  CHECK(((int*)data)[4], 4);
+  CHECK(sl_vector_append_range(vec, 3, (int*)data + 1), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 8);
+  CHECK(((int*)data)[4], 4);
+  CHECK(((int*)data)[5], 1);
+  CHECK(((int*)data)[6], 2);
+  CHECK(((int*)data)[7], 3);
+
+  CHECK(sl_vector_insert_range(NULL, 0, 2, NULL), BAD_ARG);
+  CHECK(sl_vector_insert_range(vec, 0, 2, NULL), BAD_ARG);
+  CHECK(sl_vector_insert_range(vec, 9, 2, (int[]){-1, -2}), BAD_ARG);
+  CHECK(sl_vector_insert_range(vec, 0, 2, (int[]){-1, -2}), OK);
+  CHECK(sl_vector_insert_range(vec, 10, 1, (int[]){-3}), OK);
+  CHECK(sl_vector_insert_range(vec, 4, 3, (int[]){5, 6, 7}), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 14);
+  CHECK(((int*)data)[0], -1);
+  CHECK(((int*)data)[1], -2);
+  CHECK(((int*)data)[2], 0);
+  CHECK(((int*)data)[3], 1);
+  CHECK(((int*)data)[4], 5);
+  CHECK(((int*)data)[5], 6);
+  CHECK(((int*)data)[6], 7);
+  CHECK(((int*)data)[7], 2);
+  CHECK(((int*)data)[8], 3);
+  CHECK(((int*)data)[9], 4);
+  CHECK(((int*)data)[10], 1);
+  CHECK(((int*)data)[11], 2);
+  CHECK(((int*)data)[12], 3);
+  CHECK(((int*)data)[13], -3);
+
+  CHECK(sl_vector_reserve(vec, 32), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(sl_vector_insert_range(vec, 3, 4, (int*)data + 1), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 18);
+  CHECK(((int*)data)[0], -1);
+  CHECK(((int*)data)[1], -2);
+  CHECK(((int*)data)[2], 0);
+  CHECK(((int*)data)[3], -2);
+  CHECK(((int*)data)[4], 0);
+  CHECK(((int*)data)[5], 1);
+  CHECK(((int*)data)[6], 5);
+  CHECK(((int*)data)[7], 1);
+  CHECK(((int*)data)[8], 5);
+  CHECK(((int*)data)[9], 6);
+
+  CHECK(sl_clear_vector(vec), OK);
+  CHECK(sl_vector_push_back_n(vec, 37, (int[]){9}), OK);
+  CHECK(sl_vector_insert_n(vec, 1, 13, (int[]){8}), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 50);
+  for(size = 0; size < len; ++size)
+    CHECK(((int*)data)[size], (size == 0 || size > 13) ? 9 : 8);
+  CHECK(sl_free_vector(vec), OK);
+
+  CHECK(sl_create_vector(sizeof(int), ALIGNOF(int), NULL, &vec), OK);
+  CHECK(sl_vector_sort(NULL, cmp), BAD_ARG);
+  CHECK(sl_vector_sort(vec, NULL), BAD_ARG);
+  CHECK(sl_vector_sort(vec, cmp), OK);
+  CHECK(sl_vector_append_range(vec, 6, (int[]){3, -1, 5, 0, 3, 2}), OK);
+  CHECK(sl_vector_sort(vec, cmp), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 6);
+  CHECK(((int*)data)[0], -1);
+  CHECK(((int*)data)[1], 0);
+  CHECK(((int*)data)[2], 2);
+  CHECK(((int*)data)[3], 3);
+  CHECK(((int*)data)[4], 3);
+  CHECK(((int*)data)[5], 5);
+  CHECK(sl_vector_append_range(vec, 3, (int[]){4, -2, 1}), OK);
+  CHECK(sl_vector_stable_sort(NULL, cmp), BAD_ARG);
+  CHECK(sl_vector_stable_sort(vec, NULL), BAD_ARG);
+  CHECK(sl_vector_stable_sort(vec, cmp), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 9);
+  CHECK(((int*)data)[0], -2);
+  CHECK(((int*)data)[1], -1);
+  CHECK(((int*)data)[2], 0);
+  CHECK(((int*)data)[3], 1);
+  CHECK(((int*)data)[4], 2);
+  CHECK(((int*)data)[5], 3);
+  CHECK(((int*)data)[6], 3);
+  CHECK(((int*)data)[7], 4);
+  CHECK(((int*)data)[8], 5);
+  CHECK(sl_vector_append_range(vec, 2, (int[]){-9, 9}), OK);
+  CHECK(sl_vector_radix_sort(NULL, 0, sizeof(int), SL_SORT_KEY_INT), BAD_ARG);
+  CHECK(sl_vector_radix_sort(vec, 2, sizeof(int), SL_SORT_KEY_INT), BAD_ARG);
+  CHECK(sl_vector_radix_sort(vec, 0, sizeof(int), SL_SORT_KEY_INT), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 11);
+  CHECK(((int*)data)[0], -9);
+  CHECK(((int*)data)[1], -2);
+  CHECK(((int*)data)[9], 5);
+  CHECK(((int*)data)[10], 9);
+
+  CHECK(sl_vector_parallel_sort(NULL, cmp, NULL), BAD_ARG);
+  CHECK(sl_vector_parallel_sort(vec, NULL, NULL), BAD_ARG);
+  CHECK(sl_vector_append_range(vec, 2, (int[]){7, -5}), OK);
+  CHECK(sl_vector_parallel_sort(vec, cmp, NULL), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 13);
+  for(size = 1; size < len; ++size)
+    CHECK(((int*)data)[size - 1] <= ((int*)data)[size], true);
+
+  CHECK(sl_create_vector(sizeof(int), ALIGNOF(int), NULL, &vec1), OK);
+  CHECK(sl_create_vector(sizeof(int), ALIGNOF(int), NULL, &vec2), OK);
+  CHECK(sl_vector_append_range(vec1, 3, (int[]){-3, 4, 8}), OK);
+  CHECK(sl_vector_push_back(vec2, (int[]){42}), OK);
+  CHECK(sl_vector_parallel_merge(NULL, vec, vec1, cmp, NULL), BAD_ARG);
+  CHECK(sl_vector_parallel_merge(vec2, NULL, vec1, cmp, NULL), BAD_ARG);
+  CHECK(sl_vector_parallel_merge(vec2, vec, NULL, cmp, NULL), BAD_ARG);
+  CHECK(sl_vector_parallel_merge(vec2, vec, vec1, NULL, NULL), BAD_ARG);
+  CHECK(sl_vector_parallel_merge(vec, vec, vec1, cmp, NULL), BAD_ARG);
+  CHECK(sl_vector_parallel_merge(vec1, vec, vec1, cmp, NULL), BAD_ARG);
+  CHECK(sl_vector_parallel_merge(vec2, vec, vec1, cmp, NULL), OK);
+  CHECK(sl_vector_buffer(vec2, &len, NULL, NULL, &data), OK);
+  CHECK(len, 16);
+  CHECK(((int*)data)[0], -9);
+  CHECK(((int*)data)[15], 9);
+  for(size = 1; size < len; ++size)
+    CHECK(((int*)data)[size - 1] <= ((int*)data)[size], true);
+  CHECK(sl_free_vector(vec2), OK);
+  CHECK(sl_free_vector(vec1), OK);
+  CHECK(sl_free_vector(vec), OK);
+
+  CHECK(sl_create_vector(sizeof(int), ALIGNOF(int), NULL, &vec), OK);
+  CHECK(sl_vector_swap_remove(vec, 0), BAD_ARG);
+  for(i[0] = 0; i[0] < 10; ++i[0])
+    CHECK(sl_vector_push_back(vec, i), OK);
+  CHECK(sl_vector_swap_remove(NULL, 0), BAD_ARG);
+  CHECK(sl_vector_swap_remove(vec, 10), BAD_ARG);
+  CHECK(sl_vector_swap_remove(vec, 2), OK);
+  CHECK(sl_vector_swap_remove(vec, 8), OK);
+  CHECK(sl_vector_swap_remove(vec, 0), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 7);
+  CHECK(((int*)data)[0], 7);
+  CHECK(((int*)data)[1], 1);
+  CHECK(((int*)data)[2], 9);
+  CHECK(((int*)data)[6], 6);
+
+  CHECK(sl_vector_erase_if(NULL, is_multiple, (int[]){2}), BAD_ARG);
+  CHECK(sl_vector_erase_if(vec, NULL, (int[]){2}), BAD_ARG);
+  CHECK(sl_vector_erase_if(vec, is_multiple, (int[]){2}), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 5);
+  CHECK(((int*)data)[0], 7);
+  CHECK(((int*)data)[1], 1);
+  CHECK(((int*)data)[2], 9);
+  CHECK(((int*)data)[3], 3);
+  CHECK(((int*)data)[4], 5);
+  CHECK(sl_vector_erase_if(vec, is_multiple, (int[]){1}), OK);
+  CHECK(sl_vector_length(vec, &len), OK);
+  CHECK(len, 0);
+  CHECK(sl_vector_erase_if(vec, is_multiple, (int[]){1}), OK);
+
+  for(i[0] = 0; i[0] < 1000; ++i[0])
+    CHECK(sl_vector_push_back(vec, i), OK);
+  CHECK(sl_vector_erase_if(vec, is_multiple, (int[]){3}), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 666);
+  for(size = 0; size < len; ++size) {
+    const int expected = (int)(size / 2 * 3 + size % 2 + 1);
+    CHECK(((int*)data)[size], expected);
+  }
+  /* The predicate is invoked once per element. */
+  CHECK(sl_vector_erase_if(vec, is_odd, &nb_calls), OK);
+  CHECK(nb_calls, 666);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 333);
+  for(size = 0; size < len; ++size) {
+    const int expected = (int)(size / 2 * 6 + (size % 2) * 2 + 2);
+    CHECK(((int*)data)[size], expected);
+  }
+  CHECK(sl_free_vector(vec), OK);
+
+  vec = (struct sl_vector*)&len;
+  CHECK(sl_create_small_vector(sizeof(int), ALIGNOF(int), 0, NULL, &vec),
+    BAD_ARG);
+  CHECK(vec, NULL);
+  CHECK(sl_create_small_vector(0, ALIGNOF(int), 4, NULL, &vec), BAD_ARG);
+  CHECK(sl_create_small_vector(sizeof(int), ALIGNOF(int), 4, NULL, NULL),
+    BAD_ARG);
+  CHECK(sl_create_small_vector(sizeof(int), 3, 4, NULL, &vec),
+    SL_ALIGNMENT_ERROR);
+  CHECK(sl_create_small_vector(sizeof(int), 16, 4, NULL, &vec), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 4);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 0);
+  i[0] = 0;
+  CHECK(sl_vector_push_back(vec, i), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &buf), OK);
+  CHECK(IS_ALIGNED(buf, 16), true);
+  for(i[0] = 1; i[0] < 4; ++i[0])
+    CHECK(sl_vector_push_back(vec, i), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 4);
+  CHECK(data, buf);
+  for(i[0] = 4; i[0] < 9; ++i[0])
+    CHECK(sl_vector_push_back(vec, i), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 9);
+  NCHECK(data, buf);
+  CHECK(IS_ALIGNED(data, 16), true);
+  for(size = 0; size < len; ++size)
+    CHECK(((int*)data)[size], (int)size);
+  CHECK(sl_vector_shrink_to_fit(vec), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 9);
+  CHECK(sl_vector_erase_n(vec, 1, 6), OK);
+  CHECK(sl_vector_shrink_to_fit(vec), OK);
+  CHECK(sl_vector_capacity(vec, &len), OK);
+  CHECK(len, 4);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 3);
+  CHECK(data, buf);
+  CHECK(((int*)data)[0], 0);
+  CHECK(((int*)data)[1], 7);
+  CHECK(((int*)data)[2], 8);
+  CHECK(sl_vector_insert_range(vec, 1, 2, data), OK);
+  CHECK(sl_vector_buffer(vec, &len, NULL, NULL, &data), OK);
+  CHECK(len, 5);
+  CHECK(((int*)data)[0], 0);
+  CHECK(((int*)data)[1], 0);
+  CHECK(((int*)data)[2], 7);
+  CHECK(((int*)data)[3], 7);
+  CHECK(((int*)data)[4], 8);
+  CHECK(sl_free_vector(vec), OK);
+
+  CHECK(sl_create_small_vector(sizeof(int), ALIGNOF(int), 8, NULL, &vec), OK);
+  CHECK(sl_vector_push_back(vec, i), OK);
+  CHECK(sl_free_vector(vec), OK);
+
   CHECK(MEM_ALLOCATED_SIZE(&mem_default_allocator), 0);
 
   return 0;